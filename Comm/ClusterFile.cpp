@@ -0,0 +1,358 @@
+/***********************************************************************
+ClusterFile - Binary file reader for files distributed across a cluster
+using a multicast pipe, with background readahead and block compression.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Portable Communications Library (Comm).
+
+The Portable Communications Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Portable Communications Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Communications Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Comm/ClusterFile.h>
+
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <Comm/MulticastPipe.h>
+
+namespace Comm {
+
+namespace {
+
+/****************************************************************
+Status codes sent from the master to the slaves ahead of a block:
+****************************************************************/
+
+enum BlockStatus
+	{
+	END_OF_FILE=0, // The entire file has been sent
+	READ_ERROR=-1, // The master encountered a read error
+	ABORTED=-2 // The master stopped reading ahead because the file was closed
+	};
+
+}
+
+/****************************
+Methods of class ClusterFile:
+****************************/
+
+void* ClusterFile::masterReadAheadThreadMethod(void)
+	{
+	/* Create a buffer for compressed blocks if the file is shared: */
+	uLongf compressBufferSize=pipe!=0?compressBound(blockSize):0;
+	Bytef* compressBuffer=pipe!=0?new Bytef[compressBufferSize]:0;
+	
+	while(true)
+		{
+		/* Block until there is room in the block queue: */
+		{
+		Threads::MutexCond::Lock blockQueueLock(blockQueueCond);
+		while(blockQueue.size()>=maxQueuedBlocks&&!shutdown)
+			blockQueueCond.wait(blockQueueLock);
+		if(shutdown)
+			{
+			if(pipe!=0)
+				{
+				/* Tell the slaves to stop waiting for blocks: */
+				pipe->write<int>(ABORTED);
+				pipe->finishMessage();
+				}
+			break;
+			}
+		}
+		
+		/* Read the next block from the input file: */
+		Block block;
+		block.data=new unsigned char[blockSize];
+		block.size=0;
+		bool error=false;
+		while(block.size<blockSize)
+			{
+			ssize_t readSize=::read(inputFd,block.data+block.size,blockSize-block.size);
+			if(readSize>0)
+				block.size+=size_t(readSize);
+			else if(readSize==0)
+				break;
+			else if(errno!=EINTR)
+				{
+				error=true;
+				break;
+				}
+			}
+		
+		if(pipe!=0)
+			{
+			if(error||block.size==0)
+				pipe->write<int>(error?READ_ERROR:END_OF_FILE);
+			else
+				{
+				/* Compress the block, and send it raw if it doesn't compress: */
+				uLongf compressedSize=compressBufferSize;
+				pipe->write<int>(int(block.size));
+				if(compress2(compressBuffer,&compressedSize,block.data,block.size,compressionLevel)==Z_OK&&compressedSize<block.size)
+					{
+					pipe->write<unsigned int>((unsigned int)compressedSize);
+					pipe->write<Bytef>(compressBuffer,compressedSize);
+					}
+				else
+					{
+					pipe->write<unsigned int>(0U);
+					pipe->write<unsigned char>(block.data,block.size);
+					}
+				}
+			pipe->finishMessage();
+			}
+		
+		Threads::MutexCond::Lock blockQueueLock(blockQueueCond);
+		if(error||block.size==0)
+			{
+			/* Signal the end of the file or the read error to the reader and bail out: */
+			delete[] block.data;
+			if(error)
+				readAheadError=true;
+			else
+				readAheadDone=true;
+			blockQueueCond.broadcast(blockQueueLock);
+			break;
+			}
+		
+		/* Queue the block for the reader: */
+		blockQueue.push_back(block);
+		blockQueueCond.broadcast(blockQueueLock);
+		}
+	
+	delete[] compressBuffer;
+	
+	return 0;
+	}
+
+void* ClusterFile::slaveReadAheadThreadMethod(void)
+	{
+	/* Create a buffer for compressed blocks: */
+	Bytef* compressBuffer=new Bytef[compressBound(blockSize)];
+	
+	/* Receive blocks until the master signals the end of the file, even if the reader is gone, to keep the pipe in sync: */
+	bool error=false;
+	while(true)
+		{
+		/* Receive the next block's status: */
+		int status=pipe->read<int>();
+		if(status<=0)
+			{
+			if(status!=END_OF_FILE&&status!=ABORTED)
+				error=true;
+			break;
+			}
+		
+		/* Receive and decompress the block: */
+		Block block;
+		block.data=new unsigned char[status];
+		block.size=size_t(status);
+		unsigned int compressedSize=pipe->read<unsigned int>();
+		if(compressedSize==0U)
+			pipe->read<unsigned char>(block.data,block.size);
+		else
+			{
+			pipe->read<Bytef>(compressBuffer,compressedSize);
+			uLongf uncompressedSize=block.size;
+			if(uncompress(block.data,&uncompressedSize,compressBuffer,compressedSize)!=Z_OK||uncompressedSize!=block.size)
+				error=true;
+			}
+		
+		/* Block until there is room in the block queue: */
+		Threads::MutexCond::Lock blockQueueLock(blockQueueCond);
+		while(blockQueue.size()>=maxQueuedBlocks&&!shutdown&&!error)
+			blockQueueCond.wait(blockQueueLock);
+		
+		if(shutdown||error||readAheadError)
+			{
+			/* Drop the block: */
+			delete[] block.data;
+			if(error&&!readAheadError)
+				{
+				/* Signal the error to the reader: */
+				readAheadError=true;
+				blockQueueCond.broadcast(blockQueueLock);
+				}
+			}
+		else
+			{
+			/* Queue the block for the reader: */
+			blockQueue.push_back(block);
+			blockQueueCond.broadcast(blockQueueLock);
+			}
+		}
+	
+	delete[] compressBuffer;
+	
+	/* Signal the end of the file or the read error to the reader: */
+	Threads::MutexCond::Lock blockQueueLock(blockQueueCond);
+	if(error)
+		readAheadError=true;
+	else
+		readAheadDone=true;
+	blockQueueCond.broadcast(blockQueueLock);
+	
+	return 0;
+	}
+
+bool ClusterFile::nextBlock(void)
+	{
+	/* Release the current block: */
+	delete[] currentBlock.data;
+	currentBlock.data=0;
+	currentBlock.size=0;
+	currentPos=0;
+	
+	{
+	Threads::MutexCond::Lock blockQueueLock(blockQueueCond);
+	
+	/* Block until there is a block in the queue, or the readahead thread is done: */
+	while(blockQueue.empty()&&!readAheadDone&&!readAheadError)
+		blockQueueCond.wait(blockQueueLock);
+	
+	if(!blockQueue.empty())
+		{
+		/* Take the next block and wake up the readahead thread: */
+		currentBlock=blockQueue.front();
+		blockQueue.pop_front();
+		blockQueueCond.broadcast(blockQueueLock);
+		return true;
+		}
+	
+	if(!readAheadError)
+		return false;
+	}
+	
+	throw ReadError(blockSize,0);
+	}
+
+ClusterFile::ClusterFile(const char* fileName,MulticastPipe* sPipe,ClusterFile::Endianness sEndianness,size_t sBlockSize,size_t sMaxQueuedBlocks)
+	:inputFd(-1),size(0),
+	 pipe(sPipe),
+	 blockSize(sBlockSize),compressionLevel(Z_BEST_SPEED),
+	 maxQueuedBlocks(sMaxQueuedBlocks>0?sMaxQueuedBlocks:1),
+	 readAheadDone(false),readAheadError(false),shutdown(false),
+	 currentPos(0),offset(0)
+	{
+	currentBlock.data=0;
+	currentBlock.size=0;
+	setEndianness(sEndianness);
+	
+	bool ok;
+	if(pipe==0||pipe->isMaster())
+		{
+		/* Open the input file: */
+		inputFd=open(fileName,O_RDONLY);
+		ok=inputFd>=0;
+		
+		/* Determine the file's size: */
+		struct stat fileStat;
+		if(ok&&fstat(inputFd,&fileStat)==0)
+			size=Offset(fileStat.st_size);
+		
+		if(pipe!=0)
+			{
+			/* Send an error indicator, the block size, and the file size to the slaves: */
+			pipe->write<int>(ok?1:0);
+			pipe->write<unsigned int>((unsigned int)blockSize);
+			pipe->write<Offset>(size);
+			pipe->finishMessage();
+			}
+		}
+	else
+		{
+		/* Receive the error indicator, the block size, and the file size from the master: */
+		ok=pipe->read<int>()!=0;
+		blockSize=pipe->read<unsigned int>();
+		size=pipe->read<Offset>();
+		}
+	
+	if(!ok)
+		{
+		delete pipe;
+		throw OpenError(fileName,"rb");
+		}
+	
+	/* Start the readahead thread: */
+	if(pipe==0||pipe->isMaster())
+		readAheadThread.start(this,&ClusterFile::masterReadAheadThreadMethod);
+	else
+		readAheadThread.start(this,&ClusterFile::slaveReadAheadThreadMethod);
+	}
+
+ClusterFile::~ClusterFile(void)
+	{
+	/* Tell the readahead thread to stop reading ahead and wait for it to terminate: */
+	{
+	Threads::MutexCond::Lock blockQueueLock(blockQueueCond);
+	shutdown=true;
+	blockQueueCond.broadcast(blockQueueLock);
+	}
+	readAheadThread.join();
+	
+	/* Delete all unread blocks: */
+	for(std::deque<Block>::iterator bIt=blockQueue.begin();bIt!=blockQueue.end();++bIt)
+		delete[] bIt->data;
+	delete[] currentBlock.data;
+	
+	/* Close the input file: */
+	if(inputFd>=0)
+		close(inputFd);
+	
+	/* Close the pipe: */
+	delete pipe;
+	}
+
+bool ClusterFile::isMaster(void) const
+	{
+	return pipe==0||pipe->isMaster();
+	}
+
+bool ClusterFile::eof(void)
+	{
+	/* Check if there is unread data in the current block, or in the next one: */
+	return currentPos==currentBlock.size&&!nextBlock();
+	}
+
+size_t ClusterFile::readRaw(void* data,size_t size)
+	{
+	unsigned char* dPtr=static_cast<unsigned char*>(data);
+	size_t numBytesRead=0;
+	while(numBytesRead<size)
+		{
+		/* Go to the next block if the current one is exhausted: */
+		if(currentPos==currentBlock.size&&!nextBlock())
+			break;
+		
+		/* Copy as much data as possible from the current block: */
+		size_t copySize=currentBlock.size-currentPos;
+		if(copySize>size-numBytesRead)
+			copySize=size-numBytesRead;
+		memcpy(dPtr+numBytesRead,currentBlock.data+currentPos,copySize);
+		currentPos+=copySize;
+		numBytesRead+=copySize;
+		}
+	
+	offset+=Offset(numBytesRead);
+	return numBytesRead;
+	}
+
+}
@@ -0,0 +1,153 @@
+/***********************************************************************
+ClusterFile - Binary file reader for files distributed across a cluster
+using a multicast pipe, with background readahead and block compression.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Portable Communications Library (Comm).
+
+The Portable Communications Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Portable Communications Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Communications Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef COMM_CLUSTERFILE_INCLUDED
+#define COMM_CLUSTERFILE_INCLUDED
+
+#include <stddef.h>
+#include <deque>
+#include <Misc/Endianness.h>
+#include <Misc/File.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+
+/* Forward declarations: */
+namespace Comm {
+class MulticastPipe;
+}
+
+namespace Comm {
+
+class ClusterFile
+	{
+	/* Embedded classes: */
+	public:
+	typedef Misc::File::Offset Offset; // Type for file offsets
+	typedef Misc::File::Endianness Endianness; // Enumerated type to enforce file endianness
+	typedef Misc::File::OpenError OpenError; // Exception class to report file opening errors
+	typedef Misc::File::ReadError ReadError; // Exception class to report file reading errors
+	
+	private:
+	struct Block // Structure for a block of uncompressed file data
+		{
+		/* Elements: */
+		public:
+		unsigned char* data; // Pointer to the block's data
+		size_t size; // Amount of data in the block
+		};
+	
+	/* Elements: */
+	int inputFd; // File descriptor of input file on the master node
+	Offset size; // Total size of the file, as determined by the master node
+	MulticastPipe* pipe; // Multicast pipe to distribute input file from master to slaves; owned by file
+	size_t blockSize; // Maximum amount of data in a block
+	int compressionLevel; // zlib compression level for blocks sent to the slaves
+	Endianness endianness; // Endianness of the represented file
+	bool mustSwapEndianness; // Flag if current file endianness is different from machine endianness
+	Threads::MutexCond blockQueueCond; // Mutex protecting the block queue, and condition variable signalling changes to it
+	std::deque<Block> blockQueue; // Queue of blocks read ahead of the reader
+	size_t maxQueuedBlocks; // Maximum number of blocks read ahead of the reader
+	bool readAheadDone; // Flag if the readahead thread has queued the last block of the file
+	bool readAheadError; // Flag if the readahead thread encountered a read error
+	bool shutdown; // Flag to tell the readahead thread to stop reading ahead
+	Threads::Thread readAheadThread; // Thread reading, compressing and sending blocks on the master, and receiving and decompressing them on the slaves
+	Block currentBlock; // Block currently being read
+	size_t currentPos; // Read position in the current block
+	Offset offset; // Read position in the file
+	
+	/* Private methods: */
+	void* masterReadAheadThreadMethod(void); // Reads blocks from the input file and sends them to the slaves
+	void* slaveReadAheadThreadMethod(void); // Receives blocks from the master
+	bool nextBlock(void); // Replaces the current block with the next queued block; returns false at the end of the file; throws exception on read errors
+	
+	/* Constructors and destructors: */
+	public:
+	ClusterFile(const char* fileName,MulticastPipe* sPipe,Endianness sEndianness =Misc::File::DontCare,size_t sBlockSize =65536,size_t sMaxQueuedBlocks =4); // Opens the given file for reading over the given pipe; adopts pipe
+	private:
+	ClusterFile(const ClusterFile& source); // Prohibit copy constructor
+	ClusterFile& operator=(const ClusterFile& source); // Prohibit assignment operator
+	public:
+	~ClusterFile(void); // Closes the file; must be called at the same point in the program on all nodes
+	
+	/* Methods: */
+	bool isMaster(void) const; // Returns true if the file is read on the master node, or not shared
+	Endianness getEndianness(void) const // Returns current endianness setting of file
+		{
+		return endianness;
+		}
+	void setEndianness(Endianness newEndianness) // Sets current endianness setting of file
+		{
+		endianness=newEndianness;
+		#if __BYTE_ORDER==__LITTLE_ENDIAN
+		mustSwapEndianness=endianness==Misc::File::BigEndian;
+		#endif
+		#if __BYTE_ORDER==__BIG_ENDIAN
+		mustSwapEndianness=endianness==Misc::File::LittleEndian;
+		#endif
+		}
+	Offset getSize(void) const // Returns the total size of the file
+		{
+		return size;
+		}
+	Offset tell(void) const // Returns the current read position
+		{
+		return offset;
+		}
+	bool eof(void); // Returns true if the entire file has been read; might block until the next block arrives
+	
+	/* Methods for binary file I/O with endianness conversion: */
+	size_t readRaw(void* data,size_t size); // Reads uninterpreted binary data of the given size; returns amount of data read, which is less than size at the end of the file
+	template <class DataParam>
+	DataParam read(void) // Reads single value
+		{
+		DataParam result;
+		size_t numBytesRead=readRaw(&result,sizeof(DataParam));
+		if(numBytesRead!=sizeof(DataParam))
+			throw ReadError(sizeof(DataParam),numBytesRead);
+		if(mustSwapEndianness)
+			Misc::swapEndianness(result);
+		return result;
+		}
+	template <class DataParam>
+	DataParam& read(DataParam& data) // Reads single value through reference
+		{
+		size_t numBytesRead=readRaw(&data,sizeof(DataParam));
+		if(numBytesRead!=sizeof(DataParam))
+			throw ReadError(sizeof(DataParam),numBytesRead);
+		if(mustSwapEndianness)
+			Misc::swapEndianness(data);
+		return data;
+		}
+	template <class DataParam>
+	size_t read(DataParam* data,size_t numItems) // Reads array of values; returns number of values read
+		{
+		size_t numReadItems=readRaw(data,sizeof(DataParam)*numItems)/sizeof(DataParam);
+		if(mustSwapEndianness)
+			Misc::swapEndianness(data,numReadItems);
+		return numReadItems;
+		}
+	};
+
+}
+
+#endif
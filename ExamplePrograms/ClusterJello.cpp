@@ -358,6 +358,7 @@ ClusterJello::ClusterJello(int& argc,char**& argv,char**& appDefaults)
 		{
 		/* Initialize the simulated Jell-O crystal: */
 		crystal=new JelloCrystal(JelloCrystal::Index(4,4,8));
+		crystal->setTaskScheduler(Vrui::getTaskScheduler());
 		currentSimulationParameters.atomMass=crystal->getAtomMass();
 		currentSimulationParameters.attenuation=crystal->getAttenuation();
 		currentSimulationParameters.gravity=crystal->getGravity();
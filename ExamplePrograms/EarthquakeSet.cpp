@@ -24,14 +24,24 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <string>
+#include <stdexcept>
 #include <iostream>
 #include <algorithm>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/FileNameExtensions.h>
 #include <Misc/File.h>
-#include <Misc/ValueSource.h>
 #include <Threads/GzippedFileCharacterSource.h>
+#include <Comm/MulticastPipe.h>
+#include <Comm/ClusterFile.h>
+#include <Threads/TaskScheduler.h>
 #include <Math/Math.h>
 #include <Math/Constants.h>
 #include <Geometry/ValuedPoint.h>
@@ -52,74 +62,737 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 namespace {
 
-/***********************************************************************
+/**********************************************************************
 Helper classes and functions to parse spreadsheet files in text format:
-***********************************************************************/
+**********************************************************************/
 
-bool strequal(std::string s1,const char* s2)
+bool strequal(const char* s1Begin,const char* s1End,const char* s2)
 	{
-	std::string::const_iterator s1It=s1.begin();
+	const char* s1Ptr=s1Begin;
 	const char* s2Ptr=s2;
-	while(s1It!=s1.end()&&*s2Ptr!='\0'&&tolower(*s1It)==tolower(*s2Ptr))
+	while(s1Ptr!=s1End&&*s2Ptr!='\0'&&tolower(*s1Ptr)==tolower(*s2Ptr))
 		{
-		++s1It;
+		++s1Ptr;
 		++s2Ptr;
 		}
-	return s1It==s1.end()&&*s2Ptr=='\0';
+	return s1Ptr==s1End&&*s2Ptr=='\0';
+	}
+
+inline bool isSpace(char c)
+	{
+	return c==' '||c=='\t'||c=='\r';
+	}
+
+inline const char* skipSpaces(const char* ptr,const char* end)
+	{
+	while(ptr!=end&&isSpace(*ptr))
+		++ptr;
+	return ptr;
+	}
+
+bool parseInteger(const char*& ptr,const char* end,int& value) // Parses a decimal integer with optional leading whitespace and sign, like strtol
+	{
+	ptr=skipSpaces(ptr,end);
+	bool negative=false;
+	if(ptr!=end&&(*ptr=='-'||*ptr=='+'))
+		{
+		negative=*ptr=='-';
+		++ptr;
+		}
+	if(ptr==end||*ptr<'0'||*ptr>'9')
+		return false;
+	value=0;
+	for(;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr)
+		value=value*10+int(*ptr-'0');
+	if(negative)
+		value=-value;
+	return true;
 	}
 
-double parseDateTime(const char* date,const char* time)
+bool parseNumber(const char* begin,const char* end,double& value) // Parses a field containing only a decimal floating-point number; result is identical to strtod's for numbers of up to 15 significant digits
+	{
+	static const double powersOfTen[23]=
+		{
+		1.0e0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,1.0e7,1.0e8,1.0e9,1.0e10,1.0e11,
+		1.0e12,1.0e13,1.0e14,1.0e15,1.0e16,1.0e17,1.0e18,1.0e19,1.0e20,1.0e21,1.0e22
+		};
+	
+	const char* ptr=skipSpaces(begin,end);
+	
+	/* Parse the sign: */
+	bool negative=false;
+	if(ptr!=end&&(*ptr=='-'||*ptr=='+'))
+		{
+		negative=*ptr=='-';
+		++ptr;
+		}
+	
+	/* Parse the mantissa's digits into an integer, and remember the position of the decimal point: */
+	double mantissa=0.0;
+	int exponent=0;
+	int numDigits=0;
+	for(;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr,++numDigits)
+		mantissa=mantissa*10.0+double(*ptr-'0');
+	if(ptr!=end&&*ptr=='.')
+		{
+		for(++ptr;ptr!=end&&*ptr>='0'&&*ptr<='9';++ptr,++numDigits,--exponent)
+			mantissa=mantissa*10.0+double(*ptr-'0');
+		}
+	if(numDigits==0)
+		return false;
+	
+	/* Parse the exponent: */
+	if(ptr!=end&&(*ptr=='e'||*ptr=='E'))
+		{
+		++ptr;
+		int e;
+		if(!parseInteger(ptr,end,e))
+			return false;
+		exponent+=e;
+		}
+	
+	/* Check that the entire field was parsed: */
+	if(skipSpaces(ptr,end)!=end)
+		return false;
+	
+	/* Scale the mantissa; a single multiplication or division by an exact power of ten rounds correctly: */
+	if(exponent>=0)
+		mantissa*=exponent<=22?powersOfTen[exponent]:Math::pow(10.0,double(exponent));
+	else
+		mantissa/=exponent>=-22?powersOfTen[-exponent]:Math::pow(10.0,double(-exponent));
+	value=negative?-mantissa:mantissa;
+	return true;
+	}
+
+double parseNumberOrZero(const char* begin,const char* end) // Parses a field containing a number; returns 0 for malformed fields, like atof
+	{
+	double result;
+	if(!parseNumber(begin,end,result))
+		result=0.0;
+	return result;
+	}
+
+inline const char* clampField(const char* line,const char* lineEnd,int offset) // Returns the position of a fixed-width field in a line, clamped to the end of the line
+	{
+	return lineEnd-line>offset?line+offset:lineEnd;
+	}
+
+double convertLocalTime(int year,int month,int day,int hour,int minute,int second) // Converts a local time to seconds since the epoch
 	{
 	struct tm dateTime;
+	dateTime.tm_sec=second;
+	dateTime.tm_min=minute;
+	dateTime.tm_hour=hour;
+	dateTime.tm_mday=day;
+	dateTime.tm_mon=month;
+	dateTime.tm_year=year;
+	dateTime.tm_isdst=-1;
+	return double(mktime(&dateTime));
+	}
+
+struct DateTimeCache // Structure to remember the start of the most recently parsed day, to avoid calling mktime for every event
+	{
+	/* Elements: */
+	public:
+	int key[3]; // Year, month, and day of the cached day
+	double dayStart; // Start of the cached day in seconds since the epoch
+	bool regular; // Flag if the cached day has no daylight saving time change before its last hour
 	
+	/* Constructors and destructors: */
+	DateTimeCache(void)
+		{
+		key[0]=key[1]=key[2]=-1;
+		}
+	};
+
+double parseDateTime(const char* date,const char* dateEnd,const char* time,const char* timeEnd,DateTimeCache& cache)
+	{
 	/* Parse the date: */
 	int d[3];
-	char* nextPtr=const_cast<char*>(date); // Ugly, but required by API
+	const char* nextPtr=date;
 	for(int i=0;i<3;++i)
 		{
-		d[i]=strtol(nextPtr,&nextPtr,10);
-		if((i<2&&*nextPtr!='/')||(i==2&&*nextPtr!='\0'))
-			Misc::throwStdErr("Format error in date string %s",date);
-		++nextPtr;
+		if(!parseInteger(nextPtr,dateEnd,d[i])||(i<2&&(nextPtr==dateEnd||*nextPtr!='/'))||(i==2&&nextPtr!=dateEnd))
+			Misc::throwStdErr("Format error in date string %s",std::string(date,dateEnd).c_str());
+		if(i<2)
+			++nextPtr;
 		}
+	int year=0,month=0,day=0;
 	if(d[0]>=1&&d[0]<=31&&d[1]>=1&&d[1]<=31)
 		{
 		/* Format is month, day, year: */
-		dateTime.tm_mday=d[1];
-		dateTime.tm_mon=d[0]-1;
-		dateTime.tm_year=d[2]-1900;
+		day=d[1];
+		month=d[0]-1;
+		year=d[2]-1900;
 		}
 	else if(d[1]>=1&&d[1]<=31&&d[2]>=1&&d[2]<=31)
 		{
 		/* Format is year, month, day: */
-		dateTime.tm_mday=d[2];
-		dateTime.tm_mon=d[1]-1;
-		dateTime.tm_year=d[0]-1900;
+		day=d[2];
+		month=d[1]-1;
+		year=d[0]-1900;
 		}
 	else
-		Misc::throwStdErr("Format error in date string %s",date);
+		Misc::throwStdErr("Format error in date string %s",std::string(date,dateEnd).c_str());
 	
 	/* Parse the time: */
 	int t[3];
-	nextPtr=const_cast<char*>(time); // Ugly, but required by API
+	nextPtr=time;
 	for(int i=0;i<3;++i)
 		{
-		t[i]=strtol(nextPtr,&nextPtr,10);
-		if((i<2&&*nextPtr!=':')||(i==2&&*nextPtr!='.'&&*nextPtr!='\0'))
-			Misc::throwStdErr("Format error in time string %s",time);
-		++nextPtr;
+		if(!parseInteger(nextPtr,timeEnd,t[i])||(i<2&&(nextPtr==timeEnd||*nextPtr!=':'))||(i==2&&nextPtr!=timeEnd&&*nextPtr!='.'))
+			Misc::throwStdErr("Format error in time string %s",std::string(time,timeEnd).c_str());
+		if(i<2)
+			++nextPtr;
 		}
 	
 	/* Format is hour, minute, second: */
 	if(t[0]<0||t[0]>23||t[1]<0||t[1]>59||t[2]<0||t[2]>60)
-		Misc::throwStdErr("Format error in time string %s",time);
-	dateTime.tm_sec=t[2];
-	dateTime.tm_min=t[1];
-	dateTime.tm_hour=t[0];
+		Misc::throwStdErr("Format error in time string %s",std::string(time,timeEnd).c_str());
 	
-	/* Convert the date/time structure to seconds since the epoch: */
-	dateTime.tm_isdst=-1;
-	return double(mktime(&dateTime));
+	/* Convert the start of the day to seconds since the epoch unless it is cached; catalogs are usually sorted by time: */
+	if(cache.key[0]!=year||cache.key[1]!=month||cache.key[2]!=day)
+		{
+		cache.dayStart=convertLocalTime(year,month,day,0,0,0);
+		cache.regular=convertLocalTime(year,month,day,23,0,0)-cache.dayStart==23.0*3600.0;
+		cache.key[0]=year;
+		cache.key[1]=month;
+		cache.key[2]=day;
+		}
+	
+	/* Convert the time directly unless the day has a daylight saving time change: */
+	if(cache.regular)
+		return cache.dayStart+double(t[0]*3600+t[1]*60+t[2]);
+	else
+		return convertLocalTime(year,month,day,t[0],t[1],t[2]);
+	}
+
+class FieldReader // Class to split a line of a spreadsheet file into space- or comma-separated fields, with optional quotes
+	{
+	/* Elements: */
+	private:
+	const char* ptr; // Current position in the line
+	const char* lineEnd; // End of the line
+	bool afterComma; // Flag if a comma was skipped, i.e., if another (possibly empty) field follows
+	
+	/* Constructors and destructors: */
+	public:
+	FieldReader(const char* lineBegin,const char* sLineEnd)
+		:ptr(skipSpaces(lineBegin,sLineEnd)),lineEnd(sLineEnd),
+		 afterComma(false)
+		{
+		}
+	
+	/* Methods: */
+	bool eol(void) const // Returns true if all fields have been read
+		{
+		return ptr==lineEnd&&!afterComma;
+		}
+	void readField(const char*& fieldBegin,const char*& fieldEnd) // Reads the next field, which is empty if it is immediately followed by a comma
+		{
+		afterComma=false;
+		if(ptr!=lineEnd&&*ptr=='\"')
+			{
+			/* Read a quoted field: */
+			fieldBegin=++ptr;
+			while(ptr!=lineEnd&&*ptr!='\"')
+				++ptr;
+			fieldEnd=ptr;
+			if(ptr!=lineEnd)
+				++ptr;
+			}
+		else
+			{
+			/* Read an unquoted field: */
+			fieldBegin=ptr;
+			while(ptr!=lineEnd&&*ptr!=','&&!isSpace(*ptr))
+				++ptr;
+			fieldEnd=ptr;
+			}
+		
+		/* Skip the separator: */
+		ptr=skipSpaces(ptr,lineEnd);
+		if(ptr!=lineEnd&&*ptr==',')
+			{
+			ptr=skipSpaces(ptr+1,lineEnd);
+			afterComma=true;
+			}
+		}
+	};
+
+/***************************************************************
+Helper classes and functions to parse catalog files in parallel:
+***************************************************************/
+
+class CatalogBuffer // Class holding the entire contents of a catalog file in memory; maps uncompressed files, and decompresses gzipped files
+	{
+	/* Elements: */
+	private:
+	void* map; // Memory mapping of an uncompressed file, or 0
+	size_t mapSize; // Size of the memory mapping
+	std::vector<char> data; // Decompressed contents of a gzipped file
+	const char* begin; // Beginning of the file's contents
+	const char* end; // End of the file's contents
+	
+	/* Constructors and destructors: */
+	public:
+	CatalogBuffer(const char* fileName)
+		:map(0),mapSize(0),begin(0),end(0)
+		{
+		/* Open the file and check for the gzip magic number: */
+		int fd=open(fileName,O_RDONLY);
+		if(fd<0)
+			Misc::throwStdErr("EarthquakeSet::EarthquakeSet: Could not open input file %s",fileName);
+		struct stat fileStat;
+		unsigned char magic[2]={0,0};
+		if(fstat(fd,&fileStat)<0||(fileStat.st_size>=2&&pread(fd,magic,2,0)!=2))
+			{
+			close(fd);
+			Misc::throwStdErr("EarthquakeSet::EarthquakeSet: Could not read input file %s",fileName);
+			}
+		
+		if(magic[0]==0x1fU&&magic[1]==0x8bU)
+			{
+			/* Decompress the file into memory: */
+			close(fd);
+			Threads::GzippedFileCharacterSource file(fileName);
+			int c;
+			while((c=file.getc())>=0)
+				data.push_back(char(c));
+			if(!data.empty())
+				{
+				begin=&data[0];
+				end=begin+data.size();
+				}
+			}
+		else if(fileStat.st_size>0)
+			{
+			/* Map the file into memory: */
+			mapSize=size_t(fileStat.st_size);
+			map=mmap(0,mapSize,PROT_READ,MAP_PRIVATE,fd,0);
+			close(fd);
+			if(map==MAP_FAILED)
+				{
+				map=0;
+				Misc::throwStdErr("EarthquakeSet::EarthquakeSet: Could not map input file %s",fileName);
+				}
+			madvise(map,mapSize,MADV_SEQUENTIAL);
+			begin=static_cast<const char*>(map);
+			end=begin+mapSize;
+			}
+		else
+			close(fd);
+		}
+	~CatalogBuffer(void)
+		{
+		if(map!=0)
+			munmap(map,mapSize);
+		}
+	
+	/* Methods: */
+	const char* getBegin(void) const
+		{
+		return begin;
+		}
+	const char* getEnd(void) const
+		{
+		return end;
+		}
+	};
+
+inline const char* findLineEnd(const char* ptr,const char* end) // Returns the position of the next newline, or the end of the buffer
+	{
+	const char* lineEnd=static_cast<const char*>(memchr(ptr,'\n',end-ptr));
+	return lineEnd!=0?lineEnd:end;
+	}
+
+struct CatalogChunk // Structure for line-aligned chunks of catalog files, which are parsed independently
+	{
+	/* Elements: */
+	public:
+	const char* begin; // Beginning of the chunk
+	const char* end; // End of the chunk
+	size_t firstEvent; // Index of the chunk's first event slot in the event array
+	size_t numEvents; // Number of events parsed from the chunk
+	std::string error; // Error message if the chunk could not be parsed
+	};
+
+class ANSSLineParser // Class to parse lines of earthquake database snapshots in "readable" ANSS format
+	{
+	/* Elements: */
+	private:
+	double scaleFactor; // Scale factor for Cartesian coordinates
+	
+	/* Constructors and destructors: */
+	public:
+	ANSSLineParser(double sScaleFactor)
+		:scaleFactor(sScaleFactor)
+		{
+		}
+	
+	/* Methods: */
+	bool parseLine(const char* line,const char* lineEnd,EarthquakeSet::Event& e,DateTimeCache& cache) const // Parses an event from a line; returns false if the line does not contain an event
+		{
+		/* Skip empty lines: */
+		if(line==lineEnd)
+			return false;
+		
+		/* Read date and time: */
+		e.time=parseDateTime(line,clampField(line,lineEnd,10),clampField(line,lineEnd,11),clampField(line,lineEnd,22),cache);
+		
+		/* Read event position: */
+		float sphericalCoordinates[3];
+		
+		/* Read latitude: */
+		sphericalCoordinates[0]=Math::rad(float(parseNumberOrZero(clampField(line,lineEnd,23),clampField(line,lineEnd,31))));
+		
+		/* Read longitude: */
+		sphericalCoordinates[1]=Math::rad(float(parseNumberOrZero(clampField(line,lineEnd,32),clampField(line,lineEnd,41))));
+		
+		/* Read depth: */
+		sphericalCoordinates[2]=float(parseNumberOrZero(clampField(line,lineEnd,42),clampField(line,lineEnd,48)));
+		
+		/* Convert the spherical position to Cartesian: */
+		calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
+		
+		/* Read magnitude: */
+		e.magnitude=float(parseNumberOrZero(clampField(line,lineEnd,49),clampField(line,lineEnd,54)));
+		
+		return true;
+		}
+	};
+
+class CSVLineParser // Class to parse lines of earthquake event files in space- or comma-separated format
+	{
+	/* Embedded classes: */
+	public:
+	enum RadiusMode // Enumerated types for radius coordinate modes
+		{
+		RADIUS,DEPTH,NEGDEPTH
+		};
+	
+	/* Elements: */
+	int latIndex,lngIndex,radiusIndex,dateIndex,timeIndex,magIndex; // Column indices of important columns
+	RadiusMode radiusMode; // Interpretation of the radius column
+	int maxIndex; // Largest index of any important column
+	double scaleFactor; // Scale factor for Cartesian coordinates
+	
+	/* Constructors and destructors: */
+	CSVLineParser(double sScaleFactor)
+		:latIndex(-1),lngIndex(-1),radiusIndex(-1),dateIndex(-1),timeIndex(-1),magIndex(-1),
+		 radiusMode(RADIUS),maxIndex(-1),
+		 scaleFactor(sScaleFactor)
+		{
+		}
+	
+	/* Methods: */
+	void parseHeader(const char* line,const char* lineEnd) // Finds the important columns in the header line
+		{
+		FieldReader reader(line,lineEnd);
+		for(int column=0;!reader.eol();++column)
+			{
+			/* Read the next column header: */
+			const char* header;
+			const char* headerEnd;
+			reader.readField(header,headerEnd);
+			
+			/* Parse the column header: */
+			if(strequal(header,headerEnd,"Latitude")||strequal(header,headerEnd,"Lat"))
+				latIndex=column;
+			else if(strequal(header,headerEnd,"Longitude")||strequal(header,headerEnd,"Long")||strequal(header,headerEnd,"Lon"))
+				lngIndex=column;
+			else if(strequal(header,headerEnd,"Radius"))
+				{
+				radiusIndex=column;
+				radiusMode=RADIUS;
+				}
+			else if(strequal(header,headerEnd,"Depth"))
+				{
+				radiusIndex=column;
+				radiusMode=DEPTH;
+				}
+			else if(strequal(header,headerEnd,"Negative Depth")||strequal(header,headerEnd,"Neg Depth")||strequal(header,headerEnd,"NegDepth"))
+				{
+				radiusIndex=column;
+				radiusMode=NEGDEPTH;
+				}
+			else if(strequal(header,headerEnd,"Date"))
+				dateIndex=column;
+			else if(strequal(header,headerEnd,"Time"))
+				timeIndex=column;
+			else if(strequal(header,headerEnd,"Magnitude")||strequal(header,headerEnd,"Mag"))
+				magIndex=column;
+			}
+		
+		/* Determine the number of fields: */
+		maxIndex=latIndex;
+		if(maxIndex<lngIndex)
+			maxIndex=lngIndex;
+		if(maxIndex<radiusIndex)
+			maxIndex=radiusIndex;
+		if(maxIndex<dateIndex)
+			maxIndex=dateIndex;
+		if(maxIndex<timeIndex)
+			maxIndex=timeIndex;
+		if(maxIndex<magIndex)
+			maxIndex=magIndex;
+		}
+	bool isComplete(void) const // Returns true if all important columns were found
+		{
+		return latIndex>=0&&lngIndex>=0&&radiusIndex>=0&&dateIndex>=0&&timeIndex>=0&&magIndex>=0;
+		}
+	bool parseLine(const char* line,const char* lineEnd,EarthquakeSet::Event& e,DateTimeCache& cache) const // Parses an event from a line; returns false if the line does not contain a complete event
+		{
+		float sphericalCoordinates[3]={0.0f,0.0f,0.0f};
+		const char* date="";
+		const char* dateEnd=date;
+		const char* time="";
+		const char* timeEnd=time;
+		float magnitude=0.0f;
+		FieldReader reader(line,lineEnd);
+		int column;
+		for(column=0;!reader.eol();++column)
+			{
+			/* Read the next field: */
+			const char* field;
+			const char* fieldEnd;
+			reader.readField(field,fieldEnd);
+			if(field==fieldEnd)
+				continue;
+			
+			double value;
+			if(column==latIndex||column==lngIndex||column==radiusIndex||column==magIndex)
+				{
+				/* Ignore the malformed event: */
+				if(!parseNumber(field,fieldEnd,value))
+					return false;
+				}
+			if(column==latIndex)
+				sphericalCoordinates[0]=Math::rad(float(value));
+			else if(column==lngIndex)
+				sphericalCoordinates[1]=Math::rad(float(value));
+			else if(column==radiusIndex)
+				sphericalCoordinates[2]=float(value);
+			else if(column==dateIndex)
+				{
+				date=field;
+				dateEnd=fieldEnd;
+				}
+			else if(column==timeIndex)
+				{
+				time=field;
+				timeEnd=fieldEnd;
+				}
+			else if(column==magIndex)
+				magnitude=float(value);
+			}
+		
+		/* Check if all fields were read: */
+		if(column<=maxIndex)
+			return false;
+		
+		/* Convert the read spherical coordinates to Cartesian coordinates: */
+		switch(radiusMode)
+			{
+			case RADIUS:
+				calcRadiusPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
+				break;
+			
+			case DEPTH:
+				calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
+				break;
+			
+			case NEGDEPTH:
+				calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],-sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
+				break;
+			}
+		
+		/* Calculate the event time: */
+		e.time=parseDateTime(date,dateEnd,time,timeEnd,cache);
+		
+		/* Store the event magnitude: */
+		e.magnitude=magnitude;
+		
+		return true;
+		}
+	};
+
+class ChunkLineCounter // Functor class to count the lines in a range of catalog chunks
+	{
+	/* Elements: */
+	private:
+	std::vector<CatalogChunk>& chunks; // List of chunks
+	
+	/* Constructors and destructors: */
+	public:
+	ChunkLineCounter(std::vector<CatalogChunk>& sChunks)
+		:chunks(sChunks)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rangeBegin,size_t rangeEnd)
+		{
+		for(size_t i=rangeBegin;i<rangeEnd;++i)
+			{
+			size_t numLines=0;
+			for(const char* lPtr=chunks[i].begin;lPtr!=chunks[i].end;++numLines)
+				{
+				lPtr=findLineEnd(lPtr,chunks[i].end);
+				if(lPtr!=chunks[i].end)
+					++lPtr;
+				}
+			chunks[i].numEvents=numLines;
+			}
+		}
+	};
+
+template <class LineParserParam>
+class ChunkParser // Functor class to parse the events in a range of catalog chunks directly into the event array
+	{
+	/* Elements: */
+	private:
+	const LineParserParam& lineParser; // Parser for single lines
+	std::vector<CatalogChunk>& chunks; // List of chunks
+	EarthquakeSet::Event* events; // The event array, with one slot for every line
+	
+	/* Constructors and destructors: */
+	public:
+	ChunkParser(const LineParserParam& sLineParser,std::vector<CatalogChunk>& sChunks,EarthquakeSet::Event* sEvents)
+		:lineParser(sLineParser),chunks(sChunks),events(sEvents)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rangeBegin,size_t rangeEnd)
+		{
+		for(size_t i=rangeBegin;i<rangeEnd;++i)
+			{
+			CatalogChunk& chunk=chunks[i];
+			chunk.numEvents=0;
+			DateTimeCache cache;
+			try
+				{
+				const char* lPtr=chunk.begin;
+				while(lPtr!=chunk.end)
+					{
+					const char* lineEnd=findLineEnd(lPtr,chunk.end);
+					if(lineParser.parseLine(lPtr,lineEnd,events[chunk.firstEvent+chunk.numEvents],cache))
+						++chunk.numEvents;
+					lPtr=lineEnd!=chunk.end?lineEnd+1:lineEnd;
+					}
+				}
+			catch(std::runtime_error err)
+				{
+				/* Tasks must not throw exceptions; report the error later: */
+				chunk.error=err.what();
+				}
+			}
+		}
+	};
+
+template <class LineParserParam>
+void parseCatalog(const char* begin,const char* end,const LineParserParam& lineParser,std::vector<EarthquakeSet::Event>& events,Threads::TaskScheduler* taskScheduler) // Parses all lines of a catalog in parallel and appends the events in file order
+	{
+	/* Split the catalog into line-aligned chunks of at least 1MB: */
+	size_t catalogSize=size_t(end-begin);
+	size_t chunkSize=taskScheduler!=0?taskScheduler->calcGrainSize(catalogSize,1024*1024):catalogSize;
+	size_t numChunks=chunkSize>0?(catalogSize+chunkSize-1)/chunkSize:1;
+	std::vector<CatalogChunk> chunks;
+	const char* chunkBegin=begin;
+	for(size_t i=1;i<=numChunks&&chunkBegin!=end;++i)
+		{
+		/* Move the end of the chunk to the next line start: */
+		const char* chunkEnd=i<numChunks?begin+size_t(end-begin)*i/numChunks:end;
+		if(chunkEnd<chunkBegin)
+			chunkEnd=chunkBegin;
+		chunkEnd=findLineEnd(chunkEnd,end);
+		if(chunkEnd!=end)
+			++chunkEnd;
+		
+		CatalogChunk chunk;
+		chunk.begin=chunkBegin;
+		chunk.end=chunkEnd;
+		chunks.push_back(chunk);
+		chunkBegin=chunkEnd;
+		}
+	
+	/* Count the lines in all chunks to assign each line an event slot: */
+	ChunkLineCounter counter(chunks);
+	if(taskScheduler!=0)
+		taskScheduler->parallelFor(0,chunks.size(),1,counter);
+	else
+		counter(0,chunks.size());
+	size_t firstEvent=events.size();
+	size_t numSlots=0;
+	for(std::vector<CatalogChunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		{
+		cIt->firstEvent=firstEvent+numSlots;
+		numSlots+=cIt->numEvents;
+		}
+	events.resize(firstEvent+numSlots);
+	if(numSlots==0)
+		return;
+	
+	/* Parse all chunks: */
+	ChunkParser<LineParserParam> parser(lineParser,chunks,&events[0]);
+	if(taskScheduler!=0)
+		taskScheduler->parallelFor(0,chunks.size(),1,parser);
+	else
+		parser(0,chunks.size());
+	
+	/* Report the first error in file order: */
+	for(std::vector<CatalogChunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		if(!cIt->error.empty())
+			throw std::runtime_error(cIt->error);
+	
+	/* Close the gaps left by lines that did not contain events: */
+	std::vector<EarthquakeSet::Event>::iterator eIt=events.begin()+firstEvent;
+	for(std::vector<CatalogChunk>::iterator cIt=chunks.begin();cIt!=chunks.end();++cIt)
+		{
+		std::vector<EarthquakeSet::Event>::iterator chunkEvents=events.begin()+cIt->firstEvent;
+		if(eIt!=chunkEvents)
+			std::copy(chunkEvents,chunkEvents+cIt->numEvents,eIt);
+		eIt+=cIt->numEvents;
+		}
+	events.erase(eIt,events.end());
+	}
+
+/*****************************************************
+Helper classes and functions to cache parsed catalogs:
+*****************************************************/
+
+struct CacheFileHeader // Structure for headers of binary catalog cache files
+	{
+	/* Elements: */
+	public:
+	char magic[24]; // Magic identifier
+	unsigned int endiannessMarker; // Fixed value in the writer's byte order, to reject cache files written on machines of different endianness
+	unsigned int eventSize; // Size of an event structure, to reject cache files written by incompatible builds
+	unsigned int numEvents; // Number of events in the cache file
+	double scaleFactor; // Scale factor applied to Cartesian coordinates
+	double sourceSize; // Size of the catalog file from which the cache file was created
+	double sourceModTime; // Modification time of the catalog file from which the cache file was created
+	double timeZoneStamps[2]; // Fixed local dates in winter and summer converted to seconds since the epoch, to reject cache files written in a different time zone
+	};
+
+const char cacheFileMagic[24]="EarthquakeSet Cache 1.1"; // Magic identifier of binary catalog cache files
+const unsigned int cacheFileEndiannessMarker=0x12345678U; // Endianness marker of binary catalog cache files
+
+void getTimeZoneStamps(double stamps[2]) // Converts two fixed local dates to seconds since the epoch; event times depend on the time zone and its daylight saving time rules
+	{
+	stamps[0]=convertLocalTime(100,0,1,12,0,0);
+	stamps[1]=convertLocalTime(100,6,1,12,0,0);
+	}
+
+bool getFileStamp(const char* fileName,double& size,double& modTime) // Retrieves a file's size and modification time
+	{
+	struct stat fileStat;
+	if(stat(fileName,&fileStat)<0)
+		return false;
+	size=double(fileStat.st_size);
+	modTime=double(fileStat.st_mtime);
+	return true;
 	}
 
 }
@@ -133,8 +806,15 @@ EarthquakeSet::DataItem::DataItem(void)
 	 scaledPointRadiusLocation(-1),highlightTimeLocation(-1),
 	 currentTimeLocation(-1),pointTextureLocation(-1),
 	 pointTextureObjectId(0),
-	 sortedPointIndicesBufferObjectId(0)
+	 renderPass(0)
 	{
+	for(int i=0;i<2;++i)
+		{
+		sortedOrders[i].valid=false;
+		sortedOrders[i].lastUsed=0;
+		sortedOrders[i].bufferObjectId=0;
+		}
+	
 	/* Check if the vertex buffer object extension is supported: */
 	if(GLARBVertexBufferObject::isSupported())
 		{
@@ -157,9 +837,10 @@ EarthquakeSet::DataItem::DataItem(void)
 
 			/* Create the point texture object: */
 			glGenTextures(1,&pointTextureObjectId);
-
-			/* Create the sorted point index buffer: */
-			glGenBuffersARB(1,&sortedPointIndicesBufferObjectId);
+			
+			/* Create the sorted point index buffers: */
+			for(int i=0;i<2;++i)
+				glGenBuffersARB(1,&sortedOrders[i].bufferObjectId);
 			}
 		}
 	}
@@ -181,8 +862,9 @@ EarthquakeSet::DataItem::~DataItem(void)
 			/* Delete the point texture object: */
 			glDeleteTextures(1,&pointTextureObjectId);
 			
-			/* Delete the sorted point index buffer: */
-			glDeleteBuffersARB(1,&sortedPointIndicesBufferObjectId);
+			/* Delete the sorted point index buffers: */
+			for(int i=0;i<2;++i)
+				glDeleteBuffersARB(1,&sortedOrders[i].bufferObjectId);
 			}
 		}
 	}
@@ -191,239 +873,143 @@ EarthquakeSet::DataItem::~DataItem(void)
 Methods of class EarthquakeSet:
 ******************************/
 
-void EarthquakeSet::loadANSSFile(const char* earthquakeFileName,double scaleFactor)
+void EarthquakeSet::loadANSSFile(const char* begin,const char* end,double scaleFactor)
 	{
-	/* Open the input file: */
-	Misc::File earthquakeFile(earthquakeFileName,"rt");
-	
 	/* Skip the two header lines: */
-	char line[256];
-	for(int i=0;i<2;++i)
-		earthquakeFile.gets(line,sizeof(line));
-	
-	/* Read the rest of the file: */
-	while(!earthquakeFile.eof())
+	const char* bodyBegin=begin;
+	for(int i=0;i<2&&bodyBegin!=end;++i)
 		{
-		/* Read the next line: */
-		earthquakeFile.gets(line,sizeof(line));
-		
-		/* Skip empty lines: */
-		if(line[0]=='\0'||line[0]=='\n')
-			continue;
-		
-		/* Parse an event from the line: */
-		Event e;
-		
-		/* Read date and time: */
-		line[10]='\0';
-		line[22]='\0';
-		e.time=parseDateTime(line+0,line+11);
-		
-		/* Read event position: */
-		float sphericalCoordinates[3];
-		
-		/* Read latitude: */
-		line[31]='\0';
-		sphericalCoordinates[0]=Math::rad(float(atof(line+23)));
-		
-		/* Read longitude: */
-		line[41]='\0';
-		sphericalCoordinates[1]=Math::rad(float(atof(line+32)));
-		
-		/* Read depth: */
-		line[48]='\0';
-		sphericalCoordinates[2]=float(atof(line+42));
-		
-		/* Convert the spherical position to Cartesian: */
-		calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
-		
-		/* Read magnitude: */
-		line[54]='\0';
-		e.magnitude=float(atof(line+49));
-		
-		/* Save the event: */
-		events.push_back(e);
+		bodyBegin=findLineEnd(bodyBegin,end);
+		if(bodyBegin!=end)
+			++bodyBegin;
 		}
+	
+	/* Parse the rest of the file: */
+	ANSSLineParser lineParser(scaleFactor);
+	parseCatalog(bodyBegin,end,lineParser,events,taskScheduler);
 	}
 
-void EarthquakeSet::loadCSVFile(const char* earthquakeFileName,double scaleFactor)
+void EarthquakeSet::loadCSVFile(const char* earthquakeFileName,const char* begin,const char* end,double scaleFactor)
 	{
-	/* Open the input file: */
-	Threads::GzippedFileCharacterSource earthquakeFile(earthquakeFileName);
-	Misc::ValueSource source(earthquakeFile);
-	source.setPunctuation(",\n");
-	source.setQuotes("\"");
-	source.skipWs();
-	
 	/*********************************************************************
 	Parse the point file's header line:
 	*********************************************************************/
 	
-	/* Remember the column indices of important columns: */
-	int latIndex=-1;
-	int lngIndex=-1;
-	int radiusIndex=-1;
-	enum RadiusMode // Enumerated types for radius coordinate modes
-		{
-		RADIUS,DEPTH,NEGDEPTH
-		} radiusMode=RADIUS;
-	int dateIndex=-1;
-	int timeIndex=-1;
-	int magIndex=-1;
-	
-	/* Read the header line's columns: */
-	int column=0;
-	while(true)
-		{
-		/* Read the next column header: */
-		std::string header=!source.eof()&&source.peekc()!='\n'&&source.peekc()!=','?source.readString():"";
-		
-		/* Parse the column header: */
-		if(strequal(header,"Latitude")||strequal(header,"Lat"))
-			latIndex=column;
-		else if(strequal(header,"Longitude")||strequal(header,"Long")||strequal(header,"Lon"))
-			lngIndex=column;
-		else if(strequal(header,"Radius"))
-			{
-			radiusIndex=column;
-			radiusMode=RADIUS;
-			}
-		else if(strequal(header,"Depth"))
-			{
-			radiusIndex=column;
-			radiusMode=DEPTH;
-			}
-		else if(strequal(header,"Negative Depth")||strequal(header,"Neg Depth")||strequal(header,"NegDepth"))
-			{
-			radiusIndex=column;
-			radiusMode=NEGDEPTH;
-			}
-		else if(strequal(header,"Date"))
-			dateIndex=column;
-		else if(strequal(header,"Time"))
-			timeIndex=column;
-		else if(strequal(header,"Magnitude")||strequal(header,"Mag"))
-			magIndex=column;
-		
-		++column;
-		
-		/* Check for end of line: */
-		if(source.eof()||source.peekc()=='\n')
-			break;
-		
-		/* Skip an optional comma: */
-		if(source.peekc()==',')
-			source.skipString();
-		}
-	
-	/* Determine the number of fields: */
-	int maxIndex=latIndex;
-	if(maxIndex<lngIndex)
-		maxIndex=lngIndex;
-	if(maxIndex<radiusIndex)
-		maxIndex=radiusIndex;
-	if(maxIndex<dateIndex)
-		maxIndex=dateIndex;
-	if(maxIndex<timeIndex)
-		maxIndex=timeIndex;
-	if(maxIndex<magIndex)
-		maxIndex=magIndex;
-	
-	/* Skip the newline: */
-	source.skipLine();
-	source.skipWs();
+	CSVLineParser lineParser(scaleFactor);
+	const char* headerEnd=findLineEnd(begin,end);
+	lineParser.parseHeader(begin,headerEnd);
 	
 	/* Check if all required portions have been detected: */
-	if(latIndex<0||lngIndex<0||radiusIndex<0||dateIndex<0||timeIndex<0||magIndex<0)
+	if(!lineParser.isComplete())
 		Misc::throwStdErr("EarthquakeSet::EarthquakeSet: Missing earthquake components in input file %s",earthquakeFileName);
 	
-	/* Read lines from the file: */
-	int lineNumber=2;
-	while(!source.eof())
+	/* Parse the rest of the file: */
+	parseCatalog(headerEnd!=end?headerEnd+1:end,end,lineParser,events,taskScheduler);
+	}
+
+bool EarthquakeSet::loadCacheFile(const char* cacheFileName,const char* earthquakeFileName,double scaleFactor,Comm::MulticastPipe* pipe)
+	{
+	try
 		{
-		float sphericalCoordinates[3]={0.0f,0.0f,0.0f};
-		std::string date,time;
-		float magnitude=0.0f;
-		int column=0;
-		try
-			{
-			while(true)
-				{
-				/* Read the next field: */
-				if(!source.eof()&&source.peekc()!='\n'&&source.peekc()!=',')
-					{
-					if(column==latIndex)
-						sphericalCoordinates[0]=Math::rad(float(source.readNumber()));
-					else if(column==lngIndex)
-						sphericalCoordinates[1]=Math::rad(float(source.readNumber()));
-					else if(column==radiusIndex)
-						sphericalCoordinates[2]=float(source.readNumber());
-					else if(column==dateIndex)
-						date=source.readString();
-					else if(column==timeIndex)
-						time=source.readString();
-					else if(column==magIndex)
-						magnitude=float(source.readNumber());
-					else
-						source.skipString();
-					}
-				
-				++column;
-				
-				/* Check for end of line: */
-				if(source.eof()||source.peekc()=='\n')
-					break;
-				
-				/* Skip an optional comma: */
-				if(source.peekc()==',')
-					source.skipString();
-				}
-			}
-		catch(Misc::ValueSource::NumberError err)
+		/* Check if the cache file matches the catalog file; only the master node reads the file and sends its contents to the slaves: */
+		Comm::ClusterFile cacheFile(cacheFileName,pipe);
+		CacheFileHeader header=cacheFile.read<CacheFileHeader>();
+		double sourceSize,sourceModTime;
+		double timeZoneStamps[2];
+		getTimeZoneStamps(timeZoneStamps);
+		if(memcmp(header.magic,cacheFileMagic,sizeof(cacheFileMagic))!=0||header.endiannessMarker!=cacheFileEndiannessMarker||header.eventSize!=sizeof(Event)||header.scaleFactor!=scaleFactor
+		   ||!getFileStamp(earthquakeFileName,sourceSize,sourceModTime)||header.sourceSize!=sourceSize||header.sourceModTime!=sourceModTime
+		   ||header.timeZoneStamps[0]!=timeZoneStamps[0]||header.timeZoneStamps[1]!=timeZoneStamps[1])
+			return false;
+		
+		/* Check that the cache file contains exactly the number of events stated in its header before allocating memory: */
+		Comm::ClusterFile::Offset expectedSize=Comm::ClusterFile::Offset(sizeof(CacheFileHeader))+Comm::ClusterFile::Offset(header.numEvents)*Comm::ClusterFile::Offset(sizeof(Event)+sizeof(int));
+		if(cacheFile.getSize()!=expectedSize)
+			return false;
+		
+		/* Read the events and their kd-tree order: */
+		std::vector<Event> cachedEvents(header.numEvents);
+		int* cachedTreePointIndices=new int[header.numEvents];
+		if(header.numEvents>0&&(cacheFile.read(&cachedEvents[0],header.numEvents)!=header.numEvents||cacheFile.read(cachedTreePointIndices,header.numEvents)!=header.numEvents))
 			{
-			/* Ignore the error and the malformed event */
+			delete[] cachedTreePointIndices;
+			return false;
 			}
+		events.swap(cachedEvents);
+		treePointIndices=cachedTreePointIndices;
+		return true;
+		}
+	catch(const std::runtime_error&)
+		{
+		/* Ignore unreadable cache files: */
+		return false;
+		}
+	}
+
+void EarthquakeSet::saveCacheFile(const char* cacheFileName,const char* earthquakeFileName,double scaleFactor) const
+	{
+	/* Write to a temporary file first, so that concurrent readers, e.g., other cluster nodes, never see partial cache files: */
+	char hostName[256];
+	if(gethostname(hostName,sizeof(hostName))!=0)
+		hostName[0]='\0';
+	hostName[sizeof(hostName)-1]='\0';
+	char tempFileName[1024];
+	snprintf(tempFileName,sizeof(tempFileName),"%s.%s.%d.tmp",cacheFileName,hostName,int(getpid()));
+	try
+		{
+		CacheFileHeader header;
+		memset(&header,0,sizeof(CacheFileHeader));
+		memcpy(header.magic,cacheFileMagic,sizeof(cacheFileMagic));
+		header.endiannessMarker=cacheFileEndiannessMarker;
+		header.eventSize=sizeof(Event);
+		header.numEvents=events.size();
+		header.scaleFactor=scaleFactor;
+		if(!getFileStamp(earthquakeFileName,header.sourceSize,header.sourceModTime))
+			return;
+		getTimeZoneStamps(header.timeZoneStamps);
 		
-		/* Skip the newline: */
-		source.skipLine();
-		source.skipWs();
-		
-		/* Check if all fields were read: */
-		if(column>maxIndex)
+		{
+		Misc::File cacheFile(tempFileName,"wb");
+		cacheFile.write(header);
+		if(!events.empty())
 			{
-			/* Create an event: */
-			Event e;
-			
-			/* Convert the read spherical coordinates to Cartesian coordinates: */
-			switch(radiusMode)
-				{
-				case RADIUS:
-					calcRadiusPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
-					break;
-				
-				case DEPTH:
-					calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
-					break;
-				
-				case NEGDEPTH:
-					calcDepthPos<float>(sphericalCoordinates[0],sphericalCoordinates[1],-sphericalCoordinates[2]*1000.0f,scaleFactor,e.position.getComponents());
-					break;
-				}
-			
-			/* Calculate the event time: */
-			e.time=parseDateTime(date.c_str(),time.c_str());
-			
-			/* Store the event magnitude: */
-			e.magnitude=magnitude;
-			
-			/* Append the event to the earthquake set: */
-			events.push_back(e);
+			cacheFile.write(&events[0],events.size());
+			cacheFile.write(treePointIndices,events.size());
 			}
+		}
 		
-		++lineNumber;
+		if(rename(tempFileName,cacheFileName)<0)
+			unlink(tempFileName);
+		}
+	catch(const std::runtime_error&)
+		{
+		/* Ignore errors; the catalog file's directory might not be writable: */
+		unlink(tempFileName);
 		}
 	}
 
+void EarthquakeSet::collectSplitPlanes(int left,int right,int splitDimension)
+	{
+	/* Get the current node index: */
+	int mid=(left+right)>>1;
+	
+	/* Add the node's split plane: */
+	SplitPlane sp;
+	sp.value=events[treePointIndices[mid]].position[splitDimension];
+	sp.node=mid;
+	splitPlanes[splitDimension].push_back(sp);
+	
+	int childSplitDimension=splitDimension+1;
+	if(childSplitDimension==3)
+		childSplitDimension=0;
+	
+	/* Recurse into the children: */
+	if(left<mid)
+		collectSplitPlanes(left,mid-1,childSplitDimension);
+	if(right>mid)
+		collectSplitPlanes(mid+1,right,childSplitDimension);
+	}
+
 void EarthquakeSet::drawBackToFront(int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr) const
 	{
 	/* Get the current node index: */
@@ -464,38 +1050,252 @@ void EarthquakeSet::drawBackToFront(int left,int right,int splitDimension,const
 		}
 	}
 
-EarthquakeSet::EarthquakeSet(const char* earthquakeFileName,double scaleFactor)
-	:treePointIndices(0),
-	 pointRadius(1.0f),highlightTime(1.0),currentTime(0.0)
+void EarthquakeSet::addSubtreeJobs(int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr,int maxJobSize,std::vector<EarthquakeSet::SubtreeJob>& jobs) const
 	{
-	/* Check the earthquake file name's extension: */
-	if(Misc::hasCaseExtension(earthquakeFileName,".anss"))
+	/* Check if the subtree is small enough to be sorted by a single job: */
+	if(right-left+1<=maxJobSize)
+		{
+		SubtreeJob job;
+		job.left=left;
+		job.right=right;
+		job.splitDimension=splitDimension;
+		job.bufferPtr=bufferPtr;
+		jobs.push_back(job);
+		bufferPtr+=right-left+1;
+		return;
+		}
+	
+	/* Get the current node index: */
+	int mid=(left+right)>>1;
+	
+	int childSplitDimension=splitDimension+1;
+	if(childSplitDimension==3)
+		childSplitDimension=0;
+	
+	/* Split the subtree in the same order as drawBackToFront: */
+	if(eyePos[splitDimension]>events[treePointIndices[mid]].position[splitDimension])
 		{
-		/* Read an earthquake database snapshot in "readable" ANSS format: */
-		loadANSSFile(earthquakeFileName,scaleFactor);
+		if(left<mid)
+			addSubtreeJobs(left,mid-1,childSplitDimension,eyePos,bufferPtr,maxJobSize,jobs);
+		*bufferPtr=GLuint(mid);
+		++bufferPtr;
+		if(right>mid)
+			addSubtreeJobs(mid+1,right,childSplitDimension,eyePos,bufferPtr,maxJobSize,jobs);
 		}
 	else
 		{
-		/* Read an earthquake event file in space- or comma-separated format: */
-		loadCSVFile(earthquakeFileName,scaleFactor);
+		if(right>mid)
+			addSubtreeJobs(mid+1,right,childSplitDimension,eyePos,bufferPtr,maxJobSize,jobs);
+		*bufferPtr=GLuint(mid);
+		++bufferPtr;
+		if(left<mid)
+			addSubtreeJobs(left,mid-1,childSplitDimension,eyePos,bufferPtr,maxJobSize,jobs);
 		}
+	}
+
+void EarthquakeSet::runSubtreeJobs(const std::vector<EarthquakeSet::SubtreeJob>& jobs,const EarthquakeSet::Point& eyePos) const
+	{
+	SubtreeJobRunner runner(*this,jobs,eyePos);
+	if(taskScheduler!=0&&jobs.size()>1)
+		{
+		/* Sort the subtrees in parallel; they write disjoint parts of the index buffer: */
+		taskScheduler->parallelFor(0,jobs.size(),1,runner);
+		}
+	else
+		runner(0,jobs.size());
+	}
+
+int EarthquakeSet::getMaxJobSize(void) const
+	{
+	int numPoints=int(events.size());
+	if(taskScheduler==0)
+		return numPoints;
+	
+	/* Don't split small catalogs: */
+	return int(taskScheduler->calcGrainSize(numPoints,65536));
+	}
+
+bool EarthquakeSet::updateSortedOrder(EarthquakeSet::SortedOrder& order,const EarthquakeSet::Point& eyePos,EarthquakeSet::DataItem* dataItem) const
+	{
+	int numPoints=int(events.size());
+	if(numPoints==0)
+		return false;
+	int maxJobSize=getMaxJobSize();
+	std::vector<SubtreeJob> jobs;
 	
-	/* Create a temporary kd-tree to sort the events for back-to-front traversal: */
-	Geometry::ArrayKdTree<Geometry::ValuedPoint<Point,int> > sortTree(events.size());
-	Geometry::ValuedPoint<Point,int>* stPtr=sortTree.accessPoints();
-	int i=0;
-	for(std::vector<Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt,++stPtr,++i)
+	if(!order.valid)
 		{
-		*stPtr=eIt->position;
-		stPtr->value=i;
+		/* Generate the entire order: */
+		order.indices.resize(events.size());
+		GLuint* bufferPtr=&order.indices[0];
+		addSubtreeJobs(0,numPoints-1,0,eyePos,bufferPtr,maxJobSize,jobs);
+		runSubtreeJobs(jobs,eyePos);
+		order.valid=true;
+		order.eyePos=eyePos;
+		
+		/* Upload the entire order: */
+		glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0,events.size()*sizeof(GLuint),&order.indices[0]);
+		return true;
 		}
-	sortTree.releasePoints(8);
 	
-	/* Retrieve the sorted event indices: */
-	treePointIndices=new int[events.size()];
-	stPtr=sortTree.accessPoints();
-	for(int i=0;i<sortTree.getNumNodes();++i,++stPtr)
-		treePointIndices[i]=stPtr->value;
+	/*********************************************************************
+	The traversal order of a kd-tree node only changes if the eye crosses
+	the node's split plane, i.e., if the plane lies between the old and
+	new eye positions along its split dimension. Find all such nodes by
+	binary search in the sorted split plane lists.
+	*********************************************************************/
+	
+	std::vector<int>& changedNodes=dataItem->changedNodes;
+	changedNodes.clear();
+	for(int dim=0;dim<3;++dim)
+		{
+		SplitPlane lo,hi;
+		lo.value=std::min(order.eyePos[dim],eyePos[dim]);
+		hi.value=std::max(order.eyePos[dim],eyePos[dim]);
+		std::vector<SplitPlane>::const_iterator spBegin=std::lower_bound(splitPlanes[dim].begin(),splitPlanes[dim].end(),lo);
+		std::vector<SplitPlane>::const_iterator spEnd=std::lower_bound(spBegin,splitPlanes[dim].end(),hi);
+		for(std::vector<SplitPlane>::const_iterator spIt=spBegin;spIt!=spEnd;++spIt)
+			changedNodes.push_back(spIt->node);
+		}
+	order.eyePos=eyePos;
+	if(changedNodes.empty())
+		{
+		/* The order is still valid: */
+		return false;
+		}
+	
+	/* Mark the changed nodes: */
+	std::vector<unsigned char>& nodeFlags=dataItem->nodeFlags;
+	if(nodeFlags.size()!=events.size())
+		nodeFlags.assign(events.size(),0);
+	for(std::vector<int>::iterator cnIt=changedNodes.begin();cnIt!=changedNodes.end();++cnIt)
+		nodeFlags[*cnIt]=1;
+	
+	/* Re-sort the subtrees of all changed nodes that do not have changed ancestors; their positions in the order are unaffected: */
+	std::vector<std::pair<int,int> > resortedRanges;
+	for(std::vector<int>::iterator cnIt=changedNodes.begin();cnIt!=changedNodes.end();++cnIt)
+		{
+		/* Descend from the root to the changed node and track the position of its subtree in the order: */
+		int left=0;
+		int right=numPoints-1;
+		int splitDimension=0;
+		int offset=0;
+		bool nested=false;
+		while(true)
+			{
+			int mid=(left+right)>>1;
+			if(mid==*cnIt)
+				break;
+			if(nodeFlags[mid])
+				{
+				/* The node's subtree will be re-sorted as part of its ancestor's: */
+				nested=true;
+				break;
+				}
+			
+			bool leftFirst=eyePos[splitDimension]>events[treePointIndices[mid]].position[splitDimension];
+			if(*cnIt<mid)
+				{
+				if(!leftFirst)
+					offset+=right-mid+1;
+				right=mid-1;
+				}
+			else
+				{
+				if(leftFirst)
+					offset+=mid-left+1;
+				left=mid+1;
+				}
+			if(++splitDimension==3)
+				splitDimension=0;
+			}
+		
+		if(!nested)
+			{
+			GLuint* bufferPtr=&order.indices[offset];
+			addSubtreeJobs(left,right,splitDimension,eyePos,bufferPtr,maxJobSize,jobs);
+			resortedRanges.push_back(std::pair<int,int>(offset,right-left+1));
+			}
+		}
+	
+	/* Reset the node flags: */
+	for(std::vector<int>::iterator cnIt=changedNodes.begin();cnIt!=changedNodes.end();++cnIt)
+		nodeFlags[*cnIt]=0;
+	
+	/* Re-sort the changed subtrees: */
+	runSubtreeJobs(jobs,eyePos);
+	
+	/* Upload the re-sorted subtrees including the split nodes between their jobs, or the entire order if there are many: */
+	if(resortedRanges.size()<=64)
+		{
+		for(std::vector<std::pair<int,int> >::iterator rrIt=resortedRanges.begin();rrIt!=resortedRanges.end();++rrIt)
+			glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,rrIt->first*sizeof(GLuint),rrIt->second*sizeof(GLuint),&order.indices[rrIt->first]);
+		}
+	else
+		glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0,events.size()*sizeof(GLuint),&order.indices[0]);
+	
+	return true;
+	}
+
+EarthquakeSet::EarthquakeSet(const char* earthquakeFileName,double scaleFactor,Threads::TaskScheduler* sTaskScheduler,Comm::MulticastPipe* cachePipe,bool useCacheFile)
+	:treePointIndices(0),
+	 taskScheduler(sTaskScheduler),
+	 pointRadius(1.0f),highlightTime(1.0),currentTime(0.0)
+	{
+	/* Try loading the events and their kd-tree order from a cache file written by an earlier run: */
+	std::string cacheFileName=std::string(earthquakeFileName)+".cache";
+	bool cacheMaster=cachePipe==0||cachePipe->isMaster();
+	if(!useCacheFile)
+		{
+		/* Close the pipe, which would otherwise be adopted by the cache file: */
+		delete cachePipe;
+		}
+	if(!useCacheFile||!loadCacheFile(cacheFileName.c_str(),earthquakeFileName,scaleFactor,cachePipe))
+		{
+		{
+		/* Read the entire earthquake file into memory: */
+		CatalogBuffer buffer(earthquakeFileName);
+		
+		/* Check the earthquake file name's extension: */
+		if(Misc::hasCaseExtension(earthquakeFileName,".anss"))
+			{
+			/* Read an earthquake database snapshot in "readable" ANSS format: */
+			loadANSSFile(buffer.getBegin(),buffer.getEnd(),scaleFactor);
+			}
+		else
+			{
+			/* Read an earthquake event file in space- or comma-separated format: */
+			loadCSVFile(earthquakeFileName,buffer.getBegin(),buffer.getEnd(),scaleFactor);
+			}
+		}
+		
+		/* Create a temporary kd-tree to sort the events for back-to-front traversal: */
+		Geometry::ArrayKdTree<Geometry::ValuedPoint<Point,int> > sortTree(events.size());
+		Geometry::ValuedPoint<Point,int>* stPtr=sortTree.accessPoints();
+		int i=0;
+		for(std::vector<Event>::const_iterator eIt=events.begin();eIt!=events.end();++eIt,++stPtr,++i)
+			{
+			*stPtr=eIt->position;
+			stPtr->value=i;
+			}
+		sortTree.releasePoints(Threads::TaskScheduler::getNumProcessors());
+		
+		/* Retrieve the sorted event indices: */
+		treePointIndices=new int[events.size()];
+		stPtr=sortTree.accessPoints();
+		for(int i=0;i<sortTree.getNumNodes();++i,++stPtr)
+			treePointIndices[i]=stPtr->value;
+		
+		/* Save the events and their kd-tree order for the next run; only the master node writes the cache file: */
+		if(useCacheFile&&cacheMaster)
+			saveCacheFile(cacheFileName.c_str(),earthquakeFileName,scaleFactor);
+		}
+	
+	/* Collect and sort the kd-tree's split planes to track changes in traversal order: */
+	if(!events.empty())
+		collectSplitPlanes(0,int(events.size())-1,0);
+	for(int i=0;i<3;++i)
+		std::sort(splitPlanes[i].begin(),splitPlanes[i].end());
 	}
 
 EarthquakeSet::~EarthquakeSet(void)
@@ -658,9 +1458,12 @@ void EarthquakeSet::initContext(GLContextData& contextData) const
 		glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA,32,32,0,GL_RGBA,GL_FLOAT,&texImage[0][0][0]);
 		glBindTexture(GL_TEXTURE_2D,0);
 		
-		/* Create an index buffer to render points in depth order: */
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->sortedPointIndicesBufferObjectId);
-		glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,events.size()*sizeof(GLuint),0,GL_STREAM_DRAW_ARB);
+		/* Create index buffers to render points in depth order: */
+		for(int i=0;i<2;++i)
+			{
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->sortedOrders[i].bufferObjectId);
+			glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,events.size()*sizeof(GLuint),0,GL_DYNAMIC_DRAW_ARB);
+			}
 		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
 		}
 	}
@@ -821,20 +1624,39 @@ void EarthquakeSet::glRenderAction(const EarthquakeSet::Point& eyePos,bool front
 		GLVertexArrayParts::enable(Vertex::getPartsMask());
 		glVertexPointer(static_cast<Vertex*>(0));
 		
-		if(dataItem->sortedPointIndicesBufferObjectId>0)
+		if(dataItem->sortedOrders[0].bufferObjectId>0)
 			{
-			/* Bind the point indices buffer: */
-			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->sortedPointIndicesBufferObjectId);
+			/* Find the cached order for the same eye position, or an unused order so that each eye in stereo gets its own, or the order for the closest eye position: */
+			SortedOrder* order=0;
+			for(int i=0;i<2&&order==0;++i)
+				if(dataItem->sortedOrders[i].valid&&dataItem->sortedOrders[i].eyePos==eyePos)
+					order=&dataItem->sortedOrders[i];
+			for(int i=0;i<2&&order==0;++i)
+				if(!dataItem->sortedOrders[i].valid)
+					order=&dataItem->sortedOrders[i];
+			if(order==0)
+				{
+				float minDist2=Math::Constants<float>::max;
+				for(int i=0;i<2;++i)
+					{
+					float dist2=Geometry::sqrDist(dataItem->sortedOrders[i].eyePos,eyePos);
+					if(order==0||dist2<minDist2||(dist2==minDist2&&dataItem->sortedOrders[i].lastUsed<order->lastUsed))
+						{
+						order=&dataItem->sortedOrders[i];
+						minDist2=dist2;
+						}
+					}
+				}
+			order->lastUsed=++dataItem->renderPass;
+			
+			/* Bind the order's point indices buffer: */
+			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,order->bufferObjectId);
 			
-			/* Check if the eye position changed since the last rendering pass: */
-			if(dataItem->eyePos!=eyePos)
+			/* Check if the eye position changed since the order was last used: */
+			if(!order->valid||order->eyePos!=eyePos)
 				{
-				/* Re-sort the points according to the new eye position: */
-				GLuint* bufferPtr=static_cast<GLuint*>(glMapBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
-				drawBackToFront(0,int(events.size())-1,0,eyePos,bufferPtr);
-				glUnmapBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB);
-				
-				dataItem->eyePos=eyePos;
+				/* Re-sort the points whose order changed for the new eye position: */
+				updateSortedOrder(*order,eyePos,dataItem);
 				}
 			
 			/* Render the vertex array in back-to-front order: */
@@ -29,6 +29,12 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <GL/GLObject.h>
 
 /* Forward declarations: */
+namespace Threads {
+class TaskScheduler;
+}
+namespace Comm {
+class MulticastPipe;
+}
 class GLShader;
 
 class EarthquakeSet:public GLObject
@@ -48,6 +54,68 @@ class EarthquakeSet:public GLObject
 		};
 	
 	private:
+	struct SplitPlane // Structure for kd-tree split planes, to find the nodes whose traversal order changes when the eye moves
+		{
+		/* Elements: */
+		public:
+		float value; // Position of the split plane along its split dimension
+		int node; // Index of the kd-tree node owning the split plane
+		
+		/* Methods: */
+		bool operator<(const SplitPlane& other) const
+			{
+			return value<other.value;
+			}
+		};
+	
+	struct SubtreeJob // Structure for kd-tree subtrees whose back-to-front orders are generated independently
+		{
+		/* Elements: */
+		public:
+		int left,right; // Index range of the subtree
+		int splitDimension; // Split dimension of the subtree's root
+		GLuint* bufferPtr; // Position of the subtree's order in the index buffer
+		};
+	
+	class SubtreeJobRunner // Functor class to generate the back-to-front orders of a range of subtree jobs
+		{
+		/* Elements: */
+		private:
+		const EarthquakeSet& earthquakeSet; // The earthquake set
+		const std::vector<SubtreeJob>& jobs; // List of subtree jobs
+		const Point& eyePos; // Eye position for which the orders are generated
+		
+		/* Constructors and destructors: */
+		public:
+		SubtreeJobRunner(const EarthquakeSet& sEarthquakeSet,const std::vector<SubtreeJob>& sJobs,const Point& sEyePos)
+			:earthquakeSet(sEarthquakeSet),jobs(sJobs),eyePos(sEyePos)
+			{
+			};
+		
+		/* Methods: */
+		void operator()(size_t rangeBegin,size_t rangeEnd)
+			{
+			for(size_t i=rangeBegin;i<rangeEnd;++i)
+				{
+				GLuint* bufferPtr=jobs[i].bufferPtr;
+				earthquakeSet.drawBackToFront(jobs[i].left,jobs[i].right,jobs[i].splitDimension,eyePos,bufferPtr);
+				}
+			};
+		};
+	
+	friend class SubtreeJobRunner;
+	
+	struct SortedOrder // Structure for cached back-to-front orders of the points
+		{
+		/* Elements: */
+		public:
+		bool valid; // Flag if the order has been generated
+		Point eyePos; // The eye position for which the points have been sorted in depth order
+		unsigned int lastUsed; // Rendering pass in which the order was last used
+		std::vector<GLuint> indices; // Indices of points, sorted in depth order from the eye position; kept to update the order partially
+		GLuint bufferObjectId; // ID of index buffer containing a copy of the indices
+		};
+	
 	struct DataItem:public GLObject::DataItem
 		{
 		/* Elements: */
@@ -62,8 +130,10 @@ class EarthquakeSet:public GLObject
 		GLint frontSphereTestLocation;
 		GLint pointTextureLocation; // Location of texture sample uniform variable in shader program
 		GLuint pointTextureObjectId; // ID of the point texture object
-		Point eyePos; // The eye position for which the points have been sorted in depth order
-		GLuint sortedPointIndicesBufferObjectId; // ID of index buffer containing the indices of points, sorted in depth order from the current eye position
+		SortedOrder sortedOrders[2]; // Back-to-front orders for the two most recently used eye positions, i.e., both eyes in stereo
+		unsigned int renderPass; // Counter of sorted rendering passes
+		std::vector<unsigned char> nodeFlags; // Per-node flags marking the kd-tree nodes whose traversal order changed
+		std::vector<int> changedNodes; // List of kd-tree nodes whose traversal order changed
 		
 		/* Constructors and destructors: */
 		public:
@@ -74,24 +144,37 @@ class EarthquakeSet:public GLObject
 	/* Elements: */
 	std::vector<Event> events; // Vector of earthquakes
 	int* treePointIndices; // Array of event indices in kd-tree order
+	std::vector<SplitPlane> splitPlanes[3]; // Split planes of all kd-tree nodes, by split dimension, sorted by position
+	Threads::TaskScheduler* taskScheduler; // Task scheduler to sort points in parallel, or null
 	float pointRadius; // Point radius in model space
 	double highlightTime; // Time span (in real time) for which earthquake events are highlighted during animation
 	double currentTime; // Current event time during animation
 	
 	/* Private methods: */
-	void loadANSSFile(const char* earthquakeFileName,double scaleFactor); // Loads an earthquake event file in ANSS readable database snapshot format
-	void loadCSVFile(const char* earthquakeFileName,double scaleFactor); // Loads an earthquake event file in space- or comma-separated format
+	void loadANSSFile(const char* begin,const char* end,double scaleFactor); // Parses an earthquake event file in ANSS readable database snapshot format from memory
+	void loadCSVFile(const char* earthquakeFileName,const char* begin,const char* end,double scaleFactor); // Parses an earthquake event file in space- or comma-separated format from memory
+	bool loadCacheFile(const char* cacheFileName,const char* earthquakeFileName,double scaleFactor,Comm::MulticastPipe* pipe); // Loads events and their kd-tree order from a cache file read by the master node and distributed over the given pipe, which is adopted; returns false if the cache file does not exist or is out of date
+	void saveCacheFile(const char* cacheFileName,const char* earthquakeFileName,double scaleFactor) const; // Saves events and their kd-tree order to a cache file; ignores errors
+	void collectSplitPlanes(int left,int right,int splitDimension); // Adds the split planes of the given kd-tree subtree to the split plane lists
 	void drawBackToFront(int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr) const; // Renders the given kd-tree subtree in back-to-front order
+	void addSubtreeJobs(int left,int right,int splitDimension,const Point& eyePos,GLuint*& bufferPtr,int maxJobSize,std::vector<SubtreeJob>& jobs) const; // Renders the top levels of the given kd-tree subtree in back-to-front order, and adds jobs for all subtrees of at most the given size
+	void runSubtreeJobs(const std::vector<SubtreeJob>& jobs,const Point& eyePos) const; // Generates the back-to-front orders of all subtree jobs, in parallel if possible
+	int getMaxJobSize(void) const; // Returns the maximum size of subtrees sorted by a single job
+	bool updateSortedOrder(SortedOrder& order,const Point& eyePos,DataItem* dataItem) const; // Updates the given back-to-front order for the given eye position; returns false if the order did not change
 	
 	/* Constructors and destructors: */
 	public:
-	EarthquakeSet(const char* earthquakeFileName,double scaleFactor); // Creates an earthquake set by reading a file; applies scale factor to Cartesian coordinates
+	EarthquakeSet(const char* earthquakeFileName,double scaleFactor,Threads::TaskScheduler* sTaskScheduler =0,Comm::MulticastPipe* cachePipe =0,bool useCacheFile =true); // Creates an earthquake set by reading a file, or a cache file written by an earlier run unless disabled; applies scale factor to Cartesian coordinates; uses task scheduler to parse the file and sort points in parallel if not null; in a cluster, the cache file is read by the master and sent to the slaves over the given pipe, which is adopted
 	~EarthquakeSet(void);
 	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
 	
 	/* New methods: */
+	const std::vector<Event>& getEvents(void) const // Returns the list of events in file order
+		{
+		return events;
+		}
 	std::pair<double,double> getTimeRange(void) const; // Returns the range of event times
 	void setPointRadius(float newPointRadius); // Sets the point radius in model space
 	void setHighlightTime(double newHighlightTime); // Sets the time span for which events are highlighted during animation
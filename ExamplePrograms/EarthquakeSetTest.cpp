@@ -0,0 +1,178 @@
+/***********************************************************************
+EarthquakeSetTest - Program to measure the time to load large earthquake
+catalogs in the calling thread, on a task scheduler, and from a cache
+file, and to check that all three produce the same events.
+Copyright (c) 2010 Oliver Kreylos
+
+This program is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Misc/File.h>
+#include <Threads/TaskScheduler.h>
+
+#include "EarthquakeSet.h"
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+void writeCatalog(const char* fileName,size_t numEvents) // Writes a comma-separated catalog of pseudo-random events in time order, like real catalogs
+	{
+	Misc::File file(fileName,"wt");
+	FILE* filePtr=file.getFilePtr();
+	fprintf(filePtr,"Date,Time,Latitude,Longitude,Depth,Magnitude\n");
+	unsigned int seed=12345U;
+	time_t eventTime=0;
+	for(size_t i=0;i<numEvents;++i)
+		{
+		unsigned int r[6];
+		for(int j=0;j<6;++j)
+			{
+			seed=seed*1664525U+1013904223U;
+			r[j]=seed>>8;
+			}
+		
+		/* Space events about two minutes apart on average, so that ten million events cover about 40 years: */
+		eventTime+=time_t(r[0]%253U);
+		struct tm eventTm;
+		gmtime_r(&eventTime,&eventTm);
+		double second=double(eventTm.tm_sec)+double(r[1]%100U)/100.0;
+		double latitude=double(r[2]%1800001U)/10000.0-90.0;
+		double longitude=double(r[3]%3600001U)/10000.0-180.0;
+		double depth=double(r[4]%70001U)/100.0;
+		double magnitude=2.0+double(r[5]%701U)/100.0;
+		fprintf(filePtr,"%04d/%02d/%02d,%02d:%02d:%05.2f,%.4f,%.4f,%.2f,%.2f\n",eventTm.tm_year+1900,eventTm.tm_mon+1,eventTm.tm_mday,eventTm.tm_hour,eventTm.tm_min,second,latitude,longitude,depth,magnitude);
+		}
+	}
+
+bool equal(const EarthquakeSet& set1,const EarthquakeSet& set2)
+	{
+	const std::vector<EarthquakeSet::Event>& events1=set1.getEvents();
+	const std::vector<EarthquakeSet::Event>& events2=set2.getEvents();
+	if(events1.size()!=events2.size())
+		return false;
+	for(size_t i=0;i<events1.size();++i)
+		if(events1[i].position!=events2[i].position||events1[i].time!=events2[i].time||events1[i].magnitude!=events2[i].magnitude)
+			return false;
+	return true;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	size_t numEvents=10000000;
+	const char* catalogFileName="EarthquakeSetTest.csv";
+	int numWorkers=Threads::TaskScheduler::getNumProcessors()-1;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-events")==0&&i+1<argc)
+			numEvents=size_t(atol(argv[++i]));
+		else if(strcasecmp(argv[i],"-file")==0&&i+1<argc)
+			catalogFileName=argv[++i];
+		else if(strcasecmp(argv[i],"-threads")==0&&i+1<argc)
+			numWorkers=atoi(argv[++i])-1;
+		}
+	if(numWorkers<0)
+		numWorkers=0;
+	Threads::TaskScheduler taskScheduler(numWorkers);
+	std::string cacheFileName=std::string(catalogFileName)+".cache";
+	
+	/* Create the catalog file and remove any cache file left over from an earlier run: */
+	printf("Writing %u events to %s\n",(unsigned int)numEvents,catalogFileName);
+	writeCatalog(catalogFileName,numEvents);
+	unlink(cacheFileName.c_str());
+	
+	try
+		{
+		/* Load the catalog in the calling thread: */
+		Misc::Timer serialTimer;
+		EarthquakeSet serial(catalogFileName,1.0e-3,0,0,false);
+		serialTimer.elapse();
+		printf("Loading in the calling thread: %.3f s\n",serialTimer.getTime());
+		check(serial.getEvents().size()==numEvents,"all events are loaded");
+		
+		/* Load the catalog on the task scheduler; only one more event set is kept in memory at a time: */
+		{
+		Misc::Timer parallelTimer;
+		EarthquakeSet parallel(catalogFileName,1.0e-3,&taskScheduler,0,false);
+		parallelTimer.elapse();
+		printf("Loading with %d threads: %.3f s\n",numWorkers+1,parallelTimer.getTime());
+		check(equal(serial,parallel),"task scheduler loading matches loading in the calling thread");
+		check(access(cacheFileName.c_str(),F_OK)!=0,"no cache file is written when caching is disabled");
+		}
+		
+		/* Load the catalog and write the cache file: */
+		{
+		Misc::Timer writeTimer;
+		EarthquakeSet writer(catalogFileName,1.0e-3,&taskScheduler);
+		writeTimer.elapse();
+		printf("Loading with %d threads and writing the cache file: %.3f s\n",numWorkers+1,writeTimer.getTime());
+		check(access(cacheFileName.c_str(),F_OK)==0,"cache file is written");
+		}
+		
+		/* Load the cache file: */
+		{
+		Misc::Timer cacheTimer;
+		EarthquakeSet cached(catalogFileName,1.0e-3,&taskScheduler);
+		cacheTimer.elapse();
+		printf("Loading from the cache file: %.3f s\n",cacheTimer.getTime());
+		check(equal(serial,cached),"cache file loading matches loading the catalog");
+		}
+		
+		/* Load with a different scale factor, which must not use the cache file: */
+		{
+		EarthquakeSet rescaled(catalogFileName,2.0e-3,&taskScheduler);
+		check(rescaled.getEvents().size()==numEvents,"all events are loaded at a different scale");
+		check(numEvents==0||rescaled.getEvents()[0].position!=serial.getEvents()[0].position,"cache file is not used for a different scale factor");
+		}
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"Caught exception %s\n",err.what());
+		++numFailures;
+		}
+	
+	/* Clean up: */
+	unlink(cacheFileName.c_str());
+	unlink(catalogFileName);
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -188,6 +188,9 @@ Jello::Jello(int& argc,char**& argv,char**& appDefaults)
 	if(argc>=2)
 		targetFrameRate=atof(argv[1]);
 	
+	/* Run the simulation on Vrui's worker threads: */
+	crystal.setTaskScheduler(Vrui::getTaskScheduler());
+	
 	/* Determine a good color to draw the domain box: */
 	GLColor<GLfloat,3> domainBoxColor;
 	for(int i=0;i<3;++i)
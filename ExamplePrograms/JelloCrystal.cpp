@@ -25,6 +25,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Math/Random.h>
 #include <Math/Constants.h>
 #include <Geometry/Sphere.h>
+#include <Threads/TaskScheduler.h>
 
 #include "JelloCrystal.h"
 
@@ -32,12 +33,162 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 Methods of class JelloCrystal:
 *****************************/
 
+void JelloCrystal::integrate(int stage,size_t rangeBegin,size_t rangeEnd)
+	{
+	JelloAtom* atoms=crystal.getArray();
+	Scalar timeStep=stepTimeStep;
+	switch(stage)
+		{
+		case 0:
+			/* Save initial atom states and calculate accelerations on all atoms: */
+			for(size_t i=rangeBegin;i<rangeEnd;++i)
+				{
+				JelloAtom& a=atoms[i];
+				AtomState& as=atomStates[i];
+				
+				/* Save initial atom state: */
+				as.position=a.position;
+				as.orientation=a.orientation;
+				
+				/* Calculate interaction forces: */
+				a.calculateForces();
+				
+				/* Add gravity: */
+				if(a.position[2]>domain.min[2])
+					a.linearAcceleration[2]-=gravity;
+				
+				/* Store acceleration: */
+				as.linearAcceleration[0]=a.linearAcceleration;
+				as.angularAcceleration[0]=a.angularAcceleration;
+				}
+			break;
+		
+		case 1:
+			{
+			/* Move all atoms to the first evaluation position: */
+			Scalar f1=timeStep*Scalar(0.5);
+			Scalar f2=timeStep*timeStep*Scalar(0.125);
+			for(size_t i=rangeBegin;i<rangeEnd;++i)
+				{
+				JelloAtom& a=atoms[i];
+				AtomState& as=atomStates[i];
+				
+				/* Update the atom's position and orientation: */
+				Vector dP=a.linearVelocity*f1;
+				dP+=as.linearAcceleration[0]*f2;
+				a.position+=dP;
+				Vector dO=a.angularVelocity*f1;
+				dO+=as.angularAcceleration[0]*f2;
+				a.orientation.leftMultiply(Rotation(dO));
+				}
+			break;
+			}
+		
+		case 2:
+		case 4:
+			{
+			/* Calculate accelerations on all atoms: */
+			int evaluation=stage/2;
+			for(size_t i=rangeBegin;i<rangeEnd;++i)
+				{
+				JelloAtom& a=atoms[i];
+				AtomState& as=atomStates[i];
+				
+				/* Calculate interaction forces: */
+				a.calculateForces();
+				
+				/* Add gravity: */
+				if(a.position[2]>domain.min[2])
+					a.linearAcceleration[2]-=gravity;
+				
+				/* Store acceleration: */
+				as.linearAcceleration[evaluation]=a.linearAcceleration;
+				as.angularAcceleration[evaluation]=a.angularAcceleration;
+				}
+			break;
+			}
+		
+		case 3:
+			{
+			/* Move all atoms to the second evaluation position: */
+			Scalar f1=timeStep;
+			Scalar f2=timeStep*timeStep*Scalar(0.5);
+			for(size_t i=rangeBegin;i<rangeEnd;++i)
+				{
+				JelloAtom& a=atoms[i];
+				AtomState& as=atomStates[i];
+				
+				/* Update the atom's position and orientation: */
+				Vector dP=a.linearVelocity*f1;
+				dP+=as.linearAcceleration[1]*f2;
+				a.position=as.position;
+				a.position+=dP;
+				Vector dO=a.angularVelocity*f1;
+				dO+=as.angularAcceleration[0]*f2;
+				a.orientation=as.orientation;
+				a.orientation.leftMultiply(Rotation(dO));
+				}
+			break;
+			}
+		
+		case 5:
+			{
+			/* Move all atoms to the end of the time step: */
+			Scalar f1=timeStep;
+			Scalar f2=timeStep*timeStep/Scalar(6);
+			Scalar f3=timeStep/Scalar(6);
+			for(size_t i=rangeBegin;i<rangeEnd;++i)
+				{
+				JelloAtom& a=atoms[i];
+				AtomState& as=atomStates[i];
+				
+				/* Update the atom's position and orientation: */
+				Vector dP=a.linearVelocity*f1;
+				dP+=(as.linearAcceleration[0]+as.linearAcceleration[1]*Scalar(2))*f2;
+				a.position=as.position;
+				a.position+=dP;
+				Vector dO=a.angularVelocity*f1;
+				dO+=(as.angularAcceleration[0]+as.angularAcceleration[1]*Scalar(2))*f2;
+				a.orientation=as.orientation;
+				a.orientation.leftMultiply(Rotation(dO));
+				a.orientation.renormalize();
+				
+				/* Update the atom's linear and angular velocities: */
+				a.linearVelocity+=(as.linearAcceleration[0]+as.linearAcceleration[1]*Scalar(4)+as.linearAcceleration[2])*f3;
+				a.angularVelocity+=(as.angularAcceleration[0]+as.angularAcceleration[1]*Scalar(4)+as.angularAcceleration[2])*f3;
+				
+				/* Limit the atom to the domain box: */
+				for(int j=0;j<3;++j)
+					{
+					if(a.position[j]<domain.min[j])
+						{
+						a.position[j]=Scalar(2)*domain.min[j]-a.position[j];
+						a.linearVelocity[j]=-a.linearVelocity[j];
+						}
+					else if(a.position[j]>domain.max[j])
+						{
+						a.position[j]=Scalar(2)*domain.max[j]-a.position[j];
+						a.linearVelocity[j]=-a.linearVelocity[j];
+						}
+					}
+				
+				/* Attenuate the atom's velocities: */
+				a.linearVelocity*=stepAttenuation;
+				a.angularVelocity*=stepAttenuation;
+				}
+			break;
+			}
+		}
+	}
+
 JelloCrystal::JelloCrystal(void)
 	:atomMass(1.0),
 	 attenuation(0.5),
 	 gravity(20.0),
 	 domain(Point(-60.0,-36.0,0.0),Point(60.0,60.0,96.0)),
-	 atomStates(0)
+	 atomStates(0),
+	 taskScheduler(0),
+	 stepTimeStep(0),stepAttenuation(1)
 	{
 	/* Initialize the Jell-O crystal: */
 	JelloAtom::initClass();
@@ -50,7 +201,9 @@ JelloCrystal::JelloCrystal(const JelloCrystal::Index& numAtoms)
 	 gravity(20.0),
 	 crystal(numAtoms),
 	 domain(Point(-60.0,-36.0,0.0),Point(60.0,60.0,96.0)),
-	 atomStates(0)
+	 atomStates(0),
+	 taskScheduler(0),
+	 stepTimeStep(0),stepAttenuation(1)
 	{
 	/* Initialize the Jell-O crystal: */
 	JelloAtom::initClass();
@@ -105,6 +258,7 @@ void JelloCrystal::setNumAtoms(const JelloCrystal::Index& newNumAtoms)
 		}
 	
 	/* Initialize the simulation state: */
+	delete[] atomStates;
 	atomStates=new AtomState[crystal.getNumElements()];
 	}
 
@@ -124,6 +278,11 @@ void JelloCrystal::setGravity(JelloCrystal::Scalar newGravity)
 	gravity=newGravity;
 	}
 
+void JelloCrystal::setTaskScheduler(Threads::TaskScheduler* newTaskScheduler)
+	{
+	taskScheduler=newTaskScheduler;
+	}
+
 JelloCrystal::AtomID JelloCrystal::pickAtom(const JelloCrystal::Point& p) const
 	{
 	AtomID result=crystal.end();
@@ -204,138 +363,31 @@ void JelloCrystal::unlockAtom(JelloCrystal::AtomID atom)
 void JelloCrystal::simulate(JelloCrystal::Scalar timeStep)
 	{
 	/* Calculate the effective velocity attenuation for this time step: */
-	Scalar att=Math::pow(attenuation,timeStep);
+	stepTimeStep=timeStep;
+	stepAttenuation=Math::pow(attenuation,timeStep);
 	
 	/***********************************************************
 	Perform a fourth-order Runge-Kutta-Nystrom integration step:
 	***********************************************************/
 	
-	AtomState* asPtr;
-	Scalar f1,f2;
-	
-	/* Save initial atom states and calculate accelerations on all atoms: */
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
+	size_t numAtoms=crystal.getNumElements();
+	if(taskScheduler!=0)
 		{
-		/* Save initial atom state: */
-		asPtr->position=aIt->position;
-		asPtr->orientation=aIt->orientation;
+		/* Split the crystal into slabs along its slowest-varying axis: */
+		size_t slabSize=crystal.getSize(0)>0?numAtoms/size_t(crystal.getSize(0)):numAtoms;
+		size_t grainSize=slabSize*taskScheduler->calcGrainSize(crystal.getSize(0));
 		
-		/* Calculate interaction forces: */
-		aIt->calculateForces();
-		
-		/* Add gravity: */
-		if(aIt->position[2]>domain.min[2])
-			aIt->linearAcceleration[2]-=gravity;
-		
-		/* Store acceleration: */
-		asPtr->linearAcceleration[0]=aIt->linearAcceleration;
-		asPtr->angularAcceleration[0]=aIt->angularAcceleration;
-		}
-	
-	/* Move all atoms to the first evaluation position: */
-	f1=timeStep*Scalar(0.5);
-	f2=timeStep*timeStep*Scalar(0.125);
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Update the atom's position and orientation: */
-		Vector dP=aIt->linearVelocity*f1;
-		dP+=asPtr->linearAcceleration[0]*f2;
-		aIt->position+=dP;
-		Vector dO=aIt->angularVelocity*f1;
-		dO+=asPtr->angularAcceleration[0]*f2;
-		aIt->orientation.leftMultiply(Rotation(dO));
-		}
-	
-	/* Calculate accelerations on all atoms: */
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Calculate interaction forces: */
-		aIt->calculateForces();
-		
-		/* Add gravity: */
-		if(aIt->position[2]>domain.min[2])
-			aIt->linearAcceleration[2]-=gravity;
-		
-		/* Store acceleration: */
-		asPtr->linearAcceleration[1]=aIt->linearAcceleration;
-		asPtr->angularAcceleration[1]=aIt->angularAcceleration;
-		}
-	
-	/* Move all atoms to the second evaluation position: */
-	f1=timeStep;
-	f2=timeStep*timeStep*Scalar(0.5);
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Update the atom's position and orientation: */
-		Vector dP=aIt->linearVelocity*f1;
-		dP+=asPtr->linearAcceleration[1]*f2;
-		aIt->position=asPtr->position;
-		aIt->position+=dP;
-		Vector dO=aIt->angularVelocity*f1;
-		dO+=asPtr->angularAcceleration[0]*f2;
-		aIt->orientation=asPtr->orientation;
-		aIt->orientation.leftMultiply(Rotation(dO));
-		}
-	
-	/* Calculate accelerations on all atoms: */
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Calculate interaction forces: */
-		aIt->calculateForces();
-		
-		/* Add gravity: */
-		if(aIt->position[2]>domain.min[2])
-			aIt->linearAcceleration[2]-=gravity;
-		
-		/* Store acceleration: */
-		asPtr->linearAcceleration[2]=aIt->linearAcceleration;
-		asPtr->angularAcceleration[2]=aIt->angularAcceleration;
-		}
-	
-	/* Move all atoms to the end of the time step: */
-	f1=timeStep;
-	f2=timeStep*timeStep/Scalar(6);
-	Scalar f3=timeStep/Scalar(6);
-	asPtr=atomStates;
-	for(Crystal::iterator aIt=crystal.begin();aIt!=crystal.end();++aIt,++asPtr)
-		{
-		/* Update the atom's position and orientation: */
-		Vector dP=aIt->linearVelocity*f1;
-		dP+=(asPtr->linearAcceleration[0]+asPtr->linearAcceleration[1]*Scalar(2))*f2;
-		aIt->position=asPtr->position;
-		aIt->position+=dP;
-		Vector dO=aIt->angularVelocity*f1;
-		dO+=(asPtr->angularAcceleration[0]+asPtr->angularAcceleration[1]*Scalar(2))*f2;
-		aIt->orientation=asPtr->orientation;
-		aIt->orientation.leftMultiply(Rotation(dO));
-		aIt->orientation.renormalize();
-		
-		/* Update the atom's linear and angular velocities: */
-		aIt->linearVelocity+=(asPtr->linearAcceleration[0]+asPtr->linearAcceleration[1]*Scalar(4)+asPtr->linearAcceleration[2])*f3;
-		aIt->angularVelocity+=(asPtr->angularAcceleration[0]+asPtr->angularAcceleration[1]*Scalar(4)+asPtr->angularAcceleration[2])*f3;
-		
-		/* Limit the atom to the domain box: */
-		for(int i=0;i<3;++i)
+		/* Run the integration stages in order; each stage only writes the state of the atoms in its range, so the results do not depend on the split: */
+		for(int stage=0;stage<6;++stage)
 			{
-			if(aIt->position[i]<domain.min[i])
-				{
-				aIt->position[i]=Scalar(2)*domain.min[i]-aIt->position[i];
-				aIt->linearVelocity[i]=-aIt->linearVelocity[i];
-				}
-			else if(aIt->position[i]>domain.max[i])
-				{
-				aIt->position[i]=Scalar(2)*domain.max[i]-aIt->position[i];
-				aIt->linearVelocity[i]=-aIt->linearVelocity[i];
-				}
+			IntegrationStage integrationStage(*this,stage);
+			taskScheduler->parallelFor(0,numAtoms,grainSize,integrationStage);
 			}
-		
-		/* Attenuate the atom's velocities: */
-		aIt->linearVelocity*=att;
-		aIt->angularVelocity*=att;
+		}
+	else
+		{
+		/* Run the integration stages in order in the calling thread: */
+		for(int stage=0;stage<6;++stage)
+			integrate(stage,0,numAtoms);
 		}
 	}
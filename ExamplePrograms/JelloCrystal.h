@@ -24,6 +24,7 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef JELLOCRYSTAL_INCLUDED
 #define JELLOCRYSTAL_INCLUDED
 
+#include <stddef.h>
 #include <Misc/Array.h>
 #include <Geometry/Ray.h>
 #include <Geometry/Box.h>
@@ -32,6 +33,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include "JelloAtom.h"
 
 /* Forward declarations: */
+namespace Threads {
+class TaskScheduler;
+}
 class JelloRenderer;
 
 class JelloCrystal
@@ -62,6 +66,29 @@ class JelloCrystal
 		Vector angularAcceleration[3];
 		};
 	
+	class IntegrationStage // Functor class to run one stage of a Runge-Kutta-Nystrom integration step on a range of atoms
+		{
+		/* Elements: */
+		private:
+		JelloCrystal& crystal; // The integrated Jell-O crystal
+		int stage; // Index of the integration stage
+		
+		/* Constructors and destructors: */
+		public:
+		IntegrationStage(JelloCrystal& sCrystal,int sStage)
+			:crystal(sCrystal),stage(sStage)
+			{
+			};
+		
+		/* Methods: */
+		void operator()(size_t rangeBegin,size_t rangeEnd)
+			{
+			crystal.integrate(stage,rangeBegin,rangeEnd);
+			};
+		};
+	
+	friend class IntegrationStage;
+	
 	/* Elements: */
 	Scalar atomMass; // Mass of a single Jell-O atom
 	Scalar attenuation; // The velocity attenuation factor
@@ -69,6 +96,12 @@ class JelloCrystal
 	Crystal crystal; // The virtual Jell-O crystal
 	Box domain; // The box containing the Jell-O crystal
 	AtomState* atomStates; // Buffer of atom states for Runge-Kutta-Nystrom integration
+	Threads::TaskScheduler* taskScheduler; // Task scheduler to run integration stages in parallel, or null
+	Scalar stepTimeStep; // Duration of the current time step
+	Scalar stepAttenuation; // Velocity attenuation factor for the current time step
+	
+	/* Private methods: */
+	void integrate(int stage,size_t rangeBegin,size_t rangeEnd); // Runs the given integration stage on the given range of atoms in memory layout order
 	
 	/* Constructors and destructors: */
 	public:
@@ -101,6 +134,11 @@ class JelloCrystal
 	void setAtomMass(Scalar newAtomMass); // Sets the atom mass
 	void setAttenuation(Scalar newAttenuation); // Sets the attenuation
 	void setGravity(Scalar newGravity); // Sets the gravity
+	Threads::TaskScheduler* getTaskScheduler(void) const // Returns the task scheduler used to run the simulation in parallel
+		{
+		return taskScheduler;
+		};
+	void setTaskScheduler(Threads::TaskScheduler* newTaskScheduler); // Sets a task scheduler to run the simulation in parallel; null runs the simulation in the calling thread
 	AtomID pickAtom(const Point& p) const; // Picks a Jell-O atom based on a 3D position
 	AtomID pickAtom(const Ray& r) const; // Picks a Jell-O atom based on a 3D ray
 	bool isValid(AtomID atom) const // Checks if an atom ID is valid
@@ -114,7 +152,7 @@ class JelloCrystal
 		};
 	void setAtomState(AtomID atom,const ONTransform& newAtomState); // Sets the state of an atom; atom must be locked by caller (fails on invalid atom)
 	void unlockAtom(AtomID atom); // Unlocks an atom; atom must be locked by caller (fails on invalid atom)
-	void simulate(Scalar timeStep); // Advances the simulation by the given time step
+	void simulate(Scalar timeStep); // Advances the simulation by the given time step; results do not depend on the task scheduler
 	template <class PipeParam>
 	void writeAtomStates(PipeParam& pipe) const // Writes the states of all atoms to a pipe that supports typed writes
 		{
@@ -19,6 +19,7 @@ with Virtual Jell-O; if not, write to the Free Software Foundation,
 Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
+#include <Geometry/OrthogonalTransformation.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLVertexArrayParts.h>
@@ -341,6 +342,16 @@ void JelloRenderer::glRenderAction(GLContextData& contextData) const
 	// glRenderActionTransparent(contextData);
 	}
 
+void JelloRenderer::submitTransparentItems(Vrui::TransparentObject::DrawItemList& drawItems,GLContextData&) const
+	{
+	if(!active)
+		return;
+	
+	/* Sort the Jell-O block against other transparent objects by the center of its domain in physical coordinates: */
+	Vrui::Point center(Geometry::mid(crystal->domain.min,crystal->domain.max));
+	drawItems.addItem(this,Vrui::getNavigationTransformation().transform(center),0);
+	}
+
 void JelloRenderer::glRenderActionTransparent(GLContextData& contextData) const
 	{
 	if(!active)
@@ -95,6 +95,7 @@ class JelloRenderer:public GLObject,public Vrui::TransparentObject
 	void setActive(bool newActive); // Activates or deactivates the renderer
 	void update(void); // Updates the face splines to represent the new state of the Jell-O crystal; must be called at least once before the first rendering
 	void glRenderAction(GLContextData& contextData) const; // Renders the opaque parts of the most recently updated state of the Jell-O crystal
+	virtual void submitTransparentItems(DrawItemList& drawItems,GLContextData& contextData) const;
 	void glRenderActionTransparent(GLContextData& contextData) const; // Renders the transparent part of the most recently updated state of the Jell-O crystal
 	};
 
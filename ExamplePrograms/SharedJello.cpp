@@ -197,6 +197,17 @@ void SharedJello::sendParamUpdate(void)
 	}
 	}
 
+void SharedJello::readServerUpdate(JelloCrystal& crystal)
+	{
+	/* Apply the keyframe or delta to the quantized atom positions: */
+	SharedJelloPipe::UpdateType updateType=pipe->readUpdate(updateBuffer);
+	SharedJelloPipe::decodeUpdate(updateType,updateBuffer,&atomPositions[0],atomPositions.size()/3);
+	
+	/* Restore the crystal's atom positions: */
+	SharedJelloPipe::PositionDequantizer dequantizer(domain.min,domain.max,&atomPositions[0]);
+	crystal.readAtomStates(dequantizer);
+	}
+
 void* SharedJello::communicationThreadMethod(void)
 	{
 	/* Enable immediate cancellation of this thread: */
@@ -235,7 +246,7 @@ void* SharedJello::communicationThreadMethod(void)
 					nextIndex=(nextIndex+1)%3;
 				
 				/* Process the server update message: */
-				crystals[nextIndex]->readAtomStates(*pipe);
+				readServerUpdate(*crystals[nextIndex]);
 				
 				/* Update the slot's crystal renderer: */
 				renderers[nextIndex]->update();
@@ -325,6 +336,7 @@ SharedJello::SharedJello(int& argc,char**& argv,char**& appDefaults)
 	/* Create triple buffer of Jell-O crystals: */
 	for(int i=0;i<3;++i)
 		crystals[i]=new JelloCrystal(numAtoms);
+	atomPositions.resize(size_t(numAtoms.calcIncrement(-1))*3,0);
 	
 	/* Wait for the first parameter update message to get the initial simulation parameters: */
 	if(pipe->readMessage()!=SharedJelloPipe::SERVER_PARAMUPDATE)
@@ -342,7 +354,7 @@ SharedJello::SharedJello(int& argc,char**& argv,char**& appDefaults)
 		/* Bail out: */
 		Misc::throwStdErr("SharedJello::SharedJello: Connection refused by shared Jell-O server");
 		}
-	crystals[mostRecentIndex]->readAtomStates(*pipe);
+	readServerUpdate(*crystals[mostRecentIndex]);
 	
 	/* Calculate the domain box color: */
 	GLColor<GLfloat,3> domainBoxColor;
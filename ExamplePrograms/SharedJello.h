@@ -91,6 +91,8 @@ class SharedJello:public Vrui::Application
 	Scalar gravity;
 	unsigned int newParameterVersion;
 	unsigned int parameterVersion;
+	std::vector<SharedJelloPipe::QuantizedCoordinate> atomPositions; // Quantized atom positions as of the most recent server update
+	std::vector<unsigned char> updateBuffer; // Buffer for encoded server updates
 	JelloCrystal* crystals[3]; // Triple buffer of client-side virtual Jell-O crystals
 	JelloRenderer* renderers[3]; // Triple buffer of Jell-O crystal renderers
 	volatile int lockedIndex; // Buffer index currently locked by the consumer
@@ -115,6 +117,7 @@ class SharedJello:public Vrui::Application
 	void updateSettingsDialog(void); // Updates the settings dialog
 	GLMotif::PopupWindow* createSettingsDialog(void);
 	void sendParamUpdate(void); // Sends a parameter update method to the server
+	void readServerUpdate(JelloCrystal& crystal); // Reads the contents of a server update message and applies them to the given crystal
 	void* communicationThreadMethod(void); // The thread method receiving state updates from the server
 	
 	/* Constructors and destructors: */
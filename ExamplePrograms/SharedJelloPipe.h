@@ -23,6 +23,9 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SHAREDJELLOPIPE_INCLUDED
 #define SHAREDJELLOPIPE_INCLUDED
 
+#include <stddef.h>
+#include <vector>
+#include <Misc/ThrowStdErr.h>
 #include <Comm/ClusterPipe.h>
 #include <Geometry/OrthonormalTransformation.h>
 
@@ -38,6 +41,7 @@ class SharedJelloPipe:public Comm::ClusterPipe
 	typedef JelloAtom::Vector Vector;
 	typedef JelloAtom::Rotation Rotation;
 	typedef Geometry::OrthonormalTransformation<Scalar,3> ONTransform;
+	typedef unsigned short int QuantizedCoordinate; // Type for atom position components quantized to the crystal's domain box
 	
 	enum MessageId // Enumerated type for protocol messages
 		{
@@ -50,7 +54,94 @@ class SharedJelloPipe:public Comm::ClusterPipe
 		DISCONNECT_REPLY // Reply to a disconnect request
 		};
 	
+	enum UpdateType // Enumerated type for encodings of atom positions in server update messages
+		{
+		KEYFRAME, // Update contains all quantized atom positions
+		DELTA // Update contains changes in quantized atom positions since the previous update
+		};
+	
+	class PositionQuantizer // Helper class to quantize atom positions written by JelloCrystal::writeAtomStates
+		{
+		/* Elements: */
+		private:
+		Point domainMin; // Lower corner of the crystal's domain box
+		Scalar scale[3]; // Scale factors from domain box to quantized coordinates
+		QuantizedCoordinate* qPtr; // Pointer to the next quantized coordinate to write
+		
+		/* Constructors and destructors: */
+		public:
+		PositionQuantizer(const Point& sDomainMin,const Point& domainMax,QuantizedCoordinate* sQPtr)
+			:domainMin(sDomainMin),qPtr(sQPtr)
+			{
+			for(int i=0;i<3;++i)
+				scale[i]=Scalar(65535)/(domainMax[i]-domainMin[i]);
+			};
+		
+		/* Methods: */
+		void write(const Scalar* components,size_t numComponents) // Quantizes the given position components
+			{
+			for(size_t i=0;i<numComponents;++i,++qPtr)
+				{
+				Scalar q=(components[i]-domainMin[i])*scale[i]+Scalar(0.5);
+				*qPtr=q<=Scalar(0)?QuantizedCoordinate(0):q>=Scalar(65535)?QuantizedCoordinate(65535):QuantizedCoordinate(q);
+				}
+			};
+		};
+	
+	class PositionDequantizer // Helper class to restore atom positions read by JelloCrystal::readAtomStates
+		{
+		/* Elements: */
+		private:
+		Point domainMin; // Lower corner of the crystal's domain box
+		Scalar scale[3]; // Scale factors from quantized coordinates to domain box
+		const QuantizedCoordinate* qPtr; // Pointer to the next quantized coordinate to read
+		
+		/* Constructors and destructors: */
+		public:
+		PositionDequantizer(const Point& sDomainMin,const Point& domainMax,const QuantizedCoordinate* sQPtr)
+			:domainMin(sDomainMin),qPtr(sQPtr)
+			{
+			for(int i=0;i<3;++i)
+				scale[i]=(domainMax[i]-domainMin[i])/Scalar(65535);
+			};
+		
+		/* Methods: */
+		void read(Scalar* components,size_t numComponents) // Restores the given position components
+			{
+			for(size_t i=0;i<numComponents;++i,++qPtr)
+				components[i]=domainMin[i]+Scalar(*qPtr)*scale[i];
+			};
+		};
+	
+	/* Private methods: */
+	private:
+	static void encodeUnsigned(unsigned int value,std::vector<unsigned char>& buffer) // Appends a variable-length unsigned integer to the buffer
+		{
+		while(value>=0x80U)
+			{
+			buffer.push_back((unsigned char)(value&0x7fU)|0x80U);
+			value>>=7;
+			}
+		buffer.push_back((unsigned char)value);
+		};
+	static unsigned int decodeUnsigned(const unsigned char*& bPtr,const unsigned char* bEnd) // Reads a variable-length unsigned integer from the buffer
+		{
+		unsigned int result=0;
+		for(int shift=0;bPtr!=bEnd&&shift<32;shift+=7,++bPtr)
+			{
+			result|=(unsigned int)(*bPtr&0x7fU)<<shift;
+			if((*bPtr&0x80U)==0)
+				{
+				++bPtr;
+				return result;
+				}
+			}
+		Misc::throwStdErr("SharedJelloPipe: Malformed server update");
+		return 0;
+		};
+	
 	/* Constructors and destructors: */
+	
 	public:
 	SharedJelloPipe(const char* hostName,int portID,Comm::MulticastPipe* sPipe =0) // Creates a shared Jell-O pipe for the given server host name/port ID
 		:Comm::ClusterPipe(hostName,portID,sPipe)
@@ -111,6 +202,76 @@ class SharedJelloPipe:public Comm::ClusterPipe
 		Rotation rotation=readRotation();
 		return ONTransform(translation,rotation);
 		};
+	static void encodeKeyframe(const QuantizedCoordinate* positions,size_t numCoordinates,std::vector<unsigned char>& buffer) // Encodes all quantized atom positions into the given buffer
+		{
+		buffer.clear();
+		for(size_t i=0;i<numCoordinates;++i)
+			encodeUnsigned(positions[i],buffer);
+		};
+	static void encodeDelta(const QuantizedCoordinate* positions,const QuantizedCoordinate* reference,size_t numAtoms,std::vector<unsigned char>& buffer) // Encodes the atoms whose quantized positions differ from the reference positions into the given buffer
+		{
+		buffer.clear();
+		size_t nextAtom=0;
+		for(size_t atom=0;atom<numAtoms;++atom,positions+=3,reference+=3)
+			if(positions[0]!=reference[0]||positions[1]!=reference[1]||positions[2]!=reference[2])
+				{
+				/* Encode the number of skipped atoms and the zig-zag encoded position changes: */
+				encodeUnsigned((unsigned int)(atom-nextAtom),buffer);
+				for(int i=0;i<3;++i)
+					{
+					int delta=int(positions[i])-int(reference[i]);
+					encodeUnsigned(delta>=0?(unsigned int)delta<<1:((unsigned int)(-delta)<<1)-1U,buffer);
+					}
+				nextAtom=atom+1;
+				}
+		};
+	static void decodeUpdate(UpdateType updateType,const std::vector<unsigned char>& buffer,QuantizedCoordinate* positions,size_t numAtoms) // Applies an encoded update to the given quantized atom positions
+		{
+		const unsigned char* bPtr=buffer.empty()?0:&buffer[0];
+		const unsigned char* bEnd=bPtr+buffer.size();
+		if(updateType==KEYFRAME)
+			{
+			for(size_t i=0;i<numAtoms*3;++i)
+				{
+				unsigned int value=decodeUnsigned(bPtr,bEnd);
+				positions[i]=QuantizedCoordinate(value);
+				}
+			}
+		else
+			{
+			size_t nextAtom=0;
+			while(bPtr!=bEnd)
+				{
+				size_t atom=nextAtom+decodeUnsigned(bPtr,bEnd);
+				if(atom>=numAtoms)
+					Misc::throwStdErr("SharedJelloPipe: Malformed server update");
+				QuantizedCoordinate* pPtr=positions+atom*3;
+				for(int i=0;i<3;++i)
+					{
+					unsigned int code=decodeUnsigned(bPtr,bEnd);
+					int delta=(code&0x1U)?-int((code+1U)>>1):int(code>>1);
+					pPtr[i]=QuantizedCoordinate(int(pPtr[i])+delta);
+					}
+				nextAtom=atom+1;
+				}
+			}
+		};
+	void writeUpdate(UpdateType updateType,const std::vector<unsigned char>& buffer) // Writes an encoded server update message to the pipe
+		{
+		writeMessage(SERVER_UPDATE);
+		write<unsigned char>(updateType);
+		write<unsigned int>((unsigned int)buffer.size());
+		if(!buffer.empty())
+			write<unsigned char>(&buffer[0],buffer.size());
+		};
+	UpdateType readUpdate(std::vector<unsigned char>& buffer) // Reads the contents of a server update message from the pipe into the given buffer and returns the update's encoding
+		{
+		UpdateType result=UpdateType(read<unsigned char>());
+		buffer.resize(read<unsigned int>());
+		if(!buffer.empty())
+			read<unsigned char>(&buffer[0],buffer.size());
+		return result;
+		};
 	};
 
 #endif
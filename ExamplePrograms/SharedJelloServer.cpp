@@ -104,10 +104,11 @@ void* SharedJelloServer::clientCommunicationThreadMethod(SharedJelloServer::Clie
 		pipe.flush();
 		}
 		
-		/* Mark the client as connected: */
+		/* Mark the client as connected and start sending server updates: */
 		{
 		Threads::Mutex::Lock clientStateListLock(clientStateListMutex);
 		clientState->connected=true;
+		clientState->sendThread.start(this,&SharedJelloServer::clientSendThreadMethod,clientState);
 		}
 		
 		#ifdef VERBOSE
@@ -222,6 +223,10 @@ void* SharedJelloServer::clientCommunicationThreadMethod(SharedJelloServer::Clie
 	/* Lock the client state list: */
 	Threads::Mutex::Lock clientStateListLock(clientStateListMutex);
 	
+	/* Stop sending server updates to the client: */
+	if(!clientState->sendThread.isJoined())
+		stopClientSendThread(clientState);
+	
 	/* Unlock all atoms held by the client: */
 	for(std::vector<ClientState::AtomLock>::iterator alIt=clientState->atomLocks.begin();alIt!=clientState->atomLocks.end();++alIt)
 		crystal.unlockAtom(alIt->draggedAtom);
@@ -241,12 +246,135 @@ void* SharedJelloServer::clientCommunicationThreadMethod(SharedJelloServer::Clie
 	return 0;
 	}
 
-SharedJelloServer::SharedJelloServer(const SharedJelloServer::Index& numAtoms,int listenPortID)
+void SharedJelloServer::releaseSnapshot(SharedJelloServer::StateSnapshot* releasedSnapshot)
+	{
+	bool last;
+	{
+	Threads::MutexCond::Lock snapshotLock(snapshotCond);
+	--releasedSnapshot->refCount;
+	last=releasedSnapshot->refCount==0;
+	}
+	if(last)
+		delete releasedSnapshot;
+	}
+
+void* SharedJelloServer::clientSendThreadMethod(SharedJelloServer::ClientState* clientState)
+	{
+	SharedJelloPipe& pipe=clientState->pipe;
+	
+	/* The client's state as of the last sent server update: */
+	unsigned int sentSnapshotIndex=0;
+	unsigned int clientParameterVersion=0;
+	std::vector<SharedJelloPipe::QuantizedCoordinate> clientPositions;
+	unsigned int numUpdatesSinceKeyframe=0;
+	std::vector<unsigned char> updateBuffer;
+	
+	try
+		{
+		while(true)
+			{
+			/* Wait for a snapshot newer than the last sent one; snapshots created while the client was busy receiving are skipped: */
+			StateSnapshot* s;
+			unsigned int currentKeyframeInterval;
+			{
+			Threads::MutexCond::Lock snapshotLock(snapshotCond);
+			while(!clientState->stopSending&&(snapshot==0||snapshotIndex==sentSnapshotIndex))
+				snapshotCond.wait(snapshotLock);
+			if(clientState->stopSending)
+				break;
+			s=snapshot;
+			++s->refCount;
+			sentSnapshotIndex=snapshotIndex;
+			currentKeyframeInterval=keyframeInterval;
+			}
+			
+			/* Encode the snapshot as a keyframe, or as a delta to the atom positions last sent to the client: */
+			SharedJelloPipe::UpdateType updateType;
+			size_t numAtoms=s->positions.size()/3;
+			if(clientPositions.empty()||numUpdatesSinceKeyframe>=currentKeyframeInterval)
+				{
+				updateType=SharedJelloPipe::KEYFRAME;
+				SharedJelloPipe::encodeKeyframe(&s->positions[0],s->positions.size(),updateBuffer);
+				numUpdatesSinceKeyframe=0;
+				}
+			else
+				{
+				updateType=SharedJelloPipe::DELTA;
+				SharedJelloPipe::encodeDelta(&s->positions[0],&clientPositions[0],numAtoms,updateBuffer);
+				}
+			clientPositions=s->positions;
+			++numUpdatesSinceKeyframe;
+			
+			/* Check if the client needs new simulation parameters: */
+			bool sendParameters=clientParameterVersion!=s->parameterVersion;
+			clientParameterVersion=s->parameterVersion;
+			Scalar atomMass=s->atomMass;
+			Scalar attenuation=s->attenuation;
+			Scalar gravity=s->gravity;
+			
+			releaseSnapshot(s);
+			
+			{
+			Threads::Mutex::Lock pipeLock(pipe.getMutex());
+			
+			if(sendParameters)
+				{
+				/* Send a parameter update message: */
+				pipe.writeMessage(SharedJelloPipe::SERVER_PARAMUPDATE);
+				pipe.write<Scalar>(atomMass);
+				pipe.write<Scalar>(attenuation);
+				pipe.write<Scalar>(gravity);
+				}
+			
+			/* Send a server update message: */
+			pipe.writeUpdate(updateType,updateBuffer);
+			
+			pipe.flush();
+			}
+			}
+		}
+	catch(...)
+		{
+		/* Ignore the pipe error; let the client communication thread handle it */
+		}
+	
+	return 0;
+	}
+
+void SharedJelloServer::stopClientSendThread(SharedJelloServer::ClientState* clientState)
+	{
+	/* Tell the send thread to terminate: */
+	{
+	Threads::MutexCond::Lock snapshotLock(snapshotCond);
+	clientState->stopSending=true;
+	snapshotCond.broadcast(snapshotLock);
+	}
+	
+	/* Shut down the connection in case the send thread is blocked on a stalled client: */
+	try
+		{
+		clientState->pipe.shutdown(true,true);
+		}
+	catch(...)
+		{
+		/* Ignore the error; the connection is already gone */
+		}
+	
+	/* Wait for the send thread to terminate: */
+	clientState->sendThread.join();
+	}
+
+SharedJelloServer::SharedJelloServer(const SharedJelloServer::Index& numAtoms,int listenPortID,int numSimulationThreads)
 	:newParameterVersion(1),
+	 taskScheduler(numSimulationThreads>1?new Threads::TaskScheduler(numSimulationThreads-1):0),
 	 crystal(numAtoms),
 	 parameterVersion(1),
-	 listenSocket(listenPortID,0)
+	 listenSocket(listenPortID,0),
+	 snapshot(0),snapshotIndex(0),keyframeInterval(50)
 	{
+	/* Run the simulation on the worker threads and the simulation thread: */
+	crystal.setTaskScheduler(taskScheduler);
+	
 	/* Start listening thread: */
 	listenThread.start(this,&SharedJelloServer::listenThreadMethod);
 	}
@@ -268,10 +396,21 @@ SharedJelloServer::~SharedJelloServer(void)
 		(*cslIt)->communicationThread.cancel();
 		(*cslIt)->communicationThread.join();
 		
+		/* Stop client send thread: */
+		if(!(*cslIt)->sendThread.isJoined())
+			stopClientSendThread(*cslIt);
+		
 		/* Delete client state object: */
 		delete *cslIt;
 		}
 	}
+	
+	/* Release the most recent snapshot: */
+	if(snapshot!=0)
+		releaseSnapshot(snapshot);
+	
+	/* Stop the simulation worker threads: */
+	delete taskScheduler;
 	}
 
 void SharedJelloServer::simulate(double timeStep)
@@ -368,53 +507,36 @@ void SharedJelloServer::simulate(double timeStep)
 	crystal.simulate(timeStep);
 	}
 
-void SharedJelloServer::sendServerUpdate(void)
+void SharedJelloServer::setKeyframeInterval(unsigned int newKeyframeInterval)
 	{
+	Threads::MutexCond::Lock snapshotLock(snapshotCond);
+	keyframeInterval=newKeyframeInterval;
+	}
+
+void SharedJelloServer::sendServerUpdate(void)
 	{
-	/* Lock the client state list: */
-	Threads::Mutex::Lock clientStateListLock(clientStateListMutex);
+	/* Quantize the crystal's state into a new snapshot once for all clients: */
+	StateSnapshot* newSnapshot=new StateSnapshot;
+	newSnapshot->refCount=1;
+	newSnapshot->parameterVersion=parameterVersion;
+	newSnapshot->atomMass=crystal.getAtomMass();
+	newSnapshot->attenuation=crystal.getAttenuation();
+	newSnapshot->gravity=crystal.getGravity();
+	newSnapshot->positions.resize(size_t(crystal.getNumAtoms().calcIncrement(-1))*3);
+	SharedJelloPipe::PositionQuantizer quantizer(crystal.getDomain().min,crystal.getDomain().max,&newSnapshot->positions[0]);
+	crystal.writeAtomStates(quantizer);
 	
-	/* Go through all client states: */
-	for(ClientStateList::iterator cslIt=clientStates.begin();cslIt!=clientStates.end();++cslIt)
-		{
-		ClientState* cs=*cslIt;
-		if(cs->connected)
-			{
-			try
-				{
-				{
-				Threads::Mutex::Lock pipeLock(cs->pipe.getMutex());
-				
-				if(cs->parameterVersion!=parameterVersion)
-					{
-					/* Send a parameter update message: */
-					cs->pipe.writeMessage(SharedJelloPipe::SERVER_PARAMUPDATE);
-					cs->pipe.write<Scalar>(crystal.getAtomMass());
-					cs->pipe.write<Scalar>(crystal.getAttenuation());
-					cs->pipe.write<Scalar>(crystal.getGravity());
-					cs->parameterVersion=parameterVersion;
-					}
-				
-				/* Send a server update message: */
-				cs->pipe.writeMessage(SharedJelloPipe::SERVER_UPDATE);
-				
-				/* Send the crystal's state: */
-				crystal.writeAtomStates(cs->pipe);
-				
-				cs->pipe.flush();
-				}
-				}
-			catch(Comm::TCPSocket::PipeError err)
-				{
-				/* Ignore the pipe error; let the client communication thread handle it */
-				}
-			catch(...)
-				{
-				/* Ignore the pipe error; let the client communication thread handle it */
-				}
-			}
-		}
+	/* Replace the current snapshot and wake up all client send threads: */
+	StateSnapshot* oldSnapshot;
+	{
+	Threads::MutexCond::Lock snapshotLock(snapshotCond);
+	oldSnapshot=snapshot;
+	snapshot=newSnapshot;
+	++snapshotIndex;
+	snapshotCond.broadcast(snapshotLock);
 	}
+	if(oldSnapshot!=0)
+		releaseSnapshot(oldSnapshot);
 	}
 
 /*********************
@@ -427,6 +549,8 @@ int main(int argc,char* argv[])
 	SharedJelloServer::Index numAtoms(4,4,8);
 	int listenPortID=-1; // Assign any free port
 	double updateTime=0.02; // Aim for 50 updates/sec
+	int numSimulationThreads=1;
+	unsigned int keyframeInterval=50; // Send a keyframe every second
 	for(int i=1;i<argc;++i)
 		{
 		if(argv[i][0]=='-')
@@ -452,6 +576,20 @@ int main(int argc,char* argv[])
 				if(i<argc)
 					updateTime=atof(argv[i]);
 				}
+			else if(strcasecmp(argv[i]+1,"threads")==0)
+				{
+				/* Read the number of simulation threads: */
+				++i;
+				if(i<argc)
+					numSimulationThreads=atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"keyframe")==0)
+				{
+				/* Read the number of server updates between keyframes: */
+				++i;
+				if(i<argc)
+					keyframeInterval=(unsigned int)atoi(argv[i]);
+				}
 			}
 		}
 	
@@ -463,7 +601,8 @@ int main(int argc,char* argv[])
 	sigaction(SIGPIPE,&sigPipeAction,0);
 	
 	/* Create a shared Jell-O server: */
-	SharedJelloServer sjs(numAtoms,listenPortID);
+	SharedJelloServer sjs(numAtoms,listenPortID,numSimulationThreads);
+	sjs.setKeyframeInterval(keyframeInterval);
 	std::cout<<"SharedJelloServer::main: Created Jell-O server listening on port "<<sjs.getListenPortID()<<std::endl<<std::flush;
 	
 	/* Run the simulation loop full speed: */
@@ -26,6 +26,8 @@ Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <vector>
 #include <Threads/Thread.h>
 #include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/TaskScheduler.h>
 #include <Comm/TCPSocket.h>
 #include <Geometry/Box.h>
 
@@ -92,8 +94,9 @@ class SharedJelloServer
 		public:
 		SharedJelloPipe pipe; // Communication pipe connected to the client
 		Threads::Thread communicationThread; // Thread receiving state updates from the client
+		Threads::Thread sendThread; // Thread sending server updates to the client; running while the client is connected
 		bool connected; // Flag if the client's connection protocol has finished
-		unsigned int parameterVersion; // Version number of parameter set on the client side
+		bool stopSending; // Flag to tell the send thread to terminate; protected by the snapshot mutex
 		StateUpdate stateUpdates[3]; // Triple buffer of state update packets
 		volatile int lockedIndex; // Buffer index currently locked by the consumer
 		volatile int mostRecentIndex; // Buffer index of most recently produced value
@@ -102,13 +105,24 @@ class SharedJelloServer
 		/* Constructors and destructors: */
 		ClientState(const Comm::TCPSocket& socket)
 			:pipe(&socket),
-			 connected(false),
-			 parameterVersion(0),
+			 connected(false),stopSending(false),
 			 lockedIndex(0),mostRecentIndex(0)
 			{
 			};
 		};
 	
+	struct StateSnapshot // Structure holding the crystal state sent to clients in one server update
+		{
+		/* Elements: */
+		public:
+		unsigned int refCount; // Number of references to the snapshot; protected by the snapshot mutex
+		unsigned int parameterVersion; // Version number of the snapshot's simulation parameters
+		Scalar atomMass;
+		Scalar attenuation;
+		Scalar gravity;
+		std::vector<SharedJelloPipe::QuantizedCoordinate> positions; // Quantized positions of all atoms
+		};
+	
 	typedef std::vector<ClientState*> ClientStateList; // Type for lists of pointers to client state structures
 	
 	/* Elements: */
@@ -119,6 +133,7 @@ class SharedJelloServer
 	Scalar newAtomMass;
 	Scalar newAttenuation;
 	Scalar newGravity;
+	Threads::TaskScheduler* taskScheduler; // Task scheduler to run the simulation in parallel, or null
 	JelloCrystal crystal; // The virtual Jell-O crystal
 	unsigned int parameterVersion; // Version number of simulation parameters set in Jell-O crystal
 	
@@ -127,14 +142,21 @@ class SharedJelloServer
 	Threads::Thread listenThread; // Thread listening for incoming connections on the listening port
 	Threads::Mutex clientStateListMutex; // Mutex protecting the client state list (not the included structures)
 	ClientStateList clientStates; // List of client state structures
+	Threads::MutexCond snapshotCond; // Mutex protecting the current snapshot, and condition variable signalling new snapshots
+	StateSnapshot* snapshot; // Most recent crystal state snapshot, or null before the first server update
+	unsigned int snapshotIndex; // Running index of the most recent snapshot
+	unsigned int keyframeInterval; // Number of server updates after which a client receives a keyframe instead of a delta
 	
 	/* Private methods: */
 	void* listenThreadMethod(void); // Thread method accepting connections from new clients
 	void* clientCommunicationThreadMethod(ClientState* clientState); // Thread method receiving state updates from connected clients
+	void releaseSnapshot(StateSnapshot* releasedSnapshot); // Drops a reference to the given snapshot, and deletes it if it was the last
+	void* clientSendThreadMethod(ClientState* clientState); // Thread method sending the most recent snapshot to a connected client
+	void stopClientSendThread(ClientState* clientState); // Terminates the given client's send thread
 	
 	/* Constructors and destructors: */
 	public:
-	SharedJelloServer(const Index& numAtoms,int listenPortID); // Creates a shared Jell-O server with the given crystal size and listen port ID (assigns dynamic port if port ID is negative)
+	SharedJelloServer(const Index& numAtoms,int listenPortID,int numSimulationThreads =1); // Creates a shared Jell-O server with the given crystal size, listen port ID (assigns dynamic port if port ID is negative), and number of simulation threads
 	~SharedJelloServer(void); // Destroys the shared Jell-O server
 	
 	/* Methods: */
@@ -143,6 +165,7 @@ class SharedJelloServer
 		return listenSocket.getPortId();
 		};
 	void simulate(double timeStep); // Updates the simulation state based on the real time since the last frame
+	void setKeyframeInterval(unsigned int newKeyframeInterval); // Sets the number of server updates between keyframes
 	void sendServerUpdate(void); // Sends the most recent Jell-O crystal state to all connected clients
 	};
 
@@ -0,0 +1,210 @@
+/***********************************************************************
+SharedJelloTest - Program to measure the number of bytes per server
+update sent to multiple shared Jell-O clients, and to check that the
+clients reconstruct the server's quantized atom positions exactly.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Virtual Jell-O interactive VR demonstration.
+
+Virtual Jell-O is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by the
+Free Software Foundation; either version 2 of the License, or (at your
+option) any later version.
+
+Virtual Jell-O is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with Virtual Jell-O; if not, write to the Free Software Foundation,
+Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+
+#include "JelloCrystal.h"
+#include "SharedJelloPipe.h"
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class PositionCollector // Helper class to collect the atom positions written by JelloCrystal::writeAtomStates
+	{
+	/* Elements: */
+	public:
+	std::vector<JelloCrystal::Scalar> positions; // Collected position components
+	
+	/* Methods: */
+	void write(const JelloCrystal::Scalar* components,size_t numComponents)
+		{
+		positions.insert(positions.end(),components,components+numComponents);
+		}
+	};
+
+struct Client // Structure for the server-side and client-side state of a simulated client
+	{
+	/* Elements: */
+	public:
+	unsigned int updateStride; // The client receives every updateStride-th server update, as if it were too slow for the others
+	std::vector<SharedJelloPipe::QuantizedCoordinate> serverPositions; // Positions last sent to the client on the server side
+	unsigned int numUpdatesSinceKeyframe; // Number of updates sent since the last keyframe
+	std::vector<SharedJelloPipe::QuantizedCoordinate> clientPositions; // Positions reconstructed by the client
+	size_t numUpdates; // Number of updates sent to the client
+	size_t numBytes; // Total size of all server update messages sent to the client
+	};
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	int size=8;
+	unsigned int numServerUpdates=500;
+	unsigned int numClients=4;
+	unsigned int keyframeInterval=50;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			size=atoi(argv[++i]);
+		else if(strcasecmp(argv[i],"-updates")==0&&i+1<argc)
+			numServerUpdates=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-clients")==0&&i+1<argc)
+			numClients=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-keyframe")==0&&i+1<argc)
+			keyframeInterval=(unsigned int)(atoi(argv[++i]));
+		}
+	
+	/* Create the Jell-O crystal and grab one of its corner atoms: */
+	JelloCrystal crystal(JelloCrystal::Index(size,size,size));
+	const JelloCrystal::Box& domain=crystal.getDomain();
+	PositionCollector initial;
+	crystal.writeAtomStates(initial);
+	JelloCrystal::AtomID draggedAtom=crystal.pickAtom(JelloCrystal::Point(&initial.positions[0]));
+	check(crystal.lockAtom(draggedAtom),"corner atom can be locked");
+	JelloCrystal::ONTransform dragStart=crystal.getAtomState(draggedAtom);
+	
+	/* Initialize the clients; client i receives every (i+1)-th server update: */
+	size_t numAtoms=initial.positions.size()/3;
+	std::vector<Client> clients(numClients);
+	for(unsigned int i=0;i<numClients;++i)
+		{
+		clients[i].updateStride=i+1;
+		clients[i].numUpdatesSinceKeyframe=0;
+		clients[i].clientPositions.resize(numAtoms*3);
+		clients[i].numUpdates=0;
+		clients[i].numBytes=0;
+		}
+	
+	/* Size of a server update message containing the full crystal state, as sent before delta coding: */
+	size_t fullStateSize=sizeof(SharedJelloPipe::MessageIdType)+numAtoms*3*sizeof(JelloCrystal::Scalar);
+	
+	/* Run the simulation at 50 updates per second while dragging the atom in a circle: */
+	double encodeTime=0.0;
+	double maxError=0.0;
+	std::vector<SharedJelloPipe::QuantizedCoordinate> positions(numAtoms*3);
+	std::vector<unsigned char> updateBuffer;
+	for(unsigned int update=0;update<numServerUpdates;++update)
+		{
+		JelloCrystal::Scalar angle=JelloCrystal::Scalar(2)*Math::Constants<JelloCrystal::Scalar>::pi*JelloCrystal::Scalar(update)/JelloCrystal::Scalar(100);
+		JelloCrystal::Vector offset(Math::cos(angle)*JelloCrystal::Scalar(10),Math::sin(angle)*JelloCrystal::Scalar(10),JelloCrystal::Scalar(5));
+		crystal.setAtomState(draggedAtom,JelloCrystal::ONTransform::translate(offset)*dragStart);
+		crystal.simulate(0.02);
+		
+		/* Quantize the crystal state as the server does once per update: */
+		Misc::Timer encodeTimer;
+		SharedJelloPipe::PositionQuantizer quantizer(domain.min,domain.max,&positions[0]);
+		crystal.writeAtomStates(quantizer);
+		
+		/* Encode the update for all clients that receive it: */
+		for(std::vector<Client>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+			{
+			if(update%cIt->updateStride!=0)
+				continue;
+			
+			SharedJelloPipe::UpdateType updateType;
+			if(cIt->serverPositions.empty()||cIt->numUpdatesSinceKeyframe>=keyframeInterval)
+				{
+				updateType=SharedJelloPipe::KEYFRAME;
+				SharedJelloPipe::encodeKeyframe(&positions[0],positions.size(),updateBuffer);
+				cIt->numUpdatesSinceKeyframe=0;
+				}
+			else
+				{
+				updateType=SharedJelloPipe::DELTA;
+				SharedJelloPipe::encodeDelta(&positions[0],&cIt->serverPositions[0],numAtoms,updateBuffer);
+				}
+			cIt->serverPositions=positions;
+			++cIt->numUpdatesSinceKeyframe;
+			
+			/* Account for the message ID, update type, and buffer size written by SharedJelloPipe::writeUpdate: */
+			++cIt->numUpdates;
+			cIt->numBytes+=sizeof(SharedJelloPipe::MessageIdType)+sizeof(unsigned char)+sizeof(unsigned int)+updateBuffer.size();
+			
+			/* Decode the update on the client side: */
+			SharedJelloPipe::decodeUpdate(updateType,updateBuffer,&cIt->clientPositions[0],numAtoms);
+			}
+		encodeTimer.elapse();
+		encodeTime+=encodeTimer.getTime();
+		
+		/* Check that all clients that received the update reconstructed the quantized positions: */
+		for(std::vector<Client>::iterator cIt=clients.begin();cIt!=clients.end();++cIt)
+			if(update%cIt->updateStride==0)
+				check(cIt->clientPositions==positions,"client reconstructs the server's quantized positions");
+		
+		/* Measure the quantization error of the positions the clients display: */
+		PositionCollector exact;
+		crystal.writeAtomStates(exact);
+		std::vector<JelloCrystal::Scalar> restored(numAtoms*3);
+		SharedJelloPipe::PositionDequantizer dequantizer(domain.min,domain.max,&positions[0]);
+		for(size_t i=0;i<numAtoms;++i)
+			dequantizer.read(&restored[i*3],3);
+		for(size_t i=0;i<numAtoms*3;++i)
+			if(maxError<Math::abs(double(restored[i]-exact.positions[i])))
+				maxError=Math::abs(double(restored[i]-exact.positions[i]));
+		}
+	crystal.unlockAtom(draggedAtom);
+	
+	/* Report the results: */
+	printf("%dx%dx%d crystal, %u server updates, keyframe every %u updates\n",size,size,size,numServerUpdates,keyframeInterval);
+	printf("Full state update: %u bytes\n",(unsigned int)fullStateSize);
+	size_t totalBytes=0;
+	for(unsigned int i=0;i<numClients;++i)
+		{
+		double bytesPerUpdate=double(clients[i].numBytes)/double(clients[i].numUpdates);
+		printf("Client %u (receives 1 of %u updates): %.0f bytes/update (%.1fx smaller)\n",i,clients[i].updateStride,bytesPerUpdate,double(fullStateSize)/bytesPerUpdate);
+		totalBytes+=clients[i].numBytes;
+		}
+	printf("All clients: %.0f bytes per server update\n",double(totalBytes)/double(numServerUpdates));
+	printf("Encoding time: %.3f ms per server update\n",encodeTime*1000.0/double(numServerUpdates));
+	printf("Maximum position error: %g\n",maxError);
+	check(maxError<0.001*(domain.max[0]-domain.min[0]),"quantization error is below 0.1% of the domain size");
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -683,6 +683,7 @@ ShowEarthModel::ShowEarthModel(int& argc,char**& argv,char**& appDefaults)
 		POINTSETFILE,EARTHQUAKESETFILE,SEISMICPATHFILE,SENSORPATHFILE
 		} fileMode=POINTSETFILE; // Treat all file names as point set files initially
 	float colorMask[3]={1.0f,1.0f,1.0f}; // Initial color mask for point set files
+	bool useCacheFiles=true; // Flag whether earthquake sets are loaded from and saved to cache files
 	for(int i=1;i<argc;++i)
 		{
 		/* Check if the current command line argument is a switch or a file name: */
@@ -705,6 +706,10 @@ ShowEarthModel::ShowEarthModel(int& argc,char**& argv,char**& appDefaults)
 				scaleToEnvironment=true;
 			else if(strcasecmp(argv[i]+1,"noscale")==0)
 				scaleToEnvironment=false;
+			else if(strcasecmp(argv[i]+1,"cache")==0)
+				useCacheFiles=true;
+			else if(strcasecmp(argv[i]+1,"nocache")==0)
+				useCacheFiles=false;
 			else if(strcasecmp(argv[i]+1,"pointsize")==0)
 				{
 				++i;
@@ -738,7 +743,7 @@ ShowEarthModel::ShowEarthModel(int& argc,char**& argv,char**& appDefaults)
 				case EARTHQUAKESETFILE:
 					{
 					/* Load an earthquake set: */
-					EarthquakeSet* earthquakeSet=new EarthquakeSet(argv[i],1.0e-3);
+					EarthquakeSet* earthquakeSet=new EarthquakeSet(argv[i],1.0e-3,Vrui::getTaskScheduler(),Vrui::openPipe(),useCacheFiles);
 					earthquakeSets.push_back(earthquakeSet);
 					showEarthquakeSets.push_back(false);
 					break;
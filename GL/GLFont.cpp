@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
 #include <GL/GLContextData.h>
+#include <GL/GLFontAtlas.h>
 
 #include <GL/GLFont.h>
 
@@ -400,7 +401,8 @@ GLFont::GLFont(const char* fontName)
 	 numSpans(0),spans(0),
 	 fontHeight(0),textureHeight(0),
 	 textHeight(1.0),hAlignment(Left),vAlignment(Baseline),
-	 antialiasing(false)
+	 antialiasing(false),
+	 atlas(0)
 	{
 	/* Read the font from file: */
 	char fontFileName[1024];
@@ -453,6 +455,7 @@ GLFont::GLFont(const char* fontName)
 
 GLFont::~GLFont(void)
 	{
+	delete atlas;
 	delete[] characters;
 	delete[] rasterLines;
 	delete[] spans;
@@ -524,3 +527,12 @@ void GLFont::drawString(const GLFont::Vector& origin,const char* string) const
 	glEnd();
 	glPopAttrib();
 	}
+
+GLFontAtlas& GLFont::getAtlas(void) const
+	{
+	/* Create the atlas on the first call: */
+	if(atlas==0)
+		atlas=new GLFontAtlas(*this);
+	
+	return *atlas;
+	}
@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 namespace Misc {
 class File;
 }
+class GLFontAtlas;
 
 class GLFont
 	{
@@ -104,6 +105,7 @@ class GLFont
 		};
 	
 	friend class String;
+	friend class GLFontAtlas;
 	
 	private:
 	struct CharInfo
@@ -143,6 +145,7 @@ class GLFont
 	HAlignment hAlignment; // Horizontal alignment
 	VAlignment vAlignment; // Vertical alignment
 	bool antialiasing; // Flag to enable antialiasing
+	mutable GLFontAtlas* atlas; // Glyph atlas shared by all strings rendered with this font; created on first use
 	
 	/* Private methods: */
 	GLsizei calcStringWidth(const char* string) const; // Calculates the texel width of a string
@@ -216,6 +219,7 @@ class GLFont
 	void uploadStringTexture(const char* string) const; // Uploads a string's texture image
 	void uploadStringTexture(const char* string,const Color& stringBackgroundColor,const Color& stringForegroundColor) const; // Uploads a string's texture image with the given colors
 	void drawString(const Vector& origin,const char* string) const; // Draws a simple, one-line string
+	GLFontAtlas& getAtlas(void) const; // Returns the font's glyph atlas; creates the atlas using the current antialiasing setting on the first call
 	};
 
 #endif
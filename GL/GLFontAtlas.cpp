@@ -0,0 +1,472 @@
+/***********************************************************************
+GLFontAtlas - Class to rasterize the glyphs of a texture-based font into
+a single shared texture atlas, and to render text as batches of textured
+quads.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <algorithm>
+#include <GL/gl.h>
+#include <GL/GLTexEnvTemplates.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLContextData.h>
+
+#include <GL/GLFontAtlas.h>
+
+/**************************************
+Methods of class GLFontAtlas::DataItem:
+**************************************/
+
+GLFontAtlas::DataItem::DataItem(void)
+	:numUploadedGlyphs(0),batching(false)
+	{
+	glGenTextures(1,&textureObjectId);
+	}
+
+GLFontAtlas::DataItem::~DataItem(void)
+	{
+	glDeleteTextures(1,&textureObjectId);
+	}
+
+/****************************
+Methods of class GLFontAtlas:
+****************************/
+
+void GLFontAtlas::rasterizeGlyph(GLint charIndex)
+	{
+	Glyph& g=glyphs[charIndex];
+	const GLFont::CharInfo* ciPtr=&font.characters[charIndex];
+	const unsigned char* rasterLine=&font.rasterLines[ciPtr->rasterLineOffset];
+	const unsigned char* span=&font.spans[ciPtr->spanOffset];
+	
+	/* Copy all raster lines into the glyph's cell, exactly as they would appear in a string texture: */
+	GLubyte* cellPtr=image+(g.y*atlasWidth+g.x);
+	int x=font.maxLeftLap+1+ciPtr->glyphOffset;
+	for(int y=font.baseLine-ciPtr->descent;y<font.baseLine+ciPtr->ascent;++y,++rasterLine)
+		{
+		/* Copy all spans in this line: */
+		GLubyte* texPtr=cellPtr+(y*atlasWidth+x);
+		int numSpans=int(*rasterLine);
+		for(int i=0;i<numSpans;++i,++span)
+			{
+			texPtr+=int((*span)>>3);
+			int numPixels=int((*span)&0x07);
+			for(int j=0;j<numPixels;++j,++texPtr)
+				*texPtr=GLubyte(255);
+			}
+		}
+	
+	if(font.antialiasing&&!g.empty)
+		{
+		/* Filter the cell with a separable 3x3 tent kernel, replicating the cell's border texels: */
+		GLsizei w=g.width;
+		GLsizei h=font.fontHeight;
+		GLfloat* temp=new GLfloat[w*h];
+		for(GLsizei y=0;y<h;++y)
+			{
+			const GLubyte* rowPtr=cellPtr+y*atlasWidth;
+			for(GLsizei x=0;x<w;++x)
+				{
+				GLsizei xl=x>0?x-1:x;
+				GLsizei xr=x<w-1?x+1:x;
+				temp[y*w+x]=0.25f*GLfloat(rowPtr[xl])+0.5f*GLfloat(rowPtr[x])+0.25f*GLfloat(rowPtr[xr]);
+				}
+			}
+		for(GLsizei y=0;y<h;++y)
+			{
+			GLubyte* rowPtr=cellPtr+y*atlasWidth;
+			const GLfloat* t0=temp+(y>0?y-1:y)*w;
+			const GLfloat* t1=temp+y*w;
+			const GLfloat* t2=temp+(y<h-1?y+1:y)*w;
+			for(GLsizei x=0;x<w;++x)
+				rowPtr[x]=GLubyte(0.25f*t0[x]+0.5f*t1[x]+0.25f*t2[x]+0.5f);
+			}
+		delete[] temp;
+		}
+	
+	/* Mark the glyph as rasterized: */
+	g.rasterized=true;
+	rasterizationOrder.push_back(charIndex);
+	}
+
+void GLFontAtlas::uploadGlyphs(GLFontAtlas::DataItem* dataItem) const
+	{
+	/* Upload the cells of all glyphs that were rasterized after the last upload: */
+	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH,atlasWidth);
+	for(size_t i=dataItem->numUploadedGlyphs;i<rasterizationOrder.size();++i)
+		{
+		const Glyph& g=glyphs[rasterizationOrder[i]];
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS,g.x);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS,g.y);
+		glTexSubImage2D(GL_TEXTURE_2D,0,g.x,g.y,g.width,font.fontHeight,GL_ALPHA,GL_UNSIGNED_BYTE,image);
+		}
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+	dataItem->numUploadedGlyphs=rasterizationOrder.size();
+	}
+
+GLFontAtlas::GLFontAtlas(const GLFont& sFont)
+	:font(sFont),
+	 atlasWidth(256),atlasHeight(0),
+	 glyphs(new Glyph[font.numCharacters]),
+	 image(0)
+	{
+	/* Calculate the cell sizes of all glyphs; a cell holds a glyph exactly as it would appear in a single-character string: */
+	GLsizei maxCellWidth=0;
+	for(GLsizei i=0;i<font.numCharacters;++i)
+		{
+		const GLFont::CharInfo& ci=font.characters[i];
+		Glyph& g=glyphs[i];
+		g.rasterized=false;
+		g.empty=ci.ascent+ci.descent<=0;
+		g.width=font.maxLeftLap+ci.width+font.maxRightLap+2;
+		g.advance=ci.width;
+		if(maxCellWidth<g.width)
+			maxCellWidth=g.width;
+		}
+	while(atlasWidth<maxCellWidth)
+		atlasWidth<<=1;
+	
+	/* Pack all cells into shelves of font height, widening the atlas until it is at least as wide as it is high: */
+	while(true)
+		{
+		GLsizei x=0,y=0;
+		for(GLsizei i=0;i<font.numCharacters;++i)
+			{
+			if(x+glyphs[i].width>atlasWidth)
+				{
+				/* Start a new shelf: */
+				x=0;
+				y+=font.fontHeight;
+				}
+			glyphs[i].x=x;
+			glyphs[i].y=y;
+			x+=glyphs[i].width;
+			}
+		for(atlasHeight=1;atlasHeight<y+font.fontHeight;atlasHeight<<=1)
+			;
+		if(atlasHeight<=atlasWidth)
+			break;
+		atlasWidth<<=1;
+		}
+	
+	/* Create an empty atlas image: */
+	image=new GLubyte[atlasWidth*atlasHeight];
+	memset(image,0,atlasWidth*atlasHeight);
+	rasterizationOrder.reserve(font.numCharacters);
+	}
+
+GLFontAtlas::~GLFontAtlas(void)
+	{
+	delete[] glyphs;
+	delete[] image;
+	}
+
+void GLFontAtlas::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	
+	/* Upload the current atlas image: */
+	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+	glTexImage2D(GL_TEXTURE_2D,0,GL_ALPHA8,atlasWidth,atlasHeight,0,GL_ALPHA,GL_UNSIGNED_BYTE,image);
+	glBindTexture(GL_TEXTURE_2D,0);
+	dataItem->numUploadedGlyphs=rasterizationOrder.size();
+	}
+
+const GLFontAtlas::Glyph* GLFontAtlas::getGlyph(char character) const
+	{
+	int charIndex=int(character)-font.firstCharacter;
+	if(charIndex>=0&&charIndex<font.numCharacters)
+		return &glyphs[charIndex];
+	else
+		return 0;
+	}
+
+void GLFontAtlas::addString(const char* string)
+	{
+	/* Rasterize all glyphs that are not yet in the atlas: */
+	for(const char* cPtr=string;*cPtr!=0;++cPtr)
+		{
+		int charIndex=int(*cPtr)-font.firstCharacter;
+		if(charIndex>=0&&charIndex<font.numCharacters&&!glyphs[charIndex].rasterized)
+			rasterizeGlyph(charIndex);
+		}
+	}
+
+size_t GLFontAtlas::createQuads(const char* string,const GLFontAtlas::Box& stringBox,const GLFontAtlas::Color& color,std::vector<GLFontAtlas::Vertex>& vertices) const
+	{
+	/* Calculate the scale factor from texels to model space; the string box spans from the first to the last texel center: */
+	GLfloat scale=stringBox.size[1]/GLfloat(font.fontHeight-1);
+	GLfloat y0=stringBox.origin[1];
+	GLfloat y1=stringBox.origin[1]+stringBox.size[1];
+	GLfloat z=stringBox.origin[2];
+	GLfloat tScale=1.0f/GLfloat(atlasHeight);
+	GLfloat sScale=1.0f/GLfloat(atlasWidth);
+	Vertex v;
+	v.color=color;
+	
+	/* Create a quad for each non-empty glyph: */
+	size_t numQuads=0;
+	GLsizei x=0;
+	for(const char* cPtr=string;*cPtr!=0;++cPtr)
+		{
+		int charIndex=int(*cPtr)-font.firstCharacter;
+		if(charIndex>=0&&charIndex<font.numCharacters)
+			{
+			const Glyph& g=glyphs[charIndex];
+			if(g.rasterized&&!g.empty)
+				{
+				GLfloat x0=stringBox.origin[0]+GLfloat(x)*scale;
+				GLfloat x1=stringBox.origin[0]+GLfloat(x+g.width-1)*scale;
+				GLfloat s0=(GLfloat(g.x)+0.5f)*sScale;
+				GLfloat s1=(GLfloat(g.x+g.width)-0.5f)*sScale;
+				GLfloat t0=(GLfloat(g.y)+0.5f)*tScale;
+				GLfloat t1=(GLfloat(g.y+font.fontHeight)-0.5f)*tScale;
+				
+				v.texCoord=Vertex::TexCoord(s0,t0);
+				v.position=Vertex::Position(x0,y0,z);
+				vertices.push_back(v);
+				v.texCoord=Vertex::TexCoord(s1,t0);
+				v.position=Vertex::Position(x1,y0,z);
+				vertices.push_back(v);
+				v.texCoord=Vertex::TexCoord(s1,t1);
+				v.position=Vertex::Position(x1,y1,z);
+				vertices.push_back(v);
+				v.texCoord=Vertex::TexCoord(s0,t1);
+				v.position=Vertex::Position(x0,y1,z);
+				vertices.push_back(v);
+				++numQuads;
+				}
+			x+=g.advance;
+			}
+		}
+	
+	return numQuads;
+	}
+
+size_t GLFontAtlas::clipQuads(std::vector<GLFontAtlas::Vertex>& vertices,size_t firstVertex,GLfloat clipMin,GLfloat clipMax)
+	{
+	/* Clip all quads starting at the given vertex in place, and compact the remaining quads: */
+	std::vector<Vertex>::iterator destIt=vertices.begin()+firstVertex;
+	size_t numQuads=0;
+	for(std::vector<Vertex>::iterator qIt=destIt;qIt!=vertices.end();qIt+=4)
+		{
+		/* Get the quad's horizontal extent; vertices 0 and 3 are on the left, 1 and 2 on the right: */
+		GLfloat x0=qIt[0].position[0];
+		GLfloat x1=qIt[1].position[0];
+		if(x1<=clipMin||x0>=clipMax)
+			continue;
+		
+		/* Copy the quad to its final position: */
+		if(destIt!=qIt)
+			std::copy(qIt,qIt+4,destIt);
+		
+		/* Clip the quad's left edge: */
+		GLfloat s0=destIt[0].texCoord[0];
+		GLfloat s1=destIt[1].texCoord[0];
+		if(x0<clipMin)
+			{
+			GLfloat s=s0+(s1-s0)*(clipMin-x0)/(x1-x0);
+			destIt[0].position[0]=destIt[3].position[0]=clipMin;
+			destIt[0].texCoord[0]=destIt[3].texCoord[0]=s;
+			}
+		
+		/* Clip the quad's right edge: */
+		if(x1>clipMax)
+			{
+			GLfloat s=s0+(s1-s0)*(clipMax-x0)/(x1-x0);
+			destIt[1].position[0]=destIt[2].position[0]=clipMax;
+			destIt[1].texCoord[0]=destIt[2].texCoord[0]=s;
+			}
+		
+		destIt+=4;
+		++numQuads;
+		}
+	vertices.erase(destIt,vertices.end());
+	
+	return numQuads;
+	}
+
+void GLFontAtlas::bindTexture(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Bind the atlas texture and upload any glyphs that are not in it yet: */
+	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
+	if(dataItem->numUploadedGlyphs!=rasterizationOrder.size())
+		uploadGlyphs(dataItem);
+	}
+
+void GLFontAtlas::updateTexture(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		return;
+	
+	/* Upload any glyphs that are not in the atlas texture yet: */
+	if(dataItem->numUploadedGlyphs!=rasterizationOrder.size())
+		{
+		glPushAttrib(GL_TEXTURE_BIT);
+		glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
+		uploadGlyphs(dataItem);
+		glPopAttrib();
+		}
+	}
+
+void GLFontAtlas::drawQuads(const std::vector<GLFontAtlas::Vertex>& vertices)
+	{
+	if(vertices.empty())
+		return;
+	
+	/* Set up OpenGL state to blend the glyphs' coverage over the current frame buffer contents: */
+	glPushAttrib(GL_COLOR_BUFFER_BIT|GL_LIGHTING_BIT|GL_TEXTURE_BIT);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+	glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
+	glEnable(GL_TEXTURE_2D);
+	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::MODULATE);
+	glNormal3f(0.0f,0.0f,1.0f);
+	
+	/* Draw all quads from a single vertex array: */
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	GLVertexArrayParts::enable(Vertex::getPartsMask());
+	glVertexPointer(&vertices[0]);
+	glDrawArrays(GL_QUADS,0,GLsizei(vertices.size()));
+	glPopClientAttrib();
+	
+	glPopAttrib();
+	}
+
+void GLFontAtlas::beginBatch(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Start a new batch if the atlas has already been initialized in this context: */
+	if(dataItem!=0)
+		{
+		dataItem->batching=true;
+		dataItem->batch.clear();
+		}
+	}
+
+void GLFontAtlas::drawString(const char* string,const GLFontAtlas::Box& stringBox,const GLFontAtlas::Color& color,GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		return;
+	
+	if(dataItem->batching)
+		{
+		/* Append the string's quads to the current batch: */
+		createQuads(string,stringBox,color,dataItem->batch);
+		}
+	else
+		{
+		/* Draw the string's quads immediately: */
+		std::vector<Vertex> vertices;
+		if(createQuads(string,stringBox,color,vertices)>0)
+			{
+			glPushAttrib(GL_TEXTURE_BIT);
+			bindTexture(contextData);
+			drawQuads(vertices);
+			glPopAttrib();
+			}
+		}
+	}
+
+void GLFontAtlas::drawString(const char* string,const GLFontAtlas::Box& stringBox,GLfloat clipMin,GLfloat clipMax,const GLFontAtlas::Color& color,GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem==0)
+		return;
+	
+	if(dataItem->batching)
+		{
+		/* Append the string's clipped quads to the current batch: */
+		size_t firstVertex=dataItem->batch.size();
+		createQuads(string,stringBox,color,dataItem->batch);
+		clipQuads(dataItem->batch,firstVertex,clipMin,clipMax);
+		}
+	else
+		{
+		/* Draw the string's clipped quads immediately: */
+		std::vector<Vertex> vertices;
+		createQuads(string,stringBox,color,vertices);
+		if(clipQuads(vertices,0,clipMin,clipMax)>0)
+			{
+			glPushAttrib(GL_TEXTURE_BIT);
+			bindTexture(contextData);
+			drawQuads(vertices);
+			glPopAttrib();
+			}
+		}
+	}
+
+void GLFontAtlas::flushBatch(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Draw all quads collected so far and keep collecting: */
+	if(dataItem!=0&&!dataItem->batch.empty())
+		{
+		glPushAttrib(GL_TEXTURE_BIT);
+		bindTexture(contextData);
+		drawQuads(dataItem->batch);
+		glPopAttrib();
+		dataItem->batch.clear();
+		}
+	}
+
+void GLFontAtlas::endBatch(GLContextData& contextData) const
+	{
+	/* Retrieve the context data item: */
+	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
+	
+	/* Draw all collected quads: */
+	if(dataItem==0)
+		return;
+	dataItem->batching=false;
+	if(!dataItem->batch.empty())
+		{
+		glPushAttrib(GL_TEXTURE_BIT);
+		bindTexture(contextData);
+		drawQuads(dataItem->batch);
+		glPopAttrib();
+		dataItem->batch.clear();
+		}
+	}
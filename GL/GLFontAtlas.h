@@ -0,0 +1,117 @@
+/***********************************************************************
+GLFontAtlas - Class to rasterize the glyphs of a texture-based font into
+a single shared texture atlas, and to render text as batches of textured
+quads.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef GLFONTATLAS_INCLUDED
+#define GLFONTATLAS_INCLUDED
+
+#include <vector>
+#include <GL/gl.h>
+#include <GL/GLVertex.h>
+#include <GL/GLObject.h>
+#include <GL/GLFont.h>
+
+class GLFontAtlas:public GLObject
+	{
+	/* Embedded classes: */
+	public:
+	typedef GLFont::Color Color; // Type for text colors
+	typedef GLFont::Box Box; // Type for model space boxes
+	typedef GLVertex<GLfloat,2,GLubyte,4,void,GLfloat,3> Vertex; // Type for text quad vertices
+	
+	struct Glyph // Structure describing a character's cell in the atlas
+		{
+		/* Elements: */
+		public:
+		bool rasterized; // Flag whether the glyph has already been rasterized into the atlas image
+		bool empty; // Flag whether the glyph does not contain any set pixels
+		GLsizei x,y; // Position of the glyph's cell in the atlas image
+		GLsizei width; // Width of the glyph's cell in texels; cell height is the font height
+		GLsizei advance; // Horizontal distance to the next glyph in a string in texels
+		};
+	
+	private:
+	struct DataItem:public GLObject::DataItem // Structure holding per-context atlas state
+		{
+		/* Elements: */
+		public:
+		GLuint textureObjectId; // ID of the atlas texture object
+		size_t numUploadedGlyphs; // Number of glyphs from the atlas' rasterization order that have been uploaded into the texture
+		bool batching; // Flag whether text is currently collected into a batch
+		std::vector<Vertex> batch; // Text quad vertices collected in the current batch
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
+	/* Elements: */
+	const GLFont& font; // Font whose glyphs are stored in the atlas
+	GLsizei atlasWidth,atlasHeight; // Size of the atlas image in texels
+	Glyph* glyphs; // Array of glyph cells for all characters of the font
+	GLubyte* image; // The atlas image, one coverage value per texel
+	std::vector<GLint> rasterizationOrder; // Indices of rasterized glyphs in the order in which they were added to the atlas
+	
+	/* Private methods: */
+	void rasterizeGlyph(GLint charIndex); // Rasterizes the given character into its atlas cell
+	void uploadGlyphs(DataItem* dataItem) const; // Uploads all glyphs rasterized since the last upload into the context's atlas texture
+	
+	/* Constructors and destructors: */
+	public:
+	GLFontAtlas(const GLFont& sFont); // Creates an empty atlas for the given font; lays out the cells of all characters
+	virtual ~GLFontAtlas(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	GLsizei getAtlasWidth(void) const // Returns the width of the atlas image
+		{
+		return atlasWidth;
+		}
+	GLsizei getAtlasHeight(void) const // Returns the height of the atlas image
+		{
+		return atlasHeight;
+		}
+	const GLubyte* getImage(void) const // Returns the atlas image
+		{
+		return image;
+		}
+	size_t getNumRasterizedGlyphs(void) const // Returns the number of glyphs that have been rasterized so far
+		{
+		return rasterizationOrder.size();
+		}
+	const Glyph* getGlyph(char character) const; // Returns the atlas cell of the given character, or null if the character is not in the font
+	void addString(const char* string); // Rasterizes all glyphs of the given string that are not yet in the atlas; must be called before a string is drawn
+	size_t createQuads(const char* string,const Box& stringBox,const Color& color,std::vector<Vertex>& vertices) const; // Appends one textured quad per glyph of the given string, laid out in the given string bounding box, to the given vertex array; returns number of appended quads
+	static size_t clipQuads(std::vector<Vertex>& vertices,size_t firstVertex,GLfloat clipMin,GLfloat clipMax); // Clips all text quads starting at the given vertex to the given horizontal range, and removes quads that are clipped entirely; returns number of remaining clipped quads
+	void bindTexture(GLContextData& contextData) const; // Uploads any new glyphs and binds the atlas texture in the given OpenGL context
+	void updateTexture(GLContextData& contextData) const; // Uploads any new glyphs into the atlas texture in the given OpenGL context without changing the current texture binding
+	static void drawQuads(const std::vector<Vertex>& vertices); // Draws the given text quads with the currently bound atlas texture
+	void beginBatch(GLContextData& contextData) const; // Starts collecting text quads in the given OpenGL context
+	void drawString(const char* string,const Box& stringBox,const Color& color,GLContextData& contextData) const; // Draws the given string, or appends it to the current batch if one is active
+	void drawString(const char* string,const Box& stringBox,GLfloat clipMin,GLfloat clipMax,const Color& color,GLContextData& contextData) const; // Ditto, with the string clipped to the given horizontal range
+	void flushBatch(GLContextData& contextData) const; // Draws all text quads collected so far in the current batch, and continues collecting
+	void endBatch(GLContextData& contextData) const; // Draws all text quads collected since the last call to beginBatch
+	};
+
+#endif
@@ -0,0 +1,163 @@
+/***********************************************************************
+GLFontAtlasTest - Program to check the glyph cell packing and text quad
+generation of GLFontAtlas without requiring an OpenGL context.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the OpenGL Support Library (GLSupport).
+
+The OpenGL Support Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The OpenGL Support Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the OpenGL Support Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdio.h>
+#include <vector>
+#include <GL/gl.h>
+#include <GL/GLFont.h>
+#include <GL/GLFontAtlas.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+bool overlap(const GLFontAtlas::Glyph& g1,const GLFontAtlas::Glyph& g2,GLsizei cellHeight)
+	{
+	return g1.x<g2.x+g2.width&&g2.x<g1.x+g1.width&&g1.y<g2.y+cellHeight&&g2.y<g1.y+cellHeight;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Load the font to test: */
+	const char* fontName=argc>1?argv[1]:"HelveticaMediumUpright";
+	GLFont font(fontName);
+	if(!font.isValid())
+		{
+		fprintf(stderr,"Could not load font %s\n",fontName);
+		return 1;
+		}
+	GLFontAtlas& atlas=font.getAtlas();
+	GLsizei cellHeight=GLsizei(font.getTextPixelHeight());
+	GLsizei w=atlas.getAtlasWidth();
+	GLsizei h=atlas.getAtlasHeight();
+	printf("Font %s: atlas size %d x %d, cell height %d\n",fontName,int(w),int(h),int(cellHeight));
+
+	/* Check that the atlas is a power of two at least as wide as it is high: */
+	check(w>0&&(w&(w-1))==0&&h>0&&(h&(h-1))==0,"atlas size is a power of two");
+	check(h<=w,"atlas is at least as wide as it is high");
+
+	/* Collect the cells of all printable characters: */
+	std::vector<const GLFontAtlas::Glyph*> glyphs;
+	for(int c=32;c<127;++c)
+		{
+		const GLFontAtlas::Glyph* g=atlas.getGlyph(char(c));
+		if(g!=0)
+			glyphs.push_back(g);
+		}
+	check(!glyphs.empty(),"font contains printable characters");
+
+	/* Check that all cells are inside the atlas and do not overlap: */
+	for(size_t i=0;i<glyphs.size();++i)
+		{
+		const GLFontAtlas::Glyph& g=*glyphs[i];
+		check(g.x>=0&&g.y>=0&&g.x+g.width<=w&&g.y+cellHeight<=h,"glyph cell is inside the atlas");
+		check(!g.rasterized,"glyph is not rasterized before it is used");
+		for(size_t j=0;j<i;++j)
+			check(!overlap(g,*glyphs[j],cellHeight),"glyph cells do not overlap");
+		}
+
+	/* Check that adding strings rasterizes each glyph exactly once: */
+	atlas.addString("Hello, World!");
+	size_t numRasterized=atlas.getNumRasterizedGlyphs();
+	check(numRasterized==10,"first string rasterizes its distinct glyphs");
+	atlas.addString("Hello, World!");
+	atlas.addString("World Hello");
+	check(atlas.getNumRasterizedGlyphs()==numRasterized,"repeated glyphs are not rasterized again");
+	atlas.addString("Hello, Vrui!");
+	check(atlas.getNumRasterizedGlyphs()==numRasterized+3,"new glyphs are appended to the atlas");
+
+	/* Check that all set texels are inside the cells of rasterized glyphs: */
+	std::vector<bool> covered(w*h,false);
+	for(size_t i=0;i<glyphs.size();++i)
+		{
+		const GLFontAtlas::Glyph& g=*glyphs[i];
+		if(g.rasterized)
+			for(GLsizei y=g.y;y<g.y+cellHeight;++y)
+				for(GLsizei x=g.x;x<g.x+g.width;++x)
+					covered[y*w+x]=true;
+		}
+	const GLubyte* image=atlas.getImage();
+	bool strayTexels=false;
+	for(GLsizei i=0;i<w*h;++i)
+		if(image[i]!=0&&!covered[i])
+			strayTexels=true;
+	check(!strayTexels,"texels outside rasterized glyph cells are empty");
+	const GLFontAtlas::Glyph* hGlyph=atlas.getGlyph('H');
+	bool hSet=false;
+	for(GLsizei y=hGlyph->y;y<hGlyph->y+cellHeight;++y)
+		for(GLsizei x=hGlyph->x;x<hGlyph->x+hGlyph->width;++x)
+			if(image[y*w+x]!=0)
+				hSet=true;
+	check(hSet,"rasterized glyph cell contains set texels");
+
+	/* Check the text quads created for a string: */
+	const char* string="Hello, World!";
+	size_t numNonEmpty=0;
+	for(const char* cPtr=string;*cPtr!=0;++cPtr)
+		if(!atlas.getGlyph(*cPtr)->empty)
+			++numNonEmpty;
+	std::vector<GLFontAtlas::Vertex> vertices;
+	GLFontAtlas::Box stringBox=font.calcStringBox(string);
+	size_t numQuads=atlas.createQuads(string,stringBox,GLFontAtlas::Color(1.0f,1.0f,1.0f),vertices);
+	check(numQuads==numNonEmpty,"one quad per non-empty glyph");
+	check(vertices.size()==numQuads*4,"four vertices per quad");
+	bool texCoordsValid=true;
+	for(size_t i=0;i<vertices.size();++i)
+		for(int j=0;j<2;++j)
+			if(vertices[i].texCoord[j]<0.0f||vertices[i].texCoord[j]>1.0f)
+				texCoordsValid=false;
+	check(texCoordsValid,"texture coordinates are inside the atlas");
+	check(vertices.front().position[0]==stringBox.origin[0],"first quad starts at the string box");
+
+	/* Check that clipping keeps all quads inside the clip range: */
+	GLfloat clipMin=stringBox.origin[0]+stringBox.size[0]*0.25f;
+	GLfloat clipMax=stringBox.origin[0]+stringBox.size[0]*0.75f;
+	size_t numClipped=GLFontAtlas::clipQuads(vertices,0,clipMin,clipMax);
+	check(numClipped>0&&numClipped<numQuads,"clipping removes outside quads");
+	check(vertices.size()==numClipped*4,"clipping compacts the vertex array");
+	bool clipValid=true;
+	for(size_t i=0;i<vertices.size();++i)
+		if(vertices[i].position[0]<clipMin||vertices[i].position[0]>clipMax||vertices[i].texCoord[0]<0.0f||vertices[i].texCoord[0]>1.0f)
+			clipValid=false;
+	check(clipValid,"clipped quads are inside the clip range");
+
+	if(numFailures==0)
+		printf("All checks passed\n");
+	else
+		printf("%d checks failed\n",numFailures);
+	return numFailures==0?0:1;
+	}
@@ -88,6 +88,8 @@ class Arrow
 		}
 	GLfloat getPreferredBoxSize(void) const; // Returns the arrow's preferred box size
 	ZRange calcZRange(void) const; // Returns the range of z values of the arrow
+	
+	/* Arrows are not widgets; a widget must call its update() method after changing its arrows: */
 	void setDirection(Direction newDirection); // Sets the arrow's direction
 	void setStyle(Style newStyle); // Sets the arrow's style
 	void setDepth(Depth newDepth); // Sets the arrow's depth
@@ -73,6 +73,9 @@ void Blind::setPreferredSize(const Vector& newPreferredSize)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
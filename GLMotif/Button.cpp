@@ -53,6 +53,9 @@ void Button::setArmed(bool newArmed)
 	/* Call the arm callbacks: */
 	ArmCallbackData cbData(this,isArmed);
 	armCallbacks.call(&cbData);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Button::select(void)
@@ -166,6 +169,9 @@ void Button::setBorderType(Widget::BorderType newBorderType)
 		/* Set the new border type using the base class method: */
 		Label::setBorderType(newBorderType);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Button::setBackgroundColor(const Color& newBackgroundColor)
@@ -180,6 +186,9 @@ void Button::setBackgroundColor(const Color& newBackgroundColor)
 		/* Set the new background color using the base class method: */
 		Label::setBackgroundColor(newBackgroundColor);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Button::setArmedBackgroundColor(const Color& newArmedBackgroundColor)
@@ -192,6 +201,9 @@ void Button::setArmedBackgroundColor(const Color& newArmedBackgroundColor)
 		/* Set the new armed background color right away: */
 		Label::setBackgroundColor(armedBackgroundColor);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
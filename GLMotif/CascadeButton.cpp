@@ -69,6 +69,9 @@ void CascadeButton::setArmed(bool newArmed)
 		popup->getManager()->popdownWidget(popup);
 		isPopped=false;
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void CascadeButton::drawDecoration(GLContextData& contextData) const
@@ -160,6 +163,9 @@ void CascadeButton::setBackgroundColor(const Color& newBackgroundColor)
 	
 	/* Let the arrow glyph track the background color: */
 	arrow.setArrowColor(newBackgroundColor);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 bool CascadeButton::findRecipient(Event& event)
@@ -261,6 +267,9 @@ void CascadeButton::setArrowBorderSize(GLfloat newArrowBorderSize)
 	/* Set the decoration width: */
 	GLfloat width=arrow.getPreferredBoxSize();
 	setDecorationSize(Vector(width,width,0.0f));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void CascadeButton::setArrowSize(GLfloat newArrowSize)
@@ -271,11 +280,17 @@ void CascadeButton::setArrowSize(GLfloat newArrowSize)
 	/* Set the decoration width: */
 	GLfloat width=arrow.getPreferredBoxSize();
 	setDecorationSize(Vector(width,width,0.0f));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void CascadeButton::setPopupExtrudeSize(GLfloat newPopupExtrudeSize)
 	{
 	popupExtrudeSize=newPopupExtrudeSize;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -184,6 +184,9 @@ void DecoratedButton::setDecorationSize(const Vector& newDecorationSize)
 		parent->requestResize(this,calcNaturalSize());
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DecoratedButton::setDecorationPosition(DecorationPosition newDecorationPosition)
@@ -196,6 +199,9 @@ void DecoratedButton::setDecorationPosition(DecorationPosition newDecorationPosi
 	
 	/* Update the label position, no resize necessary: */
 	positionLabel();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DecoratedButton::setSpacing(GLfloat newSpacing)
@@ -211,6 +217,9 @@ void DecoratedButton::setSpacing(GLfloat newSpacing)
 		parent->requestResize(this,calcNaturalSize());
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
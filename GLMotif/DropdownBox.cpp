@@ -191,6 +191,9 @@ void DropdownBox::setBackgroundColor(const Color& newBackgroundColor)
 	
 	/* Set the dropdown arrow's background color: */
 	arrow.setArrowColor(newBackgroundColor);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DropdownBox::draw(GLContextData& contextData) const
@@ -359,6 +362,9 @@ void DropdownBox::setSpacing(GLfloat newSpacing)
 		parent->requestResize(this,calcNaturalSize());
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DropdownBox::setArrowBorderSize(GLfloat newArrowBorderSize)
@@ -374,6 +380,9 @@ void DropdownBox::setArrowBorderSize(GLfloat newArrowBorderSize)
 		parent->requestResize(this,calcNaturalSize());
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DropdownBox::setArrowSize(GLfloat newArrowSize)
@@ -389,11 +398,17 @@ void DropdownBox::setArrowSize(GLfloat newArrowSize)
 		parent->requestResize(this,calcNaturalSize());
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DropdownBox::setPopupExtrudeSize(GLfloat newPopupExtrudeSize)
 	{
 	popupExtrudeSize=newPopupExtrudeSize;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 const char* DropdownBox::getItem(int item) const
@@ -421,6 +436,9 @@ void DropdownBox::addItem(const char* newItem)
 		parent->requestResize(this,calcNaturalSize());
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void DropdownBox::setSelectedItem(int newSelectedItem)
@@ -433,6 +451,9 @@ void DropdownBox::setSelectedItem(int newSelectedItem)
 		/* Change the displayed label: */
 		setLabel(static_cast<Button*>(items->getChild(selectedItem))->getLabel());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -22,15 +22,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <ctype.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
-#include <dirent.h>
-#ifndef _DIRENT_HAVE_D_TYPE
 #include <sys/stat.h>
-#endif
+#include <dirent.h>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
+#include <Threads/Mutex.h>
+#include <Threads/Thread.h>
 #include <Comm/MulticastPipe.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/WidgetManager.h>
@@ -84,8 +87,179 @@ class StringCompare // Class to compare strings according to case-insensitive le
 		}
 	};
 
+struct CachedDirectory // Structure to cache the entries of a directory on the master node
+	{
+	/* Elements: */
+	public:
+	time_t modTime; // Modification time of the directory when it was read
+	std::vector<std::string> directories; // Sorted names of all directories in the directory
+	std::vector<std::string> files; // Sorted names of all files in the directory, before filtering
+	
+	/* Constructors and destructors: */
+	CachedDirectory(time_t sModTime,const std::vector<std::string>& sDirectories,const std::vector<std::string>& sFiles)
+		:modTime(sModTime),directories(sDirectories),files(sFiles)
+		{
+		}
+	};
+
+typedef Misc::HashTable<std::string,CachedDirectory> DirectoryCache; // Hash table type to cache directories by full path name
+
+/****************
+Helper variables:
+****************/
+
+const size_t maxNumCachedDirectories=64; // Maximum number of directories kept in the cache
+DirectoryCache directoryCache(17); // Cache of recently read directories shared by all file selection dialogs
+
+/****************
+Helper functions:
+****************/
+
+void writeNames(Comm::MulticastPipe& pipe,const std::vector<std::string>& names)
+	{
+	/* Write the number of names, followed by the names: */
+	pipe.write<int>(int(names.size()));
+	for(std::vector<std::string>::const_iterator nIt=names.begin();nIt!=names.end();++nIt)
+		{
+		pipe.write<int>(nIt->size());
+		pipe.write<char>(nIt->c_str(),nIt->size()+1);
+		}
+	}
+
+void readNames(Comm::MulticastPipe& pipe,std::vector<std::string>& names)
+	{
+	/* Read the number of names, followed by the names: */
+	int numNames=pipe.read<int>();
+	names.reserve(names.size()+numNames);
+	std::vector<char> buffer;
+	for(int i=0;i<numNames;++i)
+		{
+		int length=pipe.read<int>();
+		buffer.resize(length+1);
+		pipe.read<char>(&buffer[0],length+1);
+		names.push_back(std::string(&buffer[0],length));
+		}
+	}
+
 }
 
+/*********************************************
+Embedded classes of class FileSelectionDialog:
+*********************************************/
+
+struct FileSelectionDialog::DirectoryScan
+	{
+	/* Elements: */
+	public:
+	std::string path; // Full path name of the scanned directory
+	time_t modTime; // Modification time of the directory when the scan was started
+	bool cacheable; // Flag whether the results of the scan can be cached
+	Threads::Thread thread; // Thread reading the directory
+	Threads::Mutex mutex; // Mutex protecting the following state
+	std::vector<std::string> directories; // Names of directories found since the dialog last retrieved entries
+	std::vector<std::string> files; // Names of files found since the dialog last retrieved entries
+	bool finished; // Flag whether the scan thread is done
+	bool failed; // Flag whether the directory could not be read
+	bool abandoned; // Flag whether the dialog abandoned the scan; the scan thread deletes an abandoned scan when it is done
+	
+	/* Constructors and destructors: */
+	DirectoryScan(const std::string& sPath,time_t sModTime,bool sCacheable)
+		:path(sPath),modTime(sModTime),cacheable(sCacheable),
+		 finished(false),failed(false),abandoned(false)
+		{
+		}
+	
+	/* Methods: */
+	void* scanThreadMethod(void); // Reads the directory and hands over its entries in batches
+	};
+
+/***************************************************
+Methods of class FileSelectionDialog::DirectoryScan:
+***************************************************/
+
+void* FileSelectionDialog::DirectoryScan::scanThreadMethod(void)
+	{
+	/* Open the directory: */
+	DIR* directory=opendir(path.c_str());
+	
+	/* Read all directory entries and hand them over in batches: */
+	std::vector<std::string> batchDirectories;
+	std::vector<std::string> batchFiles;
+	bool keepReading=directory!=0;
+	while(keepReading)
+		{
+		struct dirent* dirEntry=readdir(directory);
+		keepReading=dirEntry!=0;
+		
+		/* Ignore hidden entries: */
+		if(dirEntry!=0&&dirEntry->d_name[0]!='.')
+			{
+			/* Determine the type of the directory entry: */
+			int entryType=0; // unkown, directory, file
+			#ifdef _DIRENT_HAVE_D_TYPE
+			if(dirEntry->d_type==DT_DIR)
+				entryType=1;
+			else if(dirEntry->d_type==DT_REG)
+				entryType=2;
+			else if(dirEntry->d_type==DT_UNKNOWN||dirEntry->d_type==DT_LNK)
+			#endif
+				{
+				std::string fullName=path;
+				fullName.push_back('/');
+				fullName.append(dirEntry->d_name);
+				struct stat statResult;
+				if(stat(fullName.c_str(),&statResult)==0)
+					{
+					if(S_ISDIR(statResult.st_mode))
+						entryType=1;
+					else if(S_ISREG(statResult.st_mode))
+						entryType=2;
+					}
+				}
+			
+			if(entryType==1)
+				{
+				/* Store a directory name: */
+				std::string entryName=dirEntry->d_name;
+				entryName.push_back('/');
+				batchDirectories.push_back(entryName);
+				}
+			else if(entryType==2)
+				{
+				/* Store a file name: */
+				batchFiles.push_back(dirEntry->d_name);
+				}
+			}
+		
+		if(!keepReading||batchDirectories.size()+batchFiles.size()>=256)
+			{
+			/* Hand over the current batch: */
+			Threads::Mutex::Lock scanLock(mutex);
+			if(abandoned)
+				keepReading=false;
+			directories.insert(directories.end(),batchDirectories.begin(),batchDirectories.end());
+			files.insert(files.end(),batchFiles.begin(),batchFiles.end());
+			batchDirectories.clear();
+			batchFiles.clear();
+			}
+		}
+	if(directory!=0)
+		closedir(directory);
+	
+	/* Signal completion, and delete the scan if it was abandoned in the meantime: */
+	bool mustDelete;
+	{
+	Threads::Mutex::Lock scanLock(mutex);
+	finished=true;
+	failed=directory==0;
+	mustDelete=abandoned;
+	}
+	if(mustDelete)
+		delete this;
+	
+	return 0;
+	}
+
 /************************************
 Methods of class FileSelectionDialog:
 ************************************/
@@ -105,176 +279,251 @@ std::string FileSelectionDialog::getCurrentPath(void) const
 	return fullPath;
 	}
 
-bool FileSelectionDialog::readDirectory(void)
+bool FileSelectionDialog::passesFilters(const char* fileName) const
+	{
+	/* Accept all files if there are no filters: */
+	if(fileNameFilters==0)
+		return true;
+	
+	/* Find the file name's extension: */
+	const char* extPtr="";
+	for(const char* enPtr=fileName;*enPtr!='\0';++enPtr)
+		if(*enPtr=='.')
+			extPtr=enPtr;
+	
+	/* Match against the list of allowed extensions: */
+	bool result=false;
+	const char* filterPtr=fileNameFilters;
+	while(*filterPtr!='\0'&&!result)
+		{
+		/* Extract the next extension: */
+		const char* extStart=filterPtr;
+		for(;*filterPtr!='\0'&&*filterPtr!=';';++filterPtr)
+			;
+		
+		/* See if it matches: */
+		result=int(strlen(extPtr))==filterPtr-extStart&&memcmp(extPtr,extStart,filterPtr-extStart)==0;
+		
+		/* Skip the separator: */
+		if(*filterPtr==';')
+			++filterPtr;
+		}
+	
+	return result;
+	}
+
+void FileSelectionDialog::cancelDirectoryScan(void)
 	{
+	/* Stop polling: */
+	Misc::TimerEventScheduler* tes=getManager()->getTimerEventScheduler();
+	if(tes!=0)
+		tes->removeAllEvents(this,&FileSelectionDialog::scanTimerCallback);
+	
+	if(scan!=0)
+		{
+		/* Abandon the scan; if the scan thread is still running, it will delete the scan when it is done: */
+		bool finished;
+		{
+		Threads::Mutex::Lock scanLock(scan->mutex);
+		scan->abandoned=true;
+		finished=scan->finished;
+		}
+		if(finished)
+			delete scan;
+		scan=0;
+		}
+	}
+
+void FileSelectionDialog::readDirectory(void)
+	{
+	/* Abandon reading the previous directory: */
+	cancelDirectoryScan();
+	directories.clear();
+	files.clear();
+	numScanBatches=0;
+	fileList->getListBox()->clear();
+	
+	int status=SCAN_FAILED;
+	std::vector<std::string> newDirectories;
+	std::vector<std::string> newFiles;
 	if(pipe==0||pipe->isMaster())
 		{
-		/* Open the current directory: */
+		/* Check the current directory: */
 		std::string fullPath=getCurrentPath();
-		DIR* directory=opendir(fullPath.c_str());
-		if(directory==0)
+		struct stat statResult;
+		if(stat(fullPath.c_str(),&statResult)==0&&S_ISDIR(statResult.st_mode))
 			{
-			if(pipe!=0)
+			/* Check if the directory is cached and has not been modified since: */
+			DirectoryCache::Iterator dcIt=directoryCache.findEntry(fullPath);
+			if(!dcIt.isFinished()&&dcIt->getDest().modTime==statResult.st_mtime)
 				{
-				/* Send an error code to the slave nodes: */
-				pipe->write<int>(0);
-				pipe->finishMessage();
+				/* Use the cached directory entries: */
+				newDirectories=dcIt->getDest().directories;
+				newFiles=dcIt->getDest().files;
+				status=SCAN_COMPLETE;
 				}
-			return false;
-			}
-		
-		/* Read all directory entries: */
-		std::vector<std::string> directories;
-		std::vector<std::string> files;
-		struct dirent* dirEntry;
-		while((dirEntry=readdir(directory))!=0)
-			{
-			/* Ignore hidden entries: */
-			if(dirEntry->d_name[0]!='.')
+			else
 				{
-				/* Determine the type of the directory entry: */
-				int entryType=0; // unkown, directory, file
-				#ifdef _DIRENT_HAVE_D_TYPE
-				if(dirEntry->d_type==DT_DIR)
-					entryType=1;
-				else if(dirEntry->d_type==DT_REG)
-					entryType=2;
-				#else
-				std::string fullName=fullPath;
-				fullName.push_back('/');
-				fullName.append(dirEntry->d_name);
-				struct stat statResult;
-				if(stat(fullName.c_str(),&statResult)==0)
+				/* Start scanning the directory; the results can only be cached if the directory was not modified within the current second: */
+				scan=new DirectoryScan(fullPath,statResult.st_mtime,statResult.st_mtime<time(0));
+				if(getManager()->getTimerEventScheduler()!=0)
 					{
-					if(S_ISDIR(statResult.st_mode))
-						entryType=1;
-					else if(S_ISREG(statResult.st_mode))
-						entryType=2;
+					scan->thread.start(scan,&DirectoryScan::scanThreadMethod);
+					scan->thread.detach();
 					}
-				#endif
-				
-				if(entryType==1)
+				else
 					{
-					/* Store a directory name: */
-					std::string entryName=dirEntry->d_name;
-					entryName.push_back('/');
-					directories.push_back(entryName);
-					}
-				else if(entryType==2)
-					{
-					/* Check if the file name matches any of the supplied extensions: */
-					bool passesFilters=true;
-					if(fileNameFilters!=0)
-						{
-						/* Find the file name's extension: */
-						const char* extPtr="";
-						for(const char* enPtr=dirEntry->d_name;*enPtr!='\0';++enPtr)
-							if(*enPtr=='.')
-								extPtr=enPtr;
-						
-						/* Match against the list of allowed extensions: */
-						passesFilters=false;
-						const char* filterPtr=fileNameFilters;
-						while(*filterPtr!='\0'&&!passesFilters)
-							{
-							/* Extract the next extension: */
-							const char* extStart=filterPtr;
-							for(;*filterPtr!='\0'&&*filterPtr!=';';++filterPtr)
-								;
-							
-							/* See if it matches: */
-							passesFilters=int(strlen(extPtr))==filterPtr-extStart&&memcmp(extPtr,extStart,filterPtr-extStart)==0;
-							
-							/* Skip the separator: */
-							if(*filterPtr==';')
-								++filterPtr;
-							}
-						}
-					
-					if(passesFilters)
-						{
-						/* Store a file name: */
-						std::string entryName=dirEntry->d_name;
-						files.push_back(entryName);
-						}
+					/* Read the directory synchronously, as there is no way to poll a background scan: */
+					scan->scanThreadMethod();
 					}
+				
+				/* Retrieve the first batch of directory entries: */
+				Threads::Mutex::Lock scanLock(scan->mutex);
+				std::swap(newDirectories,scan->directories);
+				std::swap(newFiles,scan->files);
+				status=scan->failed?SCAN_FAILED:(scan->finished?SCAN_COMPLETE:SCAN_PARTIAL);
 				}
 			}
+		}
+	
+	/* Add the first batch of directory entries: */
+	distributeScanBatch(status,newDirectories,newFiles);
+	addScanBatch(status,newDirectories,newFiles);
+	}
+
+void FileSelectionDialog::distributeScanBatch(int& status,std::vector<std::string>& newDirectories,std::vector<std::string>& newFiles)
+	{
+	if(pipe==0)
+		return;
+	
+	if(pipe->isMaster())
+		{
+		/* Send the batch to the slave nodes: */
+		pipe->write<int>(status);
+		writeNames(*pipe,newDirectories);
+		writeNames(*pipe,newFiles);
+		pipe->finishMessage();
+		}
+	else
+		{
+		/* Receive the batch from the master node: */
+		status=pipe->read<int>();
+		readNames(*pipe,newDirectories);
+		readNames(*pipe,newFiles);
+		}
+	}
+
+void FileSelectionDialog::addScanBatch(int status,std::vector<std::string>& newDirectories,std::vector<std::string>& newFiles)
+	{
+	ListBox* listBox=fileList->getListBox();
+	StringCompare sc;
+	
+	if(!newDirectories.empty()||!newFiles.empty())
+		{
+		/* Sort the new entries: */
+		std::sort(newDirectories.begin(),newDirectories.end(),sc);
+		std::sort(newFiles.begin(),newFiles.end(),sc);
 		
-		if(pipe!=0)
-			{
-			/* Send a success code to the slave nodes: */
-			pipe->write<int>(1);
-			}
+		/* Insert the new directories after the directories already in the list, and append all new files passing the filters: */
+		std::vector<const char*> names;
+		names.reserve(newDirectories.size());
+		for(std::vector<std::string>::const_iterator dIt=newDirectories.begin();dIt!=newDirectories.end();++dIt)
+			names.push_back(dIt->c_str());
+		if(!names.empty())
+			listBox->insertItems(int(directories.size()),int(names.size()),&names[0]);
+		names.clear();
+		for(std::vector<std::string>::const_iterator fIt=newFiles.begin();fIt!=newFiles.end();++fIt)
+			if(passesFilters(fIt->c_str()))
+				names.push_back(fIt->c_str());
+		if(!names.empty())
+			listBox->addItems(int(names.size()),&names[0]);
 		
-		/* Sort the directory and file names separately: */
-		StringCompare sc;
-		std::sort(directories.begin(),directories.end(),sc);
-		std::sort(files.begin(),files.end(),sc);
-		if(pipe!=0)
+		/* Store the new entries: */
+		directories.insert(directories.end(),newDirectories.begin(),newDirectories.end());
+		files.insert(files.end(),newFiles.begin(),newFiles.end());
+		++numScanBatches;
+		}
+	
+	if(status==SCAN_PARTIAL)
+		{
+		/* Poll the scan again a little later: */
+		Misc::TimerEventScheduler* tes=getManager()->getTimerEventScheduler();
+		tes->scheduleEvent(tes->getCurrentTime()+0.1,this,&FileSelectionDialog::scanTimerCallback);
+		}
+	else
+		{
+		if(numScanBatches>1)
 			{
-			/* Send the directory names to the slave nodes: */
-			for(std::vector<std::string>::const_iterator dIt=directories.begin();dIt!=directories.end();++dIt)
-				{
-				/* Write the string: */
-				pipe->write<int>(dIt->size());
-				pipe->write<char>(dIt->c_str(),dIt->size()+1);
-				}
+			/* Sort all entries, which were received in several batches: */
+			std::sort(directories.begin(),directories.end(),sc);
+			std::sort(files.begin(),files.end(),sc);
 			
-			/* Send the file names to the slave nodes: */
-			for(std::vector<std::string>::const_iterator fIt=files.begin();fIt!=files.end();++fIt)
+			/* Replace the list box contents while retaining the displayed page and the selected entry: */
+			int position=listBox->getPosition();
+			int selectedItem=listBox->getSelectedItem();
+			std::string selectedName=selectedItem>=0?listBox->getItem(selectedItem):"";
+			updateFileList();
+			listBox->setPosition(position);
+			if(selectedItem>=0)
 				{
-				/* Write the string: */
-				pipe->write<int>(fIt->size());
-				pipe->write<char>(fIt->c_str(),fIt->size()+1);
+				for(int i=0;i<listBox->getNumItems();++i)
+					if(selectedName==listBox->getItem(i))
+						{
+						listBox->selectItem(i);
+						break;
+						}
 				}
-			
-			/* Send the list terminator message: */
-			pipe->write<int>(-1);
-			pipe->finishMessage();
 			}
 		
-		/* Copy all names into the list box: */
-		fileList->getListBox()->clear();
-		for(std::vector<std::string>::const_iterator dIt=directories.begin();dIt!=directories.end();++dIt)
-			fileList->getListBox()->addItem(dIt->c_str());
-		for(std::vector<std::string>::const_iterator fIt=files.begin();fIt!=files.end();++fIt)
-			fileList->getListBox()->addItem(fIt->c_str());
-		}
-	else
-		{
-		/* Read the status flag from the master node: */
-		int success=pipe->read<int>();
-		if(success)
+		if(scan!=0)
 			{
-			/* Clear the list box: */
-			fileList->getListBox()->clear();
-			
-			/* Read the directory and file names: */
-			int length;
-			int bufferSize=128;
-			char* buffer=new char[bufferSize];
-			while((length=pipe->read<int>())>=0)
+			/* Cache the directory's entries: */
+			if(status==SCAN_COMPLETE&&scan->cacheable)
 				{
-				/* Make sure the buffer is big enough: */
-				if(bufferSize<length+1)
-					{
-					delete[] buffer;
-					bufferSize=(length+1)*3/2;
-					buffer=new char[bufferSize];
-					}
-				
-				/* Read the string and add it to the list box: */
-				pipe->read<char>(buffer,length+1);
-				fileList->getListBox()->addItem(buffer);
+				if(directoryCache.getNumEntries()>=maxNumCachedDirectories)
+					directoryCache.clear();
+				directoryCache.setEntry(DirectoryCache::Entry(scan->path,CachedDirectory(scan->modTime,directories,files)));
 				}
-			delete[] buffer;
+			
+			/* Delete the finished scan: */
+			delete scan;
+			scan=0;
 			}
-		else
-			return false;
 		}
+	}
+
+void FileSelectionDialog::scanTimerCallback(Misc::TimerEventScheduler::CallbackData* cbData)
+	{
+	int status=SCAN_FAILED;
+	std::vector<std::string> newDirectories;
+	std::vector<std::string> newFiles;
+	if(scan!=0)
+		{
+		/* Retrieve all directory entries found since the last poll: */
+		Threads::Mutex::Lock scanLock(scan->mutex);
+		std::swap(newDirectories,scan->directories);
+		std::swap(newFiles,scan->files);
+		status=scan->failed?SCAN_FAILED:(scan->finished?SCAN_COMPLETE:SCAN_PARTIAL);
+		}
+	
+	/* Add the batch of directory entries: */
+	distributeScanBatch(status,newDirectories,newFiles);
+	addScanBatch(status,newDirectories,newFiles);
+	}
+
+void FileSelectionDialog::updateFileList(void)
+	{
+	/* Collect all directories and all files passing the current filters: */
+	std::vector<const char*> names;
+	names.reserve(directories.size()+files.size());
+	for(std::vector<std::string>::const_iterator dIt=directories.begin();dIt!=directories.end();++dIt)
+		names.push_back(dIt->c_str());
+	for(std::vector<std::string>::const_iterator fIt=files.begin();fIt!=files.end();++fIt)
+		if(passesFilters(fIt->c_str()))
+			names.push_back(fIt->c_str());
 	
-	return true;
+	/* Replace the list box's contents with all names in one go: */
+	fileList->getListBox()->setItems(int(names.size()),names.empty()?0:&names[0]);
 	}
 
 void FileSelectionDialog::setSelectedPathButton(int newSelectedPathButton)
@@ -351,8 +600,8 @@ void FileSelectionDialog::filterListValueChangedCallback(DropdownBox::ValueChang
 	/* Set the current file name filters to the new selected item: */
 	fileNameFilters=cbData->newSelectedItem>0?cbData->dropdownBox->getItem(cbData->newSelectedItem):0;
 	
-	/* Re-read the current directory: */
-	readDirectory();
+	/* Re-filter the current directory's entries: */
+	updateFileList();
 	}
 
 void FileSelectionDialog::okButtonSelectedCallback(Misc::CallbackData* cbData)
@@ -408,7 +657,7 @@ FileSelectionDialog::FileSelectionDialog(WidgetManager* widgetManager,const char
 	 pipe(sPipe),
 	 fileNameFilters(sFileNameFilters),
 	 pathButtonBox(0),selectedPathButton(-1),
-	 fileList(0),filterList(0)
+	 fileList(0),scan(0),numScanBatches(0),filterList(0)
 	{
 	/* Create the file selection dialog: */
 	RowColumn* fileSelectionDialog=new RowColumn("FileSelectionDialog",this,false);
@@ -521,12 +770,6 @@ FileSelectionDialog::FileSelectionDialog(WidgetManager* widgetManager,const char
 	/* Select the last path button (to read the initial directory): */
 	setSelectedPathButton(pathButtonIndex);
 	
-	/* Read the initial directory: */
-	if(!readDirectory())
-		{
-		/* This is bad! */
-		}
-	
 	/* Create the button box: */
 	RowColumn* buttonBox=new RowColumn("ButtonBox",fileSelectionDialog,false);
 	buttonBox->setOrientation(RowColumn::HORIZONTAL);
@@ -587,6 +830,9 @@ FileSelectionDialog::FileSelectionDialog(WidgetManager* widgetManager,const char
 
 FileSelectionDialog::~FileSelectionDialog(void)
 	{
+	/* Abandon reading the current directory: */
+	cancelDirectoryScan();
+	
 	/* Delete the pipe: */
 	if(pipe!=0)
 		delete pipe;
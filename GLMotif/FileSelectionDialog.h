@@ -23,8 +23,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define GLMOTIF_FILESELECTIONDIALOG_INCLUDED
 
 #include <string>
+#include <vector>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
+#include <Misc/TimerEventScheduler.h>
 #include <GLMotif/Button.h>
 #include <GLMotif/ListBox.h>
 #include <GLMotif/DropdownBox.h>
@@ -82,20 +84,37 @@ class FileSelectionDialog:public PopupWindow
 			}
 		};
 	
-	/* Elements: */
 	private:
+	enum ScanStatus // Enumerated type for states of directory scans
+		{
+		SCAN_FAILED,SCAN_PARTIAL,SCAN_COMPLETE
+		};
+	
+	struct DirectoryScan; // Structure holding the state of a background directory scan
+	
+	/* Elements: */
 	Comm::MulticastPipe* pipe; // A multicast pipe to synchronize instances of the file selection dialog across a cluster; file selection dialog takes over ownership from caller
 	const char* fileNameFilters; // Current filter expression for file names; semicolon-separated list of allowed extensions
 	RowColumn* pathButtonBox; // Box containing the path component buttons
 	int selectedPathButton; // Index of the currently selected path button; determines the displayed directory
 	ScrolledListBox* fileList; // Scrolled list box containing all directories and matching files in the current directory
+	DirectoryScan* scan; // Background scan of the current directory on the master node, or null
+	std::vector<std::string> directories; // Names of all directories in the current directory received so far
+	std::vector<std::string> files; // Names of all files in the current directory received so far, before filtering
+	int numScanBatches; // Number of non-empty batches of entries received for the current directory
 	DropdownBox* filterList; // Drop down box containing the selectable file name filters
 	Misc::CallbackList okCallbacks; // Callbacks to be called when the OK button is selected, or a file name is double-clicked
 	Misc::CallbackList cancelCallbacks; // Callbacks to be called when the cancel button is selected
 	
 	/* Private methods: */
 	std::string getCurrentPath(void) const; // Constructs the full path name of the currently displayed directory
-	bool readDirectory(void); // Reads all directories and files from the selected directory into the list box
+	bool passesFilters(const char* fileName) const; // Returns true if the given file name matches the current file name filters
+	void cancelDirectoryScan(void); // Abandons reading the current directory
+	void readDirectory(void); // Starts reading all directories and files from the selected directory into the list box
+	void distributeScanBatch(int& status,std::vector<std::string>& newDirectories,std::vector<std::string>& newFiles); // Sends a batch of directory entries from the master node to all slave nodes, or receives it
+	void addScanBatch(int status,std::vector<std::string>& newDirectories,std::vector<std::string>& newFiles); // Adds a batch of directory entries to the list box
+	void scanTimerCallback(Misc::TimerEventScheduler::CallbackData* cbData); // Callback to poll the background directory scan
+	void updateFileList(void); // Replaces the list box's contents with all directories and all files matching the current filters
 	void setSelectedPathButton(int newSelectedPathButton); // Changes the selected path button
 	void pathButtonSelectedCallback(Button::SelectCallbackData* cbData); // Callback called when one of the path buttons is selected
 	void listItemSelectedCallback(ListBox::ItemSelectedCallbackData* cbData); // Callback when a list item gets double-clicked
@@ -22,10 +22,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
-#include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
-#include <GL/GLTexEnvTemplates.h>
-#include <GL/GLContextData.h>
+#include <GL/GLFontAtlas.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/Container.h>
 
@@ -76,38 +74,18 @@ void Label::positionLabel(void)
 
 void Label::drawLabel(GLContextData& contextData) const
 	{
-	/* Retrieve the context data: */
-	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
-	
-	/* Draw the label: */
-	glPushAttrib(GL_TEXTURE_BIT);
-	GLint lightModelColorControl;
-	glGetIntegerv(GL_LIGHT_MODEL_COLOR_CONTROL,&lightModelColorControl);
-	glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
-	if(dataItem->stringVersion!=labelVersion) // Has the string been changed?
-		{
-		/* Upload the label string texture again: */
-		font->uploadStringTexture(label,backgroundColor,foregroundColor);
-		dataItem->stringVersion=labelVersion;
-		}
-	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::MODULATE);
-	glColor4f(1.0f,1.0f,1.0f,backgroundColor[3]);
+	/* Draw the label background: */
+	glColor(backgroundColor);
 	glBegin(GL_QUADS);
 	glNormal3f(0.0f,0.0f,1.0f);
-	glTexCoord(labelTexCoords.getCorner(0));
 	glVertex(labelBox.getCorner(0));
-	glTexCoord(labelTexCoords.getCorner(1));
 	glVertex(labelBox.getCorner(1));
-	glTexCoord(labelTexCoords.getCorner(3));
 	glVertex(labelBox.getCorner(3));
-	glTexCoord(labelTexCoords.getCorner(2));
 	glVertex(labelBox.getCorner(2));
 	glEnd();
-	glBindTexture(GL_TEXTURE_2D,0);
-	glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,lightModelColorControl);
-	glPopAttrib();
+	
+	/* Draw the label string on top of the background, or add it to the current text batch: */
+	font->getAtlas().drawString(label,labelBox,foregroundColor,contextData);
 	}
 
 void Label::setInsets(GLfloat newLeftInset,GLfloat newRightInset)
@@ -123,6 +101,9 @@ void Label::setInsets(GLfloat newLeftInset,GLfloat newRightInset)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 Label::Label(const char* sName,Container* sParent,const char* sLabel,const GLFont* sFont,bool sManageChild)
@@ -130,7 +111,7 @@ Label::Label(const char* sName,Container* sParent,const char* sLabel,const GLFon
 	 marginWidth(0.0f),
 	 leftInset(0.0f),rightInset(0.0f),
 	 font(sFont),
-	 labelVersion(0),label(0),hAlignment(GLFont::Left),vAlignment(GLFont::VCenter)
+	 label(0),hAlignment(GLFont::Left),vAlignment(GLFont::VCenter)
 	{
 	/* Get the style sheet: */
 	const StyleSheet* ss=getStyleSheet();
@@ -154,7 +135,7 @@ Label::Label(const char* sName,Container* sParent,const char* sLabel,bool sManag
 	 marginWidth(0.0f),
 	 leftInset(0.0f),rightInset(0.0f),
 	 font(0),
-	 labelVersion(0),label(0),hAlignment(GLFont::Left),vAlignment(GLFont::VCenter)
+	 label(0),hAlignment(GLFont::Left),vAlignment(GLFont::VCenter)
 	{
 	/* Get the style sheet: */
 	const StyleSheet* ss=getStyleSheet();
@@ -200,18 +181,6 @@ void Label::resize(const Box& newExterior)
 	positionLabel();
 	}
 
-void Label::setBackgroundColor(const Color& newBackgroundColor)
-	{
-	Widget::setBackgroundColor(newBackgroundColor);
-	++labelVersion;
-	}
-
-void Label::setForegroundColor(const Color& newForegroundColor)
-	{
-	Widget::setForegroundColor(newForegroundColor);
-	++labelVersion;
-	}
-
 void Label::draw(GLContextData& contextData) const
 	{
 	/* Draw parent class decorations: */
@@ -233,22 +202,10 @@ void Label::draw(GLContextData& contextData) const
 	glVertex(getInterior().getCorner(0));
 	glEnd();
 	
-	/* Draw the label texture: */
+	/* Draw the label string: */
 	drawLabel(contextData);
 	}
 
-void Label::initContext(GLContextData& contextData) const
-	{
-	/* Create a context data item: */
-	DataItem* dataItem=new DataItem(labelVersion);
-	contextData.addDataItem(this,dataItem);
-	
-	/* Upload the string texture: */
-	glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
-	font->uploadStringTexture(label,backgroundColor,foregroundColor);
-	glBindTexture(GL_TEXTURE_2D,0);
-	}
-
 void Label::setMarginWidth(GLfloat newMarginWidth)
 	{
 	/* Set the new margin width: */
@@ -261,6 +218,9 @@ void Label::setMarginWidth(GLfloat newMarginWidth)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Label::setHAlignment(GLFont::HAlignment newHAlignment)
@@ -270,6 +230,9 @@ void Label::setHAlignment(GLFont::HAlignment newHAlignment)
 	
 	/* Update the label position: */
 	positionLabel();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Label::setVAlignment(GLFont::VAlignment newVAlignment)
@@ -279,6 +242,9 @@ void Label::setVAlignment(GLFont::VAlignment newVAlignment)
 	
 	/* Update the label position: */
 	positionLabel();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Label::setLabel(const char* newLabel)
@@ -288,11 +254,10 @@ void Label::setLabel(const char* newLabel)
 	size_t len=strlen(newLabel);
 	label=new char[len+1];
 	memcpy(label,newLabel,len+1);
-	++labelVersion;
 	
-	/* Calculate the label's bounding box size and texture coordinates: */
+	/* Add the label's glyphs to the font's atlas and calculate the label's bounding box size: */
+	font->getAtlas().addString(label);
 	labelBox=font->calcStringBox(label);
-	labelTexCoords=font->calcStringTexCoords(label);
 	
 	if(isManaged)
 		{
@@ -301,6 +266,9 @@ void Label::setLabel(const char* newLabel)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -23,50 +23,26 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define GLMOTIF_LABEL_INCLUDED
 
 #include <GL/gl.h>
-#include <GL/GLObject.h>
 #include <GL/GLFont.h>
 #include <GLMotif/Widget.h>
 
 namespace GLMotif {
 
-class Label:public Widget,public GLObject
+class Label:public Widget
 	{
-	/* Embedded classes: */
-	private:
-	struct DataItem:public GLObject::DataItem
-		{
-		/* Elements: */
-		public:
-		GLuint stringVersion;
-		GLuint textureObjectId;
-
-		/* Constructors and destructors: */
-		DataItem(GLuint sStringVersion)
-			:stringVersion(sStringVersion)
-			{
-			glGenTextures(1,&textureObjectId);
-			}
-		~DataItem(void)
-			{
-			glDeleteTextures(1,&textureObjectId);
-			}
-		};
-	
 	/* Elements: */
 	protected:
 	GLfloat marginWidth; // Width of margin around label string
 	GLfloat leftInset,rightInset; // Additional inset spacing to the left and the right of the label
 	const GLFont* font; // Pointer to the font used to render labels
-	GLuint labelVersion; // Version of label string (to compare against texture object version)
 	char* label; // Label string
 	Box labelBox; // Position and natural size of label string
-	GLFont::TBox labelTexCoords; // Texture coordinates of label texture
 	GLFont::HAlignment hAlignment; // Horizontal alignment of label string in widget
 	GLFont::VAlignment vAlignment; // Vertical alignment of label string in widget
 	
 	/* Protected methods: */
 	void positionLabel(void); // Positions the label inside the widget
-	void drawLabel(GLContextData& contextData) const; // Draws the label texture
+	void drawLabel(GLContextData& contextData) const; // Draws the label string using the font's glyph atlas
 	void setInsets(GLfloat newLeftInset,GLfloat newRightInset); // Sets the inset values
 	
 	/* Constructors and destructors: */
@@ -78,13 +54,8 @@ class Label:public Widget,public GLObject
 	/* Methods inherited from Widget: */
 	virtual Vector calcNaturalSize(void) const;
 	virtual void resize(const Box& newExterior);
-	virtual void setBackgroundColor(const Color& newBackgroundColor);
-	virtual void setForegroundColor(const Color& newForegroundColor);
 	virtual void draw(GLContextData& contextData) const;
 	
-	/* Methods inherited from GLObject: */
-	virtual void initContext(GLContextData& contextData) const;
-	
 	/* New methods: */
 	GLfloat getMarginWidth(void) const // Returns the label's margin width
 		{
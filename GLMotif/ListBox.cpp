@@ -23,10 +23,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <string.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
-#include <GL/GLTexCoordTemplates.h>
 #include <GL/GLVertexTemplates.h>
-#include <GL/GLTexEnvTemplates.h>
-#include <GL/GLContextData.h>
+#include <GL/GLFontAtlas.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/WidgetManager.h>
 #include <GLMotif/Event.h>
@@ -36,34 +34,37 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace GLMotif {
 
-/**********************************
-Methods of class ListBox::DataItem:
-**********************************/
-
-ListBox::DataItem::DataItem(void)
-	:version(0),pageSize(0),itemTextureIds(0)
-	{
-	}
+/************************
+Methods of class ListBox:
+************************/
 
-ListBox::DataItem::~DataItem(void)
+GLfloat ListBox::getItemWidth(int index)
 	{
-	if(itemTextureIds!=0)
+	Item& item=items[index];
+	if(item.width<0.0f)
 		{
-		glDeleteTextures(pageSize,itemTextureIds);
-		delete[] itemTextureIds;
+		/* Measure the item and add its glyphs to the font's atlas: */
+		item.width=font->calcStringBox(item.item).size[0];
+		font->getAtlas().addString(item.item);
 		}
+	
+	return item.width;
 	}
 
-/************************
-Methods of class ListBox:
-************************/
+void ListBox::calcMaxItemWidth(void)
+	{
+	maxItemWidth=0.0f;
+	for(int i=0;i<int(items.size());++i)
+		if(maxItemWidth<getItemWidth(i))
+			maxItemWidth=getItemWidth(i);
+	}
 
 void ListBox::calcMaxVisibleItemWidth(void)
 	{
 	maxVisibleItemWidth=0.0f;
 	for(int i=position;i<position+pageSize&&i<int(items.size());++i)
-		if(maxVisibleItemWidth<items[i].width)
-			maxVisibleItemWidth=items[i].width;
+		if(maxVisibleItemWidth<getItemWidth(i))
+			maxVisibleItemWidth=getItemWidth(i);
 	}
 
 void ListBox::updatePageSlots(void)
@@ -76,31 +77,23 @@ void ListBox::updatePageSlots(void)
 		pageSlots[i].slotBox.size[1]=font->getTextHeight();
 		if(position+i<int(items.size()))
 			{
+			/* Measure the item if it has not been displayed before: */
+			GLfloat itemWidth=getItemWidth(position+i);
 			const Item& item=items[position+i];
 			pageSlots[i].item=item.item;
-			pageSlots[i].textWidth=item.width;
 			pageSlots[i].selected=item.selected;
-			pageSlots[i].textTexCoords=font->calcStringTexCoords(pageSlots[i].item);
-			if(horizontalOffset>0.0f)
-				{
-				/* Take the horizontal offset into account: */
-				if(pageSlots[i].textWidth>horizontalOffset)
-					{
-					/* Adjust the text width and texture coordinates to clip strings on the left: */
-					GLfloat newTextureWidth=(pageSlots[i].textWidth-horizontalOffset)*pageSlots[i].textTexCoords.size[0]/pageSlots[i].textWidth;
-					pageSlots[i].textTexCoords.origin[0]+=pageSlots[i].textTexCoords.size[0]-newTextureWidth;
-					pageSlots[i].textTexCoords.size[0]=newTextureWidth;
-					pageSlots[i].textWidth-=horizontalOffset;
-					}
-				else
-					pageSlots[i].textWidth=0.0f;
-				}
+			
+			/* Shift the text box by the horizontal offset: */
+			pageSlots[i].textBox=pageSlots[i].slotBox;
+			pageSlots[i].textBox.origin[0]-=horizontalOffset;
+			pageSlots[i].textBox.size[0]=itemWidth;
+			
+			/* Clip the visible text width to the slot: */
+			pageSlots[i].textWidth=itemWidth-horizontalOffset;
+			if(pageSlots[i].textWidth<0.0f)
+				pageSlots[i].textWidth=0.0f;
 			if(pageSlots[i].textWidth>pageSlots[i].slotBox.size[0])
-				{
-				/* Adjust the text width and texture coordinates to clip strings on the right: */
-				pageSlots[i].textTexCoords.size[0]=pageSlots[i].slotBox.size[0]*pageSlots[i].textTexCoords.size[0]/pageSlots[i].textWidth;
 				pageSlots[i].textWidth=pageSlots[i].slotBox.size[0];
-				}
 			}
 		else
 			{
@@ -113,9 +106,6 @@ void ListBox::updatePageSlots(void)
 		pageSlots[i].textEnd[1]=pageSlots[i].slotBox.getCorner(2);
 		pageSlots[i].textEnd[1][0]+=pageSlots[i].textWidth;
 		}
-	
-	/* Update the page slots version number: */
-	++version;
 	}
 
 ListBox::ListBox(const char* sName,Container* sParent,ListBox::SelectionMode sSelectionMode,int sPreferredWidth,int sPreferredPageSize,bool sManageChild)
@@ -132,7 +122,6 @@ ListBox::ListBox(const char* sName,Container* sParent,ListBox::SelectionMode sSe
 	 maxVisibleItemWidth(0.0f),
 	 horizontalOffset(0.0f),
 	 lastSelectedItem(-1),
-	 version(0),
 	 lastClickedItem(-1),lastClickTime(0.0),numClicks(0)
 	{
 	/* Get the style sheet: */
@@ -238,7 +227,7 @@ void ListBox::resize(const Box& newExterior)
 	if(changeMask!=0x0)
 		{
 		/* Send a page change callback: */
-		PageChangedCallbackData cbData(this,changeMask,position,int(items.size()),pageSize,horizontalOffset,maxItemWidth,itemsBox.size[0]);
+		PageChangedCallbackData cbData(this,changeMask,position,int(items.size()),pageSize,horizontalOffset,maxVisibleItemWidth,itemsBox.size[0]);
 		pageChangedCallbacks.call(&cbData);
 		}
 	}
@@ -313,58 +302,34 @@ void ListBox::draw(GLContextData& contextData) const
 	glVertex(itemsBox.getCorner(0));
 	glEnd();
 	
-	/* Retrieve the data item: */
-	DataItem* dataItem=contextData.retrieveDataItem<DataItem>(this);
-	if(dataItem->version!=version)
-		{
-		/* Update the data item: */
-		if(dataItem->pageSize!=pageSize)
+	/* Draw the backgrounds of the list items' text strings: */
+	glBegin(GL_QUADS);
+	for(int i=0;i<pageSize;++i)
+		if(pageSlots[i].textWidth>0.0f)
 			{
-			if(dataItem->itemTextureIds!=0)
-				{
-				glDeleteTextures(dataItem->pageSize,dataItem->itemTextureIds);
-				delete[] dataItem->itemTextureIds;
-				}
-			dataItem->pageSize=pageSize;
-			dataItem->itemTextureIds=new GLuint[dataItem->pageSize];
-			glGenTextures(dataItem->pageSize,dataItem->itemTextureIds);
+			if(pageSlots[i].selected)
+				glColor3f(0.5f,0.5f,0.5f);
+			else
+				glColor(backgroundColor);
+			glVertex(pageSlots[i].slotBox.getCorner(0));
+			glVertex(pageSlots[i].textEnd[0]);
+			glVertex(pageSlots[i].textEnd[1]);
+			glVertex(pageSlots[i].slotBox.getCorner(2));
 			}
-		}
+	glEnd();
 	
-	/* Draw the list items: */
-	glPushAttrib(GL_TEXTURE_BIT);
-	GLint lightModelColorControl;
-	glGetIntegerv(GL_LIGHT_MODEL_COLOR_CONTROL,&lightModelColorControl);
-	glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
-	glEnable(GL_TEXTURE_2D);
-	glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::MODULATE);
-	glColor4f(1.0f,1.0f,1.0f,backgroundColor[3]);
-	for(int i=0;i<pageSize&&position+i<int(items.size());++i)
-		{
-		glBindTexture(GL_TEXTURE_2D,dataItem->itemTextureIds[i]);
-		if(dataItem->version!=version)
+	/* Draw the list items' text strings clipped to their slots, or add them to the current text batch: */
+	const GLFontAtlas& atlas=font->getAtlas();
+	for(int i=0;i<pageSize;++i)
+		if(pageSlots[i].textWidth>0.0f)
 			{
-			/* Upload the item string texture again: */
+			GLfloat clipMin=pageSlots[i].slotBox.origin[0];
+			GLfloat clipMax=pageSlots[i].textEnd[0][0];
 			if(pageSlots[i].selected)
-				font->uploadStringTexture(pageSlots[i].item,Color(0.5f,0.5f,0.5f),Color(1.0f,1.0f,1.0f));
+				atlas.drawString(pageSlots[i].item,pageSlots[i].textBox,clipMin,clipMax,Color(1.0f,1.0f,1.0f),contextData);
 			else
-				font->uploadStringTexture(pageSlots[i].item,backgroundColor,foregroundColor);
+				atlas.drawString(pageSlots[i].item,pageSlots[i].textBox,clipMin,clipMax,foregroundColor,contextData);
 			}
-		glBegin(GL_QUADS);
-		glTexCoord(pageSlots[i].textTexCoords.getCorner(0));
-		glVertex(pageSlots[i].slotBox.getCorner(0));
-		glTexCoord(pageSlots[i].textTexCoords.getCorner(1));
-		glVertex(pageSlots[i].textEnd[0]);
-		glTexCoord(pageSlots[i].textTexCoords.getCorner(3));
-		glVertex(pageSlots[i].textEnd[1]);
-		glTexCoord(pageSlots[i].textTexCoords.getCorner(2));
-		glVertex(pageSlots[i].slotBox.getCorner(2));
-		glEnd();
-		}
-	glBindTexture(GL_TEXTURE_2D,0);
-	glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,lightModelColorControl);
-	glPopAttrib();
-	dataItem->version=version;
 	}
 
 void ListBox::pointerButtonDown(Event& event)
@@ -421,13 +386,6 @@ void ListBox::pointerMotion(Event& event)
 	{
 	}
 
-void ListBox::initContext(GLContextData& contextData) const
-	{
-	/* Create a data item and store it with the OpenGL context: */
-	DataItem* dataItem=new DataItem;
-	contextData.addDataItem(this,dataItem);
-	}
-
 void ListBox::setMarginWidth(GLfloat newMarginWidth)
 	{
 	/* Set the margin width: */
@@ -438,6 +396,9 @@ void ListBox::setMarginWidth(GLfloat newMarginWidth)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::setItemSeparation(GLfloat newItemSep)
@@ -450,6 +411,9 @@ void ListBox::setItemSeparation(GLfloat newItemSep)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::setAutoResize(bool newAutoResize)
@@ -457,6 +421,10 @@ void ListBox::setAutoResize(bool newAutoResize)
 	/* Set the autoresize flag: */
 	autoResize=newAutoResize;
 	
+	/* Measure all items to find the longest one: */
+	if(autoResize)
+		calcMaxItemWidth();
+	
 	if(autoResize&&maxItemWidth>itemsBox.size[0])
 		{
 		/* Resize the list box to accomodate the largest item: */
@@ -465,21 +433,36 @@ void ListBox::setAutoResize(bool newAutoResize)
 		else
 			resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
-void ListBox::insertItem(int index,const char* newItem,bool moveToPage)
+void ListBox::insertItems(int index,int numNewItems,const char* const newItems[],bool moveToPage)
 	{
-	/* Add the new item to the list: */
-	Item it;
-	it.item=new char[strlen(newItem)+1];
-	strcpy(it.item,newItem);
-	it.width=font->calcStringBox(newItem).size[0];
-	it.selected=false;
-	items.insert(items.begin()+index,it);
+	/* Do nothing if there are no new items: */
+	if(numNewItems<=0)
+		return;
+	
+	/* Create the new items; they will be measured once they become visible: */
+	std::vector<Item> newItemList;
+	newItemList.reserve(numNewItems);
+	for(int i=0;i<numNewItems;++i)
+		{
+		Item it;
+		it.item=new char[strlen(newItems[i])+1];
+		strcpy(it.item,newItems[i]);
+		it.width=-1.0f;
+		it.selected=false;
+		newItemList.push_back(it);
+		}
+	
+	/* Add the new items to the list in one go: */
+	items.insert(items.begin()+index,newItemList.begin(),newItemList.end());
 	
 	{
 	/* Call the list changed callbacks: */
-	ListChangedCallbackData cbData(this,ListChangedCallbackData::ITEM_INSERTED,index);
+	ListChangedCallbackData cbData(this,numNewItems==1?ListChangedCallbackData::ITEM_INSERTED:ListChangedCallbackData::ITEMS_INSERTED,index,numNewItems);
 	listChangedCallbacks.call(&cbData);
 	}
 	
@@ -490,13 +473,13 @@ void ListBox::insertItem(int index,const char* newItem,bool moveToPage)
 		{
 		if(position>index)
 			{
-			/* Move the new item to the beginning of the page: */
+			/* Move the first new item to the beginning of the page: */
 			position=index;
 			reasonMask|=PageChangedCallbackData::POSITION_CHANGED;
 			}
 		else if(position<index-pageSize+1)
 			{
-			/* Move the new item to the end of the page: */
+			/* Move the first new item to the end of the page: */
 			position=index-pageSize+1;
 			reasonMask|=PageChangedCallbackData::POSITION_CHANGED;
 			}
@@ -504,8 +487,8 @@ void ListBox::insertItem(int index,const char* newItem,bool moveToPage)
 	
 	if(index<position)
 		{
-		/* Adjust the position by one so that the displayed items don't change: */
-		++position;
+		/* Adjust the position so that the displayed items don't change: */
+		position+=numNewItems;
 		reasonMask|=PageChangedCallbackData::POSITION_CHANGED;
 		}
 	else if(index<position+pageSize)
@@ -545,17 +528,22 @@ void ListBox::insertItem(int index,const char* newItem,bool moveToPage)
 	if(lastSelectedItem>=index)
 		{
 		/* Adjust the selected item's index: */
-		++lastSelectedItem;
+		lastSelectedItem+=numNewItems;
 		
 		/* Call the value changed callbacks: */
-		ValueChangedCallbackData cbData(this,lastSelectedItem-1,lastSelectedItem);
+		ValueChangedCallbackData cbData(this,lastSelectedItem-numNewItems,lastSelectedItem);
 		valueChangedCallbacks.call(&cbData);
 		}
 	
-	if(maxItemWidth<it.width)
+	if(autoResize)
 		{
-		maxItemWidth=it.width;
-		if(autoResize&&maxItemWidth>itemsBox.size[0])
+		/* Measure the new items: */
+		GLfloat oldMaxItemWidth=maxItemWidth;
+		for(int i=index;i<index+numNewItems;++i)
+			if(maxItemWidth<getItemWidth(i))
+				maxItemWidth=getItemWidth(i);
+		
+		if(maxItemWidth>oldMaxItemWidth&&maxItemWidth>itemsBox.size[0])
 			{
 			if(isManaged)
 				parent->requestResize(this,calcNaturalSize());
@@ -563,6 +551,94 @@ void ListBox::insertItem(int index,const char* newItem,bool moveToPage)
 				resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
 			}
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
+	}
+
+void ListBox::setItems(int numNewItems,const char* const newItems[])
+	{
+	/* Delete the old list items: */
+	for(std::vector<Item>::iterator iIt=items.begin();iIt!=items.end();++iIt)
+		delete[] iIt->item;
+	items.clear();
+	
+	/* Create the new items; they will be measured once they become visible: */
+	items.reserve(numNewItems);
+	for(int i=0;i<numNewItems;++i)
+		{
+		Item it;
+		it.item=new char[strlen(newItems[i])+1];
+		strcpy(it.item,newItems[i]);
+		it.width=-1.0f;
+		it.selected=false;
+		items.push_back(it);
+		}
+	
+	{
+	/* Call the list changed callbacks: */
+	ListChangedCallbackData cbData(this,ListChangedCallbackData::LIST_REPLACED,-1,numNewItems);
+	listChangedCallbacks.call(&cbData);
+	}
+	
+	/* Keep track of changes to the page state: */
+	int reasonMask=PageChangedCallbackData::NUMITEMS_CHANGED;
+	
+	/* Move to the beginning of the new list: */
+	if(position!=0)
+		reasonMask|=PageChangedCallbackData::POSITION_CHANGED;
+	position=0;
+	if(horizontalOffset!=0.0f)
+		reasonMask|=PageChangedCallbackData::HORIZONTALOFFSET_CHANGED;
+	horizontalOffset=0.0f;
+	
+	/* Update the visible list items: */
+	GLfloat oldMaxVisibleItemWidth=maxVisibleItemWidth;
+	calcMaxVisibleItemWidth();
+	if(oldMaxVisibleItemWidth!=maxVisibleItemWidth)
+		reasonMask|=PageChangedCallbackData::MAXITEMWIDTH_CHANGED;
+	updatePageSlots();
+	
+	{
+	/* Call the page change callbacks: */
+	PageChangedCallbackData cbData(this,reasonMask,position,int(items.size()),pageSize,horizontalOffset,maxVisibleItemWidth,itemsBox.size[0]);
+	pageChangedCallbacks.call(&cbData);
+	}
+	
+	{
+	/* Call the selection change callbacks: */
+	SelectionChangedCallbackData cbData(this,SelectionChangedCallbackData::NUMITEMS_CHANGED,-1);
+	selectionChangedCallbacks.call(&cbData);
+	}
+	
+	if(lastSelectedItem>=0)
+		{
+		/* Select the invalid item: */
+		int oldLastSelectedItem=lastSelectedItem;
+		lastSelectedItem=-1;
+		
+		/* Call the value changed callbacks: */
+		ValueChangedCallbackData cbData(this,oldLastSelectedItem,lastSelectedItem);
+		valueChangedCallbacks.call(&cbData);
+		}
+	
+	if(autoResize)
+		{
+		/* Measure all new items: */
+		GLfloat oldMaxItemWidth=maxItemWidth;
+		calcMaxItemWidth();
+		
+		if((maxItemWidth>oldMaxItemWidth&&maxItemWidth>itemsBox.size[0])||(maxItemWidth<oldMaxItemWidth&&itemsBox.size[0]==oldMaxItemWidth))
+			{
+			if(isManaged)
+				parent->requestResize(this,calcNaturalSize());
+			else
+				resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+			}
+		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::setItem(int index,const char* newItem)
@@ -572,7 +648,7 @@ void ListBox::setItem(int index,const char* newItem)
 	delete[] items[index].item;
 	items[index].item=new char[strlen(newItem)+1];
 	strcpy(items[index].item,newItem);
-	items[index].width=font->calcStringBox(newItem).size[0];
+	items[index].width=-1.0f;
 	
 	{
 	/* Call the list changed callbacks: */
@@ -612,10 +688,17 @@ void ListBox::setItem(int index,const char* newItem)
 		pageChangedCallbacks.call(&cbData);
 		}
 	
-	if(maxItemWidth<items[index].width)
+	if(!autoResize)
+		{
+		/* Invalidate the visual representation: */
+		update();
+		return;
+		}
+	
+	if(maxItemWidth<getItemWidth(index))
 		{
-		maxItemWidth=items[index].width;
-		if(autoResize&&maxItemWidth>itemsBox.size[0])
+		maxItemWidth=getItemWidth(index);
+		if(maxItemWidth>itemsBox.size[0])
 			{
 			if(isManaged)
 				parent->requestResize(this,calcNaturalSize());
@@ -626,12 +709,9 @@ void ListBox::setItem(int index,const char* newItem)
 	else if(maxItemWidth==oldItemWidth)
 		{
 		/* Find the new widest item:*/
-		maxItemWidth=0.0f;
-		for(std::vector<Item>::const_iterator iIt=items.begin();iIt!=items.end();++iIt)
-			if(maxItemWidth<iIt->width)
-				maxItemWidth=iIt->width;
+		calcMaxItemWidth();
 		
-		if(autoResize&&maxItemWidth<oldItemWidth&&itemsBox.size[0]==oldItemWidth)
+		if(maxItemWidth<oldItemWidth&&itemsBox.size[0]==oldItemWidth)
 			{
 			if(isManaged)
 				parent->requestResize(this,calcNaturalSize());
@@ -639,6 +719,9 @@ void ListBox::setItem(int index,const char* newItem)
 				resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
 			}
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::removeItem(int index)
@@ -716,12 +799,10 @@ void ListBox::removeItem(int index)
 			if(lastSelectedItem>int(items.size())-1)
 				lastSelectedItem=int(items.size())-1;
 			items[lastSelectedItem].selected=true;
+			
+			/* Update the item's page slot if it is visible: */
 			if(lastSelectedItem>=position&&lastSelectedItem<position+pageSize)
-				{
-				/* Update the item's page slot and invalidate the cache: */
 				pageSlots[lastSelectedItem-position].selected=true;
-				++version;
-				}
 			
 			/* Call the selection change callbacks: */
 			SelectionChangedCallbackData cbData(this,SelectionChangedCallbackData::ITEM_SELECTED,lastSelectedItem);
@@ -747,15 +828,12 @@ void ListBox::removeItem(int index)
 		valueChangedCallbacks.call(&cbData);
 		}
 	
-	if(maxItemWidth==oldItemWidth)
+	if(autoResize&&maxItemWidth==oldItemWidth)
 		{
 		/* Find the new widest item:*/
-		maxItemWidth=0.0f;
-		for(std::vector<Item>::const_iterator iIt=items.begin();iIt!=items.end();++iIt)
-			if(maxItemWidth<iIt->width)
-				maxItemWidth=iIt->width;
+		calcMaxItemWidth();
 		
-		if(autoResize&&maxItemWidth<oldItemWidth&&itemsBox.size[0]==oldItemWidth)
+		if(maxItemWidth<oldItemWidth&&itemsBox.size[0]==oldItemWidth)
 			{
 			if(isManaged)
 				parent->requestResize(this,calcNaturalSize());
@@ -763,6 +841,9 @@ void ListBox::removeItem(int index)
 				resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
 			}
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::clear(void)
@@ -831,6 +912,9 @@ void ListBox::clear(void)
 		else
 			resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::setPosition(int newPosition)
@@ -869,6 +953,9 @@ void ListBox::setPosition(int newPosition)
 		PageChangedCallbackData cbData(this,reasonMask,position,int(items.size()),pageSize,horizontalOffset,maxVisibleItemWidth,itemsBox.size[0]);
 		pageChangedCallbacks.call(&cbData);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::setHorizontalOffset(GLfloat newHorizontalOffset)
@@ -890,6 +977,9 @@ void ListBox::setHorizontalOffset(GLfloat newHorizontalOffset)
 		PageChangedCallbackData cbData(this,PageChangedCallbackData::HORIZONTALOFFSET_CHANGED,position,int(items.size()),pageSize,horizontalOffset,maxVisibleItemWidth,itemsBox.size[0]);
 		pageChangedCallbacks.call(&cbData);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 int ListBox::getNumSelectedItems(void) const
@@ -940,12 +1030,9 @@ void ListBox::selectItem(int index,bool moveToPage)
 		selectionChangedCallbacks.call(&cbData);
 		}
 		
-		/* Invalidate the page slot cache if the old selected item was visible: */
+		/* Update the page slot if the old selected item was visible: */
 		if(lastSelectedItem>=position&&lastSelectedItem<position+pageSize)
-			{
 			pageSlots[lastSelectedItem-position].selected=false;
-			++version;
-			}
 		}
 	
 	/* Check if the item is valid: */
@@ -968,20 +1055,13 @@ void ListBox::selectItem(int index,bool moveToPage)
 			else if(position<index-pageSize+1)
 				setPosition(index-pageSize+1);
 			else
-				{
-				/* Update the page slot and invalidate the cache: */
 				pageSlots[index-position].selected=true;
-				++version;
-				}
 			}
 		else
 			{
-			/* Invalidate the page slot cache if the selected item is visible: */
+			/* Update the page slot if the selected item is visible: */
 			if(index>=position&&index<position+pageSize)
-				{
 				pageSlots[index-position].selected=true;
-				++version;
-				}
 			}
 		}
 	
@@ -994,6 +1074,9 @@ void ListBox::selectItem(int index,bool moveToPage)
 	ValueChangedCallbackData cbData(this,oldLastSelectedItem,lastSelectedItem);
 	valueChangedCallbacks.call(&cbData);
 	}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::deselectItem(int index,bool moveToPage)
@@ -1025,12 +1108,9 @@ void ListBox::deselectItem(int index,bool moveToPage)
 		}
 	else
 		{
-		/* Invalidate the page slot cache if the deselected item is visible: */
+		/* Update the page slot if the deselected item is visible: */
 		if(index>=position&&index<position+pageSize)
-			{
 			pageSlots[index-position].selected=false;
-			++version;
-			}
 		}
 	
 	/* Update the last selected item: */
@@ -1054,6 +1134,9 @@ void ListBox::deselectItem(int index,bool moveToPage)
 		ValueChangedCallbackData cbData(this,oldLastSelectedItem,lastSelectedItem);
 		valueChangedCallbacks.call(&cbData);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ListBox::clearSelection(void)
@@ -1086,12 +1169,9 @@ void ListBox::clearSelection(void)
 		SelectionChangedCallbackData cbData(this,SelectionChangedCallbackData::SELECTION_CLEARED,-1);
 		selectionChangedCallbacks.call(&cbData);
 		
-		/* Invalidate the page slot cache if the deselected item is visible: */
+		/* Update the page slot if the deselected item is visible: */
 		if(lastSelectedItem>=position&&lastSelectedItem<position+pageSize)
-			{
 			pageSlots[lastSelectedItem-position].selected=false;
-			++version;
-			}
 		}
 	
 	if(lastSelectedItem>=0)
@@ -1104,6 +1184,9 @@ void ListBox::clearSelection(void)
 		ValueChangedCallbackData cbData(this,oldLastSelectedItem,lastSelectedItem);
 		valueChangedCallbacks.call(&cbData);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -26,13 +26,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
 #include <GL/gl.h>
-#include <GL/GLObject.h>
 #include <GL/GLFont.h>
 #include <GLMotif/Widget.h>
 
 namespace GLMotif {
 
-class ListBox:public Widget,public GLObject
+class ListBox:public Widget
 	{
 	/* Embedded classes: */
 	public:
@@ -60,17 +59,23 @@ class ListBox:public Widget,public GLObject
 		public:
 		enum ChangeReason // Enumerated type for different change reasons
 			{
-			ITEM_INSERTED,ITEM_CHANGED,ITEM_REMOVED,LIST_CLEARED
+			ITEM_INSERTED,ITEM_CHANGED,ITEM_REMOVED,LIST_CLEARED,ITEMS_INSERTED,LIST_REPLACED
 			};
 		
 		/* Elements: */
 		ChangeReason reason; // Reason for the item list change
-		int item; // Index of inserted, changed, or removed item
+		int item; // Index of inserted, changed, or removed item, or of first of several inserted items
+		int numItems; // Number of inserted items for ITEMS_INSERTED, or new number of items for LIST_REPLACED
 		
 		/* Constructors and destructors: */
 		ListChangedCallbackData(ListBox* sListBox,ChangeReason sReason,int sItem)
 			:CallbackData(sListBox),
-			 reason(sReason),item(sItem)
+			 reason(sReason),item(sItem),numItems(1)
+			{
+			}
+		ListChangedCallbackData(ListBox* sListBox,ChangeReason sReason,int sItem,int sNumItems)
+			:CallbackData(sListBox),
+			 reason(sReason),item(sItem),numItems(sNumItems)
 			{
 			}
 		};
@@ -162,7 +167,7 @@ class ListBox:public Widget,public GLObject
 		/* Elements: */
 		public:
 		char* item; // Pointer to item's string
-		GLfloat width; // Item's width
+		GLfloat width; // Item's width, or negative if the item has not been measured yet
 		bool selected; // Flag whether item is currently selected
 		};
 	
@@ -174,22 +179,10 @@ class ListBox:public Widget,public GLObject
 		char* item; // Pointer to slot's current text string
 		GLfloat textWidth; // Visible width of current text string
 		bool selected; // Flag if the slot is currently selected
-		GLFont::TBox textTexCoords; // Texture coordinate box of current text string
+		Box textBox; // Box of the entire current text string, shifted by the list box's horizontal offset
 		Vector textEnd[2]; // Lower and upper point at the right end of the current text string
 		};
 	
-	struct DataItem:public GLObject::DataItem
-		{
-		/* Elements: */
-		public:
-		unsigned int version; // Version number of state in the data item
-		int pageSize; // Number of items visible in the list box
-		GLuint* itemTextureIds; // Array of texture objects holding the item strings
-		
-		DataItem(void);
-		virtual ~DataItem(void);
-		};
-	
 	/* Elements: */
 	SelectionMode selectionMode; // List box's selection mode
 	GLfloat marginWidth; // Width of margin around text strings
@@ -200,7 +193,7 @@ class ListBox:public Widget,public GLObject
 	bool autoResize; // Flag whether the list box shall attempt to resize its width to the visible items
 	Box itemsBox; // Box surrounding list items
 	std::vector<Item> items; // Vector of text strings
-	GLfloat maxItemWidth; // Width of longest item
+	GLfloat maxItemWidth; // Width of longest item; only maintained if the list box resizes automatically
 	int pageSize; // Number of items visible in the list box
 	ListBoxSlot* pageSlots; // Array of states of currently visible items
 	int position; // Index of the top item currently visible in the list box
@@ -212,12 +205,13 @@ class ListBox:public Widget,public GLObject
 	Misc::CallbackList valueChangedCallbacks; // List of callbacks to be called when a different list item is selected
 	Misc::CallbackList itemSelectedCallbacks; // List of callbacks to be called when a list item is double-clicked
 	Misc::CallbackList selectionChangedCallbacks; // List of callbacks to be called when the selection state of a list item changes
-	unsigned int version; // Version number of state in the list box
 	int lastClickedItem; // Index of item which received last button down event
 	double lastClickTime; // Time of last pointer button down event, to detect double clicks
 	int numClicks; // Number of clicks on the current selected item
 	
 	/* Private methods: */
+	GLfloat getItemWidth(int index); // Returns the width of the given item; measures the item on first call
+	void calcMaxItemWidth(void); // Measures all items and updates the width of the longest item
 	void calcMaxVisibleItemWidth(void); // Updates the maximum width of any visible items
 	void updatePageSlots(void); // Update the currently visible list items
 	
@@ -234,9 +228,6 @@ class ListBox:public Widget,public GLObject
 	virtual void pointerButtonUp(Event& event);
 	virtual void pointerMotion(Event& event);
 	
-	/* Methods inherited from GLObject: */
-	virtual void initContext(GLContextData& contextData) const;
-	
 	/* New methods: */
 	
 	/* Methods to query or change the list box's appearance and behavior: */
@@ -265,7 +256,21 @@ class ListBox:public Widget,public GLObject
 		/* Return the new item's index: */
 		return int(items.size())-1;
 		}
-	void insertItem(int index,const char* newItem,bool moveToPage =false); // Inserts a new item before the current item of the given index and moves it to the page if it is not visible and moveToPage is true
+	void insertItem(int index,const char* newItem,bool moveToPage =false) // Inserts a new item before the current item of the given index and moves it to the page if it is not visible and moveToPage is true
+		{
+		insertItems(index,1,&newItem,moveToPage);
+		}
+	int addItems(int numNewItems,const char* const newItems[],bool moveToPage =false) // Adds a list of new items to the end of the list; returns index of first new item
+		{
+		/* Insert the items at the end of the list: */
+		int result=int(items.size());
+		insertItems(result,numNewItems,newItems,moveToPage);
+		
+		/* Return the first new item's index: */
+		return result;
+		}
+	void insertItems(int index,int numNewItems,const char* const newItems[],bool moveToPage =false); // Inserts a list of new items before the current item of the given index and moves the first new item to the page if it is not visible and moveToPage is true
+	void setItems(int numNewItems,const char* const newItems[]); // Replaces the entire list with the given list of items, and clears the selection
 	void setItem(int index,const char* newItem); // Sets the text of the given item
 	void removeItem(int index); // Removes the item at the given index
 	void clear(void); // Clears the list
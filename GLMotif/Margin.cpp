@@ -146,6 +146,9 @@ void Margin::setMarginWidth(GLfloat newMarginWidth)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Margin::setAlignment(const Alignment& newAlignment)
@@ -156,6 +159,9 @@ void Margin::setAlignment(const Alignment& newAlignment)
 	/* Resize the widget to the same size to update the child's padding: */
 	if(child!=0)
 		resize(getExterior());
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
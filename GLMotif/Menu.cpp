@@ -77,6 +77,9 @@ void Menu::addChild(Widget* newChild)
 	Button* newButton=dynamic_cast<Button*>(newChild);
 	if(newButton!=0)
 		newButton->getSelectCallbacks().add(childrenSelectCallbackWrapper,this);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Menu::addEntry(const char* newEntryLabel)
@@ -85,6 +88,9 @@ void Menu::addEntry(const char* newEntryLabel)
 	char newButtonName[40];
 	snprintf(newButtonName,sizeof(newButtonName),"_MenuButton%d",int(children.size()));
 	new Button(newButtonName,this,newEntryLabel);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 int Menu::getEntryIndex(const Button* entry) const
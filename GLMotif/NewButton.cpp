@@ -62,6 +62,9 @@ void NewButton::setArmed(bool newArmed)
 	/* Call the arm callbacks: */
 	ArmCallbackData cbData(this,isArmed);
 	armCallbacks.call(&cbData);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void NewButton::select(void)
@@ -209,6 +212,9 @@ void NewButton::setBorderType(Widget::BorderType newBorderType)
 		/* Set the new border type using the base class method: */
 		SingleChildContainer::setBorderType(newBorderType);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void NewButton::setForegroundColor(const Color& newForegroundColor)
@@ -219,6 +225,9 @@ void NewButton::setForegroundColor(const Color& newForegroundColor)
 	/* Set the child's foreground color: */
 	if(child!=0)
 		child->setForegroundColor(newForegroundColor);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void NewButton::setBackgroundColor(const Color& newBackgroundColor)
@@ -235,6 +244,9 @@ void NewButton::setBackgroundColor(const Color& newBackgroundColor)
 		if(child!=0)
 			child->setBackgroundColor(newBackgroundColor);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void NewButton::setArmedBackgroundColor(const Color& newArmedBackgroundColor)
@@ -249,6 +261,9 @@ void NewButton::setArmedBackgroundColor(const Color& newArmedBackgroundColor)
 		if(child!=0)
 			child->setBackgroundColor(armedBackgroundColor);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -22,6 +22,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
 #include <GL/GLVertexTemplates.h>
+#include <GL/GLFontAtlas.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/Event.h>
 #include <GLMotif/WidgetManager.h>
@@ -150,6 +151,10 @@ void Popup::resize(const Box& newExterior)
 	
 	/* Resize the parent class widget again to calculate the correct z range: */
 	Container::resize(newExterior);
+	
+	/* Notify the widget manager of the popup's new size: */
+	if(manager!=0)
+		manager->updateWidgetBounds(this);
 	}
 
 Vector Popup::calcHotSpot(void) const
@@ -253,7 +258,12 @@ void Popup::draw(GLContextData& contextData) const
 	
 	/* Draw the title and child: */
 	if(title!=0)
+		{
 		title->draw(contextData);
+		
+		/* Draw the title's batched text before the child layer: */
+		getStyleSheet()->font->getAtlas().flushBatch(contextData);
+		}
 	if(child!=0)
 		child->draw(contextData);
 	}
@@ -285,6 +295,9 @@ void Popup::addChild(Widget* newChild)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Popup::requestResize(Widget* child,const Vector&)
@@ -336,6 +349,9 @@ void Popup::setMarginWidth(GLfloat newMarginWidth)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Popup::setTitleSpacing(GLfloat newTitleSpacing)
@@ -345,6 +361,9 @@ void Popup::setTitleSpacing(GLfloat newTitleSpacing)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Popup::setTitle(const char* titleString,const GLFont* font)
@@ -362,6 +381,9 @@ void Popup::setTitle(const char* titleString,const GLFont* font)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Popup::setTitle(const char* titleString)
@@ -379,6 +401,9 @@ void Popup::setTitle(const char* titleString)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
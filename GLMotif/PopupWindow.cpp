@@ -24,6 +24,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLColorTemplates.h>
 #include <GL/GLVertexTemplates.h>
 #include <GL/GLFont.h>
+#include <GL/GLFontAtlas.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/Event.h>
 #include <GLMotif/WidgetManager.h>
@@ -159,6 +160,10 @@ void PopupWindow::resize(const Box& newExterior)
 	
 	/* Resize the parent class widget again to calculate the correct z range: */
 	Container::resize(newExterior);
+	
+	/* Notify the widget manager of the popup window's new size: */
+	if(manager!=0)
+		manager->updateWidgetBounds(this);
 	}
 
 Vector PopupWindow::calcHotSpot(void) const
@@ -205,8 +210,9 @@ void PopupWindow::draw(GLContextData& contextData) const
 	glVertex(getExterior().getCorner(3));
 	glEnd();
 	
-	/* Draw the title bar: */
+	/* Draw the title bar and its batched text before the child layer: */
 	titleBar->draw(contextData);
+	getStyleSheet()->font->getAtlas().flushBatch(contextData);
 	
 	/* Draw the child border: */
 	Box childBox=getInterior();
@@ -377,6 +383,9 @@ void PopupWindow::addChild(Widget* newChild)
 		/* Resize the widget: */
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void PopupWindow::requestResize(Widget* requestChild,const Vector& newExteriorSize)
@@ -418,12 +427,18 @@ void PopupWindow::setTitleBarColor(const Color& newTitleBarColor)
 	/* Set title bar color: */
 	titleBar->setBorderColor(newTitleBarColor);
 	titleBar->setBackgroundColor(newTitleBarColor);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void PopupWindow::setTitleBarTextColor(const Color& newTitleBarTextColor)
 	{
 	/* Set title bar text color: */
 	titleBar->setForegroundColor(newTitleBarTextColor);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void PopupWindow::setTitleBorderWidth(GLfloat newTitleBorderWidth)
@@ -433,6 +448,9 @@ void PopupWindow::setTitleBorderWidth(GLfloat newTitleBorderWidth)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void PopupWindow::setTitleString(const char* newTitleString)
@@ -442,6 +460,9 @@ void PopupWindow::setTitleString(const char* newTitleString)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void PopupWindow::setResizableFlags(bool horizontal,bool vertical)
@@ -452,6 +473,9 @@ void PopupWindow::setResizableFlags(bool horizontal,bool vertical)
 		resizableMask|=0x1;
 	if(vertical)
 		resizableMask|=0x2;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void PopupWindow::setChildBorderWidth(GLfloat newChildBorderWidth)
@@ -461,6 +485,9 @@ void PopupWindow::setChildBorderWidth(GLfloat newChildBorderWidth)
 	
 	/* Resize the widget: */
 	resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 const char* PopupWindow::getTitleString(void) const
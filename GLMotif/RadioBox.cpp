@@ -94,6 +94,9 @@ void RadioBox::addChild(Widget* newChild)
 		selectedToggle=newToggle;
 		newToggle->setToggle(true);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RadioBox::addToggle(const char* newToggleLabel)
@@ -102,6 +105,9 @@ void RadioBox::addToggle(const char* newToggleLabel)
 	char newToggleName[40];
 	snprintf(newToggleName,sizeof(newToggleName),"_RadioBoxToggle%d",int(children.size()));
 	new ToggleButton(newToggleName,this,newToggleLabel);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 int RadioBox::getToggleIndex(const ToggleButton* toggle) const
@@ -130,6 +136,9 @@ void RadioBox::setSelectionMode(RadioBox::SelectionMode newSelectionMode)
 		selectedToggle=static_cast<ToggleButton*>(children.front());
 		selectedToggle->setToggle(true);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RadioBox::setSelectedToggle(ToggleButton* newSelectedToggle)
@@ -142,6 +151,9 @@ void RadioBox::setSelectedToggle(ToggleButton* newSelectedToggle)
 		if(selectedToggle!=0)
 			selectedToggle->setToggle(true);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RadioBox::setSelectedToggle(int newSelectedToggleIndex)
@@ -160,6 +172,9 @@ void RadioBox::setSelectedToggle(int newSelectedToggleIndex)
 		if(selectedToggle!=0)
 			selectedToggle->setToggle(true);
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
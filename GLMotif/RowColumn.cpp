@@ -494,6 +494,9 @@ void RowColumn::addChild(Widget* newChild)
 		/* Try to resize the widget to accomodate the new child: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::requestResize(Widget* child,const Vector& newExteriorSize)
@@ -626,6 +629,9 @@ void RowColumn::setOrientation(RowColumn::Orientation newOrientation)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setPacking(RowColumn::Packing newPacking)
@@ -638,6 +644,9 @@ void RowColumn::setPacking(RowColumn::Packing newPacking)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setAlignment(const Alignment& newAlignment)
@@ -650,6 +659,9 @@ void RowColumn::setAlignment(const Alignment& newAlignment)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setNumMinorWidgets(GLsizei newNumMinorWidgets)
@@ -690,6 +702,9 @@ void RowColumn::setNumMinorWidgets(GLsizei newNumMinorWidgets)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setNextChildIndex(GLint newNextChildIndex)
@@ -710,6 +725,9 @@ void RowColumn::setMarginWidth(GLfloat newMarginWidth)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setSpacing(GLfloat newSpacing)
@@ -722,18 +740,27 @@ void RowColumn::setSpacing(GLfloat newSpacing)
 		/* Try to resize the widget to accomodate the new setting: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setColumnWeight(int columnIndex,GLfloat weight)
 	{
 	if(columnIndex>=0&&columnIndex<int(columnWeights.size()))
 		columnWeights[columnIndex]=weight;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void RowColumn::setRowWeight(int rowIndex,GLfloat weight)
 	{
 	if(rowIndex>=0&&rowIndex<int(rowWeights.size()))
 		rowWeights[rowIndex]=weight;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 GLint RowColumn::getChildIndex(const Widget* child) const
@@ -858,6 +885,9 @@ void RowColumn::removeWidgets(GLint majorDirectionIndex)
 			oldSize[dimension]-=spacing;
 		parent->requestResize(this,calcExteriorSize(oldSize));
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -129,6 +129,9 @@ void ScrollBar::clickRepeatTimerEventCallback(Misc::TimerEventScheduler::Callbac
 		positionHandle();
 		if(changed)
 			{
+			/* Invalidate the visual representation: */
+			update();
+			
 			ValueChangedCallbackData cbData(this,clickChangeReason,position);
 			valueChangedCallbacks.call(&cbData);
 			
@@ -242,6 +245,9 @@ void ScrollBar::setBackgroundColor(const Color& newBackgroundColor)
 	/* Let the arrow glyphs track the background color: */
 	for(int i=0;i<2;++i)
 		arrows[i].setArrowColor(newBackgroundColor);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ScrollBar::draw(GLContextData& contextData) const
@@ -394,6 +400,7 @@ void ScrollBar::pointerButtonDown(Event& event)
 		arrowBevelBox[0]=arrowBox[0].inset(Vector(bevelWidth,bevelWidth,0.0f));
 		arrowBevelBox[0].origin[2]-=bevelWidth;
 		arrows[0].setArrowBox(arrowBevelBox[0]);
+		update();
 		
 		/* Update the scroll bar position: */
 		int increment=reverse?1:-1;
@@ -466,6 +473,7 @@ void ScrollBar::pointerButtonDown(Event& event)
 		arrowBevelBox[1]=arrowBox[1].inset(Vector(bevelWidth,bevelWidth,0.0f));
 		arrowBevelBox[1].origin[2]-=bevelWidth;
 		arrows[1].setArrowBox(arrowBevelBox[1]);
+		update();
 		
 		/* Update the scroll bar position: */
 		int increment=reverse?-1:1;
@@ -503,6 +511,7 @@ void ScrollBar::pointerButtonUp(Event& event)
 		arrowBevelBox[armedArrowIndex].origin[2]+=bevelWidth;
 		arrows[armedArrowIndex].setArrowBox(arrowBevelBox[armedArrowIndex]);
 		armedArrowIndex=-1;
+		update();
 		}
 	}
 
@@ -543,6 +552,9 @@ void ScrollBar::setBevelWidth(GLfloat newBevelWidth)
 	/* Update the positions of the scroll bar components: */
 	positionButtonsAndShaft();
 	positionHandle();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ScrollBar::setPosition(int newPosition)
@@ -550,6 +562,9 @@ void ScrollBar::setPosition(int newPosition)
 	/* Update the position and reposition the scroll bar handle: */
 	position=newPosition;
 	positionHandle();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ScrollBar::setPositionRange(int newPositionMin,int newPositionMax,int newPageSize)
@@ -565,6 +580,9 @@ void ScrollBar::setPositionRange(int newPositionMin,int newPositionMax,int newPa
 	else if(position>positionMax-pageSize)
 		position=positionMax-pageSize;
 	positionHandle();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -116,10 +116,12 @@ class ScrollBar:public DragWidget
 	void setShaftColor(const Color& newShaftColor) // Changes color of shaft
 		{
 		shaftColor=newShaftColor;
+		update();
 		}
 	void setHandleColor(const Color& newHandleColor) // Changes color of scroll bar handle
 		{
 		handleColor=newHandleColor;
+		update();
 		}
 	int getPosition(void) const // Returns the current scroll bar position
 		{
@@ -212,6 +212,9 @@ void Separator::setPreferredHeight(GLfloat newPreferredHeight)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Separator::setMarginWidth(GLfloat newMarginWidth)
@@ -226,6 +229,9 @@ void Separator::setMarginWidth(GLfloat newMarginWidth)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Separator::setStyle(Separator::Style newStyle)
@@ -240,6 +246,9 @@ void Separator::setStyle(Separator::Style newStyle)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Separator::setSeparatorWidth(GLfloat newSeparatorWidth)
@@ -254,6 +263,9 @@ void Separator::setSeparatorWidth(GLfloat newSeparatorWidth)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
@@ -132,6 +132,9 @@ void SingleChildContainer::addChild(Widget* newChild)
 		/* Try to resize the widget to accomodate the new child: */
 		parent->requestResize(this,calcNaturalSize());
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void SingleChildContainer::requestResize(Widget* child,const Vector& newExteriorSize)
@@ -99,6 +99,9 @@ void Slider::clickRepeatTimerEventCallback(Misc::TimerEventScheduler::CallbackDa
 		positionSlider();
 		if(changed)
 			{
+			/* Invalidate the visual representation: */
+			update();
+			
 			ValueChangedCallbackData cbData(this,ValueChangedCallbackData::CLICKED,value);
 			valueChangedCallbacks.call(&cbData);
 			
@@ -522,6 +525,9 @@ void Slider::setMarginWidth(GLfloat newMarginWidth)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Slider::setValue(GLfloat newValue)
@@ -529,6 +535,9 @@ void Slider::setValue(GLfloat newValue)
 	/* Update the value and reposition the slider: */
 	value=newValue;
 	positionSlider();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Slider::setValueRange(GLfloat newValueMin,GLfloat newValueMax,GLfloat newValueIncrement)
@@ -546,6 +555,9 @@ void Slider::setValueRange(GLfloat newValueMin,GLfloat newValueMax,GLfloat newVa
 	if(valueIncrement>0.0f)
 		value=GLfloat(floor(double(value)/double(valueIncrement)+0.5)*double(valueIncrement));
 	positionSlider();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
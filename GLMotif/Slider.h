@@ -107,10 +107,12 @@ class Slider:public DragWidget
 	void setSliderColor(const Color& newSliderColor) // Changes color of slider handle
 		{
 		sliderColor=newSliderColor;
+		update();
 		}
 	void setShaftColor(const Color& newShaftColor) // Changes color of shaft
 		{
 		shaftColor=newShaftColor;
+		update();
 		}
 	GLfloat getValue(void) const // Returns the current slider value
 		{
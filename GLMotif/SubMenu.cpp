@@ -79,6 +79,9 @@ void SubMenu::addChild(Widget* newChild)
 	Button* newButton=dynamic_cast<Button*>(newChild);
 	if(newButton!=0)
 		newButton->getSelectCallbacks().add(childrenSelectCallbackWrapper,this);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void SubMenu::addEntry(const char* newEntryLabel)
@@ -87,6 +90,9 @@ void SubMenu::addEntry(const char* newEntryLabel)
 	char newButtonName[40];
 	snprintf(newButtonName,sizeof(newButtonName),"_SubMenuButton%d",int(children.size()));
 	new Button(newButtonName,this,newEntryLabel);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 int SubMenu::getEntryIndex(const Button* entry) const
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 #include <string.h>
 #include <stdio.h>
+#include <GL/GLFontAtlas.h>
 #include <GLMotif/StyleSheet.h>
 #include <GLMotif/Container.h>
 #include <GLMotif/WidgetManager.h>
@@ -118,14 +119,16 @@ void TextField::setLabel(const char* newLabel)
 	delete[] label;
 	label=new char[strlen(newLabel)+1];
 	strcpy(label,newLabel);
-	++labelVersion;
 	
-	/* Calculate the label's bounding box size and texture coordinates: */
+	/* Add the label's glyphs to the font's atlas and calculate the label's bounding box size: */
+	font->getAtlas().addString(label);
 	labelBox=font->calcStringBox(label);
-	labelTexCoords=font->calcStringTexCoords(label);
 	
 	/* Adjust the label position: */
 	positionLabel();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void TextField::setCharWidth(GLint newCharWidth)
@@ -140,24 +143,36 @@ void TextField::setCharWidth(GLint newCharWidth)
 		}
 	else
 		resize(Box(Vector(0.0f,0.0f,0.0f),calcNaturalSize()));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void TextField::setFieldWidth(GLint newFieldWidth)
 	{
 	/* Set the field width: */
 	fieldWidth=newFieldWidth;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void TextField::setPrecision(GLint newPrecision)
 	{
 	/* Set the precision: */
 	precision=newPrecision;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void TextField::setFloatFormat(TextField::FloatFormat newFloatFormat)
 	{
 	/* Set the floating-point formatting mode: */
 	floatFormat=newFloatFormat;
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 template <class ValueParam>
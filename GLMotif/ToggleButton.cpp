@@ -40,6 +40,9 @@ void ToggleButton::setArmed(bool newArmed)
 	
 	/* Update the toggle button display: */
 	setSet(set);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ToggleButton::select(void)
@@ -190,6 +193,9 @@ void ToggleButton::setSet(bool newSet)
 		for(int i=0;i<4;++i)
 			toggleInner[i][2]=decorationBox.origin[2]+toggleBorderWidth;
 		}
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 ToggleButton::ToggleButton(const char* sName,Container* sParent,const char* sLabel,const GLFont* sFont,bool sManageChild)
@@ -266,6 +272,9 @@ void ToggleButton::setToggleType(ToggleButton::ToggleType newToggleType)
 	
 	/* Position the toggle button: */
 	positionToggle();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ToggleButton::setToggleBorderWidth(GLfloat newToggleBorderWidth)
@@ -275,6 +284,9 @@ void ToggleButton::setToggleBorderWidth(GLfloat newToggleBorderWidth)
 	/* Set the decoration width: */
 	GLfloat width=2.0f*toggleBorderWidth+toggleWidth;
 	setDecorationSize(Vector(width,width,0.0f));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void ToggleButton::setToggleWidth(GLfloat newToggleWidth)
@@ -284,6 +296,9 @@ void ToggleButton::setToggleWidth(GLfloat newToggleWidth)
 	/* Set the decoration width: */
 	GLfloat width=2.0f*toggleBorderWidth+toggleWidth;
 	setDecorationSize(Vector(width,width,0.0f));
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 }
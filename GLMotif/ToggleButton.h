@@ -97,6 +97,7 @@ class ToggleButton:public DecoratedButton
 	void setToggleColor(const Color& newToggleColor)
 		{
 		toggleColor=newToggleColor;
+		update();
 		}
 	void setToggle(bool newSet)
 		{
@@ -33,12 +33,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace GLMotif {
 
+/*******************************
+Static elements of class Widget:
+*******************************/
+
+unsigned int Widget::lastVisualVersion=0;
+
 /***********************
 Methods of class Widget:
 ***********************/
 
 Widget::Widget(const char* sName,Container* sParent,bool sManageChild)
-	:parent(sParent),isManaged(false),name(new char[strlen(sName)+1]),
+	:parent(sParent),isManaged(false),
+	 visualVersion(++lastVisualVersion),
+	 name(new char[strlen(sName)+1]),
 	 exterior(Vector(0.0f,0.0f,0.0f),Vector(0.0f,0.0f,0.0f)),
 	 borderWidth(0.0f),borderType(PLAIN),
 	 interior(Vector(0.0f,0.0f,0.0f),Vector(0.0f,0.0f,0.0f)),
@@ -114,6 +122,12 @@ WidgetManager* Widget::getManager(void)
 	return parent->getManager();
 	}
 
+void Widget::update(void)
+	{
+	/* Assign a new version number to the widget tree; the number is unique so that a new widget tree never matches a stale cached representation: */
+	getRoot()->visualVersion=++lastVisualVersion;
+	}
+
 Vector Widget::calcExteriorSize(const Vector& interiorSize) const
 	{
 	Vector result=interiorSize;
@@ -149,6 +163,9 @@ void Widget::resize(const Box& newExterior)
 	
 	/* Calculate the z range: */
 	zRange=calcZRange();
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 Vector Widget::calcHotSpot(void) const
@@ -169,6 +186,9 @@ void Widget::setBorderWidth(GLfloat newBorderWidth)
 		parent->requestResize(this,newExterior.size);
 	else
 		resize(newExterior);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Widget::setBorderType(Widget::BorderType newBorderType)
@@ -180,6 +200,9 @@ void Widget::setBorderType(Widget::BorderType newBorderType)
 		parent->requestResize(this,exterior.size);
 	else
 		resize(exterior);
+	
+	/* Invalidate the visual representation: */
+	update();
 	}
 
 void Widget::draw(GLContextData&) const
@@ -45,10 +45,13 @@ class Widget
 		};
 	
 	/* Elements: */
+	private:
+	static unsigned int lastVisualVersion; // Last version number assigned to a changed widget tree
 	protected:
 	Container* parent; // Pointer to widget's parent (must be a container)
 	bool isManaged; // Flag if the child is currently managed by its parent
 	private:
+	unsigned int visualVersion; // Version number of the visual representation of the widget tree rooted at this widget; only maintained for root widgets
 	char* name; // Widget's name (unique amongst siblings)
 	Box exterior; // Exterior rectangle of widget (including border)
 	GLfloat borderWidth; // Width of border around widget
@@ -84,6 +87,11 @@ class Widget
 	virtual const WidgetManager* getManager(void) const; // Returns a pointer to the widget manager
 	virtual WidgetManager* getManager(void); // Ditto
 	const StyleSheet* getStyleSheet(void) const; // Returns a pointer to the widget manager's style sheet
+	void update(void); // Notifies the widget tree containing the widget that the widget's visual representation changed
+	unsigned int getVisualVersion(void) const // Returns the version number of the visual representation of the widget tree rooted at this widget
+		{
+		return visualVersion;
+		}
 	const Box& getExterior(void) const
 		{
 		return exterior;
@@ -126,14 +134,17 @@ class Widget
 	virtual void setBorderColor(const Color& newBorderColor)
 		{
 		borderColor=newBorderColor;
+		update();
 		}
 	virtual void setBackgroundColor(const Color& newBackgroundColor)
 		{
 		backgroundColor=newBackgroundColor;
+		update();
 		}
 	virtual void setForegroundColor(const Color& newForegroundColor)
 		{
 		foregroundColor=newForegroundColor;
+		update();
 		}
 	virtual void draw(GLContextData& contextData) const; // Draws the widget
 	
@@ -20,9 +20,14 @@ with the GLMotif Widget Library; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 ***********************************************************************/
 
+#include <algorithm>
+#include <Math/Constants.h>
 #include <GL/gl.h>
+#include <GL/GLContextData.h>
 #include <GL/GLTransformationWrappers.h>
+#include <GL/GLFontAtlas.h>
 #include <GLMotif/Event.h>
+#include <GLMotif/StyleSheet.h>
 #include <GLMotif/Widget.h>
 
 #include <GLMotif/WidgetManager.h>
@@ -31,13 +36,72 @@ using GLTransformationWrappers::glMultMatrix;  // PO'Leary
 
 namespace GLMotif {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline Scalar calcHalfArea(const WidgetManager::WorldBox& box) // Returns half the surface area of a non-empty box; does not vanish for flat boxes
+	{
+	Scalar sx=box.max[0]-box.min[0];
+	Scalar sy=box.max[1]-box.min[1];
+	Scalar sz=box.max[2]-box.min[2];
+	return sx*sy+sy*sz+sz*sx;
+	}
+
+bool intersectsRay(const WidgetManager::WorldBox& box,const Ray& ray) // Returns true if the forward part of the ray intersects the box
+	{
+	Scalar lMin=Scalar(0);
+	Scalar lMax=Math::Constants<Scalar>::max;
+	for(int i=0;i<3;++i)
+		{
+		if(ray.getDirection()[i]!=Scalar(0))
+			{
+			Scalar l1=(box.min[i]-ray.getOrigin()[i])/ray.getDirection()[i];
+			Scalar l2=(box.max[i]-ray.getOrigin()[i])/ray.getDirection()[i];
+			if(l1>l2)
+				std::swap(l1,l2);
+			if(lMin<l1)
+				lMin=l1;
+			if(lMax>l2)
+				lMax=l2;
+			if(lMin>lMax)
+				return false;
+			}
+		else if(ray.getOrigin()[i]<box.min[i]||ray.getOrigin()[i]>box.max[i])
+			return false;
+		}
+	return true;
+	}
+
+}
+
+/****************************************
+Methods of class WidgetManager::DataItem:
+****************************************/
+
+WidgetManager::DataItem::DataItem(void)
+	:retainedWidgets(17),
+	 frame(0)
+	{
+	}
+
+WidgetManager::DataItem::~DataItem(void)
+	{
+	/* Delete all retained display lists: */
+	for(RetainedWidgetHash::Iterator rwIt=retainedWidgets.begin();!rwIt.isFinished();++rwIt)
+		glDeleteLists(rwIt->getDest().displayListId,1);
+	}
+
 /********************************************
 Methods of class WidgetManager::PopupBinding:
 ********************************************/
 
 WidgetManager::PopupBinding::PopupBinding(Widget* sTopLevelWidget,const WidgetManager::Transformation& sWidgetToWorld,WidgetManager::PopupBinding* sParent,WidgetManager::PopupBinding* sSucc)
 	:topLevelWidget(sTopLevelWidget),widgetToWorld(sWidgetToWorld),visible(true),
-	 parent(sParent),pred(0),succ(sSucc),firstSecondary(0)
+	 parent(sParent),pred(0),succ(sSucc),firstSecondary(0),
+	 popupSerial(0),boundsLeaf(0)
 	{
 	}
 
@@ -87,7 +151,28 @@ WidgetManager::PopupBinding* WidgetManager::PopupBinding::findTopLevelWidget(con
 	return foundBinding;
 	}
 
-void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contextData) const
+void WidgetManager::PopupBinding::calcBounds(const WidgetManager::Transformation& ownerToWorld,WidgetManager::WorldBox& bounds) const
+	{
+	Transformation toWorld=ownerToWorld*widgetToWorld;
+	
+	/* Add the corners of our widget's exterior box, extended by its z range: */
+	const Box& exterior=topLevelWidget->getExterior();
+	const ZRange& zRange=topLevelWidget->getZRange();
+	for(int i=0;i<8;++i)
+		{
+		Point corner;
+		for(int j=0;j<2;++j)
+			corner[j]=(i&(1<<j))?exterior.origin[j]+exterior.size[j]:exterior.origin[j];
+		corner[2]=(i&0x4)?zRange.second:zRange.first;
+		bounds.addPoint(toWorld.transform(corner));
+		}
+	
+	/* Add the bounds of all secondary bindings: */
+	for(const PopupBinding* bPtr=firstSecondary;bPtr!=0;bPtr=bPtr->succ)
+		bPtr->calcBounds(toWorld,bounds);
+	}
+
+void WidgetManager::PopupBinding::draw(bool overlayWidgets,WidgetManager::DataItem* dataItem,GLContextData& contextData) const
 	{
 	if(visible)
 		{
@@ -98,10 +183,52 @@ void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contex
 		
 		/* Draw all its secondary top level widgets: */
 		for(PopupBinding* bPtr=firstSecondary;bPtr!=0;bPtr=bPtr->succ)
-			bPtr->draw(overlayWidgets,contextData);
+			bPtr->draw(overlayWidgets,dataItem,contextData);
 		
-		/* Draw the top level widget: */
-		topLevelWidget->draw(contextData);
+		const GLFontAtlas& atlas=topLevelWidget->getStyleSheet()->font->getAtlas();
+		GLuint displayListId=0;
+		if(dataItem!=0)
+			{
+			/* Find the top level widget's display list, or create a new one: */
+			RetainedWidgetHash::Iterator rwIt=dataItem->retainedWidgets.findEntry(topLevelWidget);
+			if(rwIt.isFinished())
+				{
+				RetainedWidget newRw;
+				newRw.displayListId=glGenLists(1);
+				newRw.version=0;
+				newRw.lastUsedFrame=dataItem->frame;
+				dataItem->retainedWidgets.setEntry(RetainedWidgetHash::Entry(topLevelWidget,newRw));
+				rwIt=dataItem->retainedWidgets.findEntry(topLevelWidget);
+				}
+			RetainedWidget& rw=rwIt->getDest();
+			rw.lastUsedFrame=dataItem->frame;
+			displayListId=rw.displayListId;
+			
+			/* Re-record the display list if the widget tree changed since it was last recorded: */
+			if(rw.version!=topLevelWidget->getVisualVersion())
+				{
+				/* Upload new glyphs before recording so that the display list does not contain texture uploads: */
+				atlas.updateTexture(contextData);
+				
+				/* Record the top level widget, collecting all text using the style sheet's font into a single batch: */
+				glNewList(displayListId,GL_COMPILE);
+				atlas.beginBatch(contextData);
+				topLevelWidget->draw(contextData);
+				atlas.endBatch(contextData);
+				glEndList();
+				rw.version=topLevelWidget->getVisualVersion();
+				}
+			
+			/* Draw the top level widget: */
+			glCallList(displayListId);
+			}
+		else
+			{
+			/* Draw the top level widget, collecting all text using the style sheet's font into a single batch: */
+			atlas.beginBatch(contextData);
+			topLevelWidget->draw(contextData);
+			atlas.endBatch(contextData);
+			}
 		
 		if(overlayWidgets)
 			{
@@ -112,7 +239,10 @@ void WidgetManager::PopupBinding::draw(bool overlayWidgets,GLContextData& contex
 			GLboolean colorMask[4];
 			glGetBooleanv(GL_COLOR_WRITEMASK,colorMask);
 			glColorMask(GL_FALSE,GL_FALSE,GL_FALSE,GL_FALSE);
-			topLevelWidget->draw(contextData);
+			if(displayListId!=0)
+				glCallList(displayListId);
+			else
+				topLevelWidget->draw(contextData);
 			glColorMask(colorMask[0],colorMask[1],colorMask[2],colorMask[3]);
 			glDepthRange(depthRange[0],depthRange[1]);
 			}
@@ -140,24 +270,10 @@ void WidgetManager::deleteQueuedWidgets(void)
 		/* Pop down the widget if it is a managed root widget: */
 		if((*dlIt)->getParent()==0)
 			{
-			/* Find the widget's binding: */
-			PopupBinding* bPtr;
-			for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=*dlIt;bPtr=bPtr->getSucc())
-				;
-			
+			/* Find the widget's binding and delete it: */
+			PopupBinding* bPtr=findBinding(*dlIt);
 			if(bPtr!=0)
-				{
-				/* Remove the binding from the list: */
-				if(bPtr->pred!=0)
-					bPtr->pred->succ=bPtr->succ;
-				else if(bPtr->parent!=0)
-					bPtr->parent->firstSecondary=bPtr->succ;
-				else
-					firstBinding=bPtr->succ;
-				if(bPtr->succ!=0)
-					bPtr->succ->pred=bPtr->pred;
-				delete bPtr;
-				}
+				deleteBinding(bPtr);
 			}
 		
 		delete *dlIt;
@@ -165,9 +281,192 @@ void WidgetManager::deleteQueuedWidgets(void)
 	deletionList.clear();
 	}
 
+WidgetManager::PopupBinding* WidgetManager::findBinding(const Widget* widget) const
+	{
+	BindingHash::ConstIterator bIt=bindingMap.findEntry(widget->getRoot());
+	return bIt.isFinished()?0:bIt->getDest();
+	}
+
+void WidgetManager::unmapBindings(WidgetManager::PopupBinding* binding)
+	{
+	bindingMap.removeEntry(binding->topLevelWidget);
+	for(PopupBinding* bPtr=binding->firstSecondary;bPtr!=0;bPtr=bPtr->succ)
+		unmapBindings(bPtr);
+	}
+
+void WidgetManager::deleteBinding(WidgetManager::PopupBinding* binding)
+	{
+	/* Remove the binding from the list: */
+	if(binding->pred!=0)
+		binding->pred->succ=binding->succ;
+	else if(binding->parent!=0)
+		binding->parent->firstSecondary=binding->succ;
+	else
+		firstBinding=binding->succ;
+	if(binding->succ!=0)
+		binding->succ->pred=binding->pred;
+	
+	/* Remove the binding and its secondaries from the binding map: */
+	unmapBindings(binding);
+	
+	if(binding->parent!=0)
+		{
+		/* Shrink the bounds of the binding's primary binding: */
+		updateBounds(binding->parent);
+		}
+	else
+		{
+		/* Remove the binding's leaf from the bounding volume hierarchy: */
+		removeBoundsLeaf(binding->boundsLeaf);
+		delete binding->boundsLeaf;
+		}
+	
+	delete binding;
+	}
+
+void WidgetManager::insertBoundsLeaf(WidgetManager::BoundsNode* leaf)
+	{
+	if(boundsRoot==0)
+		{
+		/* Make the leaf the root of the hierarchy: */
+		leaf->parent=0;
+		boundsRoot=leaf;
+		return;
+		}
+	
+	/* Descend to the sibling whose bounds grow least by adding the leaf's bounds: */
+	BoundsNode* sibling=boundsRoot;
+	while(sibling->children[0]!=0)
+		{
+		Scalar growth[2];
+		for(int i=0;i<2;++i)
+			{
+			WorldBox merged=sibling->children[i]->box;
+			merged.addBox(leaf->box);
+			growth[i]=calcHalfArea(merged)-calcHalfArea(sibling->children[i]->box);
+			}
+		sibling=sibling->children[growth[1]<growth[0]?1:0];
+		}
+	
+	/* Replace the sibling with a new interior node holding the sibling and the leaf: */
+	BoundsNode* node=new BoundsNode;
+	node->parent=sibling->parent;
+	node->children[0]=sibling;
+	node->children[1]=leaf;
+	node->binding=0;
+	if(node->parent!=0)
+		node->parent->children[node->parent->children[0]==sibling?0:1]=node;
+	else
+		boundsRoot=node;
+	sibling->parent=node;
+	leaf->parent=node;
+	
+	/* Refit the bounds of all ancestors of the leaf: */
+	for(;node!=0;node=node->parent)
+		{
+		node->box=node->children[0]->box;
+		node->box.addBox(node->children[1]->box);
+		}
+	}
+
+void WidgetManager::removeBoundsLeaf(WidgetManager::BoundsNode* leaf)
+	{
+	BoundsNode* parent=leaf->parent;
+	leaf->parent=0;
+	if(parent==0)
+		{
+		/* The leaf was the only node in the hierarchy: */
+		boundsRoot=0;
+		return;
+		}
+	
+	/* Replace the leaf's parent with the leaf's sibling: */
+	BoundsNode* sibling=parent->children[parent->children[0]==leaf?1:0];
+	BoundsNode* node=parent->parent;
+	sibling->parent=node;
+	if(node!=0)
+		node->children[node->children[0]==parent?0:1]=sibling;
+	else
+		boundsRoot=sibling;
+	delete parent;
+	
+	/* Refit the bounds of all former ancestors of the leaf: */
+	for(;node!=0;node=node->parent)
+		{
+		node->box=node->children[0]->box;
+		node->box.addBox(node->children[1]->box);
+		}
+	}
+
+void WidgetManager::updateBounds(WidgetManager::PopupBinding* binding)
+	{
+	/* Find the primary binding containing the given binding: */
+	while(binding->parent!=0)
+		binding=binding->parent;
+	
+	/* Calculate the primary binding's new bounds: */
+	WorldBox bounds=WorldBox::empty;
+	binding->calcBounds(Transformation::identity,bounds);
+	
+	/* Re-insert the binding's leaf into the bounding volume hierarchy: */
+	if(binding->boundsLeaf!=0)
+		removeBoundsLeaf(binding->boundsLeaf);
+	else
+		{
+		binding->boundsLeaf=new BoundsNode;
+		binding->boundsLeaf->children[0]=binding->boundsLeaf->children[1]=0;
+		binding->boundsLeaf->binding=binding;
+		}
+	binding->boundsLeaf->box=bounds;
+	insertBoundsLeaf(binding->boundsLeaf);
+	}
+
+bool WidgetManager::isEarlierPrimary(const WidgetManager::PopupBinding* binding1,const WidgetManager::PopupBinding* binding2)
+	{
+	return binding1->popupSerial>binding2->popupSerial;
+	}
+
+void WidgetManager::deleteBoundsNodes(WidgetManager::BoundsNode* node)
+	{
+	if(node!=0)
+		{
+		deleteBoundsNodes(node->children[0]);
+		deleteBoundsNodes(node->children[1]);
+		delete node;
+		}
+	}
+
+void WidgetManager::collectPickCandidates(const WidgetManager::BoundsNode* node,const Point& point)
+	{
+	if(node->box.contains(point))
+		{
+		if(node->binding!=0)
+			pickCandidates.push_back(node->binding);
+		else
+			{
+			collectPickCandidates(node->children[0],point);
+			collectPickCandidates(node->children[1],point);
+			}
+		}
+	}
+
+void WidgetManager::collectPickCandidates(const WidgetManager::BoundsNode* node,const Ray& ray)
+	{
+	if(intersectsRay(node->box,ray))
+		{
+		if(node->binding!=0)
+			pickCandidates.push_back(node->binding);
+		else
+			{
+			collectPickCandidates(node->children[0],ray);
+			collectPickCandidates(node->children[1],ray);
+			}
+		}
+	}
+
 WidgetManager::WidgetManager(void)
-	:styleSheet(0),timerEventScheduler(0),drawOverlayWidgets(false),
-	 firstBinding(0),
+	:styleSheet(0),timerEventScheduler(0),drawOverlayWidgets(false),retainedMode(false),
+	 firstBinding(0),bindingMap(17),lastPopupSerial(0),boundsRoot(0),
 	 time(0.0),
 	 hardGrab(false),pointerGrabWidget(0),
 	 inEventProcessing(false)
@@ -183,6 +482,16 @@ WidgetManager::~WidgetManager(void)
 		delete firstBinding;
 		firstBinding=next;
 		}
+	
+	/* Delete the bounding volume hierarchy: */
+	deleteBoundsNodes(boundsRoot);
+	}
+
+void WidgetManager::initContext(GLContextData& contextData) const
+	{
+	/* Create a new context data item: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
 	}
 
 void WidgetManager::setStyleSheet(const StyleSheet* newStyleSheet)
@@ -200,21 +509,28 @@ void WidgetManager::setDrawOverlayWidgets(bool newDrawOverlayWidgets)
 	drawOverlayWidgets=newDrawOverlayWidgets;
 	}
 
+void WidgetManager::setRetainedMode(bool newRetainedMode)
+	{
+	retainedMode=newRetainedMode;
+	}
+
 void WidgetManager::popupPrimaryWidget(Widget* topLevelWidget,const WidgetManager::Transformation& widgetToWorld)
 	{
 	PopupBinding* newBinding=new PopupBinding(topLevelWidget,widgetToWorld,0,firstBinding);
 	if(firstBinding!=0)
 		firstBinding->pred=newBinding;
 	firstBinding=newBinding;
+	newBinding->popupSerial=++lastPopupSerial;
+	bindingMap.setEntry(BindingHash::Entry(topLevelWidget,newBinding));
+	
+	/* Add the new binding's bounds to the bounding volume hierarchy: */
+	updateBounds(newBinding);
 	}
 
 void WidgetManager::popupSecondaryWidget(Widget* owner,Widget* topLevelWidget,const Vector& offset)
 	{
 	/* Find the owner's binding: */
-	Widget* root=owner->getRoot();
-	PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
+	PopupBinding* bPtr=findBinding(owner);
 	
 	if(bPtr!=0)
 		{
@@ -222,39 +538,25 @@ void WidgetManager::popupSecondaryWidget(Widget* owner,Widget* topLevelWidget,co
 		if(bPtr->firstSecondary!=0)
 			bPtr->firstSecondary->pred=newBinding;
 		bPtr->firstSecondary=newBinding;
+		bindingMap.setEntry(BindingHash::Entry(topLevelWidget,newBinding));
+		
+		/* Extend the bounds of the primary binding: */
+		updateBounds(newBinding);
 		}
 	}
 
 void WidgetManager::popdownWidget(Widget* widget)
 	{
-	/* Find the widget's binding: */
-	Widget* root=widget->getRoot();
-	PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
-	
+	/* Find the widget's binding and delete it: */
+	PopupBinding* bPtr=findBinding(widget);
 	if(bPtr!=0)
-		{
-		/* Remove the binding from the list: */
-		if(bPtr->pred!=0)
-			bPtr->pred->succ=bPtr->succ;
-		else if(bPtr->parent!=0)
-			bPtr->parent->firstSecondary=bPtr->succ;
-		else
-			firstBinding=bPtr->succ;
-		if(bPtr->succ!=0)
-			bPtr->succ->pred=bPtr->pred;
-		delete bPtr;
-		}
+		deleteBinding(bPtr);
 	}
 
 void WidgetManager::show(Widget* widget)
 	{
 	/* Find the widget's binding: */
-	Widget* root=widget->getRoot();
-	PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
+	PopupBinding* bPtr=findBinding(widget);
 	
 	/* Mark the binding as visible: */
 	if(bPtr!=0)
@@ -264,10 +566,7 @@ void WidgetManager::show(Widget* widget)
 void WidgetManager::hide(Widget* widget)
 	{
 	/* Find the widget's binding: */
-	Widget* root=widget->getRoot();
-	PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
+	PopupBinding* bPtr=findBinding(widget);
 	
 	/* Mark the binding as invisible: */
 	if(bPtr!=0)
@@ -277,10 +576,7 @@ void WidgetManager::hide(Widget* widget)
 bool WidgetManager::isManaged(const Widget* widget) const
 	{
 	/* Find the widget's binding: */
-	const Widget* root=widget->getRoot();
-	PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
+	PopupBinding* bPtr=findBinding(widget);
 	
 	return bPtr!=0;
 	}
@@ -288,59 +584,53 @@ bool WidgetManager::isManaged(const Widget* widget) const
 bool WidgetManager::isVisible(const Widget* widget) const
 	{
 	/* Find the widget's binding: */
-	const Widget* root=widget->getRoot();
-	PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
+	PopupBinding* bPtr=findBinding(widget);
 	
 	return bPtr!=0&&bPtr->visible;
 	}
 
 Widget* WidgetManager::findPrimaryWidget(const Point& point)
 	{
-	/* Find a recipient for this event amongst all primary bindings: */
-	PopupBinding* foundBinding=0;
-	for(PopupBinding* bPtr=firstBinding;bPtr!=0&&foundBinding==0;bPtr=bPtr->succ)
-		foundBinding=bPtr->findTopLevelWidget(point);
-	
-	/* Bail out if no widget was found: */
-	if(foundBinding==0)
-		return 0;
-	
-	/* Find the primary top level widget containing the found widget: */
-	while(foundBinding->parent!=0)
-		foundBinding=foundBinding->parent;
+	/* Collect all primary bindings whose bounds contain the point: */
+	pickCandidates.clear();
+	if(boundsRoot!=0)
+		collectPickCandidates(boundsRoot,point);
+	
+	/* Find a recipient for this event amongst the candidates, in the order of the list of primary bindings: */
+	std::sort(pickCandidates.begin(),pickCandidates.end(),isEarlierPrimary);
+	for(std::vector<PopupBinding*>::iterator cIt=pickCandidates.begin();cIt!=pickCandidates.end();++cIt)
+		if((*cIt)->findTopLevelWidget(point)!=0)
+			{
+			/* Return the primary top level widget containing the found widget: */
+			return (*cIt)->topLevelWidget;
+			}
 	
-	/* Return the top level widget: */
-	return foundBinding->topLevelWidget;
+	return 0;
 	}
 
 Widget* WidgetManager::findPrimaryWidget(const Ray& ray)
 	{
-	/* Find a recipient for this event amongst all primary bindings: */
-	PopupBinding* foundBinding=0;
-	for(PopupBinding* bPtr=firstBinding;bPtr!=0&&foundBinding==0;bPtr=bPtr->succ)
-		foundBinding=bPtr->findTopLevelWidget(ray);
-	
-	/* Bail out if no widget was found: */
-	if(foundBinding==0)
-		return 0;
-	
-	/* Find the primary top level widget containing the found widget: */
-	while(foundBinding->parent!=0)
-		foundBinding=foundBinding->parent;
+	/* Collect all primary bindings whose bounds are intersected by the ray: */
+	pickCandidates.clear();
+	if(boundsRoot!=0)
+		collectPickCandidates(boundsRoot,ray);
+	
+	/* Find a recipient for this event amongst the candidates, in the order of the list of primary bindings: */
+	std::sort(pickCandidates.begin(),pickCandidates.end(),isEarlierPrimary);
+	for(std::vector<PopupBinding*>::iterator cIt=pickCandidates.begin();cIt!=pickCandidates.end();++cIt)
+		if((*cIt)->findTopLevelWidget(ray)!=0)
+			{
+			/* Return the primary top level widget containing the found widget: */
+			return (*cIt)->topLevelWidget;
+			}
 	
-	/* Return the top level widget: */
-	return foundBinding->topLevelWidget;
+	return 0;
 	}
 
 WidgetManager::Transformation WidgetManager::calcWidgetTransformation(const Widget* widget) const
 	{
 	/* Find the widget's binding: */
-	const Widget* root=widget->getRoot();
-	const PopupBinding* bPtr;
-	for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-		;
+	const PopupBinding* bPtr=findBinding(widget);
 	
 	/* Concatenate all transformations up to the primary top level widget: */
 	Transformation result=Transformation::identity;
@@ -355,16 +645,23 @@ WidgetManager::Transformation WidgetManager::calcWidgetTransformation(const Widg
 
 void WidgetManager::setPrimaryWidgetTransformation(Widget* widget,const WidgetManager::Transformation& newWidgetToWorld)
 	{
-	/* Find the widget's top level widget: */
-	Widget* root=widget->getRoot();
-	
-	/* Find the root amongst the managed top level widgets: */
-	for(PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-		if(bPtr->topLevelWidget==root)
-			{
-			bPtr->widgetToWorld=newWidgetToWorld;
-			break;
-			}
+	/* Find the root amongst the managed primary top level widgets: */
+	PopupBinding* bPtr=findBinding(widget);
+	if(bPtr!=0&&bPtr->parent==0)
+		{
+		bPtr->widgetToWorld=newWidgetToWorld;
+		
+		/* Move the binding's bounds: */
+		updateBounds(bPtr);
+		}
+	}
+
+void WidgetManager::updateWidgetBounds(const Widget* topLevelWidget)
+	{
+	/* Recalculate the bounds of the primary binding containing the widget's binding: */
+	PopupBinding* bPtr=findBinding(topLevelWidget);
+	if(bPtr!=0)
+		updateBounds(bPtr);
 	}
 
 void WidgetManager::deleteWidget(Widget* widget)
@@ -389,9 +686,31 @@ void WidgetManager::setTime(double newTime)
 
 void WidgetManager::draw(GLContextData& contextData) const
 	{
+	/* Retrieve the context data item if top level widgets are drawn in retained mode: */
+	DataItem* dataItem=0;
+	if(retainedMode)
+		{
+		dataItem=contextData.retrieveDataItem<DataItem>(this);
+		++dataItem->frame;
+		}
+	
 	/* Traverse all primary top level widgets: */
 	for(const PopupBinding* bPtr=firstBinding;bPtr!=0;bPtr=bPtr->succ)
-		bPtr->draw(drawOverlayWidgets,contextData);
+		bPtr->draw(drawOverlayWidgets,dataItem,contextData);
+	
+	if(dataItem!=0)
+		{
+		/* Delete the display lists of all top level widgets that were not drawn in this frame: */
+		std::vector<const Widget*> staleWidgets;
+		for(RetainedWidgetHash::Iterator rwIt=dataItem->retainedWidgets.begin();!rwIt.isFinished();++rwIt)
+			if(rwIt->getDest().lastUsedFrame!=dataItem->frame)
+				{
+				glDeleteLists(rwIt->getDest().displayListId,1);
+				staleWidgets.push_back(rwIt->getSource());
+				}
+		for(std::vector<const Widget*>::iterator swIt=staleWidgets.begin();swIt!=staleWidgets.end();++swIt)
+			dataItem->retainedWidgets.removeEntry(*swIt);
+		}
 	}
 
 bool WidgetManager::pointerButtonDown(Event& event)
@@ -426,6 +745,7 @@ bool WidgetManager::pointerButtonDown(Event& event)
 			foundTopLevel->succ=firstBinding;
 			foundTopLevel->succ->pred=foundTopLevel;
 			firstBinding=foundTopLevel;
+			foundTopLevel->popupSerial=++lastPopupSerial;
 			}
 		}
 	
@@ -440,6 +760,9 @@ bool WidgetManager::pointerButtonDown(Event& event)
 		/* Pass the event to the found target: */
 		event.getTargetWidget()->pointerButtonDown(event);
 		
+		/* Invalidate the visual representation of the target's widget tree: */
+		event.getTargetWidget()->update();
+		
 		result=true;
 		}
 	
@@ -465,6 +788,9 @@ bool WidgetManager::pointerButtonUp(Event& event)
 		/* Pass the event to the grabbing widget: */
 		pointerGrabWidget->pointerButtonUp(event);
 		
+		/* Invalidate the visual representation of the grabbing widget's tree: */
+		pointerGrabWidget->update();
+		
 		/* Release any "soft" grabs: */
 		if(!hardGrab)
 			pointerGrabWidget=0;
@@ -494,6 +820,9 @@ bool WidgetManager::pointerMotion(Event& event)
 		/* Pass the event to the grabbing widget: */
 		pointerGrabWidget->pointerMotion(event);
 		
+		/* Invalidate the visual representation of the grabbing widget's tree: */
+		pointerGrabWidget->update();
+		
 		result=pointerGrabWidget!=0;
 		}
 	else
@@ -507,6 +836,9 @@ bool WidgetManager::pointerMotion(Event& event)
 			/* Pass the event to the found target: */
 			event.getTargetWidget()->pointerMotion(event);
 			
+			/* Invalidate the visual representation of the target's widget tree: */
+			event.getTargetWidget()->update();
+			
 			result=true;
 			}
 		}
@@ -524,11 +856,8 @@ void WidgetManager::grabPointer(Widget* widget)
 	if(pointerGrabWidget==0)
 		{
 		/* Find the widget's binding: */
-		Widget* root=widget->getRoot();
-		PopupBinding* bPtr;
-		for(bPtr=firstBinding;bPtr!=0&&bPtr->topLevelWidget!=root;bPtr=bPtr->getSucc())
-			;
-
+		PopupBinding* bPtr=findBinding(widget);
+		
 		if(bPtr!=0)
 			{
 			hardGrab=true;
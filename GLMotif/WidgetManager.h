@@ -24,7 +24,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #define GLMOTIF_WIDGETMANAGER_INCLUDED
 
 #include <vector>
+#include <Misc/HashTable.h>
+#include <Geometry/Box.h>
 #include <Geometry/OrthogonalTransformation.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
 #include <GLMotif/Types.h>
 
 /* Forward declarations: */
@@ -40,13 +44,50 @@ class Widget;
 
 namespace GLMotif {
 
-class WidgetManager
+class WidgetManager:public GLObject
 	{
 	/* Embedded classes: */
 	public:
 	typedef Geometry::OrthogonalTransformation<Scalar,3> Transformation;
+	typedef Geometry::Box<Scalar,3> WorldBox; // Type for axis-aligned boxes in world coordinates
 	
 	private:
+	struct PopupBinding;
+	
+	struct BoundsNode // Structure for nodes of the bounding volume hierarchy over the world-space bounds of primary top level widgets
+		{
+		/* Elements: */
+		public:
+		WorldBox box; // Bounds of all primary top level widgets in the node's subtree
+		BoundsNode* parent; // Pointer to the parent node, or 0 for the root
+		BoundsNode* children[2]; // Pointers to the two children of an interior node, or 0 for leaves
+		PopupBinding* binding; // Pointer to the primary binding bounded by a leaf, or 0 for interior nodes
+		};
+	
+	struct RetainedWidget // Structure holding the recorded visual representation of a top level widget
+		{
+		/* Elements: */
+		public:
+		GLuint displayListId; // ID of display list containing the top level widget's drawing commands
+		unsigned int version; // Visual version number of the top level widget at the time the display list was recorded
+		unsigned int lastUsedFrame; // Index of the last frame in which the display list was used
+		};
+	
+	typedef Misc::HashTable<const Widget*,PopupBinding*> BindingHash; // Hash table mapping top level widgets to their bindings
+	typedef Misc::HashTable<const Widget*,RetainedWidget> RetainedWidgetHash; // Hash table mapping top level widgets to their recorded visual representations
+	
+	struct DataItem:public GLObject::DataItem // Structure holding per-context widget state
+		{
+		/* Elements: */
+		public:
+		RetainedWidgetHash retainedWidgets; // Recorded visual representations of all top level widgets drawn in the context
+		unsigned int frame; // Index of the current frame in the context
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		};
+	
 	struct PopupBinding // Structure to bind top level widgets
 		{
 		/* Elements: */
@@ -58,6 +99,8 @@ class WidgetManager
 		PopupBinding* pred; // Pointer to previous binding in same hierarchy level
 		PopupBinding* succ; // Pointer to previous binding in same hierarchy level
 		PopupBinding* firstSecondary; // Pointer to first secondary top level window
+		unsigned int popupSerial; // Serial number of a primary binding; bindings earlier in the list of primary bindings have higher numbers
+		BoundsNode* boundsLeaf; // Bounding volume hierarchy leaf holding the bounds of a primary binding, or 0 for secondary bindings
 		
 		/* Constructors and destructors: */
 		PopupBinding(Widget* sTopLevelWidget,const Transformation& sWidgetToWorld,PopupBinding* sParent,PopupBinding* sSucc);
@@ -100,7 +143,8 @@ class WidgetManager
 			}
 		PopupBinding* findTopLevelWidget(const Point& point);
 		PopupBinding* findTopLevelWidget(const Ray& ray);
-		void draw(bool overlayWidgets,GLContextData& contextData) const;
+		void calcBounds(const Transformation& ownerToWorld,WorldBox& bounds) const; // Adds the world-space bounds of the top level widget and its secondaries to the given box
+		void draw(bool overlayWidgets,DataItem* dataItem,GLContextData& contextData) const; // Draws the top level widget and its secondaries; uses or records retained display lists if a context data item is given
 		};
 	
 	/* Elements: */
@@ -108,7 +152,12 @@ class WidgetManager
 	const StyleSheet* styleSheet; // The widget manager's style sheet
 	Misc::TimerEventScheduler* timerEventScheduler; // Pointer to a scheduler for timer events managed by the OS/window system binding layer
 	bool drawOverlayWidgets; // Flag whether widgets are drawn in an overlay layer on top of all other 3D imagery
+	bool retainedMode; // Flag whether top level widgets are drawn from display lists that are only re-recorded when the widgets change
 	PopupBinding* firstBinding; // Pointer to first bound top level widget
+	BindingHash bindingMap; // Map from top level widgets to their bindings
+	unsigned int lastPopupSerial; // Serial number of the most recently popped up primary top level widget
+	BoundsNode* boundsRoot; // Root of the bounding volume hierarchy over the world-space bounds of all primary top level widgets, or 0
+	std::vector<PopupBinding*> pickCandidates; // Primary bindings whose bounds contain a picking point or ray, reused between queries
 	double time; // The time reported to widgets
 	bool hardGrab; // Flag if the current pointer grab is a hard one
 	Widget* pointerGrabWidget; // Pointer to the widget grabbing the input
@@ -118,13 +167,26 @@ class WidgetManager
 	
 	/* Private methods: */
 	void deleteQueuedWidgets(void); // Deletes all widgets in the deletion list
+	PopupBinding* findBinding(const Widget* widget) const; // Returns the binding of the top level widget containing the given widget, or 0
+	void unmapBindings(PopupBinding* binding); // Removes the given binding and all its secondaries from the binding map
+	void deleteBinding(PopupBinding* binding); // Removes the given binding from its list and from the bounding volume hierarchy and deletes it
+	void insertBoundsLeaf(BoundsNode* leaf); // Inserts a leaf into the bounding volume hierarchy
+	void removeBoundsLeaf(BoundsNode* leaf); // Removes a leaf from the bounding volume hierarchy without deleting it
+	void updateBounds(PopupBinding* binding); // Recalculates the bounds of the primary binding containing the given binding
+	static bool isEarlierPrimary(const PopupBinding* binding1,const PopupBinding* binding2); // Returns true if the first primary binding precedes the second in the list of primary bindings
+	static void deleteBoundsNodes(BoundsNode* node); // Deletes the given bounding volume hierarchy subtree
+	void collectPickCandidates(const BoundsNode* node,const Point& point); // Collects the primary bindings in the given subtree whose bounds contain the given point
+	void collectPickCandidates(const BoundsNode* node,const Ray& ray); // Collects the primary bindings in the given subtree whose bounds are intersected by the given ray
 	
 	/* Constructors and destructors: */
 	public:
 	WidgetManager(void); // Constructs an empty widget manager
-	~WidgetManager(void);
+	virtual ~WidgetManager(void);
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
 	
-	/* Methods: */
+	/* New methods: */
 	void setStyleSheet(const StyleSheet* newStyleSheet); // Sets the widget manager's style sheet
 	const StyleSheet* getStyleSheet(void) const // Returns the widget manager's style sheet
 		{
@@ -144,6 +206,11 @@ class WidgetManager
 		{
 		return drawOverlayWidgets;
 		}
+	void setRetainedMode(bool newRetainedMode); // Sets whether top level widgets are drawn from retained display lists
+	bool getRetainedMode(void) const // Returns the current setting of the retained mode flag
+		{
+		return retainedMode;
+		}
 	void popupPrimaryWidget(Widget* topLevelWidget,const Transformation& widgetToWorld); // Pops up a primary top level widget
 	void popupSecondaryWidget(Widget* owner,Widget* topLevelWidget,const Vector& offset); // Pops up a secondary top level widget
 	void popdownWidget(Widget* widget); // Pops down the top level widget containing the given widget
@@ -155,6 +222,7 @@ class WidgetManager
 	Widget* findPrimaryWidget(const Ray& ray); // Finds the primary top level widget whose descendants are intersected by the given ray
 	Transformation calcWidgetTransformation(const Widget* widget) const; // Returns the transformation associated with a widget's root
 	void setPrimaryWidgetTransformation(Widget* widget,const Transformation& newWidgetToWorld); // Sets the transformation of a primary top level widget
+	void updateWidgetBounds(const Widget* topLevelWidget); // Notifies the widget manager that a top level widget changed its size
 	void deleteWidget(Widget* widget); // Method to delete a widget that is safe to call from within a callback belonging to the widget
 	void setTime(double newTime); // Sets the widget manager's time
 	double getTime(void) const // Returns the current time
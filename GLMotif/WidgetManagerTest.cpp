@@ -0,0 +1,231 @@
+/***********************************************************************
+WidgetManagerTest - Program to measure the time to find the primary top
+level widget hit by a ray among hundreds of widgets, and to check that
+the widget manager's bounding volume hierarchy picks the same widget as
+a linear scan over all widgets in popup order.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the GLMotif Widget Library (GLMotif).
+
+The GLMotif Widget Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The GLMotif Widget Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the GLMotif Widget Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <GLMotif/StyleSheet.h>
+#include <GLMotif/WidgetManager.h>
+#include <GLMotif/Popup.h>
+#include <GLMotif/Blind.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+typedef GLMotif::WidgetManager::Transformation Transformation;
+
+struct TestWidget // Structure for a primary top level widget and its optional secondary top level widget
+	{
+	/* Elements: */
+	public:
+	GLMotif::Popup* primary; // The primary top level widget
+	Transformation widgetToWorld; // The primary widget's transformation, as set by the test
+	GLMotif::Popup* secondary; // A secondary top level widget owned by the primary widget, or null
+	GLMotif::Vector secondaryOffset; // Offset of the secondary widget relative to the primary widget
+	bool mapped; // Flag whether the widget is currently popped up
+	};
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+double randUniform(double min,double max)
+	{
+	return min+(max-min)*double(rand())/double(RAND_MAX);
+	}
+
+GLMotif::Popup* createPopup(const char* name,GLMotif::WidgetManager& widgetManager,GLfloat width,GLfloat height) // Creates a popup containing a blind of the given size
+	{
+	GLMotif::Popup* popup=new GLMotif::Popup(name,&widgetManager);
+	GLMotif::Blind* blind=new GLMotif::Blind("Blind",popup,false);
+	blind->setPreferredSize(GLMotif::Vector(width,height,0.0f));
+	blind->manageChild();
+	return popup;
+	}
+
+Transformation randomPlacement(void) // Returns a random transformation placing a widget on a sphere around the origin, facing the origin
+	{
+	double azimuth=randUniform(0.0,2.0*Math::Constants<double>::pi);
+	double elevation=randUniform(-40.0,40.0);
+	Transformation::Point position(Math::sin(azimuth)*100.0,elevation,-Math::cos(azimuth)*100.0);
+	return Transformation::translateFromOriginTo(position)*Transformation::rotate(Transformation::Rotation::rotateY(-azimuth));
+	}
+
+bool hitsWidget(const GLMotif::Widget* widget,const GLMotif::Ray& widgetRay) // Same test as the widget manager's
+	{
+	GLMotif::Point intersection;
+	GLMotif::Scalar lambda=widget->intersectRay(widgetRay,intersection);
+	return lambda>=GLMotif::Scalar(0)&&widget->isInside(intersection);
+	}
+
+GLMotif::Widget* findPrimaryWidgetLinear(const std::vector<TestWidget>& widgets,const GLMotif::Ray& ray) // Tests all mapped widgets, most recently popped up first
+	{
+	for(std::vector<TestWidget>::const_reverse_iterator wIt=widgets.rbegin();wIt!=widgets.rend();++wIt)
+		if(wIt->mapped)
+			{
+			GLMotif::Ray widgetRay=ray;
+			widgetRay.inverseTransform(wIt->widgetToWorld);
+			if(hitsWidget(wIt->primary,widgetRay))
+				return wIt->primary;
+			if(wIt->secondary!=0)
+				{
+				widgetRay.inverseTransform(Transformation::translate(Transformation::Vector(wIt->secondaryOffset.getXyzw())));
+				if(hitsWidget(wIt->secondary,widgetRay))
+					return wIt->primary;
+				}
+			}
+	return 0;
+	}
+
+void runQueries(GLMotif::WidgetManager& widgetManager,const std::vector<TestWidget>& widgets,unsigned int numQueries,const char* phase)
+	{
+	/* Create random rays from around the origin: */
+	std::vector<GLMotif::Ray> rays;
+	rays.reserve(numQueries);
+	for(unsigned int i=0;i<numQueries;++i)
+		{
+		GLMotif::Ray::Point origin(randUniform(-1.0,1.0),randUniform(-1.0,1.0),randUniform(-1.0,1.0));
+		double azimuth=randUniform(0.0,2.0*Math::Constants<double>::pi);
+		double elevation=randUniform(-0.4,0.4);
+		GLMotif::Ray::Vector direction(Math::sin(azimuth)*Math::cos(elevation),Math::sin(elevation),-Math::cos(azimuth)*Math::cos(elevation));
+		rays.push_back(GLMotif::Ray(origin,direction));
+		}
+	
+	/* Pick with a linear scan: */
+	std::vector<GLMotif::Widget*> linearResults(numQueries);
+	Misc::Timer linearTimer;
+	for(unsigned int i=0;i<numQueries;++i)
+		linearResults[i]=findPrimaryWidgetLinear(widgets,rays[i]);
+	linearTimer.elapse();
+	
+	/* Pick with the widget manager: */
+	std::vector<GLMotif::Widget*> managerResults(numQueries);
+	Misc::Timer managerTimer;
+	for(unsigned int i=0;i<numQueries;++i)
+		managerResults[i]=widgetManager.findPrimaryWidget(rays[i]);
+	managerTimer.elapse();
+	
+	unsigned int numHits=0;
+	unsigned int numMismatches=0;
+	for(unsigned int i=0;i<numQueries;++i)
+		{
+		if(linearResults[i]!=0)
+			++numHits;
+		if(linearResults[i]!=managerResults[i])
+			++numMismatches;
+		}
+	printf("%s: %u of %u rays hit a widget; linear scan %.3f us/ray, widget manager %.3f us/ray\n",phase,numHits,numQueries,linearTimer.getTime()*1.0e6/double(numQueries),managerTimer.getTime()*1.0e6/double(numQueries));
+	check(numHits>0,"some rays hit widgets");
+	check(numMismatches==0,"widget manager picks the same widget as a linear scan");
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numWidgets=500;
+	unsigned int numQueries=100000;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-widgets")==0&&i+1<argc)
+			numWidgets=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-queries")==0&&i+1<argc)
+			numQueries=(unsigned int)(atoi(argv[++i]));
+		}
+	srand(1);
+	
+	/* Create a widget manager with a style sheet that does not need fonts: */
+	GLMotif::StyleSheet styleSheet;
+	styleSheet.setSize(0.5f);
+	GLMotif::WidgetManager widgetManager;
+	widgetManager.setStyleSheet(&styleSheet);
+	
+	/* Pop up overlapping widgets on a sphere around the origin; every tenth widget gets a secondary widget to its right: */
+	std::vector<TestWidget> widgets(numWidgets);
+	for(unsigned int i=0;i<numWidgets;++i)
+		{
+		TestWidget& w=widgets[i];
+		w.primary=createPopup("Primary",widgetManager,GLfloat(randUniform(5.0,15.0)),GLfloat(randUniform(5.0,15.0)));
+		w.widgetToWorld=randomPlacement();
+		w.secondary=0;
+		w.mapped=true;
+		widgetManager.popupPrimaryWidget(w.primary,w.widgetToWorld);
+		if(i%10==0)
+			{
+			w.secondary=createPopup("Secondary",widgetManager,GLfloat(randUniform(2.0,6.0)),GLfloat(randUniform(2.0,6.0)));
+			w.secondaryOffset=GLMotif::Vector(w.primary->getExterior().size[0],0.0f,0.5f);
+			widgetManager.popupSecondaryWidget(w.primary,w.secondary,w.secondaryOffset);
+			}
+		}
+	printf("%u primary top level widgets\n",numWidgets);
+	runQueries(widgetManager,widgets,numQueries,"Initial layout");
+	
+	/* Move a tenth of the widgets and pop down a twentieth: */
+	for(unsigned int i=0;i<numWidgets;i+=10)
+		{
+		TestWidget& w=widgets[(i*7+3)%numWidgets];
+		w.widgetToWorld=randomPlacement();
+		widgetManager.setPrimaryWidgetTransformation(w.primary,w.widgetToWorld);
+		}
+	for(unsigned int i=0;i<numWidgets;i+=20)
+		{
+		TestWidget& w=widgets[(i*13+5)%numWidgets];
+		if(w.mapped)
+			{
+			widgetManager.popdownWidget(w.primary);
+			w.mapped=false;
+			}
+		}
+	runQueries(widgetManager,widgets,numQueries,"After moving and popping down widgets");
+	
+	/* Delete all widgets, secondaries first: */
+	for(std::vector<TestWidget>::iterator wIt=widgets.begin();wIt!=widgets.end();++wIt)
+		{
+		delete wIt->secondary;
+		delete wIt->primary;
+		}
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -0,0 +1,346 @@
+/***********************************************************************
+ResampleImage - Functions to resample 8-bit RGB and RGBA images with
+separable box, bilinear, or Lanczos filters, and to create mipmap
+pyramids for texture images.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Images/ResampleImage.h>
+
+#include <string.h>
+#include <math.h>
+#include <GL/gl.h>
+#include <Threads/TaskScheduler.h>
+#include <Images/RGBImage.h>
+#include <Images/RGBAImage.h>
+
+namespace Images {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const int weightShift=14; // Number of fractional bits in fixed-point filter weights
+const int weightOne=1<<weightShift; // Fixed-point representation of a filter weight of one
+
+inline double getFilterSupport(ResampleFilter filter) // Returns the radius of the given filter kernel at unit scale
+	{
+	switch(filter)
+		{
+		case BOX_FILTER:
+			return 0.5;
+		
+		case BILINEAR_FILTER:
+			return 1.0;
+		
+		default:
+			return 3.0;
+		}
+	}
+
+inline double sinc(double x)
+	{
+	if(x==0.0)
+		return 1.0;
+	x*=M_PI;
+	return sin(x)/x;
+	}
+
+inline double evaluateFilter(ResampleFilter filter,double x) // Evaluates the given filter kernel at unit scale
+	{
+	switch(filter)
+		{
+		case BOX_FILTER:
+			return x>=-0.5&&x<0.5?1.0:0.0;
+		
+		case BILINEAR_FILTER:
+			x=fabs(x);
+			return x<1.0?1.0-x:0.0;
+		
+		default:
+			return x>-3.0&&x<3.0?sinc(x)*sinc(x/3.0):0.0;
+		}
+	}
+
+inline GLubyte clampComponent(int value) // Converts a fixed-point accumulator to a pixel component
+	{
+	value>>=weightShift;
+	if(value<0)
+		return GLubyte(0);
+	else if(value>255)
+		return GLubyte(255);
+	else
+		return GLubyte(value);
+	}
+
+/**************
+Helper classes:
+**************/
+
+class FilterWeights // Class to hold the fixed-point weights of a filter kernel resampling along one image axis
+	{
+	/* Elements: */
+	public:
+	unsigned int maxNumContributors; // Maximum number of source pixels contributing to any destination pixel
+	std::vector<unsigned int> firsts; // Index of first contributing source pixel for each destination pixel
+	std::vector<unsigned int> numContributors; // Number of contributing source pixels for each destination pixel
+	std::vector<int> weights; // Fixed-point weights of contributing source pixels, maxNumContributors entries per destination pixel
+	
+	/* Constructors and destructors: */
+	FilterWeights(unsigned int sourceSize,unsigned int destSize,ResampleFilter filter);
+	
+	/* Methods: */
+	const int* getWeights(unsigned int destIndex) const // Returns the weights for the given destination pixel
+		{
+		return &weights[destIndex*maxNumContributors];
+		}
+	};
+
+FilterWeights::FilterWeights(unsigned int sourceSize,unsigned int destSize,ResampleFilter filter)
+	:firsts(destSize),numContributors(destSize)
+	{
+	/* Widen the filter kernel when minifying to avoid aliasing: */
+	double scale=double(sourceSize)/double(destSize);
+	double filterScale=scale>1.0?scale:1.0;
+	double support=getFilterSupport(filter)*filterScale;
+	maxNumContributors=(unsigned int)(ceil(support*2.0))+2;
+	weights.resize(size_t(destSize)*maxNumContributors,0);
+	
+	std::vector<double> w(maxNumContributors);
+	for(unsigned int i=0;i<destSize;++i)
+		{
+		/* Find the range of source pixels covered by the filter kernel centered on the destination pixel: */
+		double center=(double(i)+0.5)*scale;
+		int first=int(floor(center-support));
+		if(first<0)
+			first=0;
+		int last=int(ceil(center+support));
+		if(last>int(sourceSize))
+			last=int(sourceSize);
+		
+		/* Evaluate the filter kernel for all covered source pixels: */
+		double weightSum=0.0;
+		for(int j=first;j<last;++j)
+			{
+			w[j-first]=evaluateFilter(filter,(double(j)+0.5-center)/filterScale);
+			weightSum+=w[j-first];
+			}
+		
+		/* Trim source pixels with zero weight from both ends of the range: */
+		while(first<last-1&&w[0]==0.0)
+			{
+			for(int j=first+1;j<last;++j)
+				w[j-first-1]=w[j-first];
+			++first;
+			}
+		while(last-1>first&&w[last-1-first]==0.0)
+			--last;
+		
+		/* Fall back to replicating the nearest source pixel if the kernel missed all pixel centers: */
+		if(weightSum==0.0)
+			{
+			first=int(floor(center));
+			if(first>int(sourceSize)-1)
+				first=int(sourceSize)-1;
+			last=first+1;
+			w[0]=1.0;
+			weightSum=1.0;
+			}
+		
+		/* Convert the normalized weights to fixed point, and assign the rounding error to the largest weight: */
+		firsts[i]=first;
+		numContributors[i]=last-first;
+		int* iw=&weights[i*maxNumContributors];
+		int iWeightSum=0;
+		int maxIndex=0;
+		for(int j=0;j<last-first;++j)
+			{
+			iw[j]=int(floor(w[j]*double(weightOne)/weightSum+0.5));
+			iWeightSum+=iw[j];
+			if(iw[j]>iw[maxIndex])
+				maxIndex=j;
+			}
+		iw[maxIndex]+=weightOne-iWeightSum;
+		}
+	}
+
+template <int numComponentsParam>
+class HorizontalPass // Class to resample a range of image rows horizontally
+	{
+	/* Elements: */
+	public:
+	const FilterWeights* filterWeights; // Weights of the horizontal filter kernel
+	const GLubyte* source; // Source image
+	unsigned int sourceWidth; // Width of the source image in pixels
+	GLubyte* dest; // Destination image, with the same number of rows as the source image
+	unsigned int destWidth; // Width of the destination image in pixels
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd) // Resamples the given range of rows
+		{
+		for(size_t y=rowBegin;y<rowEnd;++y)
+			{
+			const GLubyte* sRow=source+y*sourceWidth*numComponentsParam;
+			GLubyte* dPtr=dest+y*destWidth*numComponentsParam;
+			for(unsigned int x=0;x<destWidth;++x,dPtr+=numComponentsParam)
+				{
+				/* Accumulate all contributing source pixels; rounding is folded into the initial accumulator: */
+				const GLubyte* sPtr=sRow+filterWeights->firsts[x]*numComponentsParam;
+				const int* w=filterWeights->getWeights(x);
+				unsigned int numContributors=filterWeights->numContributors[x];
+				int acc[numComponentsParam];
+				for(int i=0;i<numComponentsParam;++i)
+					acc[i]=weightOne/2;
+				for(unsigned int j=0;j<numContributors;++j,sPtr+=numComponentsParam)
+					for(int i=0;i<numComponentsParam;++i)
+						acc[i]+=int(sPtr[i])*w[j];
+				for(int i=0;i<numComponentsParam;++i)
+					dPtr[i]=clampComponent(acc[i]);
+				}
+			}
+		}
+	};
+
+template <int numComponentsParam>
+class VerticalPass // Class to resample a range of image rows vertically
+	{
+	/* Elements: */
+	public:
+	const FilterWeights* filterWeights; // Weights of the vertical filter kernel
+	const GLubyte* source; // Source image, with the same width as the destination image
+	GLubyte* dest; // Destination image
+	unsigned int width; // Width of source and destination images in pixels
+	
+	/* Methods: */
+	void operator()(size_t rowBegin,size_t rowEnd) // Resamples the given range of destination rows
+		{
+		/* Accumulate entire rows at once so that the inner loops run over contiguous arrays: */
+		size_t rowSize=size_t(width)*numComponentsParam;
+		std::vector<int> accRow(rowSize);
+		int* acc=&accRow[0];
+		for(size_t y=rowBegin;y<rowEnd;++y)
+			{
+			for(size_t i=0;i<rowSize;++i)
+				acc[i]=weightOne/2;
+			const int* w=filterWeights->getWeights(y);
+			unsigned int numContributors=filterWeights->numContributors[y];
+			const GLubyte* sRow=source+size_t(filterWeights->firsts[y])*rowSize;
+			for(unsigned int j=0;j<numContributors;++j,sRow+=rowSize)
+				{
+				int wj=w[j];
+				for(size_t i=0;i<rowSize;++i)
+					acc[i]+=int(sRow[i])*wj;
+				}
+			GLubyte* dRow=dest+y*rowSize;
+			for(size_t i=0;i<rowSize;++i)
+				dRow[i]=clampComponent(acc[i]);
+			}
+		}
+	};
+
+template <class PassParam>
+void runPass(PassParam& pass,unsigned int numRows,Threads::TaskScheduler* taskScheduler) // Runs the given resampling pass on the given number of rows, split between the given task scheduler's threads if one is given
+	{
+	if(taskScheduler!=0)
+		taskScheduler->parallelFor(0,numRows,taskScheduler->calcGrainSize(numRows,16),pass);
+	else
+		pass(0,numRows);
+	}
+
+}
+
+/***********************************
+Resampling and mipmapping functions:
+***********************************/
+
+template <class ImageParam>
+ImageParam resampleImage(const ImageParam& source,unsigned int newWidth,unsigned int newHeight,ResampleFilter filter,Threads::TaskScheduler* taskScheduler)
+	{
+	const int numComponents=ImageParam::numComponents;
+	unsigned int width=source.getWidth();
+	unsigned int height=source.getHeight();
+	ImageParam result(newWidth,newHeight);
+	const GLubyte* sourcePixels=source.getPixels()[0].getRgba();
+	
+	/* Resample horizontally into an intermediate image, unless the width does not change: */
+	std::vector<GLubyte> intermediate;
+	const GLubyte* intermediatePixels=sourcePixels;
+	if(newWidth!=width)
+		{
+		intermediate.resize(size_t(newWidth)*size_t(height)*numComponents);
+		FilterWeights weights(width,newWidth,filter);
+		HorizontalPass<numComponents> pass;
+		pass.filterWeights=&weights;
+		pass.source=sourcePixels;
+		pass.sourceWidth=width;
+		pass.dest=&intermediate[0];
+		pass.destWidth=newWidth;
+		runPass(pass,height,taskScheduler);
+		intermediatePixels=&intermediate[0];
+		}
+	
+	/* Resample vertically into the result image: */
+	GLubyte* resultPixels=result.modifyPixels()[0].getRgba();
+	if(newHeight!=height)
+		{
+		FilterWeights weights(height,newHeight,filter);
+		VerticalPass<numComponents> pass;
+		pass.filterWeights=&weights;
+		pass.source=intermediatePixels;
+		pass.dest=resultPixels;
+		pass.width=newWidth;
+		runPass(pass,newHeight,taskScheduler);
+		}
+	else
+		memcpy(resultPixels,intermediatePixels,size_t(newWidth)*size_t(newHeight)*numComponents);
+	
+	return result;
+	}
+
+template <class ImageParam>
+void createMipmapPyramid(const ImageParam& baseLevel,std::vector<ImageParam>& levels,Threads::TaskScheduler* taskScheduler)
+	{
+	levels.clear();
+	levels.push_back(baseLevel);
+	unsigned int width=baseLevel.getWidth();
+	unsigned int height=baseLevel.getHeight();
+	while(width>1||height>1)
+		{
+		/* Halve the previous level's size as OpenGL does for non-power-of-two textures: */
+		width=width>1?width/2:1;
+		height=height>1?height/2:1;
+		
+		/* Box-filter the previous level; exact halvings average 2x2 pixel blocks: */
+		ImageParam level=resampleImage(levels.back(),width,height,BOX_FILTER,taskScheduler);
+		levels.push_back(level);
+		}
+	}
+
+/********************************************************
+Force instantiation of all standard resampling functions:
+********************************************************/
+
+template RGBImage resampleImage<RGBImage>(const RGBImage&,unsigned int,unsigned int,ResampleFilter,Threads::TaskScheduler*);
+template RGBAImage resampleImage<RGBAImage>(const RGBAImage&,unsigned int,unsigned int,ResampleFilter,Threads::TaskScheduler*);
+template void createMipmapPyramid<RGBImage>(const RGBImage&,std::vector<RGBImage>&,Threads::TaskScheduler*);
+template void createMipmapPyramid<RGBAImage>(const RGBAImage&,std::vector<RGBAImage>&,Threads::TaskScheduler*);
+
+}
@@ -0,0 +1,51 @@
+/***********************************************************************
+ResampleImage - Functions to resample 8-bit RGB and RGBA images with
+separable box, bilinear, or Lanczos filters, and to create mipmap
+pyramids for texture images.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef IMAGES_RESAMPLEIMAGE_INCLUDED
+#define IMAGES_RESAMPLEIMAGE_INCLUDED
+
+#include <vector>
+
+/* Forward declarations: */
+namespace Threads {
+class TaskScheduler;
+}
+
+namespace Images {
+
+enum ResampleFilter // Enumerated type for resampling filter kernels
+	{
+	BOX_FILTER, // Box filter; averages all covered source pixels when minifying, and replicates pixels when magnifying
+	BILINEAR_FILTER, // Triangle filter; bilinear interpolation when magnifying
+	LANCZOS_FILTER // Three-lobed Lanczos filter; sharpest results, but may ring at hard edges
+	};
+
+template <class ImageParam>
+ImageParam resampleImage(const ImageParam& source,unsigned int newWidth,unsigned int newHeight,ResampleFilter filter,Threads::TaskScheduler* taskScheduler =0); // Returns a copy of the given image resampled to the given size with the given filter, splitting the image rows between the given task scheduler's threads if one is given; only defined for RGBImage and RGBAImage
+
+template <class ImageParam>
+void createMipmapPyramid(const ImageParam& baseLevel,std::vector<ImageParam>& levels,Threads::TaskScheduler* taskScheduler =0); // Fills the given vector with all mipmap levels of the given image, from the base level (which is shared, not copied) down to size 1x1; only defined for RGBImage and RGBAImage
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+/***********************************************************************
+ResampleImageTest - Program to benchmark the resampling filters and
+mipmap pyramid creation on large images, and to check that resampling
+on a task scheduler produces the same pixels as resampling in the
+calling thread.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Image Handling Library (Images).
+
+The Image Handling Library is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Image Handling Library is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Image Handling Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Threads/TaskScheduler.h>
+#include <Images/RGBImage.h>
+#include <Images/ResampleImage.h>
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+bool equal(const Images::RGBImage& image1,const Images::RGBImage& image2)
+	{
+	if(image1.getWidth()!=image2.getWidth()||image1.getHeight()!=image2.getHeight())
+		return false;
+	size_t imageSize=size_t(image1.getWidth())*size_t(image1.getHeight())*3;
+	return memcmp(image1.getPixels()[0].getRgba(),image2.getPixels()[0].getRgba(),imageSize)==0;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int size=16384;
+	int numWorkers=Threads::TaskScheduler::getNumProcessors()-1;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			size=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-threads")==0&&i+1<argc)
+			numWorkers=atoi(argv[++i])-1;
+		}
+	if(numWorkers<0)
+		numWorkers=0;
+	Threads::TaskScheduler taskScheduler(numWorkers);
+	printf("Resampling %u x %u RGB image with %d threads\n",size,size,numWorkers+1);
+	
+	/* Create a source image with a pattern that exercises all filter taps: */
+	Images::RGBImage source(size,size);
+	GLubyte* sPtr=source.modifyPixels()[0].getRgba();
+	for(unsigned int y=0;y<size;++y)
+		for(unsigned int x=0;x<size;++x,sPtr+=3)
+			{
+			sPtr[0]=GLubyte((x*7+y*3)&0xff);
+			sPtr[1]=GLubyte((x^y)&0xff);
+			sPtr[2]=GLubyte(((x/16+y/16)&1)*255);
+			}
+	
+	/* Resample with all filters, once in the calling thread and once on the task scheduler: */
+	static const char* filterNames[3]={"box","bilinear","Lanczos"};
+	for(int f=0;f<3;++f)
+		{
+		Images::ResampleFilter filter=Images::ResampleFilter(f);
+		unsigned int newSizes[2]={size/4,size+size/3};
+		for(int s=0;s<2;++s)
+			{
+			unsigned int newSize=newSizes[s];
+			if(size_t(newSize)*size_t(newSize)>size_t(size)*size_t(size)&&size>8192)
+				continue;
+			
+			Misc::Timer serialTimer;
+			Images::RGBImage serial=Images::resampleImage(source,newSize,newSize,filter);
+			serialTimer.elapse();
+			
+			Misc::Timer parallelTimer;
+			Images::RGBImage parallel=Images::resampleImage(source,newSize,newSize,filter,&taskScheduler);
+			parallelTimer.elapse();
+			
+			printf("%s filter to %u x %u: %.3f s serial, %.3f s on task scheduler\n",filterNames[f],newSize,newSize,serialTimer.getTime(),parallelTimer.getTime());
+			check(equal(serial,parallel),"task scheduler resampling matches serial resampling");
+			}
+		}
+	
+	/* Create the mipmap pyramid both ways: */
+	{
+	Misc::Timer serialTimer;
+	std::vector<Images::RGBImage> serialLevels;
+	Images::createMipmapPyramid(source,serialLevels);
+	serialTimer.elapse();
+	
+	Misc::Timer parallelTimer;
+	std::vector<Images::RGBImage> parallelLevels;
+	Images::createMipmapPyramid(source,parallelLevels,&taskScheduler);
+	parallelTimer.elapse();
+	
+	printf("Mipmap pyramid with %u levels: %.3f s serial, %.3f s on task scheduler\n",(unsigned int)(serialLevels.size()),serialTimer.getTime(),parallelTimer.getTime());
+	check(serialLevels.size()==parallelLevels.size(),"mipmap pyramids have the same number of levels");
+	bool levelsEqual=serialLevels.size()==parallelLevels.size();
+	for(size_t i=0;levelsEqual&&i<serialLevels.size();++i)
+		levelsEqual=equal(serialLevels[i],parallelLevels[i]);
+	check(levelsEqual,"task scheduler mipmap levels match serial mipmap levels");
+	check(serialLevels.back().getWidth()==1&&serialLevels.back().getHeight()==1,"last mipmap level is 1x1");
+	}
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -24,6 +24,7 @@ Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <ctype.h>
 #include <Misc/File.h>
 #include <Misc/StandardValueCoders.h>
+#include <Misc/ConfigurationFileSnapshot.h>
 
 #include <Misc/ConfigurationFile.h>
 
@@ -455,6 +456,22 @@ ConfigurationFileBase::ConfigurationFileBase(const char* sFileName)
 	load(sFileName);
 	}
 
+ConfigurationFileBase::ConfigurationFileBase(const ConfigurationFileSnapshot& snapshot)
+	:fileName(snapshot.fileName),
+	 rootSection(new Section(0,std::string("")))
+	{
+	/* Re-create the section hierarchy; parents precede their subsections in the snapshot: */
+	std::vector<Section*> sections;
+	sections.reserve(snapshot.sections.size());
+	sections.push_back(rootSection);
+	for(size_t i=1;i<snapshot.sections.size();++i)
+		sections.push_back(sections[snapshot.sections[i].parent]->addSubsection(snapshot.sections[i].name));
+	
+	/* Add all tag/value pairs: */
+	for(std::vector<ConfigurationFileSnapshot::Tag>::const_iterator tIt=snapshot.tags.begin();tIt!=snapshot.tags.end();++tIt)
+		sections[tIt->section]->values.push_back(Section::TagValue(tIt->name,tIt->value));
+	}
+
 ConfigurationFileBase::~ConfigurationFileBase(void)
 	{
 	delete rootSection;
@@ -34,6 +34,7 @@ namespace Misc {
 class File;
 class ConfigurationFileSection;
 class ConfigurationFile;
+class ConfigurationFileSnapshot;
 }
 
 namespace Misc {
@@ -42,6 +43,7 @@ class ConfigurationFileBase
 	{
 	friend class ConfigurationFileSection;
 	friend class ConfigurationFile;
+	friend class ConfigurationFileSnapshot;
 	
 	/* Embedded classes: */
 	public:
@@ -293,6 +295,7 @@ class ConfigurationFileBase
 	ConfigurationFileBase(const char* sFileName); // Opens an existing configuration file
 	template <class PipeParam>
 	ConfigurationFileBase(PipeParam& pipe); // Reads a configuration file from a pipe
+	ConfigurationFileBase(const ConfigurationFileSnapshot& snapshot); // Re-creates a configuration file from a snapshot
 	private:
 	ConfigurationFileBase(const ConfigurationFile& source); // Prohibit copy constructor
 	ConfigurationFileBase& operator=(const ConfigurationFile& source); // Prohibit assignment operator
@@ -360,6 +363,16 @@ class ConfigurationFile:public ConfigurationFileBase,public ConfigurationFileBas
 		 ConfigurationFileBase::SectionValueCoder(rootSection)
 		{
 		}
+	ConfigurationFile(const ConfigurationFileSnapshot& snapshot) // Re-creates a configuration file from a snapshot; current section is the root section
+		:ConfigurationFileBase(snapshot),
+		 ConfigurationFileBase::SectionValueCoder(rootSection)
+		{
+		}
+	ConfigurationFile(ConfigurationFileSnapshot& snapshot) // Ditto; overrides the pipe constructor for non-const snapshots
+		:ConfigurationFileBase(static_cast<const ConfigurationFileSnapshot&>(snapshot)),
+		 ConfigurationFileBase::SectionValueCoder(rootSection)
+		{
+		}
 	
 	/* Methods: */
 	std::string getCurrentPath(void) const; // Returns absolute path to current section
@@ -0,0 +1,158 @@
+/***********************************************************************
+ConfigurationFileSnapshot - Class for flattened copies of configuration
+files that can be sent through pipes as a single block.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Miscellaneous Support Library (Misc).
+
+The Miscellaneous Support Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Miscellaneous Support Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Miscellaneous Support Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <Misc/ConfigurationFileSnapshot.h>
+
+#include <string.h>
+#include <Misc/ThrowStdErr.h>
+
+namespace Misc {
+
+/******************************************************
+Methods of class ConfigurationFileSnapshot::BlobReader:
+******************************************************/
+
+void ConfigurationFileSnapshot::BlobReader::readRaw(void* data,size_t size)
+	{
+	if(size_t(bEnd-bPtr)<size)
+		Misc::throwStdErr("ConfigurationFileSnapshot: Truncated configuration file snapshot");
+	memcpy(data,bPtr,size);
+	bPtr+=size;
+	}
+
+void ConfigurationFileSnapshot::BlobReader::readString(std::string& string)
+	{
+	unsigned int length=read<unsigned int>();
+	if(size_t(bEnd-bPtr)<length)
+		Misc::throwStdErr("ConfigurationFileSnapshot: Truncated configuration file snapshot");
+	string.assign(bPtr,length);
+	bPtr+=length;
+	}
+
+/******************************************
+Methods of class ConfigurationFileSnapshot:
+******************************************/
+
+void ConfigurationFileSnapshot::addSections(const ConfigurationFileBase::Section* section,unsigned int parent)
+	{
+	/* Add the section: */
+	unsigned int index=sections.size();
+	Section newSection;
+	newSection.parent=parent;
+	newSection.name=section->name;
+	sections.push_back(newSection);
+	
+	/* Add the section's tag/value pairs: */
+	for(std::list<ConfigurationFileBase::Section::TagValue>::const_iterator tvIt=section->values.begin();tvIt!=section->values.end();++tvIt)
+		{
+		Tag newTag;
+		newTag.section=index;
+		newTag.name=tvIt->tag;
+		newTag.value=tvIt->value;
+		tags.push_back(newTag);
+		}
+	
+	/* Add all subsections: */
+	for(const ConfigurationFileBase::Section* ssPtr=section->firstSubsection;ssPtr!=0;ssPtr=ssPtr->sibling)
+		addSections(ssPtr,index);
+	}
+
+std::vector<char> ConfigurationFileSnapshot::serialize(void) const
+	{
+	BlobWriter writer;
+	
+	/* Write the file name: */
+	writer.writeString(fileName);
+	
+	/* Write all sections: */
+	writer.write<unsigned int>(sections.size());
+	for(std::vector<Section>::const_iterator sIt=sections.begin();sIt!=sections.end();++sIt)
+		{
+		writer.write<unsigned int>(sIt->parent);
+		writer.writeString(sIt->name);
+		}
+	
+	/* Write all tag/value pairs: */
+	writer.write<unsigned int>(tags.size());
+	for(std::vector<Tag>::const_iterator tIt=tags.begin();tIt!=tags.end();++tIt)
+		{
+		writer.write<unsigned int>(tIt->section);
+		writer.writeString(tIt->name);
+		writer.writeString(tIt->value);
+		}
+	
+	return writer.blob;
+	}
+
+void ConfigurationFileSnapshot::deserialize(const std::vector<char>& blob)
+	{
+	BlobReader reader(blob);
+	
+	/* Read the file name: */
+	reader.readString(fileName);
+	
+	/* Read all sections: */
+	unsigned int numSections=reader.read<unsigned int>();
+	if(numSections==0)
+		Misc::throwStdErr("ConfigurationFileSnapshot: Configuration file snapshot has no root section");
+	sections.reserve(numSections);
+	for(unsigned int i=0;i<numSections;++i)
+		{
+		Section newSection;
+		newSection.parent=reader.read<unsigned int>();
+		if(newSection.parent>i||(i>0&&newSection.parent==i))
+			Misc::throwStdErr("ConfigurationFileSnapshot: Malformed configuration file snapshot");
+		reader.readString(newSection.name);
+		sections.push_back(newSection);
+		}
+	
+	/* Read all tag/value pairs: */
+	unsigned int numTags=reader.read<unsigned int>();
+	tags.reserve(numTags);
+	for(unsigned int i=0;i<numTags;++i)
+		{
+		Tag newTag;
+		newTag.section=reader.read<unsigned int>();
+		if(newTag.section>=numSections)
+			Misc::throwStdErr("ConfigurationFileSnapshot: Malformed configuration file snapshot");
+		reader.readString(newTag.name);
+		reader.readString(newTag.value);
+		tags.push_back(newTag);
+		}
+	}
+
+ConfigurationFileSnapshot::ConfigurationFileSnapshot(const ConfigurationFile& configFile)
+	:fileName(configFile.fileName)
+	{
+	/* Flatten the configuration file's section hierarchy: */
+	addSections(configFile.rootSection,0);
+	}
+
+ConfigurationFileSnapshot::ConfigurationFileSnapshot(ConfigurationFile& configFile)
+	:fileName(configFile.fileName)
+	{
+	/* Flatten the configuration file's section hierarchy: */
+	addSections(configFile.rootSection,0);
+	}
+
+}
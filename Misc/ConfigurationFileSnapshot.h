@@ -0,0 +1,154 @@
+/***********************************************************************
+ConfigurationFileSnapshot - Class for flattened copies of configuration
+files that can be sent through pipes as a single block.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Miscellaneous Support Library (Misc).
+
+The Miscellaneous Support Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Miscellaneous Support Library is distributed in the hope that it
+will be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Miscellaneous Support Library; if not, write to the Free
+Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#ifndef MISC_CONFIGURATIONFILESNAPSHOT_INCLUDED
+#define MISC_CONFIGURATIONFILESNAPSHOT_INCLUDED
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <Misc/ConfigurationFile.h>
+
+namespace Misc {
+
+class ConfigurationFileSnapshot
+	{
+	friend class ConfigurationFileBase;
+	
+	/* Embedded classes: */
+	private:
+	struct Section // Structure describing a section of the configuration file
+		{
+		/* Elements: */
+		public:
+		unsigned int parent; // Index of parent section; root section is its own parent
+		std::string name; // Section name
+		};
+	
+	struct Tag // Structure describing a tag/value pair
+		{
+		/* Elements: */
+		public:
+		unsigned int section; // Index of the section containing the tag
+		std::string name; // Tag name
+		std::string value; // Value encoded as std::string
+		};
+	
+	class BlobWriter // Helper class to serialize snapshots into a single memory block
+		{
+		/* Elements: */
+		public:
+		std::vector<char> blob; // The serialized snapshot
+		
+		/* Methods: */
+		template <class DataParam>
+		void write(const DataParam& data) // Appends a single value
+			{
+			const char* dPtr=reinterpret_cast<const char*>(&data);
+			blob.insert(blob.end(),dPtr,dPtr+sizeof(DataParam));
+			}
+		void writeString(const std::string& string) // Appends a string as its length followed by its characters
+			{
+			write<unsigned int>(string.size());
+			blob.insert(blob.end(),string.begin(),string.end());
+			}
+		};
+	
+	class BlobReader // Helper class to deserialize snapshots from a single memory block
+		{
+		/* Elements: */
+		private:
+		const char* bPtr; // Current read position
+		const char* bEnd; // End of the serialized snapshot
+		
+		/* Private methods: */
+		void readRaw(void* data,size_t size); // Reads raw data; throws exception if the blob is truncated
+		
+		/* Constructors and destructors: */
+		public:
+		BlobReader(const std::vector<char>& blob)
+			:bPtr(blob.empty()?0:&blob[0]),bEnd(bPtr+blob.size())
+			{
+			}
+		
+		/* Methods: */
+		template <class DataParam>
+		DataParam read(void) // Reads a single value
+			{
+			DataParam result;
+			readRaw(&result,sizeof(DataParam));
+			return result;
+			}
+		void readString(std::string& string); // Reads a string written by BlobWriter::writeString
+		};
+	
+	/* Elements: */
+	std::string fileName; // File name of the original configuration file
+	std::vector<Section> sections; // List of sections; parents precede their subsections, and the root section is first
+	std::vector<Tag> tags; // List of tag/value pairs in section order
+	
+	/* Private methods: */
+	void addSections(const ConfigurationFileBase::Section* section,unsigned int parent); // Adds the given section and its subsections to the snapshot
+	std::vector<char> serialize(void) const; // Returns the snapshot serialized into a memory block
+	void deserialize(const std::vector<char>& blob); // Restores the snapshot from a memory block
+	
+	/* Constructors and destructors: */
+	public:
+	ConfigurationFileSnapshot(const ConfigurationFile& configFile); // Flattens the current contents of the given configuration file
+	ConfigurationFileSnapshot(ConfigurationFile& configFile); // Ditto; overrides the pipe constructor for non-const configuration files
+	template <class PipeParam>
+	ConfigurationFileSnapshot(PipeParam& pipe) // Reads a snapshot from a pipe
+		{
+		/* Read the serialized snapshot as a single block: */
+		std::vector<char> blob(pipe.template read<unsigned int>());
+		if(!blob.empty())
+			pipe.template read<char>(&blob[0],blob.size());
+		deserialize(blob);
+		}
+	private:
+	ConfigurationFileSnapshot(const ConfigurationFileSnapshot& source); // Prohibit copy constructor
+	ConfigurationFileSnapshot& operator=(const ConfigurationFileSnapshot& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	template <class PipeParam>
+	void writeToPipe(PipeParam& pipe) const // Writes the snapshot to a pipe as a single block
+		{
+		std::vector<char> blob=serialize();
+		pipe.template write<unsigned int>(blob.size());
+		if(!blob.empty())
+			pipe.template write<char>(&blob[0],blob.size());
+		}
+	const std::string& getFileName(void) const // Returns the file name of the original configuration file
+		{
+		return fileName;
+		}
+	size_t getNumTags(void) const // Returns the number of tag/value pairs in the snapshot
+		{
+		return tags.size();
+		}
+	};
+
+}
+
+#endif
@@ -45,22 +45,8 @@ typename FactoryManager<ManagedFactoryParam>::FactoryData
 FactoryManager<ManagedFactoryParam>::loadClassFromDSO(
 	const char* className)
 	{
-	/* Construct the DSO name from the given class name: */
-	char dsoName[256];
-	snprintf(dsoName,sizeof(dsoName),dsoNameTemplate.c_str(),className);
-	
 	/* Locate and open the DSO containing the class implementation: */
-	void* dsoHandle;
-	try
-		{
-		std::string fullDsoName=dsoLocator.locateFile(dsoName);
-		dsoHandle=dlopen(fullDsoName.c_str(),RTLD_LAZY|RTLD_GLOBAL);
-		}
-	catch(std::runtime_error err)
-		{
-		/* Re-throw the error as a DSO error: */
-		throw DsoError(err.what());
-		}
+	void* dsoHandle=dlopen(getDsoName(className).c_str(),RTLD_LAZY|RTLD_GLOBAL);
 	
 	/* Check if DSO handle is valid: */
 	if(dsoHandle==0)
@@ -154,6 +140,44 @@ FactoryManager<ManagedFactoryParam>::~FactoryManager(
 	releaseClasses();
 	}
 
+template <class ManagedFactoryParam>
+inline
+std::string
+FactoryManager<ManagedFactoryParam>::getDsoName(
+	const char* className)
+	{
+	/* Construct the DSO name from the given class name: */
+	char dsoName[256];
+	snprintf(dsoName,sizeof(dsoName),dsoNameTemplate.c_str(),className);
+	
+	/* Locate the DSO containing the class implementation: */
+	try
+		{
+		return dsoLocator.locateFile(dsoName);
+		}
+	catch(std::runtime_error err)
+		{
+		/* Re-throw the error as a DSO error: */
+		throw DsoError(err.what());
+		}
+	}
+
+template <class ManagedFactoryParam>
+inline
+typename FactoryManager<ManagedFactoryParam>::ManagedFactory*
+FactoryManager<ManagedFactoryParam>::findClass(
+	const char* className)
+	const
+	{
+	typename FactoryList::const_iterator fIt;
+	for(fIt=factories.begin();fIt!=factories.end()&&strcmp(fIt->factory->getClassName(),className)!=0;++fIt)
+		;
+	if(fIt!=factories.end())
+		return fIt->factory;
+	else
+		return 0;
+	}
+
 template <class ManagedFactoryParam>
 inline
 typename FactoryManager<ManagedFactoryParam>::ManagedFactory*
@@ -198,6 +198,8 @@ class FactoryManager
 		{
 		return dsoLocator;
 		}
+	std::string getDsoName(const char* className); // Returns the full name of the DSO containing the class of the given name without loading it; throws exception if DSO cannot be found
+	ManagedFactory* findClass(const char* className) const; // Returns factory object of the given class if the class is already loaded, or null
 	ManagedFactory* loadClass(const char* className); // Loads an object class at runtime and returns class object pointer
 	void addClass(ManagedFactory* newFactory,DestroyFactoryFunction newDestroyFactoryFunction =0); // Adds an existing factory to the manager
 	void releaseClass(const char* className); // Destroys an object class at runtime; throws exception if class cannot be removed due to dependencies
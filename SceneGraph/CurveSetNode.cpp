@@ -184,7 +184,7 @@ void CurveSetNode::glRenderAction(GLRenderState& renderState) const
 		typedef GLGeometry::Vertex<void,0,void,0,void,Scalar,3> Vertex;
 		
 		/* Bind the curve set's vertex buffer object: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+		renderState.bindVertexBuffer(dataItem->vertexBufferObjectId);
 		
 		if(dataItem->version!=version)
 			{
@@ -228,7 +228,7 @@ void CurveSetNode::glRenderAction(GLRenderState& renderState) const
 			}
 		
 		/* Set up the vertex array: */
-		GLVertexArrayParts::enable(Vertex::getPartsMask());
+		renderState.enableVertexArrays(Vertex::getPartsMask());
 		glVertexPointer(static_cast<Vertex*>(0));
 		
 		/* Draw all curves: */
@@ -247,12 +247,6 @@ void CurveSetNode::glRenderAction(GLRenderState& renderState) const
 		
 		/* Draw the endpoints of all curves: */
 		glDrawArrays(GL_POINTS,baseVertexIndex,numVertices.size()*2);
-		
-		/* Disable the vertex array: */
-		GLVertexArrayParts::disable(Vertex::getPartsMask());
-		
-		/* Protect the buffer: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
 		}
 	else
 		{
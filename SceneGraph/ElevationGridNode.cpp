@@ -537,7 +537,7 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 	typedef GLGeometry::Vertex<Scalar,2,GLubyte,4,Scalar,Scalar,3> Vertex;
 	
 	/* Bind the vertex buffer object: */
-	glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+	renderState.bindVertexBuffer(dataItem->vertexBufferObjectId);
 	
 	/* Set up the vertex arrays: */
 	int vertexArrayParts=Vertex::getPartsMask();
@@ -546,13 +546,13 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 		/* Disable the color vertex array: */
 		vertexArrayParts&=~GLVertexArrayParts::Color;
 		}
-	GLVertexArrayParts::enable(vertexArrayParts);
+	renderState.enableVertexArrays(vertexArrayParts);
 	glVertexPointer(static_cast<Vertex*>(0));
 	
 	if(indexed)
 		{
 		/* Bind the index buffer object: */
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->indexBufferObjectId);
+		renderState.bindIndexBuffer(dataItem->indexBufferObjectId);
 		
 		/* Check if the buffers are current: */
 		if(dataItem->version!=version)
@@ -568,9 +568,6 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 		const GLuint* iPtr=0;
 		for(int z=0;z<zDimension.getValue()-1;++z,iPtr+=xDimension.getValue()*2)
 			glDrawElements(GL_QUAD_STRIP,xDimension.getValue()*2,GL_UNSIGNED_INT,iPtr);
-		
-		/* Protect the index buffer object: */
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
 		}
 	else
 		{
@@ -587,12 +584,6 @@ void ElevationGridNode::glRenderAction(GLRenderState& renderState) const
 		/* Draw the elevation grid as a set of quads: */
 		glDrawArrays(GL_QUADS,0,(xDimension.getValue()-1)*(zDimension.getValue()-1)*4);
 		}
-	
-	/* Reset the vertex arrays: */
-	GLVertexArrayParts::disable(vertexArrayParts);
-	
-	/* Protect the vertex buffer object: */
-	glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
 	}
 
 void ElevationGridNode::initContext(GLContextData& contextData) const
@@ -23,7 +23,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/GLRenderState.h>
 
 #include <GL/gl.h>
+#include <GL/GLMaterialTemplates.h>
 #include <GL/GLTexEnvTemplates.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLExtensionManager.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
 #include <GL/GLTransformationWrappers.h>
 
 using GLTransformationWrappers::glMultMatrix; // PO'Leary
@@ -38,7 +42,11 @@ GLRenderState::GLRenderState(GLContextData& sContextData,const Point& sBaseViewe
 	:contextData(sContextData),
 	 baseViewerPos(sBaseViewerPos),baseUpVector(sBaseUpVector),
 	 currentTransform(OGTransform::identity),
-	 emissiveColor(0.0f,0.0f,0.0f)
+	 emissiveColor(0.0f,0.0f,0.0f),
+	 materialValid(false),
+	 numStateChanges(0),numRedundantStateChanges(0),
+	 sortShapes(false),
+	 textureUploadBudget(4*1024*1024),bufferUploadBudget(8*1024*1024)
 	{
 	/* Initialize the view frustum from the current OpenGL context: */
 	baseFrustum.setFromGL();
@@ -66,11 +74,60 @@ GLRenderState::GLRenderState(GLContextData& sContextData,const Point& sBaseViewe
 	GLint lightModelColorControl;
 	glGetIntegerv(GL_LIGHT_MODEL_COLOR_CONTROL,&lightModelColorControl);
 	separateSpecularColorEnabled=lightModelColorControl==GL_SEPARATE_SPECULAR_COLOR;
+	
+	/* Query the state shadowed to skip redundant state changes: */
+	GLint tempMatrixMode;
+	glGetIntegerv(GL_MATRIX_MODE,&tempMatrixMode);
+	initialMatrixMode=matrixMode=tempMatrixMode;
+	GLint tempBinding;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D,&tempBinding);
+	initialTexture2D=boundTexture2D=tempBinding;
+	
+	/* Buffer objects can only be bound if a node initialized the vertex buffer object extension: */
+	haveBufferObjects=GLExtensionManager::isExtensionRegistered("GL_ARB_vertex_buffer_object");
+	initialVertexBuffer=boundVertexBuffer=0;
+	initialIndexBuffer=boundIndexBuffer=0;
+	if(haveBufferObjects)
+		{
+		glGetIntegerv(GL_ARRAY_BUFFER_BINDING_ARB,&tempBinding);
+		initialVertexBuffer=boundVertexBuffer=tempBinding;
+		glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING_ARB,&tempBinding);
+		initialIndexBuffer=boundIndexBuffer=tempBinding;
+		}
+	
+	enabledVertexArrays=GLVertexArrayParts::No;
+	if(glIsEnabled(GL_VERTEX_ARRAY))
+		enabledVertexArrays|=GLVertexArrayParts::Position;
+	if(glIsEnabled(GL_NORMAL_ARRAY))
+		enabledVertexArrays|=GLVertexArrayParts::Normal;
+	if(glIsEnabled(GL_COLOR_ARRAY))
+		enabledVertexArrays|=GLVertexArrayParts::Color;
+	if(glIsEnabled(GL_TEXTURE_COORD_ARRAY))
+		enabledVertexArrays|=GLVertexArrayParts::TexCoord;
+	if(glIsEnabled(GL_EDGE_FLAG_ARRAY))
+		enabledVertexArrays|=GLVertexArrayParts::EdgeFlag;
+	if(glIsEnabled(GL_INDEX_ARRAY))
+		enabledVertexArrays|=GLVertexArrayParts::Index;
+	initialVertexArrays=enabledVertexArrays;
+	}
+
+GLRenderState::~GLRenderState(void)
+	{
+	/* Restore the state not covered by glPushAttrib to what it was when the render state was created: */
+	bindTexture2D(initialTexture2D);
+	if(haveBufferObjects)
+		{
+		bindVertexBuffer(initialVertexBuffer);
+		bindIndexBuffer(initialIndexBuffer);
+		}
+	enableVertexArrays(initialVertexArrays);
+	setMatrixMode(initialMatrixMode);
 	}
 
 OGTransform GLRenderState::pushTransform(const OGTransform& deltaTransform)
 	{
-	/* Push the new matrix onto the OpenGL matrix stack: */
+	/* Push the new matrix onto the OpenGL modelview matrix stack: */
+	setMatrixMode(GL_MODELVIEW);
 	glPushMatrix();
 	glMultMatrix(deltaTransform);
 	
@@ -84,7 +141,8 @@ OGTransform GLRenderState::pushTransform(const OGTransform& deltaTransform)
 
 void GLRenderState::popTransform(const OGTransform& previousTransform)
 	{
-	/* Pop the last matrix off the OpenGL matrix stack: */
+	/* Pop the last matrix off the OpenGL modelview matrix stack: */
+	setMatrixMode(GL_MODELVIEW);
 	glPopMatrix();
 	
 	/* Reinstate the current transformation: */
@@ -125,12 +183,18 @@ void GLRenderState::enableCulling(GLenum newCulledFace)
 		if(lightingEnabled)
 			glLightModeli(GL_LIGHT_MODEL_TWO_SIDE,GL_FALSE);
 		cullingEnabled=true;
+		++numStateChanges;
 		}
+	else
+		++numRedundantStateChanges;
 	if(culledFace!=newCulledFace)
 		{
 		glCullFace(newCulledFace);
 		culledFace=newCulledFace;
+		++numStateChanges;
 		}
+	else
+		++numRedundantStateChanges;
 	}
 
 void GLRenderState::disableCulling(void)
@@ -141,7 +205,10 @@ void GLRenderState::disableCulling(void)
 		if(lightingEnabled)
 			glLightModeli(GL_LIGHT_MODEL_TWO_SIDE,GL_TRUE);
 		cullingEnabled=false;
+		++numStateChanges;
 		}
+	else
+		++numRedundantStateChanges;
 	}
 
 void GLRenderState::enableMaterials(void)
@@ -155,17 +222,22 @@ void GLRenderState::enableMaterials(void)
 		if(highestTexturePriority>=0)
 			glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::MODULATE);
 		lightingEnabled=true;
+		++numStateChanges;
 		}
+	else
+		++numRedundantStateChanges;
 	if(!colorMaterialEnabled)
 		{
 		glEnable(GL_COLOR_MATERIAL);
 		glColorMaterial(GL_FRONT_AND_BACK,GL_AMBIENT_AND_DIFFUSE);
 		colorMaterialEnabled=true;
+		++numStateChanges;
 		}
 	if(highestTexturePriority>=0&&!separateSpecularColorEnabled)
 		{
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
 		separateSpecularColorEnabled=true;
+		++numStateChanges;
 		}
 	}
 
@@ -180,27 +252,38 @@ void GLRenderState::disableMaterials(void)
 		if(highestTexturePriority>=0)
 			glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,GLTexEnvEnums::REPLACE);
 		lightingEnabled=false;
+		++numStateChanges;
 		}
+	else
+		++numRedundantStateChanges;
 	if(colorMaterialEnabled)
 		{
 		glDisable(GL_COLOR_MATERIAL);
 		colorMaterialEnabled=false;
+		++numStateChanges;
 		}
 	if(separateSpecularColorEnabled)
 		{
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
 		separateSpecularColorEnabled=false;
+		++numStateChanges;
 		}
 	}
 
 void GLRenderState::enableTexture1D(void)
 	{
 	bool textureEnabled=highestTexturePriority>=0;
-	if(highestTexturePriority>=1)
-		glDisable(GL_TEXTURE_2D);
-	if(highestTexturePriority<0)
-		glEnable(GL_TEXTURE_1D);
-	highestTexturePriority=0;
+	if(highestTexturePriority!=0)
+		{
+		if(highestTexturePriority>=1)
+			glDisable(GL_TEXTURE_2D);
+		if(highestTexturePriority<0)
+			glEnable(GL_TEXTURE_1D);
+		highestTexturePriority=0;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
 	
 	if(!textureEnabled)
 		glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,lightingEnabled?GLTexEnvEnums::MODULATE:GLTexEnvEnums::REPLACE);
@@ -208,6 +291,7 @@ void GLRenderState::enableTexture1D(void)
 		{
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
 		separateSpecularColorEnabled=true;
+		++numStateChanges;
 		}
 	}
 
@@ -215,8 +299,13 @@ void GLRenderState::enableTexture2D(void)
 	{
 	bool textureEnabled=highestTexturePriority>=0;
 	if(highestTexturePriority<1)
+		{
 		glEnable(GL_TEXTURE_2D);
-	highestTexturePriority=1;
+		highestTexturePriority=1;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
 	
 	if(!textureEnabled)
 		glTexEnvMode(GLTexEnvEnums::TEXTURE_ENV,lightingEnabled?GLTexEnvEnums::MODULATE:GLTexEnvEnums::REPLACE);
@@ -224,22 +313,121 @@ void GLRenderState::enableTexture2D(void)
 		{
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SEPARATE_SPECULAR_COLOR);
 		separateSpecularColorEnabled=true;
+		++numStateChanges;
 		}
 	}
 
 void GLRenderState::disableTextures(void)
 	{
-	if(highestTexturePriority>=1)
-		glDisable(GL_TEXTURE_2D);
 	if(highestTexturePriority>=0)
+		{
+		if(highestTexturePriority>=1)
+			glDisable(GL_TEXTURE_2D);
 		glDisable(GL_TEXTURE_1D);
-	highestTexturePriority=-1;
+		highestTexturePriority=-1;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
 	
 	if(separateSpecularColorEnabled)
 		{
 		glLightModeli(GL_LIGHT_MODEL_COLOR_CONTROL,GL_SINGLE_COLOR);
 		separateSpecularColorEnabled=false;
+		++numStateChanges;
 		}
 	}
 
+void GLRenderState::setMatrixMode(GLenum newMatrixMode)
+	{
+	if(matrixMode!=newMatrixMode)
+		{
+		glMatrixMode(newMatrixMode);
+		matrixMode=newMatrixMode;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	}
+
+void GLRenderState::bindTexture2D(GLuint textureObjectId)
+	{
+	if(boundTexture2D!=textureObjectId)
+		{
+		glBindTexture(GL_TEXTURE_2D,textureObjectId);
+		boundTexture2D=textureObjectId;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	}
+
+void GLRenderState::bindVertexBuffer(GLuint bufferObjectId)
+	{
+	if(boundVertexBuffer!=bufferObjectId)
+		{
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB,bufferObjectId);
+		boundVertexBuffer=bufferObjectId;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	}
+
+void GLRenderState::bindIndexBuffer(GLuint bufferObjectId)
+	{
+	if(boundIndexBuffer!=bufferObjectId)
+		{
+		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,bufferObjectId);
+		boundIndexBuffer=bufferObjectId;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	}
+
+void GLRenderState::enableVertexArrays(int vertexArrayPartsMask)
+	{
+	if(enabledVertexArrays!=vertexArrayPartsMask)
+		{
+		/* Only touch the parts whose state changes: */
+		GLVertexArrayParts::disable(enabledVertexArrays&~vertexArrayPartsMask);
+		GLVertexArrayParts::enable(vertexArrayPartsMask&~enabledVertexArrays);
+		enabledVertexArrays=vertexArrayPartsMask;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	}
+
+void GLRenderState::setMaterial(const GLMaterial& newMaterial)
+	{
+	/* Ambient and diffuse colors are not shadowed, as they track the current color through color material: */
+	if(!materialValid||materialSpecular!=newMaterial.specular)
+		{
+		glMaterialSpecular(GLMaterialEnums::FRONT_AND_BACK,newMaterial.specular);
+		materialSpecular=newMaterial.specular;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	if(!materialValid||materialShininess!=newMaterial.shininess)
+		{
+		glMaterialShininess(GLMaterialEnums::FRONT_AND_BACK,newMaterial.shininess);
+		materialShininess=newMaterial.shininess;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	if(!materialValid||materialEmission!=newMaterial.emission)
+		{
+		glMaterialEmission(GLMaterialEnums::FRONT_AND_BACK,newMaterial.emission);
+		materialEmission=newMaterial.emission;
+		++numStateChanges;
+		}
+	else
+		++numRedundantStateChanges;
+	materialValid=true;
+	}
+
 }
@@ -23,9 +23,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_GLRENDERSTATE_INCLUDED
 #define SCENEGRAPH_GLRENDERSTATE_INCLUDED
 
+#include <stddef.h>
 #include <Geometry/OrthogonalTransformation.h>
 #include <GL/gl.h>
 #include <GL/GLColor.h>
+#include <GL/GLMaterial.h>
 #include <GL/GLFrustum.h>
 #include <SceneGraph/Geometry.h>
 
@@ -58,9 +60,36 @@ class GLRenderState
 	bool colorMaterialEnabled;
 	int highestTexturePriority; // Priority level of highest enabled texture unit (None=-1, 1D=0, 2D, 3D, cube map)
 	bool separateSpecularColorEnabled;
+	private:
+	GLenum initialMatrixMode; // Matrix mode when the render state was created
+	GLenum matrixMode; // Current matrix mode
+	GLuint initialTexture2D; // ID of texture object bound to the 2D texture target when the render state was created
+	GLuint boundTexture2D; // ID of texture object bound to the 2D texture target
+	bool haveBufferObjects; // Flag if the OpenGL context uses vertex buffer objects
+	GLuint initialVertexBuffer; // ID of buffer object bound to the vertex array buffer target when the render state was created
+	GLuint boundVertexBuffer; // ID of buffer object bound to the vertex array buffer target
+	GLuint initialIndexBuffer; // ID of buffer object bound to the element array buffer target when the render state was created
+	GLuint boundIndexBuffer; // ID of buffer object bound to the element array buffer target
+	int initialVertexArrays; // Bit mask of vertex array parts enabled when the render state was created
+	int enabledVertexArrays; // Bit mask of enabled vertex array parts
+	bool materialValid; // Flag if the shadowed material properties are valid
+	GLMaterial::Color materialSpecular; // Specular color of front and back materials
+	GLMaterial::Scalar materialShininess; // Specular exponent of front and back materials
+	GLMaterial::Color materialEmission; // Emissive color of front and back materials
+	unsigned int numStateChanges; // Number of OpenGL state changes issued during this rendering pass
+	unsigned int numRedundantStateChanges; // Number of requested state changes skipped during this rendering pass because they matched current state
+	
+	/* Rendering options: */
+	public:
+	bool sortShapes; // Flag whether group nodes render their shape children grouped by appearance; off by default as it changes rendering order
+	
+	/* Elements limiting work per rendering pass: */
+	size_t textureUploadBudget; // Number of bytes of texture image data that may still be uploaded during this rendering pass
+	size_t bufferUploadBudget; // Number of bytes of vertex buffer data that may still be uploaded during this rendering pass
 	
 	/* Constructors and destructors: */
 	GLRenderState(GLContextData& sContextData,const Point& sBaseViewerPos,const Vector& sBaseUpVector); // Creates a render state object
+	~GLRenderState(void); // Restores the texture and buffer bindings, enabled vertex arrays, and matrix mode found when the render state was created
 	
 	/* Methods: */
 	Point getViewerPos(void) const // Returns the viewer position in current model coordinates
@@ -74,6 +103,14 @@ class GLRenderState
 	OGTransform pushTransform(const OGTransform& deltaTransform); // Pushes the given transformation onto the matrix stack and returns the previous transformation
 	void popTransform(const OGTransform& previousTransform); // Resets the matrix stack to the given transformation; must be result from previous pushTransform call
 	bool doesBoxIntersectFrustum(const Box& box) const; // Returns true if the given box in current model coordinates intersects the view frustum
+	unsigned int getNumStateChanges(void) const // Returns the number of OpenGL state changes issued during this rendering pass
+		{
+		return numStateChanges;
+		}
+	unsigned int getNumRedundantStateChanges(void) const // Returns the number of redundant state changes skipped during this rendering pass
+		{
+		return numRedundantStateChanges;
+		}
 	
 	/* OpenGL state management methods: */
 	void enableCulling(GLenum newCulledFace); // Enables OpenGL face culling
@@ -83,6 +120,12 @@ class GLRenderState
 	void enableTexture1D(void); // Enables OpenGL 1D texture mapping
 	void enableTexture2D(void); // Enables OpenGL 2D texture mapping
 	void disableTextures(void); // Disables OpenGL texture mapping
+	void setMatrixMode(GLenum newMatrixMode); // Sets the OpenGL matrix mode
+	void bindTexture2D(GLuint textureObjectId); // Binds a texture object to the 2D texture target
+	void bindVertexBuffer(GLuint bufferObjectId); // Binds a buffer object to the vertex array buffer target
+	void bindIndexBuffer(GLuint bufferObjectId); // Binds a buffer object to the element array buffer target
+	void enableVertexArrays(int vertexArrayPartsMask); // Enables exactly the given set of vertex array parts, and disables all others
+	void setMaterial(const GLMaterial& newMaterial); // Sets the specular, shininess, and emissive properties of front and back materials; ambient and diffuse colors follow the current color while materials are enabled
 	};
 
 }
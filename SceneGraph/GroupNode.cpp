@@ -22,11 +22,34 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/GroupNode.h>
 
 #include <string.h>
+#include <vector>
+#include <algorithm>
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/AppearanceNode.h>
+#include <SceneGraph/ShapeNode.h>
+#include <SceneGraph/GLRenderState.h>
 
 namespace SceneGraph {
 
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class ShapeAppearanceOrder // Functor class to order shape nodes by their appearance nodes
+	{
+	/* Methods: */
+	public:
+	bool operator()(const ShapeNode* shape1,const ShapeNode* shape2) const
+		{
+		return shape1->appearance.getValue().getPointer()<shape2->appearance.getValue().getPointer();
+		}
+	};
+
+}
+
 /**************************
 Methods of class GroupNode:
 **************************/
@@ -161,9 +184,30 @@ Box GroupNode::calcBoundingBox(void) const
 
 void GroupNode::glRenderAction(GLRenderState& renderState) const
 	{
-	/* Call the render actions of all children in order: */
-	for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
-		(*chIt)->glRenderAction(renderState);
+	if(renderState.sortShapes)
+		{
+		/* Call the render actions of all non-shape children in order, and collect the shape children: */
+		std::vector<const ShapeNode*> shapes;
+		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+			{
+			const ShapeNode* shape=dynamic_cast<const ShapeNode*>(chIt->getPointer());
+			if(shape!=0)
+				shapes.push_back(shape);
+			else
+				(*chIt)->glRenderAction(renderState);
+			}
+		
+		/* Call the render actions of all shape children grouped by appearance to avoid redundant state changes: */
+		std::stable_sort(shapes.begin(),shapes.end(),ShapeAppearanceOrder());
+		for(std::vector<const ShapeNode*>::iterator sIt=shapes.begin();sIt!=shapes.end();++sIt)
+			(*sIt)->glRenderAction(renderState);
+		}
+	else
+		{
+		/* Call the render actions of all children in order: */
+		for(MFGraphNode::ValueList::const_iterator chIt=children.getValues().begin();chIt!=children.getValues().end();++chIt)
+			(*chIt)->glRenderAction(renderState);
+		}
 	}
 
 }
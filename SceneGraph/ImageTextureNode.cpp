@@ -25,7 +25,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/gl.h>
 #include <GL/GLContextData.h>
 #include <Images/RGBImage.h>
-#include <Images/ReadImageFile.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
 
@@ -37,13 +36,18 @@ Methods of class ImageTextureNode::DataItem:
 
 ImageTextureNode::DataItem::DataItem(void)
 	:textureObjectId(0),
-	 version(0)
+	 version(0),numUploadedLevels(0),numUploadedRows(0),
+	 uploadImage(0)
 	{
 	glGenTextures(1,&textureObjectId);
 	}
 
 ImageTextureNode::DataItem::~DataItem(void)
 	{
+	/* Unlock the decoded texture image if the texture object was still being uploaded: */
+	if(uploadImage!=0)
+		TextureImageCache::getTheCache().finishUpload(uploadImage);
+	
 	glDeleteTextures(1,&textureObjectId);
 	}
 
@@ -53,8 +57,15 @@ Methods of class ImageTextureNode:
 
 ImageTextureNode::ImageTextureNode(void)
 	:repeatS(true),repeatT(true),
-	 version(0)
+	 version(0),image(0)
+	{
+	}
+
+ImageTextureNode::~ImageTextureNode(void)
 	{
+	/* Release the texture image: */
+	if(image!=0)
+		TextureImageCache::getTheCache().releaseImage(image);
 	}
 
 const char* ImageTextureNode::getStaticClassName(void)
@@ -93,38 +104,129 @@ void ImageTextureNode::update(void)
 	{
 	/* Bump up the texture's version number: */
 	++version;
+	
+	/* Request the texture image from the image cache, which starts decoding it in the background: */
+	const TextureImageCache::Image* oldImage=image;
+	if(url.getNumValues()>0)
+		image=TextureImageCache::getTheCache().requestImage(url.getValue(0));
+	else
+		image=0;
+	
+	/* Release the previous texture image: */
+	if(oldImage!=0)
+		TextureImageCache::getTheCache().releaseImage(oldImage);
 	}
 
 void ImageTextureNode::setGLState(GLRenderState& renderState) const
 	{
-	if(url.getNumValues()>0)
+	if(image!=0)
 		{
-		/* Enable 2D textures: */
-		renderState.enableTexture2D();
-		
 		/* Get the data item: */
 		DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
 		
-		/* Bind the texture object: */
-		glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectId);
-		
 		/* Check if the texture object needs to be updated: */
 		if(dataItem->version!=version)
 			{
-			/* Load the texture image: */
-			Images::RGBImage texture=Images::readImageFile(url.getValue(0).c_str());
+			/* Unlock a previous texture image that was not completely uploaded: */
+			if(dataItem->uploadImage!=0)
+				{
+				TextureImageCache::getTheCache().finishUpload(dataItem->uploadImage);
+				dataItem->uploadImage=0;
+				}
 			
-			/* Upload the texture image: */
-			texture.glTexImage2D(GL_TEXTURE_2D,0,GL_RGB8,false);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,0);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,repeatS.getValue()?GL_REPEAT:GL_CLAMP);
-			glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,repeatT.getValue()?GL_REPEAT:GL_CLAMP);
+			/* Lock the decoded texture image for uploading if it is available: */
+			if(TextureImageCache::getTheCache().startUpload(image))
+				{
+				unsigned int numLevels=image->getNumLevels();
+				
+				/* Bind the texture object: */
+				renderState.bindTexture2D(dataItem->textureObjectId);
+				
+				/* Allocate all mipmap levels of the texture image without uploading any data: */
+				for(unsigned int level=0;level<numLevels;++level)
+					{
+					const Images::RGBImage& texture=image->getLevel(level);
+					glTexImage2D(GL_TEXTURE_2D,level,GL_RGB8,texture.getWidth(),texture.getHeight(),0,GL_RGB,GL_UNSIGNED_BYTE,0);
+					}
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_BASE_LEVEL,0);
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAX_LEVEL,numLevels-1);
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR_MIPMAP_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,repeatS.getValue()?GL_REPEAT:GL_CLAMP);
+				glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,repeatT.getValue()?GL_REPEAT:GL_CLAMP);
+				dataItem->numUploadedLevels=0;
+				dataItem->numUploadedRows=0;
+				dataItem->uploadImage=image;
+				
+				/* Mark the texture object as up-to-date: */
+				dataItem->version=version;
+				}
+			}
+		
+		if(dataItem->version==version)
+			{
+			/* Bind the texture object: */
+			renderState.bindTexture2D(dataItem->textureObjectId);
 			
-			/* Mark the texture object as up-to-date: */
-			dataItem->version=version;
+			if(dataItem->uploadImage!=0)
+				{
+				unsigned int numLevels=image->getNumLevels();
+				
+				glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+				glPixelStorei(GL_UNPACK_SKIP_PIXELS,0);
+				glPixelStorei(GL_UNPACK_ROW_LENGTH,0);
+				glPixelStorei(GL_UNPACK_SKIP_ROWS,0);
+				
+				/* Upload as many image rows as the rendering pass' upload budget allows, but at least one: */
+				bool firstChunk=true;
+				while(dataItem->numUploadedLevels<numLevels)
+					{
+					const Images::RGBImage& texture=image->getLevel(dataItem->numUploadedLevels);
+					size_t rowSize=size_t(texture.getWidth())*3;
+					if(!firstChunk&&renderState.textureUploadBudget<rowSize)
+						break;
+					unsigned int numRows=texture.getHeight()-dataItem->numUploadedRows;
+					if(size_t(numRows)*rowSize>renderState.textureUploadBudget)
+						numRows=renderState.textureUploadBudget>=rowSize?(unsigned int)(renderState.textureUploadBudget/rowSize):1U;
+					glTexSubImage2D(GL_TEXTURE_2D,dataItem->numUploadedLevels,0,dataItem->numUploadedRows,texture.getWidth(),numRows,GL_RGB,GL_UNSIGNED_BYTE,texture.getPixels()+size_t(dataItem->numUploadedRows)*texture.getWidth());
+					dataItem->numUploadedRows+=numRows;
+					if(renderState.textureUploadBudget>size_t(numRows)*rowSize)
+						renderState.textureUploadBudget-=size_t(numRows)*rowSize;
+					else
+						renderState.textureUploadBudget=0;
+					firstChunk=false;
+					
+					/* Go to the next mipmap level if the current one is complete: */
+					if(dataItem->numUploadedRows==texture.getHeight())
+						{
+						++dataItem->numUploadedLevels;
+						dataItem->numUploadedRows=0;
+						}
+					}
+				
+				/* Unlock the decoded texture image once the entire mipmap pyramid has been uploaded: */
+				if(dataItem->numUploadedLevels==numLevels)
+					{
+					TextureImageCache::getTheCache().finishUpload(dataItem->uploadImage);
+					dataItem->uploadImage=0;
+					}
+				}
+			
+			if(dataItem->uploadImage==0)
+				{
+				/* Enable 2D textures: */
+				renderState.enableTexture2D();
+				}
+			else
+				{
+				/* Render untextured until the entire mipmap pyramid has been uploaded: */
+				renderState.disableTextures();
+				}
+			}
+		else
+			{
+			/* Render untextured until the texture image has been decoded: */
+			renderState.disableTextures();
 			}
 		}
 	else
@@ -136,13 +238,7 @@ void ImageTextureNode::setGLState(GLRenderState& renderState) const
 
 void ImageTextureNode::resetGLState(GLRenderState& renderState) const
 	{
-	if(url.getNumValues()>0)
-		{
-		/* Unbind the texture object: */
-		glBindTexture(GL_TEXTURE_2D,0);
-		}
-	
-	/* Don't do anything else; next guy cleans up */
+	/* Don't do anything; the render state keeps track of the bound texture object, and next guy cleans up */
 	}
 
 void ImageTextureNode::initContext(GLContextData& contextData) const
@@ -26,6 +26,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/TextureNode.h>
+#include <SceneGraph/TextureImageCache.h>
 
 namespace SceneGraph {
 
@@ -38,6 +39,9 @@ class ImageTextureNode:public TextureNode,public GLObject
 		/* Elements: */
 		GLuint textureObjectId; // ID of texture object
 		unsigned int version; // Version of texture in texture object
+		unsigned int numUploadedLevels; // Number of mipmap levels already completely uploaded into the texture object
+		unsigned int numUploadedRows; // Number of image rows of the next mipmap level already uploaded into the texture object
+		const TextureImageCache::Image* uploadImage; // Texture image whose decoded levels are locked while they are uploaded into the texture object, or null if the texture object is complete
 		
 		/* Constructors and destructors: */
 		DataItem(void);
@@ -55,10 +59,12 @@ class ImageTextureNode:public TextureNode,public GLObject
 	/* Derived state: */
 	protected:
 	unsigned int version; // Version number of texture
+	const TextureImageCache::Image* image; // Texture image in the process-wide image cache, or null if there is no texture image
 	
 	/* Constructors and destructors: */
 	public:
 	ImageTextureNode(void); // Creates a default image texture node with no texture image
+	virtual ~ImageTextureNode(void); // Releases the node's texture image
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
@@ -23,16 +23,68 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/IndexedFaceSetNode.h>
 
 #include <string.h>
+#include <Math/Math.h>
 #include <GL/gl.h>
 #include <GL/GLContextData.h>
 #include <GL/GLExtensionManager.h>
 #include <GL/Extensions/GLARBVertexBufferObject.h>
 #include <GL/GLGeometryVertex.h>
+#include <Threads/TaskScheduler.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/VertexCacheOptimizer.h>
 
 namespace SceneGraph {
 
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+class CornerNormalGenerator // Functor class to generate smooth normal vectors for the corners of a range of faces
+	{
+	/* Elements: */
+	private:
+	const std::vector<int>& coordIndices; // Face vertex indices of the face set
+	const std::vector<size_t>& faceStarts; // Index of each face's first corner
+	const std::vector<size_t>& faceEnds; // Index one past each face's last valid corner
+	const std::vector<Vector>& faceNormals; // Normal vector of each face
+	const std::vector<size_t>& pointFaceOffsets; // Offsets of each point's faces in the point face list
+	const std::vector<size_t>& pointFaces; // List of faces sharing each point
+	Scalar cosCreaseAngle; // Cosine of the crease angle
+	std::vector<Vector>& cornerNormals; // Generated normal vector for each corner, parallel to the face vertex index list
+	
+	/* Constructors and destructors: */
+	public:
+	CornerNormalGenerator(const std::vector<int>& sCoordIndices,const std::vector<size_t>& sFaceStarts,const std::vector<size_t>& sFaceEnds,const std::vector<Vector>& sFaceNormals,const std::vector<size_t>& sPointFaceOffsets,const std::vector<size_t>& sPointFaces,Scalar sCosCreaseAngle,std::vector<Vector>& sCornerNormals)
+		:coordIndices(sCoordIndices),faceStarts(sFaceStarts),faceEnds(sFaceEnds),faceNormals(sFaceNormals),
+		 pointFaceOffsets(sPointFaceOffsets),pointFaces(sPointFaces),
+		 cosCreaseAngle(sCosCreaseAngle),cornerNormals(sCornerNormals)
+		{
+		}
+	
+	/* Methods: */
+	void operator()(size_t rangeBegin,size_t rangeEnd) const
+		{
+		for(size_t face=rangeBegin;face<rangeEnd;++face)
+			for(size_t i=faceStarts[face];i<faceEnds[face];++i)
+				{
+				/* Average this face's normal vector and those of all other faces sharing the point that do not form a crease with this face: */
+				int coordIndex=coordIndices[i];
+				Vector normal=faceNormals[face];
+				for(size_t pf=pointFaceOffsets[coordIndex];pf<pointFaceOffsets[coordIndex+1];++pf)
+					if(pointFaces[pf]!=face&&faceNormals[pointFaces[pf]]*faceNormals[face]>=cosCreaseAngle)
+						normal+=faceNormals[pointFaces[pf]];
+				if(Geometry::sqr(normal)!=Scalar(0))
+					normal.normalize();
+				cornerNormals[i]=normal;
+				}
+		}
+	};
+
+}
+
 /*********************************************
 Methods of class IndexedFaceSetNode::DataItem:
 *********************************************/
@@ -68,22 +120,289 @@ IndexedFaceSetNode::DataItem::~DataItem(void)
 Methods of class IndexedFaceSetNode:
 ***********************************/
 
+void IndexedFaceSetNode::triangulate(void)
+	{
+	meshVertices.clear();
+	meshIndices.clear();
+	if(coord.getValue()==0)
+		return;
+	
+	const std::vector<Point>& points=coord.getValue()->point.getValues();
+	const std::vector<int>& coordIndices=coordIndex.getValues();
+	int numPoints=int(points.size());
+	
+	/* Find all faces and calculate their normal vectors; faces with invalid vertex indices get no corners: */
+	std::vector<size_t> faceStarts;
+	std::vector<size_t> faceEnds;
+	std::vector<Vector> faceNormals;
+	size_t faceStart=0;
+	for(size_t i=0;i<=coordIndices.size();++i)
+		if(i==coordIndices.size()||coordIndices[i]<0)
+			{
+			if(i==coordIndices.size()&&faceStart==i)
+				break;
+			
+			/* Check the face's vertex indices: */
+			bool valid=i-faceStart>=3;
+			for(size_t j=faceStart;j<i&&valid;++j)
+				valid=coordIndices[j]<numPoints;
+			
+			/* Calculate the face's normal vector using Newell's method: */
+			Vector normal=Vector::zero;
+			if(valid)
+				{
+				const Point& p0=points[coordIndices[faceStart]];
+				for(size_t j=faceStart+2;j<i;++j)
+					normal+=Geometry::cross(points[coordIndices[j-1]]-p0,points[coordIndices[j]]-p0);
+				if(Geometry::sqr(normal)!=Scalar(0))
+					normal.normalize();
+				if(!ccw.getValue())
+					normal=-normal;
+				}
+			
+			faceStarts.push_back(faceStart);
+			faceEnds.push_back(valid?i:faceStart);
+			faceNormals.push_back(normal);
+			faceStart=i+1;
+			}
+	size_t numFaces=faceStarts.size();
+	
+	/* Create lists of the faces sharing each point to generate smooth normal vectors: */
+	bool generateNormals=normal.getValue()==0;
+	std::vector<size_t> pointFaceOffsets;
+	std::vector<size_t> pointFaces;
+	if(generateNormals)
+		{
+		pointFaceOffsets.resize(numPoints+1,0);
+		for(size_t face=0;face<numFaces;++face)
+			for(size_t i=faceStarts[face];i<faceEnds[face];++i)
+				++pointFaceOffsets[coordIndices[i]+1];
+		for(int i=0;i<numPoints;++i)
+			pointFaceOffsets[i+1]+=pointFaceOffsets[i];
+		pointFaces.resize(pointFaceOffsets[numPoints]);
+		std::vector<size_t> fillOffsets(pointFaceOffsets.begin(),pointFaceOffsets.end()-1);
+		for(size_t face=0;face<numFaces;++face)
+			for(size_t i=faceStarts[face];i<faceEnds[face];++i)
+				pointFaces[fillOffsets[coordIndices[i]]++]=face;
+		}
+	
+	/* Generate the normal vectors of all face corners, in parallel if a task scheduler is set: */
+	std::vector<Vector> cornerNormals;
+	if(generateNormals)
+		{
+		cornerNormals.resize(coordIndices.size());
+		CornerNormalGenerator cornerNormalGenerator(coordIndices,faceStarts,faceEnds,faceNormals,pointFaceOffsets,pointFaces,Math::cos(creaseAngle.getValue()),cornerNormals);
+		if(taskScheduler!=0)
+			taskScheduler->parallelFor(0,numFaces,taskScheduler->calcGrainSize(numFaces,1024),cornerNormalGenerator);
+		else
+			cornerNormalGenerator(0,numFaces);
+		}
+	
+	/* Calculate the parameters of the default texture mapping: */
+	Box bbox=coord.getValue()->calcBoundingBox();
+	int sDim=0;
+	for(int i=1;i<3;++i)
+		if(bbox.getSize(sDim)<bbox.getSize(i))
+			sDim=i;
+	int tDim=sDim==0?1:0;
+	for(int i=0;i<3;++i)
+		if(i!=sDim&&bbox.getSize(tDim)<bbox.getSize(i))
+			tDim=i;
+	Scalar texScale=bbox.getSize(sDim)>Scalar(0)?Scalar(1)/bbox.getSize(sDim):Scalar(1);
+	
+	/* Create a unique vertex for each distinct combination of corner attributes: */
+	std::vector<int> firstPointVertex(numPoints,-1); // Index of the first vertex created for each point
+	std::vector<int> nextPointVertex; // Index of the next vertex created for the same point
+	std::vector<GLuint> faceVertices;
+	for(size_t face=0;face<numFaces;++face)
+		{
+		faceVertices.clear();
+		for(size_t i=faceStarts[face];i<faceEnds[face];++i)
+			{
+			MeshVertex v;
+			v.coordIndex=coordIndices[i];
+			
+			/* Get the corner's color index: */
+			v.colorIndex=-1;
+			if(color.getValue()!=0)
+				{
+				size_t ci=colorPerVertex.getValue()?i:face;
+				if(colorIndex.getNumValues()==0)
+					v.colorIndex=colorPerVertex.getValue()?v.coordIndex:int(face);
+				else if(ci<colorIndex.getNumValues())
+					v.colorIndex=colorIndex.getValue(ci);
+				if(v.colorIndex>=int(color.getValue()->color.getNumValues()))
+					v.colorIndex=-1;
+				}
+			
+			/* Get the corner's texture coordinate: */
+			if(texCoord.getValue()!=0)
+				{
+				int tci=texCoordIndex.getNumValues()==0?v.coordIndex:(i<texCoordIndex.getNumValues()?texCoordIndex.getValue(i):-1);
+				if(tci>=0&&tci<int(texCoord.getValue()->point.getNumValues()))
+					v.texCoord=texCoord.getValue()->point.getValue(tci);
+				else
+					v.texCoord=TexCoord::origin;
+				}
+			else
+				{
+				const Point& p=points[v.coordIndex];
+				v.texCoord=TexCoord((p[sDim]-bbox.min[sDim])*texScale,(p[tDim]-bbox.min[tDim])*texScale);
+				}
+			
+			/* Get the corner's normal vector: */
+			if(generateNormals)
+				v.normal=cornerNormals[i];
+			else
+				{
+				size_t ni=normalPerVertex.getValue()?i:face;
+				int nIndex=-1;
+				if(normalIndex.getNumValues()==0)
+					nIndex=normalPerVertex.getValue()?v.coordIndex:int(face);
+				else if(ni<normalIndex.getNumValues())
+					nIndex=normalIndex.getValue(ni);
+				if(nIndex>=0&&nIndex<int(normal.getValue()->vector.getNumValues()))
+					v.normal=Geometry::normalize(normal.getValue()->vector.getValue(nIndex));
+				else
+					v.normal=faceNormals[face];
+				}
+			
+			/* Find an existing vertex with the same attributes: */
+			int vertexIndex;
+			for(vertexIndex=firstPointVertex[v.coordIndex];vertexIndex>=0;vertexIndex=nextPointVertex[vertexIndex])
+				{
+				const MeshVertex& mv=meshVertices[vertexIndex];
+				if(mv.colorIndex==v.colorIndex&&mv.texCoord==v.texCoord&&mv.normal==v.normal)
+					break;
+				}
+			if(vertexIndex<0)
+				{
+				/* Create a new vertex: */
+				vertexIndex=int(meshVertices.size());
+				meshVertices.push_back(v);
+				nextPointVertex.push_back(firstPointVertex[v.coordIndex]);
+				firstPointVertex[v.coordIndex]=vertexIndex;
+				}
+			faceVertices.push_back(GLuint(vertexIndex));
+			}
+		
+		/* Triangulate the face as a triangle fan: */
+		for(size_t i=2;i<faceVertices.size();++i)
+			{
+			meshIndices.push_back(faceVertices[0]);
+			if(ccw.getValue())
+				{
+				meshIndices.push_back(faceVertices[i-1]);
+				meshIndices.push_back(faceVertices[i]);
+				}
+			else
+				{
+				meshIndices.push_back(faceVertices[i]);
+				meshIndices.push_back(faceVertices[i-1]);
+				}
+			}
+		}
+	
+	if(optimizeMesh.getValue())
+		{
+		/* Reorder the triangles for the post-transform vertex cache: */
+		optimizeTriangleOrder(meshIndices,GLuint(meshVertices.size()));
+		
+		/* Reorder the vertices in order of first use for vertex fetch locality: */
+		std::vector<GLuint> vertexOrder;
+		optimizeVertexOrder(meshIndices,GLuint(meshVertices.size()),vertexOrder);
+		std::vector<MeshVertex> orderedVertices;
+		orderedVertices.reserve(vertexOrder.size());
+		for(std::vector<GLuint>::const_iterator voIt=vertexOrder.begin();voIt!=vertexOrder.end();++voIt)
+			orderedVertices.push_back(meshVertices[*voIt]);
+		meshVertices.swap(orderedVertices);
+		}
+	}
+
 void IndexedFaceSetNode::uploadColoredFaceSet(DataItem* dataItem) const
 	{
 	/* Define the vertex type used in the vertex array: */
 	typedef GLGeometry::Vertex<Scalar,2,Scalar,4,Scalar,Scalar,3> Vertex;
+	
+	/* Bail out if the face set is empty: */
+	dataItem->numVertexIndices=GLsizei(meshIndices.size());
+	if(meshIndices.empty())
+		return;
+	
+	/* Initialize the vertex buffer object: */
+	glBufferDataARB(GL_ARRAY_BUFFER_ARB,meshVertices.size()*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
+	
+	/* Store all vertices: */
+	const std::vector<Point>& points=coord.getValue()->point.getValues();
+	Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
+	for(std::vector<MeshVertex>::const_iterator mvIt=meshVertices.begin();mvIt!=meshVertices.end();++mvIt,++vPtr)
+		{
+		vPtr->texCoord=Vertex::TexCoord(mvIt->texCoord.getComponents());
+		if(mvIt->colorIndex>=0)
+			vPtr->color=Vertex::Color(color.getValue()->color.getValue(mvIt->colorIndex));
+		else
+			vPtr->color=Vertex::Color(1.0f,1.0f,1.0f);
+		const Point& p=points[mvIt->coordIndex];
+		if(pointTransform.getValue()!=0)
+			{
+			vPtr->normal=Vertex::Normal(pointTransform.getValue()->transformNormal(p,mvIt->normal));
+			vPtr->position=Vertex::Position(pointTransform.getValue()->transformPoint(p));
+			}
+		else
+			{
+			vPtr->normal=Vertex::Normal(mvIt->normal);
+			vPtr->position=Vertex::Position(p);
+			}
+		}
+	glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+	
+	/* Store all triangle vertex indices in the index buffer object: */
+	glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,meshIndices.size()*sizeof(GLuint),&meshIndices[0],GL_STATIC_DRAW_ARB);
 	}
 
 void IndexedFaceSetNode::uploadFaceSet(DataItem* dataItem) const
 	{
 	/* Define the vertex type used in the vertex array: */
 	typedef GLGeometry::Vertex<Scalar,2,void,0,Scalar,Scalar,3> Vertex;
+	
+	/* Bail out if the face set is empty: */
+	dataItem->numVertexIndices=GLsizei(meshIndices.size());
+	if(meshIndices.empty())
+		return;
+	
+	/* Initialize the vertex buffer object: */
+	glBufferDataARB(GL_ARRAY_BUFFER_ARB,meshVertices.size()*sizeof(Vertex),0,GL_STATIC_DRAW_ARB);
+	
+	/* Store all vertices: */
+	const std::vector<Point>& points=coord.getValue()->point.getValues();
+	Vertex* vPtr=static_cast<Vertex*>(glMapBufferARB(GL_ARRAY_BUFFER_ARB,GL_WRITE_ONLY_ARB));
+	for(std::vector<MeshVertex>::const_iterator mvIt=meshVertices.begin();mvIt!=meshVertices.end();++mvIt,++vPtr)
+		{
+		vPtr->texCoord=Vertex::TexCoord(mvIt->texCoord.getComponents());
+		const Point& p=points[mvIt->coordIndex];
+		if(pointTransform.getValue()!=0)
+			{
+			vPtr->normal=Vertex::Normal(pointTransform.getValue()->transformNormal(p,mvIt->normal));
+			vPtr->position=Vertex::Position(pointTransform.getValue()->transformPoint(p));
+			}
+		else
+			{
+			vPtr->normal=Vertex::Normal(mvIt->normal);
+			vPtr->position=Vertex::Position(p);
+			}
+		}
+	glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+	
+	/* Store all triangle vertex indices in the index buffer object: */
+	glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,meshIndices.size()*sizeof(GLuint),&meshIndices[0],GL_STATIC_DRAW_ARB);
 	}
 
 IndexedFaceSetNode::IndexedFaceSetNode(void)
 	:colorPerVertex(true),normalPerVertex(true),
 	 ccw(true),convex(true),solid(true),
-	 version(0)
+	 creaseAngle(Scalar(0)),optimizeMesh(true),
+	 version(0),
+	 taskScheduler(0)
 	{
 	}
 
@@ -155,12 +474,19 @@ void IndexedFaceSetNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		{
 		vrmlFile.parseField(creaseAngle);
 		}
+	else if(strcmp(fieldName,"optimizeMesh")==0)
+		{
+		vrmlFile.parseField(optimizeMesh);
+		}
 	else
 		GeometryNode::parseField(fieldName,vrmlFile);
 	}
 
 void IndexedFaceSetNode::update(void)
 	{
+	/* Triangulate the face set once for all OpenGL contexts: */
+	triangulate();
+	
 	/* Bump up the indexed face set's version number: */
 	++version;
 	}
@@ -199,8 +525,8 @@ void IndexedFaceSetNode::glRenderAction(GLRenderState& renderState) const
 		typedef GLGeometry::Vertex<Scalar,2,void,0,Scalar,Scalar,3> Vertex;
 		
 		/* Bind the face set's vertex and index buffer objects: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->indexBufferObjectId);
+		renderState.bindVertexBuffer(dataItem->vertexBufferObjectId);
+		renderState.bindIndexBuffer(dataItem->indexBufferObjectId);
 		
 		if(dataItem->version!=version)
 			{
@@ -218,27 +544,17 @@ void IndexedFaceSetNode::glRenderAction(GLRenderState& renderState) const
 		/* Set up the vertex arrays: */
 		if(color.getValue()!=0)
 			{
-			GLVertexArrayParts::enable(ColorVertex::getPartsMask());
+			renderState.enableVertexArrays(ColorVertex::getPartsMask());
 			glVertexPointer(static_cast<ColorVertex*>(0));
 			}
 		else
 			{
-			GLVertexArrayParts::enable(Vertex::getPartsMask());
+			renderState.enableVertexArrays(Vertex::getPartsMask());
 			glVertexPointer(static_cast<Vertex*>(0));
 			}
 		
 		/* Draw the indexed face set: */
 		glDrawElements(GL_TRIANGLES,dataItem->numVertexIndices,GL_UNSIGNED_INT,static_cast<const GLuint*>(0));
-		
-		/* Disable the vertex arrays: */
-		if(color.getValue()!=0)
-			GLVertexArrayParts::disable(ColorVertex::getPartsMask());
-		else
-			GLVertexArrayParts::disable(Vertex::getPartsMask());
-		
-		/* Protect the buffers: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
 		}
 	else
 		{
@@ -274,4 +590,9 @@ void IndexedFaceSetNode::initContext(GLContextData& contextData) const
 		}
 	}
 
+void IndexedFaceSetNode::setTaskScheduler(Threads::TaskScheduler* newTaskScheduler)
+	{
+	taskScheduler=newTaskScheduler;
+	}
+
 }
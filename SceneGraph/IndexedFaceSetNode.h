@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #ifndef SCENEGRAPH_INDEXEDFACESETNODE_INCLUDED
 #define SCENEGRAPH_INDEXEDFACESETNODE_INCLUDED
 
+#include <vector>
 #include <GL/gl.h>
 #include <GL/GLObject.h>
 #include <SceneGraph/FieldTypes.h>
@@ -32,6 +33,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/NormalNode.h>
 #include <SceneGraph/TextureCoordinateNode.h>
 
+/* Forward declarations: */
+namespace Threads {
+class TaskScheduler;
+}
+
 namespace SceneGraph {
 
 class IndexedFaceSetNode:public GeometryNode,public GLObject
@@ -58,6 +64,16 @@ class IndexedFaceSetNode:public GeometryNode,public GLObject
 		virtual ~DataItem(void);
 		};
 	
+	struct MeshVertex // Structure for unique vertices of the triangulated face set
+		{
+		/* Elements: */
+		public:
+		int coordIndex; // Index of the vertex' position in the coordinate node
+		int colorIndex; // Index of the vertex' color in the color node, or -1 if the vertex has no color
+		TexCoord texCoord; // Vertex' texture coordinate
+		Vector normal; // Vertex' normal vector, from the normal node or generated according to the crease angle
+		};
+	
 	/* Elements: */
 	
 	/* Fields: */
@@ -76,13 +92,18 @@ class IndexedFaceSetNode:public GeometryNode,public GLObject
 	SFBool convex;
 	SFBool solid;
 	SFFloat creaseAngle;
+	SFBool optimizeMesh; // Non-standard field to reorder the triangulated face set for vertex cache and vertex fetch locality
 	
 	/* Derived state: */
 	protected:
 	unsigned int version; // Version number of face set
+	std::vector<MeshVertex> meshVertices; // Unique vertices of the triangulated face set, shared by all OpenGL contexts
+	std::vector<GLuint> meshIndices; // Vertex index triples of the triangulated face set
+	Threads::TaskScheduler* taskScheduler; // Task scheduler to generate normal vectors in parallel, or null
 	
 	/* Protected methods: */
 	protected:
+	void triangulate(void); // Triangulates the face set into unique vertices and triangles, optionally reordered for vertex cache locality
 	void uploadFaceSet(DataItem* dataItem) const; // Uploads new face set into OpenGL buffers
 	void uploadColoredFaceSet(DataItem* dataItem) const; // Uploads new face set with per-vertex or per-face colors into OpenGL buffers
 	
@@ -102,6 +123,9 @@ class IndexedFaceSetNode:public GeometryNode,public GLObject
 	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	void setTaskScheduler(Threads::TaskScheduler* newTaskScheduler); // Sets a task scheduler to generate normal vectors in parallel; null generates them in the calling thread
 	};
 
 }
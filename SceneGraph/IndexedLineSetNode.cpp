@@ -302,7 +302,7 @@ void IndexedLineSetNode::glRenderAction(GLRenderState& renderState) const
 		typedef GLGeometry::Vertex<void,0,void,0,void,Scalar,3> Vertex;
 		
 		/* Bind the line set's vertex buffer object: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+		renderState.bindVertexBuffer(dataItem->vertexBufferObjectId);
 		
 		if(dataItem->version!=version)
 			{
@@ -319,12 +319,12 @@ void IndexedLineSetNode::glRenderAction(GLRenderState& renderState) const
 		/* Set up the vertex array: */
 		if(color.getValue()!=0)
 			{
-			GLVertexArrayParts::enable(ColorVertex::getPartsMask());
+			renderState.enableVertexArrays(ColorVertex::getPartsMask());
 			glVertexPointer(static_cast<ColorVertex*>(0));
 			}
 		else
 			{
-			GLVertexArrayParts::enable(Vertex::getPartsMask());
+			renderState.enableVertexArrays(Vertex::getPartsMask());
 			glVertexPointer(static_cast<Vertex*>(0));
 			
 			/* Use the current emissive color: */
@@ -344,15 +344,6 @@ void IndexedLineSetNode::glRenderAction(GLRenderState& renderState) const
 			/* Go to the next line: */
 			baseVertexIndex+=*nvIt;
 			}
-		
-		/* Disable the vertex array: */
-		if(color.getValue()!=0)
-			GLVertexArrayParts::disable(ColorVertex::getPartsMask());
-		else
-			GLVertexArrayParts::disable(Vertex::getPartsMask());
-		
-		/* Protect the buffer: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
 		}
 	else
 		{
@@ -0,0 +1,185 @@
+/***********************************************************************
+InlineFileCache - Class to share the scene graphs of inlined VRML files
+between all inline nodes in a process, and to load them in parallel.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/InlineFileCache.h>
+
+#include <pthread.h>
+#include <stdexcept>
+#include <Misc/FileCharacterSource.h>
+#include <SceneGraph/NodeCreator.h>
+#include <SceneGraph/VRMLFile.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+const pthread_mutexattr_t* getRecursiveMutexAttribute(void) // Returns attributes for mutexes that can be locked repeatedly by the same thread
+	{
+	static pthread_mutexattr_t attribute;
+	static bool initialized=false;
+	if(!initialized)
+		{
+		pthread_mutexattr_init(&attribute);
+		pthread_mutexattr_settype(&attribute,PTHREAD_MUTEX_RECURSIVE);
+		initialized=true;
+		}
+	return &attribute;
+	}
+
+}
+
+/*********************************************
+Methods of class InlineFileCache::SharedGroup:
+*********************************************/
+
+InlineFileCache::SharedGroup::~SharedGroup(void)
+	{
+	/* Remove the group from the cache unless it was replaced after a failed load: */
+	Threads::Mutex::Lock cacheLock(theCache.mutex);
+	GroupMap::Iterator gIt=theCache.groups.findEntry(url);
+	if(!gIt.isFinished()&&gIt->getDest()==this)
+		theCache.groups.removeEntry(gIt);
+	}
+
+/******************************************
+Methods of class InlineFileCache::LoadTask:
+******************************************/
+
+void InlineFileCache::LoadTask::execute(void)
+	{
+	/* Parse the inlined file into a private group outside the lock: */
+	GroupNodePointer root=new GroupNode;
+	std::string error;
+	try
+		{
+		Misc::FileCharacterSource file(group->url.c_str());
+		VRMLFile vrmlFile(group->url,file,nodeCreator);
+		vrmlFile.parseNodes(root);
+		}
+	catch(const std::runtime_error& err)
+		{
+		error=err.what();
+		}
+	catch(...)
+		{
+		/* Record any other failure as well, so that the group is released and the load error is reported: */
+		error="InlineFileCache: Unknown error while loading inlined file "+group->url;
+		}
+	
+	Threads::Mutex::Lock cacheLock(theCache.mutex);
+	if(error.empty())
+		{
+		/* Move the parsed nodes into the shared group: */
+		group->children.getValues().swap(root->children.getValues());
+		group->update();
+		}
+	else
+		{
+		/* Report the error, and remove the group from the cache so that the file is loaded again on the next request: */
+		theCache.loadErrors.push_back(error);
+		GroupMap::Iterator gIt=theCache.groups.findEntry(group->url);
+		if(!gIt.isFinished()&&gIt->getDest()==group)
+			theCache.groups.removeEntry(gIt);
+		}
+	
+	/* Destroy the private group while holding the lock, as it might reference other shared groups: */
+	root=0;
+	
+	/* Release the task's reference to the shared group: */
+	group->unref();
+	}
+
+/****************************************
+Static elements of class InlineFileCache:
+****************************************/
+
+InlineFileCache InlineFileCache::theCache;
+
+/********************************
+Methods of class InlineFileCache:
+********************************/
+
+InlineFileCache::InlineFileCache(void)
+	:mutex(getRecursiveMutexAttribute()),
+	 groups(17)
+	{
+	}
+
+void InlineFileCache::addInlinedFile(GroupNode& parent,const std::string& url,NodeCreator& nodeCreator)
+	{
+	SharedGroup* group;
+	{
+	Threads::Mutex::Lock cacheLock(mutex);
+	
+	/* Share the group if the file has been requested before: */
+	GroupMap::Iterator gIt=groups.findEntry(url);
+	if(!gIt.isFinished())
+		{
+		parent.children.appendValue(GraphNodePointer(gIt->getDest()));
+		return;
+		}
+	
+	/* Create a new shared group: */
+	group=new SharedGroup(url);
+	groups.setEntry(GroupMap::Entry(url,group));
+	parent.children.appendValue(GraphNodePointer(group));
+	group->ref();
+	}
+	
+	/* Load the file on the node creator's task scheduler if it has worker threads, or in the calling thread otherwise: */
+	Threads::TaskScheduler* taskScheduler=nodeCreator.getTaskScheduler();
+	if(taskScheduler!=0&&taskScheduler->getNumWorkers()>0)
+		taskScheduler->submit(new LoadTask(group,nodeCreator),&loadGroup);
+	else
+		{
+		LoadTask loadTask(group,nodeCreator);
+		loadTask.execute();
+		}
+	}
+
+void InlineFileCache::releaseInlinedFiles(GroupNode& parent)
+	{
+	Threads::Mutex::Lock cacheLock(mutex);
+	parent.children.clearValues();
+	}
+
+void InlineFileCache::waitForLoads(Threads::TaskScheduler* taskScheduler)
+	{
+	/* Wait for all queued load tasks, including those queued while waiting; without a task scheduler, all files were loaded immediately: */
+	if(taskScheduler!=0)
+		taskScheduler->wait(loadGroup);
+	
+	/* Report the first error encountered while loading: */
+	std::vector<std::string> errors;
+	{
+	Threads::Mutex::Lock cacheLock(mutex);
+	errors.swap(loadErrors);
+	}
+	if(!errors.empty())
+		throw std::runtime_error(errors.front());
+	}
+
+}
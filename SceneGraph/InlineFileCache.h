@@ -0,0 +1,113 @@
+/***********************************************************************
+InlineFileCache - Class to share the scene graphs of inlined VRML files
+between all inline nodes in a process, and to load them in parallel.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_INLINEFILECACHE_INCLUDED
+#define SCENEGRAPH_INLINEFILECACHE_INCLUDED
+
+#include <string>
+#include <vector>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
+#include <Threads/Mutex.h>
+#include <Threads/TaskScheduler.h>
+#include <SceneGraph/GroupNode.h>
+
+/* Forward declarations: */
+namespace SceneGraph {
+class NodeCreator;
+}
+
+namespace SceneGraph {
+
+class InlineFileCache
+	{
+	/* Embedded classes: */
+	private:
+	class SharedGroup;
+	class LoadTask;
+	
+	friend class SharedGroup;
+	friend class LoadTask;
+	
+	class SharedGroup:public GroupNode // Class for group nodes holding the top-level nodes of inlined files
+		{
+		friend class InlineFileCache;
+		
+		/* Elements: */
+		private:
+		std::string url; // Fully-qualified URL of the inlined file
+		
+		/* Constructors and destructors: */
+		public:
+		SharedGroup(const std::string& sUrl)
+			:url(sUrl)
+			{
+			}
+		virtual ~SharedGroup(void); // Removes the group from the cache
+		};
+	
+	class LoadTask:public Threads::TaskScheduler::Task // Class for tasks loading an inlined file into its shared group
+		{
+		/* Elements: */
+		private:
+		SharedGroup* group; // The shared group; referenced by the task
+		NodeCreator& nodeCreator; // Node creator to parse the inlined file
+		
+		/* Constructors and destructors: */
+		public:
+		LoadTask(SharedGroup* sGroup,NodeCreator& sNodeCreator)
+			:group(sGroup),nodeCreator(sNodeCreator)
+			{
+			}
+		
+		/* Methods from Threads::TaskScheduler::Task: */
+		virtual void execute(void);
+		};
+	
+	typedef Misc::HashTable<std::string,SharedGroup*> GroupMap; // Hash table type to map URLs to shared groups
+	
+	/* Elements: */
+	static InlineFileCache theCache; // The process-wide inline file cache
+	Threads::Mutex mutex; // Recursive mutex protecting the cache's state and the reference counts of all shared groups
+	GroupMap groups; // Map of the shared groups of all live inlined files; does not reference the groups
+	Threads::TaskScheduler::TaskGroup loadGroup; // Group of all load tasks queued on the node creators' task schedulers
+	std::vector<std::string> loadErrors; // Error messages of failed load tasks since the last wait
+	
+	/* Constructors and destructors: */
+	InlineFileCache(void); // Creates an empty cache
+	InlineFileCache(const InlineFileCache& source); // Prohibit copy constructor
+	InlineFileCache& operator=(const InlineFileCache& source); // Prohibit assignment operator
+	
+	/* Methods: */
+	public:
+	static InlineFileCache& getTheCache(void) // Returns the process-wide inline file cache
+		{
+		return theCache;
+		}
+	void addInlinedFile(GroupNode& parent,const std::string& url,NodeCreator& nodeCreator); // Adds the shared group of the given fully-qualified URL to the given group's children; on the first request, queues the file for loading on the node creator's task scheduler, or loads it immediately if the node creator has no worker threads
+	void releaseInlinedFiles(GroupNode& parent); // Removes all children from the given group that was passed to addInlinedFile
+	void waitForLoads(Threads::TaskScheduler* taskScheduler); // Blocks until all queued inlined files are loaded, executing queued tasks on the given scheduler while waiting; throws exception if any of them failed to load
+	};
+
+}
+
+#endif
@@ -23,8 +23,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/InlineNode.h>
 
 #include <string.h>
-#include <Misc/FileCharacterSource.h>
 #include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/InlineFileCache.h>
 
 namespace SceneGraph {
 
@@ -36,6 +36,12 @@ InlineNode::InlineNode(void)
 	{
 	}
 
+InlineNode::~InlineNode(void)
+	{
+	/* Release the shared scene graphs of the external VRML files: */
+	InlineFileCache::getTheCache().releaseInlinedFiles(*this);
+	}
+
 const char* InlineNode::getStaticClassName(void)
 	{
 	return "Inline";
@@ -52,11 +58,9 @@ void InlineNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		{
 		vrmlFile.parseField(url);
 		
-		/* Load the external VRML file: */
-		std::string externalFileName=vrmlFile.getFullUrl(url.getValue(0));
-		Misc::FileCharacterSource externalFile(externalFileName.c_str());
-		SceneGraph::VRMLFile externalVrmlFile(externalFileName,externalFile,vrmlFile.getNodeCreator());
-		externalVrmlFile.parse(this);
+		/* Share the external VRML file's scene graph with all other inline nodes referencing it; it is loaded in the background on the first request: */
+		if(url.getNumValues()>0)
+			InlineFileCache::getTheCache().addInlinedFile(*this,vrmlFile.getFullUrl(url.getValue(0)),vrmlFile.getNodeCreator());
 		}
 	else
 		GroupNode::parseField(fieldName,vrmlFile);
@@ -39,6 +39,7 @@ class InlineNode:public GroupNode
 	/* Constructors and destructors: */
 	public:
 	InlineNode(void); // Creates a default inline node
+	virtual ~InlineNode(void);
 	
 	/* Methods from Node: */
 	static const char* getStaticClassName(void);
@@ -239,7 +239,7 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 			glRotate(transform);
 			
 			/* Draw the label: */
-			glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
+			renderState.bindTexture2D(dataItem->textureObjectIds[i]);
 			glBegin(GL_QUADS);
 			glNormal3f(0.0f,0.0f,1.0f);
 			glTexCoord(stringTexBox[i].getCorner(0));
@@ -255,9 +255,6 @@ void LabelSetNode::glRenderAction(GLRenderState& renderState) const
 			glPopMatrix();
 			}
 		
-		/* Protect the texture objects: */
-		glBindTexture(GL_TEXTURE_2D,0);
-		
 		/* Reset OpenGL state: */
 		glPopAttrib();
 		}
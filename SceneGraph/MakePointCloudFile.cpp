@@ -0,0 +1,562 @@
+/***********************************************************************
+MakePointCloudFile - Program to sort large point clouds into the
+out-of-core multiresolution octree files rendered by PointCloudFileNode.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <float.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/LargeFile.h>
+#include <SceneGraph/PointCloudFile.h>
+
+namespace {
+
+typedef SceneGraph::PointCloudFile::PointRecord PointRecord;
+typedef SceneGraph::PointCloudFile::NodeRecord NodeRecord;
+
+/**************
+Helper classes:
+**************/
+
+struct Cube // Structure for the cubical domains of octree nodes
+	{
+	/* Elements: */
+	public:
+	double min[3]; // Minimum corner of the domain
+	double size; // Edge length of the domain
+	
+	/* Methods: */
+	Cube getOctant(int octantIndex) const // Returns the domain of one of the cube's octants
+		{
+		Cube result;
+		result.size=size*0.5;
+		for(int i=0;i<3;++i)
+			result.min[i]=octantIndex&(0x1<<i)?min[i]+result.size:min[i];
+		return result;
+		}
+	int findOctant(const PointRecord& point) const // Returns the index of the octant containing the given point
+		{
+		int result=0;
+		for(int i=0;i<3;++i)
+			if(double(point.position[i])>=min[i]+size*0.5)
+				result|=0x1<<i;
+		return result;
+		}
+	};
+
+class PointBox // Class to accumulate bounding boxes of point sets
+	{
+	/* Elements: */
+	public:
+	float min[3],max[3];
+	
+	/* Constructors and destructors: */
+	PointBox(void) // Creates an empty box
+		{
+		for(int i=0;i<3;++i)
+			{
+			min[i]=FLT_MAX;
+			max[i]=-FLT_MAX;
+			}
+		}
+	
+	/* Methods: */
+	void addPoint(const PointRecord& point)
+		{
+		for(int i=0;i<3;++i)
+			{
+			if(min[i]>point.position[i])
+				min[i]=point.position[i];
+			if(max[i]<point.position[i])
+				max[i]=point.position[i];
+			}
+		}
+	void store(NodeRecord& node) const // Stores the box in the given node record
+		{
+		for(int i=0;i<3;++i)
+			{
+			node.bboxMin[i]=min[i];
+			node.bboxMax[i]=max[i];
+			}
+		}
+	};
+
+class AxisSplitter // Predicate to partition points along a coordinate axis
+	{
+	/* Elements: */
+	private:
+	int axis; // Index of splitting axis
+	double split; // Splitting value
+	
+	/* Constructors and destructors: */
+	public:
+	AxisSplitter(int sAxis,double sSplit)
+		:axis(sAxis),split(sSplit)
+		{
+		}
+	
+	/* Methods: */
+	bool operator()(const PointRecord& point) const
+		{
+		return double(point.position[axis])<split;
+		}
+	};
+
+class PointCloudBuilder // Class to sort points into an octree file
+	{
+	/* Elements: */
+	private:
+	Misc::LargeFile& outputFile; // The point cloud file being written
+	unsigned int maxNodePoints; // Maximum number of points stored in any interior node
+	unsigned int sampleResolution; // Number of cells per axis of the grid used to subsample node domains
+	size_t maxMemoryPoints; // Maximum number of points sorted in memory
+	unsigned int maxDepth; // Maximum depth of the octree
+	std::string tempFilePrefix; // Prefix for names of temporary point files
+	unsigned int numTempFiles; // Number of temporary point files created so far
+	std::vector<NodeRecord> nodes; // The octree's node table
+	std::vector<unsigned char> sampleGrid; // Occupancy grid to subsample node domains
+	
+	/* Private methods: */
+	void clearSampleGrid(void)
+		{
+		std::fill(sampleGrid.begin(),sampleGrid.end(),(unsigned char)0);
+		}
+	bool samplePoint(const Cube& cube,const PointRecord& point) // Returns true if the given point is the first point in its sample grid cell
+		{
+		size_t cellIndex=0;
+		for(int i=2;i>=0;--i)
+			{
+			int cell=int((double(point.position[i])-cube.min[i])*double(sampleResolution)/cube.size);
+			if(cell<0)
+				cell=0;
+			if(cell>int(sampleResolution)-1)
+				cell=int(sampleResolution)-1;
+			cellIndex=cellIndex*sampleResolution+size_t(cell);
+			}
+		if(sampleGrid[cellIndex]!=0)
+			return false;
+		sampleGrid[cellIndex]=1;
+		return true;
+		}
+	std::string createTempFileName(void) // Returns the name of a new temporary point file
+		{
+		char suffix[32];
+		snprintf(suffix,sizeof(suffix),".%u",numTempFiles);
+		++numTempFiles;
+		return tempFilePrefix+suffix;
+		}
+	unsigned int addChildren(unsigned int nodeIndex,unsigned int numChildren) // Allocates consecutive child nodes for the given node
+		{
+		unsigned int firstChild=nodes.size();
+		nodes[nodeIndex].firstChild=firstChild;
+		nodes[nodeIndex].numChildren=numChildren;
+		NodeRecord child;
+		memset(&child,0,sizeof(NodeRecord));
+		nodes.insert(nodes.end(),numChildren,child);
+		return firstChild;
+		}
+	void buildInMemory(unsigned int nodeIndex,const Cube& cube,PointRecord* points,size_t numPoints,unsigned int depth); // Creates the subtree of the given node from an array of points
+	void buildOutOfCore(unsigned int nodeIndex,const Cube& cube,const std::string& pointFileName,size_t numPoints,unsigned int depth); // Creates the subtree of the given node from a temporary point file, which is deleted
+	
+	/* Constructors and destructors: */
+	public:
+	PointCloudBuilder(Misc::LargeFile& sOutputFile,unsigned int sMaxNodePoints,size_t sMaxMemoryPoints,const std::string& sTempFilePrefix);
+	
+	/* Methods: */
+	void build(const std::string& pointFileName,size_t numPoints,const PointBox& bbox); // Creates the octree from a temporary point file, which is deleted
+	unsigned int getNumNodes(void) const
+		{
+		return nodes.size();
+		}
+	void writeNodeTable(void); // Writes the node table to the end of the output file
+	};
+
+void PointCloudBuilder::buildInMemory(unsigned int nodeIndex,const Cube& cube,PointRecord* points,size_t numPoints,unsigned int depth)
+	{
+	/* Calculate the bounding box of the node's subtree: */
+	PointBox bbox;
+	for(size_t i=0;i<numPoints;++i)
+		bbox.addPoint(points[i]);
+	bbox.store(nodes[nodeIndex]);
+	
+	if(numPoints<=maxNodePoints||depth>=maxDepth)
+		{
+		/* Store all points in a leaf node: */
+		nodes[nodeIndex].numPoints=numPoints;
+		outputFile.write<PointRecord>(points,numPoints);
+		return;
+		}
+	
+	/* Move a uniform subsample of the points to the front of the array: */
+	clearSampleGrid();
+	size_t numSamples=0;
+	for(size_t i=0;i<numPoints&&numSamples<maxNodePoints;++i)
+		if(samplePoint(cube,points[i]))
+			{
+			std::swap(points[numSamples],points[i]);
+			++numSamples;
+			}
+	nodes[nodeIndex].numPoints=numSamples;
+	outputFile.write<PointRecord>(points,numSamples);
+	
+	/* Partition the remaining points into the node's octants: */
+	PointRecord* octants[9];
+	octants[0]=points+numSamples;
+	octants[8]=points+numPoints;
+	double mid[3];
+	for(int i=0;i<3;++i)
+		mid[i]=cube.min[i]+cube.size*0.5;
+	octants[4]=std::partition(octants[0],octants[8],AxisSplitter(2,mid[2]));
+	for(int i=0;i<8;i+=4)
+		{
+		octants[i+2]=std::partition(octants[i],octants[i+4],AxisSplitter(1,mid[1]));
+		for(int j=i;j<i+4;j+=2)
+			octants[j+1]=std::partition(octants[j],octants[j+2],AxisSplitter(0,mid[0]));
+		}
+	
+	/* Create children for all non-empty octants and sort their points recursively: */
+	unsigned int numChildren=0;
+	for(int i=0;i<8;++i)
+		if(octants[i+1]!=octants[i])
+			++numChildren;
+	unsigned int childIndex=addChildren(nodeIndex,numChildren);
+	for(int i=0;i<8;++i)
+		if(octants[i+1]!=octants[i])
+			{
+			buildInMemory(childIndex,cube.getOctant(i),octants[i],octants[i+1]-octants[i],depth+1);
+			++childIndex;
+			}
+	}
+
+void PointCloudBuilder::buildOutOfCore(unsigned int nodeIndex,const Cube& cube,const std::string& pointFileName,size_t numPoints,unsigned int depth)
+	{
+	if(numPoints<=maxMemoryPoints||depth>=maxDepth)
+		{
+		/* Read the points into memory and sort them there: */
+		std::vector<PointRecord> points(numPoints);
+		{
+		Misc::LargeFile pointFile(pointFileName.c_str(),"rb");
+		pointFile.read<PointRecord>(&points[0],numPoints);
+		}
+		unlink(pointFileName.c_str());
+		buildInMemory(nodeIndex,cube,&points[0],numPoints,depth);
+		return;
+		}
+	
+	/* Stream the points, subsample them, and distribute the remaining points to temporary files for the node's octants: */
+	clearSampleGrid();
+	std::vector<PointRecord> samples;
+	samples.reserve(maxNodePoints);
+	PointBox bbox;
+	std::string octantFileNames[8];
+	Misc::LargeFile* octantFiles[8];
+	size_t octantSizes[8];
+	for(int i=0;i<8;++i)
+		{
+		octantFiles[i]=0;
+		octantSizes[i]=0;
+		}
+	try
+		{
+		Misc::LargeFile pointFile(pointFileName.c_str(),"rb");
+		const size_t chunkSize=65536;
+		std::vector<PointRecord> chunk(chunkSize);
+		std::vector<PointRecord> octantBuffers[8];
+		for(size_t chunkStart=0;chunkStart<numPoints;chunkStart+=chunkSize)
+			{
+			size_t numChunkPoints=std::min(chunkSize,numPoints-chunkStart);
+			pointFile.read<PointRecord>(&chunk[0],numChunkPoints);
+			for(size_t i=0;i<numChunkPoints;++i)
+				{
+				bbox.addPoint(chunk[i]);
+				if(samples.size()<maxNodePoints&&samplePoint(cube,chunk[i]))
+					samples.push_back(chunk[i]);
+				else
+					octantBuffers[cube.findOctant(chunk[i])].push_back(chunk[i]);
+				}
+			
+			/* Append the octant buffers to their files: */
+			for(int i=0;i<8;++i)
+				if(!octantBuffers[i].empty())
+					{
+					if(octantFiles[i]==0)
+						{
+						octantFileNames[i]=createTempFileName();
+						octantFiles[i]=new Misc::LargeFile(octantFileNames[i].c_str(),"wb");
+						}
+					octantFiles[i]->write<PointRecord>(&octantBuffers[i][0],octantBuffers[i].size());
+					octantSizes[i]+=octantBuffers[i].size();
+					octantBuffers[i].clear();
+					}
+			}
+		}
+	catch(...)
+		{
+		for(int i=0;i<8;++i)
+			delete octantFiles[i];
+		throw;
+		}
+	
+	/* Close the octant files and delete the node's point file: */
+	for(int i=0;i<8;++i)
+		delete octantFiles[i];
+	unlink(pointFileName.c_str());
+	
+	/* Write the node's point block: */
+	bbox.store(nodes[nodeIndex]);
+	nodes[nodeIndex].numPoints=samples.size();
+	outputFile.write<PointRecord>(&samples[0],samples.size());
+	
+	/* Create children for all non-empty octants and sort their points recursively: */
+	unsigned int numChildren=0;
+	for(int i=0;i<8;++i)
+		if(octantSizes[i]!=0)
+			++numChildren;
+	unsigned int childIndex=addChildren(nodeIndex,numChildren);
+	for(int i=0;i<8;++i)
+		if(octantSizes[i]!=0)
+			{
+			buildOutOfCore(childIndex,cube.getOctant(i),octantFileNames[i],octantSizes[i],depth+1);
+			++childIndex;
+			}
+	}
+
+PointCloudBuilder::PointCloudBuilder(Misc::LargeFile& sOutputFile,unsigned int sMaxNodePoints,size_t sMaxMemoryPoints,const std::string& sTempFilePrefix)
+	:outputFile(sOutputFile),
+	 maxNodePoints(sMaxNodePoints),
+	 sampleResolution(1),
+	 maxMemoryPoints(sMaxMemoryPoints),
+	 maxDepth(32),
+	 tempFilePrefix(sTempFilePrefix),numTempFiles(0)
+	{
+	/* Always sort leaf nodes in memory: */
+	if(maxMemoryPoints<maxNodePoints)
+		maxMemoryPoints=maxNodePoints;
+	
+	/* Choose a sample grid resolution such that a surface crossing a node's domain occupies about as many cells as fit into the node: */
+	while(sampleResolution*sampleResolution*4<=maxNodePoints)
+		sampleResolution*=2;
+	sampleGrid.resize(size_t(sampleResolution)*size_t(sampleResolution)*size_t(sampleResolution));
+	}
+
+void PointCloudBuilder::build(const std::string& pointFileName,size_t numPoints,const PointBox& bbox)
+	{
+	/* Make the root domain a cube enclosing the bounding box: */
+	Cube root;
+	root.size=0.0;
+	for(int i=0;i<3;++i)
+		if(root.size<double(bbox.max[i])-double(bbox.min[i]))
+			root.size=double(bbox.max[i])-double(bbox.min[i]);
+	root.size*=1.0001;
+	if(root.size==0.0)
+		root.size=1.0;
+	for(int i=0;i<3;++i)
+		root.min[i]=(double(bbox.min[i])+double(bbox.max[i])-root.size)*0.5;
+	
+	/* Create the root node and sort the points: */
+	NodeRecord rootNode;
+	memset(&rootNode,0,sizeof(NodeRecord));
+	nodes.push_back(rootNode);
+	buildOutOfCore(0,root,pointFileName,numPoints,0);
+	}
+
+void PointCloudBuilder::writeNodeTable(void)
+	{
+	outputFile.write<NodeRecord>(&nodes[0],nodes.size());
+	}
+
+/****************
+Helper functions:
+****************/
+
+size_t readPointFile(const char* inputFileName,const double offset[3],Misc::LargeFile& pointFile,PointBox& bbox,bool& hasColors) // Appends the points from an ASCII point file to a temporary point file; returns the number of read points
+	{
+	Misc::LargeFile inputFile(inputFileName,"rt");
+	
+	size_t numPoints=0;
+	std::vector<PointRecord> buffer;
+	buffer.reserve(65536);
+	char line[1024];
+	while(inputFile.gets(line,sizeof(line))!=0)
+		{
+		/* Parse up to six numbers separated by whitespace or commas: */
+		double values[6];
+		int numValues=0;
+		char* lPtr=line;
+		while(numValues<6)
+			{
+			while(isspace(*lPtr)||*lPtr==',')
+				++lPtr;
+			char* numEnd;
+			values[numValues]=strtod(lPtr,&numEnd);
+			if(numEnd==lPtr)
+				break;
+			++numValues;
+			lPtr=numEnd;
+			}
+		
+		/* Ignore lines that don't define a point: */
+		if(numValues<3)
+			continue;
+		
+		/* Create a point record: */
+		PointRecord point;
+		for(int i=0;i<3;++i)
+			point.position[i]=float(values[i]-offset[i]);
+		if(numValues==6)
+			{
+			for(int i=0;i<3;++i)
+				point.color[i]=(unsigned char)(values[3+i]<0.0?0:values[3+i]>255.0?255:int(values[3+i]+0.5));
+			hasColors=true;
+			}
+		else
+			{
+			for(int i=0;i<3;++i)
+				point.color[i]=255U;
+			}
+		point.color[3]=255U;
+		bbox.addPoint(point);
+		buffer.push_back(point);
+		
+		/* Flush the buffer if it is full: */
+		if(buffer.size()==buffer.capacity())
+			{
+			pointFile.write<PointRecord>(&buffer[0],buffer.size());
+			numPoints+=buffer.size();
+			buffer.clear();
+			}
+		}
+	if(!buffer.empty())
+		{
+		pointFile.write<PointRecord>(&buffer[0],buffer.size());
+		numPoints+=buffer.size();
+		}
+	
+	return numPoints;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int maxNodePoints=8192;
+	size_t memoryLimit=512;
+	double offset[3]={0.0,0.0,0.0};
+	std::vector<const char*> fileNames;
+	for(int i=1;i<argc;++i)
+		{
+		if(argv[i][0]=='-')
+			{
+			if(strcasecmp(argv[i]+1,"maxPoints")==0&&i+1<argc)
+				{
+				++i;
+				maxNodePoints=(unsigned int)atoi(argv[i]);
+				}
+			else if(strcasecmp(argv[i]+1,"memoryLimit")==0&&i+1<argc)
+				{
+				++i;
+				memoryLimit=size_t(atoi(argv[i]));
+				}
+			else if(strcasecmp(argv[i]+1,"offset")==0&&i+3<argc)
+				{
+				for(int j=0;j<3;++j)
+					offset[j]=atof(argv[i+1+j]);
+				i+=3;
+				}
+			else
+				std::cerr<<"Ignoring unrecognized option "<<argv[i]<<std::endl;
+			}
+		else
+			fileNames.push_back(argv[i]);
+		}
+	if(fileNames.size()<2||maxNodePoints==0)
+		{
+		std::cerr<<"Usage: "<<argv[0]<<" [-maxPoints <max points per node>] [-memoryLimit <MB>] [-offset <x> <y> <z>] <input file 1> ... <input file n> <output file>"<<std::endl;
+		std::cerr<<"  Input files contain one point per line as x y z [r g b], with colors in [0, 255]"<<std::endl;
+		std::cerr<<"  The offset is subtracted from all input points before they are converted to single precision"<<std::endl;
+		return 1;
+		}
+	const char* outputFileName=fileNames.back();
+	fileNames.pop_back();
+	std::string tempFilePrefix=std::string(outputFileName)+".tmp";
+	
+	try
+		{
+		/* Read all input files into a temporary point file: */
+		PointBox bbox;
+		bool hasColors=false;
+		size_t numPoints=0;
+		std::string pointFileName=tempFilePrefix;
+		{
+		Misc::LargeFile pointFile(pointFileName.c_str(),"wb");
+		for(std::vector<const char*>::iterator fnIt=fileNames.begin();fnIt!=fileNames.end();++fnIt)
+			{
+			std::cout<<"Reading "<<*fnIt<<"..."<<std::flush;
+			size_t numFilePoints=readPointFile(*fnIt,offset,pointFile,bbox,hasColors);
+			std::cout<<" done, "<<numFilePoints<<" points"<<std::endl;
+			numPoints+=numFilePoints;
+			}
+		}
+		if(numPoints==0)
+			{
+			unlink(pointFileName.c_str());
+			Misc::throwStdErr("No points in input files");
+			}
+		
+		/* Write a preliminary header to the output file: */
+		Misc::LargeFile outputFile(outputFileName,"w+b",Misc::LargeFile::LittleEndian);
+		SceneGraph::PointCloudFile::Header header;
+		memcpy(header.magic,SceneGraph::PointCloudFile::magic,sizeof(header.magic));
+		header.version=SceneGraph::PointCloudFile::version;
+		header.hasColors=hasColors?1:0;
+		header.numNodes=0;
+		header.reserved=0;
+		outputFile.write(header);
+		
+		/* Sort the points into an octree, writing point blocks as they are created: */
+		std::cout<<"Sorting "<<numPoints<<" points..."<<std::flush;
+		PointCloudBuilder builder(outputFile,maxNodePoints,memoryLimit*1024*1024/sizeof(PointRecord),tempFilePrefix);
+		builder.build(pointFileName,numPoints,bbox);
+		std::cout<<" done, "<<builder.getNumNodes()<<" octree nodes"<<std::endl;
+		
+		/* Write the node table and the final header: */
+		builder.writeNodeTable();
+		header.numNodes=builder.getNumNodes();
+		outputFile.rewind();
+		outputFile.write(header);
+		}
+	catch(const std::runtime_error& err)
+		{
+		std::cerr<<"MakePointCloudFile: "<<err.what()<<std::endl;
+		return 1;
+		}
+	
+	return 0;
+	}
@@ -101,8 +101,8 @@ void MaterialNode::setGLState(GLRenderState& renderState) const
 	/* Enable material rendering: */
 	renderState.enableMaterials();
 	
-	/* Set the material properties: */
-	glMaterial(GLMaterialEnums::FRONT_AND_BACK,material);
+	/* Set the material properties; ambient and diffuse colors follow the current color: */
+	renderState.setMaterial(material);
 	renderState.emissiveColor=material.emission;
 	glColor(material.diffuse);
 	}
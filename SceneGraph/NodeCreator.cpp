@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/NormalNode.h>
 #include <SceneGraph/CoordinateNode.h>
 #include <SceneGraph/PointSetNode.h>
+#include <SceneGraph/PointCloudFileNode.h>
 #include <SceneGraph/IndexedLineSetNode.h>
 #include <SceneGraph/CurveSetNode.h>
 #include <SceneGraph/ElevationGridNode.h>
@@ -54,12 +55,48 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 
 namespace SceneGraph {
 
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+template <class NodeParam>
+class TaskSchedulerNodeFactory:public GenericNodeFactory<NodeParam> // Factory class for nodes that process their geometry on the node creator's task scheduler
+	{
+	/* Embedded classes: */
+	public:
+	typedef NodeParam Node; // Type of created nodes
+	
+	/* Elements: */
+	private:
+	const NodeCreator& nodeCreator; // Node creator whose task scheduler is passed to created nodes
+	
+	/* Constructors and destructors: */
+	public:
+	TaskSchedulerNodeFactory(const NodeCreator& sNodeCreator)
+		:nodeCreator(sNodeCreator)
+		{
+		}
+	
+	/* Methods from NodeFactory: */
+	virtual Node* createNode(void)
+		{
+		Node* result=new Node;
+		result->setTaskScheduler(nodeCreator.getTaskScheduler());
+		return result;
+		}
+	};
+
+}
+
 /****************************
 Methods of class NodeCreator:
 ****************************/
 
 NodeCreator::NodeCreator(void)
-	:nodeFactoryMap(31)
+	:nodeFactoryMap(31),
+	 taskScheduler(0)
 	{
 	/* Register the standard node types: */
 	registerNodeType(new GenericNodeFactory<GroupNode>());
@@ -80,15 +117,16 @@ NodeCreator::NodeCreator(void)
 	registerNodeType(new GenericNodeFactory<NormalNode>());
 	registerNodeType(new GenericNodeFactory<CoordinateNode>());
 	registerNodeType(new GenericNodeFactory<PointSetNode>());
+	registerNodeType(new GenericNodeFactory<PointCloudFileNode>());
 	registerNodeType(new GenericNodeFactory<IndexedLineSetNode>());
 	registerNodeType(new GenericNodeFactory<CurveSetNode>());
 	registerNodeType(new GenericNodeFactory<ElevationGridNode>());
-	registerNodeType(new GenericNodeFactory<IndexedFaceSetNode>());
+	registerNodeType(new TaskSchedulerNodeFactory<IndexedFaceSetNode>(*this));
 	registerNodeType(new GenericNodeFactory<ShapeNode>());
 	registerNodeType(new GenericNodeFactory<FontStyleNode>());
 	registerNodeType(new GenericNodeFactory<TextNode>());
 	registerNodeType(new GenericNodeFactory<LabelSetNode>());
-	registerNodeType(new GenericNodeFactory<TSurfFileNode>());
+	registerNodeType(new TaskSchedulerNodeFactory<TSurfFileNode>(*this));
 	registerNodeType(new GenericNodeFactory<ArcInfoExportFileNode>());
 	registerNodeType(new GenericNodeFactory<ESRIShapeFileNode>());
 	}
@@ -105,6 +143,11 @@ void NodeCreator::registerNodeType(NodeFactory* nodeFactory)
 	nodeFactoryMap.setEntry(NodeFactoryMap::Entry(nodeFactory->getClassName(),nodeFactory));
 	}
 
+void NodeCreator::setTaskScheduler(Threads::TaskScheduler* newTaskScheduler)
+	{
+	taskScheduler=newTaskScheduler;
+	}
+
 Node* NodeCreator::createNode(const char* nodeType)
 	{
 	NodeFactoryMap::Iterator nfIt=nodeFactoryMap.findEntry(nodeType);
@@ -31,6 +31,9 @@ namespace SceneGraph {
 class Node;
 class NodeFactory;
 }
+namespace Threads {
+class TaskScheduler;
+}
 
 namespace SceneGraph {
 
@@ -42,6 +45,7 @@ class NodeCreator
 	
 	/* Elements: */
 	NodeFactoryMap nodeFactoryMap; // Hash table mapping node type names to node factories
+	Threads::TaskScheduler* taskScheduler; // Task scheduler used by created nodes to process their geometry in parallel, or null
 	
 	/* Constructors and destructors: */
 	public:
@@ -51,6 +55,11 @@ class NodeCreator
 	/* Methods: */
 	void registerNodeType(NodeFactory* nodeFactory); // Registers a node factory for nodes of the given type; node creator inherits factory object
 	Node* createNode(const char* nodeTypeName); // Creates a new node of the given type
+	Threads::TaskScheduler* getTaskScheduler(void) const // Returns the task scheduler used by created nodes
+		{
+		return taskScheduler;
+		}
+	void setTaskScheduler(Threads::TaskScheduler* newTaskScheduler); // Sets a task scheduler passed to nodes created afterwards to process their geometry in parallel; null processes it in the loading thread
 	};
 
 }
@@ -0,0 +1,145 @@
+/***********************************************************************
+PointCloudFile - Definitions for the on-disk format of out-of-core,
+multiresolution point clouds.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+/***********************************************************************
+A point cloud file contains an octree of point blocks in little-endian
+byte order. The file starts with a header, followed by the point blocks
+of all octree nodes in depth-first order (a node's block precedes the
+blocks of its children, and children are visited in order), followed
+by the octree's node table. The node table is stored at the end of the
+file because its size is not known until all points have been sorted;
+its position follows from the file size and the number of nodes, and
+the positions of all point blocks follow from a depth-first traversal
+of the node table.
+Each interior node stores a spatially uniform subsample of the points
+inside its domain, and its children store the remaining points. The
+points of a node and all its ancestors together form a level-of-detail
+approximation of the node's domain; no point is stored twice.
+***********************************************************************/
+
+#ifndef SCENEGRAPH_POINTCLOUDFILE_INCLUDED
+#define SCENEGRAPH_POINTCLOUDFILE_INCLUDED
+
+#include <Misc/Endianness.h>
+
+namespace SceneGraph {
+
+namespace PointCloudFile {
+
+static const char magic[16]={'V','r','u','i',' ','P','o','i','n','t',' ','C','l','o','u','d'}; // Magic identifier at the start of a point cloud file
+static const unsigned int version=1; // Version number of the file format
+
+struct Header // Structure for point cloud file headers
+	{
+	/* Elements: */
+	public:
+	char magic[16]; // Magic identifier
+	unsigned int version; // Version number of the file format
+	unsigned int hasColors; // Flag if the points have individual colors; points in files without colors are white
+	unsigned int numNodes; // Number of nodes in the node table
+	unsigned int reserved; // Padding to align the point blocks
+	};
+
+struct PointRecord // Structure for points; matches layout of GLGeometry::Vertex<void,0,GLubyte,4,void,float,3>
+	{
+	/* Elements: */
+	public:
+	unsigned char color[4]; // RGBA point color
+	float position[3]; // Point position
+	};
+
+struct NodeRecord // Structure for octree nodes
+	{
+	/* Elements: */
+	public:
+	float bboxMin[3],bboxMax[3]; // Bounding box of all points in the node's subtree
+	unsigned int firstChild; // Index of the node's first child in the node table; children are stored consecutively
+	unsigned int numChildren; // Number of the node's children; 0 for leaf nodes
+	unsigned int numPoints; // Number of points in the node's point block
+	unsigned int reserved; // Padding
+	};
+
+}
+
+}
+
+namespace Misc {
+
+template <>
+class EndiannessSwapper<SceneGraph::PointCloudFile::Header>
+	{
+	/* Methods: */
+	public:
+	static void swap(SceneGraph::PointCloudFile::Header& value)
+		{
+		swapEndianness(value.version);
+		swapEndianness(value.hasColors);
+		swapEndianness(value.numNodes);
+		swapEndianness(value.reserved);
+		}
+	static void swap(SceneGraph::PointCloudFile::Header* values,size_t numValues)
+		{
+		for(size_t i=0;i<numValues;++i)
+			swap(values[i]);
+		}
+	};
+
+template <>
+class EndiannessSwapper<SceneGraph::PointCloudFile::PointRecord>
+	{
+	/* Methods: */
+	public:
+	static void swap(SceneGraph::PointCloudFile::PointRecord& value)
+		{
+		swapEndianness(value.position,3);
+		}
+	static void swap(SceneGraph::PointCloudFile::PointRecord* values,size_t numValues)
+		{
+		for(size_t i=0;i<numValues;++i)
+			swapEndianness(values[i].position,3);
+		}
+	};
+
+template <>
+class EndiannessSwapper<SceneGraph::PointCloudFile::NodeRecord>
+	{
+	/* Methods: */
+	public:
+	static void swap(SceneGraph::PointCloudFile::NodeRecord& value)
+		{
+		swapEndianness(value.bboxMin,3);
+		swapEndianness(value.bboxMax,3);
+		swapEndianness(value.firstChild);
+		swapEndianness(value.numChildren);
+		swapEndianness(value.numPoints);
+		swapEndianness(value.reserved);
+		}
+	static void swap(SceneGraph::PointCloudFile::NodeRecord* values,size_t numValues)
+		{
+		for(size_t i=0;i<numValues;++i)
+			swap(values[i]);
+		}
+	};
+
+}
+
+#endif
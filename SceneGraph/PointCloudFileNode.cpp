@@ -0,0 +1,547 @@
+/***********************************************************************
+PointCloudFileNode - Class for out-of-core, multiresolution point clouds
+read from octree files, with view-dependent level-of-detail and
+background paging of point blocks.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/PointCloudFileNode.h>
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <Misc/ThrowStdErr.h>
+#include <Misc/Endianness.h>
+#include <Misc/MemMappedFile.h>
+#include <Misc/PriorityHeap.h>
+#include <Geometry/Box.h>
+#include <GL/gl.h>
+#include <GL/GLColorTemplates.h>
+#include <GL/GLContextData.h>
+#include <GL/GLExtensionManager.h>
+#include <GL/Extensions/GLARBVertexBufferObject.h>
+#include <GL/GLVertexArrayParts.h>
+#include <GL/GLGeometryVertex.h>
+#include <SceneGraph/PointCloudFile.h>
+#include <SceneGraph/VRMLFile.h>
+#include <SceneGraph/GLRenderState.h>
+
+namespace SceneGraph {
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct TraversalItem // Structure for octree nodes waiting to be traversed during level-of-detail selection
+	{
+	/* Elements: */
+	public:
+	unsigned int nodeIndex; // Index of the octree node
+	Scalar priority; // Approximate projected size of the node's domain
+	
+	/* Constructors and destructors: */
+	TraversalItem(unsigned int sNodeIndex,Scalar sPriority)
+		:nodeIndex(sNodeIndex),priority(sPriority)
+		{
+		}
+	
+	/* Methods: */
+	static bool lessEqual(const TraversalItem& i1,const TraversalItem& i2) // Orders the traversal heap by decreasing priority
+		{
+		return i1.priority>=i2.priority;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+inline Scalar calcPriority(const Point& center,Scalar radius,const Point& viewerPos) // Returns the approximate projected size of a node's domain
+	{
+	Scalar distance=Geometry::dist(center,viewerPos)-radius;
+	if(distance<radius*Scalar(0.01))
+		distance=radius*Scalar(0.01);
+	return radius/distance;
+	}
+
+}
+
+/*********************************************
+Methods of class PointCloudFileNode::DataItem:
+*********************************************/
+
+PointCloudFileNode::DataItem::DataItem(void)
+	:hasVertexBufferObjectExtension(GLARBVertexBufferObject::isSupported()),
+	 version(0),
+	 numResidentPoints(0)
+	{
+	if(hasVertexBufferObjectExtension)
+		{
+		/* Initialize the vertex buffer object extension: */
+		GLARBVertexBufferObject::initExtension();
+		}
+	}
+
+PointCloudFileNode::DataItem::~DataItem(void)
+	{
+	/* Destroy all buffer objects: */
+	for(std::vector<unsigned int>::iterator rnIt=residentNodes.begin();rnIt!=residentNodes.end();++rnIt)
+		glDeleteBuffersARB(1,&bufferObjectIds[*rnIt]);
+	}
+
+void PointCloudFileNode::DataItem::reset(unsigned int newVersion,unsigned int numNodes)
+	{
+	/* Destroy all buffer objects: */
+	for(std::vector<unsigned int>::iterator rnIt=residentNodes.begin();rnIt!=residentNodes.end();++rnIt)
+		glDeleteBuffersARB(1,&bufferObjectIds[*rnIt]);
+	residentNodes.clear();
+	numResidentPoints=0;
+	
+	/* Prepare for the new octree: */
+	version=newVersion;
+	bufferObjectIds.assign(numNodes,0);
+	lastUsed.assign(numNodes,0);
+	}
+
+/***********************************
+Methods of class PointCloudFileNode:
+***********************************/
+
+void* PointCloudFileNode::pagerThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next requested point block: */
+		unsigned int nodeIndex;
+		{
+		Threads::MutexCond::Lock cacheLock(cacheCond);
+		while(loadQueue.empty()&&!shutdown)
+			cacheCond.wait(cacheLock);
+		if(shutdown)
+			break;
+		nodeIndex=loadQueue.front();
+		loadQueue.pop_front();
+		}
+		
+		/* Copy the point block out of the file mapping, which pages it in from disk: */
+		const OctreeNode& node=nodes[nodeIndex];
+		Vertex* points=new Vertex[node.numPoints];
+		memcpy(points,fileMap+node.dataOffset,node.numPoints*sizeof(Vertex));
+		#if __BYTE_ORDER==__BIG_ENDIAN
+		for(unsigned int i=0;i<node.numPoints;++i)
+			Misc::swapEndianness(points[i].position.getComponents(),3);
+		#endif
+		if(pointTransform.getValue()!=0)
+			{
+			/* Transform the points: */
+			for(unsigned int i=0;i<node.numPoints;++i)
+				points[i].position=pointTransform.getValue()->transformPoint(points[i].position);
+			}
+		
+		/* Add the point block to the memory cache: */
+		Threads::MutexCond::Lock cacheLock(cacheCond);
+		cache[nodeIndex].state=LOADED;
+		cache[nodeIndex].points=points;
+		cachedNodes.push_back(nodeIndex);
+		numCachedPoints+=node.numPoints;
+		
+		/* Evict the least recently requested point blocks that are not needed by the current rendering pass: */
+		while(numCachedPoints>size_t(cacheSize.getValue()))
+			{
+			std::vector<unsigned int>::iterator lruIt=cachedNodes.begin();
+			for(std::vector<unsigned int>::iterator cnIt=cachedNodes.begin();cnIt!=cachedNodes.end();++cnIt)
+				if(cache[*lruIt].lastUsed>cache[*cnIt].lastUsed)
+					lruIt=cnIt;
+			if(cache[*lruIt].lastUsed>=renderPass)
+				break;
+			
+			CachedBlock& block=cache[*lruIt];
+			delete[] block.points;
+			block.points=0;
+			block.state=UNLOADED;
+			numCachedPoints-=nodes[*lruIt].numPoints;
+			*lruIt=cachedNodes.back();
+			cachedNodes.pop_back();
+			}
+		}
+	
+	return 0;
+	}
+
+void PointCloudFileNode::closeFile(void)
+	{
+	if(!pagerThread.isJoined())
+		{
+		/* Shut down the pager thread: */
+		{
+		Threads::MutexCond::Lock cacheLock(cacheCond);
+		shutdown=true;
+		cacheCond.broadcast(cacheLock);
+		}
+		pagerThread.join();
+		}
+	
+	/* Release the memory cache: */
+	for(std::vector<CachedBlock>::iterator cIt=cache.begin();cIt!=cache.end();++cIt)
+		delete[] cIt->points;
+	cache.clear();
+	cachedNodes.clear();
+	numCachedPoints=0;
+	loadQueue.clear();
+	nodes.clear();
+	
+	/* Close the point cloud file: */
+	if(fileMap!=0)
+		munmap(const_cast<unsigned char*>(fileMap),fileSize);
+	fileMap=0;
+	fileSize=0;
+	if(fileFd>=0)
+		close(fileFd);
+	fileFd=-1;
+	}
+
+PointCloudFileNode::PointCloudFileNode(void)
+	:pointSize(Scalar(1)),
+	 pointBudget(2000000),
+	 cacheSize(8000000),
+	 fileFd(-1),fileMap(0),fileSize(0),
+	 hasColors(false),
+	 version(0),
+	 numCachedPoints(0),
+	 renderPass(0),
+	 shutdown(false)
+	{
+	}
+
+PointCloudFileNode::~PointCloudFileNode(void)
+	{
+	closeFile();
+	}
+
+const char* PointCloudFileNode::getStaticClassName(void)
+	{
+	return "PointCloudFile";
+	}
+
+const char* PointCloudFileNode::getClassName(void) const
+	{
+	return "PointCloudFile";
+	}
+
+void PointCloudFileNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
+	{
+	if(strcmp(fieldName,"url")==0)
+		{
+		vrmlFile.parseField(url);
+		
+		/* Fully qualify all URLs: */
+		for(size_t i=0;i<url.getNumValues();++i)
+			url.setValue(i,vrmlFile.getFullUrl(url.getValue(i)));
+		}
+	else if(strcmp(fieldName,"pointSize")==0)
+		{
+		vrmlFile.parseField(pointSize);
+		}
+	else if(strcmp(fieldName,"pointBudget")==0)
+		{
+		vrmlFile.parseField(pointBudget);
+		}
+	else if(strcmp(fieldName,"cacheSize")==0)
+		{
+		vrmlFile.parseField(cacheSize);
+		}
+	else
+		GeometryNode::parseField(fieldName,vrmlFile);
+	}
+
+void PointCloudFileNode::update(void)
+	{
+	/* Close a previously opened point cloud file: */
+	closeFile();
+	
+	if(url.getNumValues()>0)
+		{
+		/* Open and map the point cloud file: */
+		const char* fileName=url.getValue(0).c_str();
+		fileFd=open(fileName,O_RDONLY);
+		if(fileFd<0)
+			Misc::throwStdErr("PointCloudFileNode::update: Could not open file %s",fileName);
+		struct stat fileStat;
+		if(fstat(fileFd,&fileStat)<0||size_t(fileStat.st_size)<sizeof(PointCloudFile::Header))
+			{
+			closeFile();
+			Misc::throwStdErr("PointCloudFileNode::update: File %s is not a valid point cloud file",fileName);
+			}
+		fileSize=size_t(fileStat.st_size);
+		void* map=mmap(0,fileSize,PROT_READ,MAP_SHARED,fileFd,0);
+		if(map==MAP_FAILED)
+			{
+			closeFile();
+			Misc::throwStdErr("PointCloudFileNode::update: Could not map file %s",fileName);
+			}
+		fileMap=static_cast<const unsigned char*>(map);
+		
+		/* Read and check the file header: */
+		Misc::MemMappedFile file(fileMap,fileSize,Misc::MemMappedFile::LittleEndian);
+		PointCloudFile::Header header=file.read<PointCloudFile::Header>();
+		size_t nodeTableSize=size_t(header.numNodes)*sizeof(PointCloudFile::NodeRecord);
+		if(memcmp(header.magic,PointCloudFile::magic,sizeof(header.magic))!=0||header.version!=PointCloudFile::version||header.numNodes==0||nodeTableSize>fileSize-sizeof(PointCloudFile::Header))
+			{
+			closeFile();
+			Misc::throwStdErr("PointCloudFileNode::update: File %s is not a valid point cloud file",fileName);
+			}
+		hasColors=header.hasColors!=0;
+		
+		/* Read the node table from the end of the file: */
+		std::vector<PointCloudFile::NodeRecord> records(header.numNodes);
+		file.seekSet(fileSize-nodeTableSize);
+		file.read(&records[0],header.numNodes);
+		
+		/* Create the octree and calculate the positions of the point blocks by traversing it in depth-first order: */
+		nodes.resize(header.numNodes);
+		size_t dataOffset=sizeof(PointCloudFile::Header);
+		size_t dataEnd=fileSize-nodeTableSize;
+		std::vector<unsigned int> traversalStack;
+		traversalStack.push_back(0);
+		while(!traversalStack.empty())
+			{
+			unsigned int nodeIndex=traversalStack.back();
+			traversalStack.pop_back();
+			const PointCloudFile::NodeRecord& record=records[nodeIndex];
+			OctreeNode& node=nodes[nodeIndex];
+			
+			/* Check the node record; children must follow their parents to prevent cycles: */
+			if((record.numChildren>0&&(record.firstChild<=nodeIndex||record.firstChild>header.numNodes||record.numChildren>header.numNodes-record.firstChild))||size_t(record.numPoints)*sizeof(Vertex)>dataEnd-dataOffset)
+				{
+				closeFile();
+				Misc::throwStdErr("PointCloudFileNode::update: Malformed octree in point cloud file %s",fileName);
+				}
+			
+			/* Calculate the node's bounding box after point transformation: */
+			Box recordBox(Point(record.bboxMin),Point(record.bboxMax));
+			if(pointTransform.getValue()!=0)
+				{
+				node.box=Box::empty;
+				for(int i=0;i<8;++i)
+					node.box.addPoint(pointTransform.getValue()->transformPoint(recordBox.getVertex(i)));
+				}
+			else
+				node.box=recordBox;
+			node.center=Geometry::mid(node.box.min,node.box.max);
+			node.radius=Geometry::dist(node.box.min,node.box.max)*Scalar(0.5);
+			
+			node.firstChild=record.firstChild;
+			node.numChildren=record.numChildren;
+			node.numPoints=record.numPoints;
+			node.dataOffset=dataOffset;
+			dataOffset+=size_t(record.numPoints)*sizeof(Vertex);
+			
+			/* Traverse the node's children in order: */
+			for(unsigned int i=record.numChildren;i>0;--i)
+				traversalStack.push_back(record.firstChild+i-1);
+			}
+		
+		/* Initialize the memory cache: */
+		CachedBlock emptyBlock;
+		emptyBlock.state=UNLOADED;
+		emptyBlock.lastUsed=0;
+		emptyBlock.points=0;
+		cache.assign(nodes.size(),emptyBlock);
+		
+		/* Start the pager thread: */
+		shutdown=false;
+		pagerThread.start(this,&PointCloudFileNode::pagerThreadMethod);
+		}
+	
+	/* Bump up the octree's version number: */
+	++version;
+	}
+
+Box PointCloudFileNode::calcBoundingBox(void) const
+	{
+	/* Return the bounding box of the root node: */
+	if(!nodes.empty())
+		return nodes[0].box;
+	else
+		return Box::empty;
+	}
+
+void PointCloudFileNode::glRenderAction(GLRenderState& renderState) const
+	{
+	if(nodes.empty())
+		return;
+	
+	/* Get the context data item and update it for the current octree: */
+	DataItem* dataItem=renderState.contextData.retrieveDataItem<DataItem>(this);
+	if(dataItem->version!=version)
+		{
+		/* Unbind the buffer objects before deleting them: */
+		renderState.bindVertexBuffer(0);
+		dataItem->reset(version,nodes.size());
+		}
+	
+	/* Set up OpenGL state: */
+	renderState.disableMaterials();
+	renderState.disableTextures();
+	glPointSize(pointSize.getValue());
+	int vertexPartsMask=Vertex::getPartsMask();
+	if(!hasColors)
+		{
+		/* Use the current emissive color: */
+		glColor(renderState.emissiveColor);
+		vertexPartsMask=GLVertexArrayParts::Position;
+		}
+	renderState.enableVertexArrays(vertexPartsMask);
+	
+	std::vector<unsigned int> renderNodes;
+	{
+	Threads::MutexCond::Lock cacheLock(cacheCond);
+	unsigned int pass=++renderPass;
+	
+	/* Select octree nodes in order of decreasing projected size until the point budget is exhausted: */
+	Point viewerPos=renderState.getViewerPos();
+	Misc::PriorityHeap<TraversalItem,TraversalItem> traversalHeap(64);
+	std::vector<unsigned int> missingNodes;
+	size_t maxNumPoints=size_t(pointBudget.getValue());
+	size_t numPoints=0;
+	if(renderState.doesBoxIntersectFrustum(nodes[0].box))
+		traversalHeap.insert(TraversalItem(0,calcPriority(nodes[0].center,nodes[0].radius,viewerPos)));
+	while(!traversalHeap.isEmpty())
+		{
+		unsigned int nodeIndex=traversalHeap.getSmallest().nodeIndex;
+		traversalHeap.removeSmallest();
+		const OctreeNode& node=nodes[nodeIndex];
+		if(numPoints+node.numPoints>maxNumPoints)
+			break;
+		numPoints+=node.numPoints;
+		CachedBlock& block=cache[nodeIndex];
+		block.lastUsed=pass;
+		
+		/* Check if the node's point block can be rendered: */
+		bool ready;
+		if(dataItem->hasVertexBufferObjectExtension)
+			{
+			if(dataItem->bufferObjectIds[nodeIndex]==0&&block.state==LOADED&&renderState.bufferUploadBudget>0)
+				{
+				/* Upload the point block into a new buffer object: */
+				size_t blockSize=size_t(node.numPoints)*sizeof(Vertex);
+				glGenBuffersARB(1,&dataItem->bufferObjectIds[nodeIndex]);
+				renderState.bindVertexBuffer(dataItem->bufferObjectIds[nodeIndex]);
+				glBufferDataARB(GL_ARRAY_BUFFER_ARB,blockSize,block.points,GL_STATIC_DRAW_ARB);
+				dataItem->residentNodes.push_back(nodeIndex);
+				dataItem->numResidentPoints+=node.numPoints;
+				if(renderState.bufferUploadBudget>blockSize)
+					renderState.bufferUploadBudget-=blockSize;
+				else
+					renderState.bufferUploadBudget=0;
+				}
+			ready=dataItem->bufferObjectIds[nodeIndex]!=0;
+			if(ready)
+				dataItem->lastUsed[nodeIndex]=pass;
+			}
+		else
+			ready=block.state==LOADED;
+		
+		if(ready)
+			{
+			/* Render the node and traverse its visible children: */
+			renderNodes.push_back(nodeIndex);
+			for(unsigned int childIndex=node.firstChild;childIndex<node.firstChild+node.numChildren;++childIndex)
+				if(renderState.doesBoxIntersectFrustum(nodes[childIndex].box))
+					traversalHeap.insert(TraversalItem(childIndex,calcPriority(nodes[childIndex].center,nodes[childIndex].radius,viewerPos)));
+			}
+		else if(block.state!=LOADED)
+			{
+			/* Request the node's point block, and don't refine it until it arrives: */
+			missingNodes.push_back(nodeIndex);
+			}
+		}
+	
+	/* Replace the pager thread's load queue with the missing point blocks in priority order: */
+	for(std::deque<unsigned int>::iterator lqIt=loadQueue.begin();lqIt!=loadQueue.end();++lqIt)
+		if(cache[*lqIt].state==QUEUED)
+			cache[*lqIt].state=UNLOADED;
+	loadQueue.clear();
+	for(std::vector<unsigned int>::iterator mnIt=missingNodes.begin();mnIt!=missingNodes.end();++mnIt)
+		if(cache[*mnIt].state==UNLOADED)
+			{
+			cache[*mnIt].state=QUEUED;
+			loadQueue.push_back(*mnIt);
+			}
+	if(!loadQueue.empty())
+		cacheCond.signal(cacheLock);
+	
+	if(dataItem->hasVertexBufferObjectExtension)
+		{
+		/* Evict the least recently rendered point blocks from the OpenGL context: */
+		while(dataItem->numResidentPoints>size_t(cacheSize.getValue()))
+			{
+			std::vector<unsigned int>::iterator lruIt=dataItem->residentNodes.begin();
+			for(std::vector<unsigned int>::iterator rnIt=dataItem->residentNodes.begin();rnIt!=dataItem->residentNodes.end();++rnIt)
+				if(dataItem->lastUsed[*lruIt]>dataItem->lastUsed[*rnIt])
+					lruIt=rnIt;
+			if(dataItem->lastUsed[*lruIt]>=pass)
+				break;
+			
+			/* Unbind the buffer object before deleting it: */
+			renderState.bindVertexBuffer(0);
+			glDeleteBuffersARB(1,&dataItem->bufferObjectIds[*lruIt]);
+			dataItem->bufferObjectIds[*lruIt]=0;
+			dataItem->numResidentPoints-=nodes[*lruIt].numPoints;
+			*lruIt=dataItem->residentNodes.back();
+			dataItem->residentNodes.pop_back();
+			}
+		}
+	else
+		{
+		/* Render the selected point blocks from the memory cache while the pager thread can't evict them: */
+		renderState.bindVertexBuffer(0);
+		for(std::vector<unsigned int>::iterator rnIt=renderNodes.begin();rnIt!=renderNodes.end();++rnIt)
+			{
+			glVertexPointer(vertexPartsMask,cache[*rnIt].points);
+			glDrawArrays(GL_POINTS,0,nodes[*rnIt].numPoints);
+			}
+		}
+	}
+	
+	if(dataItem->hasVertexBufferObjectExtension)
+		{
+		/* Render the selected point blocks from their buffer objects: */
+		for(std::vector<unsigned int>::iterator rnIt=renderNodes.begin();rnIt!=renderNodes.end();++rnIt)
+			{
+			renderState.bindVertexBuffer(dataItem->bufferObjectIds[*rnIt]);
+			glVertexPointer(vertexPartsMask,static_cast<const Vertex*>(0));
+			glDrawArrays(GL_POINTS,0,nodes[*rnIt].numPoints);
+			}
+		}
+	}
+
+void PointCloudFileNode::initContext(GLContextData& contextData) const
+	{
+	/* Create a data item and store it in the context: */
+	DataItem* dataItem=new DataItem;
+	contextData.addDataItem(this,dataItem);
+	}
+
+}
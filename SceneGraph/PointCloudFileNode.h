@@ -0,0 +1,142 @@
+/***********************************************************************
+PointCloudFileNode - Class for out-of-core, multiresolution point clouds
+read from octree files, with view-dependent level-of-detail and
+background paging of point blocks.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_POINTCLOUDFILENODE_INCLUDED
+#define SCENEGRAPH_POINTCLOUDFILENODE_INCLUDED
+
+#include <stddef.h>
+#include <deque>
+#include <vector>
+#include <Geometry/Box.h>
+#include <GL/gl.h>
+#include <GL/GLObject.h>
+#include <GL/GLGeometryVertex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <SceneGraph/FieldTypes.h>
+#include <SceneGraph/GeometryNode.h>
+
+namespace SceneGraph {
+
+class PointCloudFileNode:public GeometryNode,public GLObject
+	{
+	/* Embedded classes: */
+	protected:
+	typedef GLGeometry::Vertex<void,0,GLubyte,4,void,float,3> Vertex; // Type for rendered points; matches the layout of points in the file
+	
+	struct OctreeNode // Structure for octree nodes
+		{
+		/* Elements: */
+		public:
+		Box box; // Bounding box of all points in the node's subtree, after point transformation
+		Point center; // Center of the bounding box
+		Scalar radius; // Radius of the bounding box's circumscribed sphere
+		unsigned int firstChild; // Index of the node's first child; children are stored consecutively
+		unsigned int numChildren; // Number of the node's children; 0 for leaf nodes
+		unsigned int numPoints; // Number of points in the node's point block
+		size_t dataOffset; // Offset of the node's point block in the file
+		};
+	
+	enum BlockState // Enumerated type for states of point blocks in the memory cache
+		{
+		UNLOADED,QUEUED,LOADED
+		};
+	
+	struct CachedBlock // Structure for point blocks in the memory cache
+		{
+		/* Elements: */
+		public:
+		BlockState state; // Loading state of the block
+		unsigned int lastUsed; // Rendering pass in which the block was last requested
+		Vertex* points; // The block's points ready for rendering, if the block is loaded
+		};
+	
+	struct DataItem:public GLObject::DataItem
+		{
+		/* Elements: */
+		public:
+		bool hasVertexBufferObjectExtension; // Flag if buffer objects are supported
+		unsigned int version; // Version of the octree for which the buffer objects were created
+		std::vector<GLuint> bufferObjectIds; // IDs of buffer objects holding the point blocks of all octree nodes, or 0 for nodes not uploaded
+		std::vector<unsigned int> lastUsed; // Rendering pass in which each uploaded point block was last rendered
+		std::vector<unsigned int> residentNodes; // List of octree nodes whose point blocks are uploaded
+		size_t numResidentPoints; // Total number of points in uploaded point blocks
+		
+		/* Constructors and destructors: */
+		DataItem(void);
+		virtual ~DataItem(void);
+		
+		/* Methods: */
+		void reset(unsigned int newVersion,unsigned int numNodes); // Deletes all buffer objects and prepares for the given octree
+		};
+	
+	/* Fields: */
+	public:
+	MFString url; // Name of the point cloud file
+	SFFloat pointSize;
+	SFInt pointBudget; // Maximum number of points rendered per pass
+	SFInt cacheSize; // Maximum number of points held in memory and in each OpenGL context
+	
+	/* Derived elements: */
+	protected:
+	int fileFd; // File descriptor of the point cloud file
+	const unsigned char* fileMap; // Memory mapping of the point cloud file
+	size_t fileSize; // Size of the point cloud file and its mapping
+	bool hasColors; // Flag if the points have individual colors
+	std::vector<OctreeNode> nodes; // The point cloud's octree; root node is first
+	unsigned int version; // Version number of the octree
+	mutable Threads::MutexCond cacheCond; // Mutex protecting the memory cache and load queue, and condition variable to wake up the pager thread
+	mutable std::vector<CachedBlock> cache; // Memory cache states of the point blocks of all octree nodes
+	mutable std::vector<unsigned int> cachedNodes; // List of octree nodes whose point blocks are in the memory cache
+	mutable size_t numCachedPoints; // Total number of points in the memory cache
+	mutable std::deque<unsigned int> loadQueue; // Octree nodes whose point blocks are requested, in priority order
+	mutable unsigned int renderPass; // Counter of rendering passes
+	bool shutdown; // Flag to shut down the pager thread
+	Threads::Thread pagerThread; // Thread loading requested point blocks into the memory cache
+	
+	/* Protected methods: */
+	void* pagerThreadMethod(void); // Loads requested point blocks and evicts the least recently used ones
+	void closeFile(void); // Stops the pager thread, releases the memory cache, and closes the point cloud file
+	
+	/* Constructors and destructors: */
+	public:
+	PointCloudFileNode(void); // Creates a default node with no point cloud
+	virtual ~PointCloudFileNode(void);
+	
+	/* Methods from Node: */
+	static const char* getStaticClassName(void);
+	virtual const char* getClassName(void) const;
+	virtual void parseField(const char* fieldName,VRMLFile& vrmlFile);
+	virtual void update(void);
+	
+	/* Methods from GeometryNode: */
+	virtual Box calcBoundingBox(void) const;
+	virtual void glRenderAction(GLRenderState& renderState) const;
+	
+	/* Methods from GLObject: */
+	virtual void initContext(GLContextData& contextData) const;
+	};
+
+}
+
+#endif
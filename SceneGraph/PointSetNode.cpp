@@ -145,7 +145,7 @@ void PointSetNode::glRenderAction(GLRenderState& renderState) const
 			typedef GLGeometry::Vertex<void,0,void,0,void,Scalar,3> Vertex;
 			
 			/* Bind the point set's vertex buffer object: */
-			glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
+			renderState.bindVertexBuffer(dataItem->vertexBufferObjectId);
 			
 			/* Check if the vertex buffer object is outdated: */
 			if(dataItem->version!=version)
@@ -200,26 +200,17 @@ void PointSetNode::glRenderAction(GLRenderState& renderState) const
 			/* Set up the vertex arrays: */
 			if(color.getValue()!=0)
 				{
-				GLVertexArrayParts::enable(ColorVertex::getPartsMask());
+				renderState.enableVertexArrays(ColorVertex::getPartsMask());
 				glVertexPointer(static_cast<ColorVertex*>(0));
 				}
 			else
 				{
-				GLVertexArrayParts::enable(Vertex::getPartsMask());
+				renderState.enableVertexArrays(Vertex::getPartsMask());
 				glVertexPointer(static_cast<Vertex*>(0));
 				}
 			
 			/* Draw the point set: */
 			glDrawArrays(GL_POINTS,0,coord.getValue()->point.getNumValues());
-			
-			/* Disable the vertex arrays: */
-			if(color.getValue()!=0)
-				GLVertexArrayParts::disable(ColorVertex::getPartsMask());
-			else
-				GLVertexArrayParts::disable(Vertex::getPartsMask());
-			
-			/* Protect the vertex buffer object: */
-			glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
 			}
 		else
 			{
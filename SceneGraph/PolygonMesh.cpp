@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Math/Constants.h>
 #include <GL/gl.h>
 #include <GL/GLGeometryWrappers.h>
+#include <Threads/TaskScheduler.h>
 
 // #include <SceneGraph/TexCoordCalculator.h>
 
@@ -59,6 +60,9 @@ PolygonMesh<MeshVertexParam>::connectFace(
 	/* Get a handle to the face: */
 	Face& face=faces[faceIndex];
 	
+	/* Invalidate the half-edge adjacency: */
+	adjacencyValid=false;
+	
 	#if 0
 	
 	/* Check if the face already exists: */
@@ -193,10 +197,12 @@ PolygonMesh<MeshVertexParam>::connectFace(
 			faceVertexIndices[face.firstVertexIndex+i0]=vertices.size();
 			vertices.push_back(vertices[e0]);
 			vertexEdges.push_back(invalidIndex);
+			vertexMultiSurfaceFlags.push_back(false);
 			vertexCreaseFlags.push_back(false);
 			faceVertexIndices[face.firstVertexIndex+i1]=vertices.size();
 			vertices.push_back(vertices[e1]);
 			vertexEdges.push_back(invalidIndex);
+			vertexMultiSurfaceFlags.push_back(false);
 			vertexCreaseFlags.push_back(false);
 			
 			e1=faceVertexIndices[face.firstVertexIndex+i1];
@@ -516,15 +522,15 @@ PolygonMesh<MeshVertexParam>::getVertexNormal(
 	if(vertexCreaseFlags[vertexIndex])
 		{
 		/* Get the vertex' per-face normal vector: */
-		typename FaceVertexNormalHasher::ConstIterator fvnIt=vertexNormals.findEntry(FaceVertex(faceIndex,vertexIndex));
-		if(fvnIt.isFinished())
+		Card corner=findFaceVertex(faceIndex,vertexIndex);
+		if(corner==invalidIndex||corner>=cornerNormalFlags.size()||!cornerNormalFlags[corner])
 			{
 			// DEBUGGING
 			//std::cout<<"Missing per-face vertex normal for face "<<faceIndex<<", vertex "<<vertexIndex<<std::endl;
 			return vertices[vertexIndex].normal;
 			}
 		else
-			return fvnIt->getDest();
+			return cornerNormals[corner];
 		}
 	else
 		return vertices[vertexIndex].normal;
@@ -541,6 +547,359 @@ PolygonMesh<MeshVertexParam>::getTriangleVertexIndex(
 	return invalidIndex;
 	}
 
+template <class MeshVertexParam>
+inline
+typename PolygonMesh<MeshVertexParam>::Card
+PolygonMesh<MeshVertexParam>::findHalfEdge(
+	typename PolygonMesh<MeshVertexParam>::Card vertexIndex0,
+	typename PolygonMesh<MeshVertexParam>::Card vertexIndex1) const
+	{
+	if(vertexIndex0>=vertices.size())
+		return invalidIndex;
+	
+	/* Search the start vertex' outgoing half-edges: */
+	for(Card i=vertexHalfEdgeOffsets[vertexIndex0];i<vertexHalfEdgeOffsets[vertexIndex0+1];++i)
+		if(faceVertexIndices[vertexHalfEdges[i]]==vertexIndex1)
+			return vertexHalfEdges[i];
+	
+	return invalidIndex;
+	}
+
+template <class MeshVertexParam>
+inline
+typename PolygonMesh<MeshVertexParam>::Card
+PolygonMesh<MeshVertexParam>::findFaceVertex(
+	typename PolygonMesh<MeshVertexParam>::Card faceIndex,
+	typename PolygonMesh<MeshVertexParam>::Card vertexIndex) const
+	{
+	const Face& face=faces[faceIndex];
+	for(Card i=0;i<face.numVertices;++i)
+		if(faceVertexIndices[face.firstVertexIndex+i]==vertexIndex)
+			return face.firstVertexIndex+i;
+	
+	return invalidIndex;
+	}
+
+template <class MeshVertexParam>
+inline
+bool
+PolygonMesh<MeshVertexParam>::isCreaseHalfEdge(
+	typename PolygonMesh<MeshVertexParam>::Card halfEdge) const
+	{
+	/* Check the half-edge and its opposite: */
+	if(halfEdgeCreaseFlags[halfEdge])
+		return true;
+	Card opposite=halfEdgeOpposites[halfEdge];
+	if(opposite!=invalidIndex&&halfEdgeCreaseFlags[opposite])
+		return true;
+	
+	/* Check the explicitly marked crease edges: */
+	if(creaseEdges.getNumEntries()==0)
+		return false;
+	return creaseEdges.isEntry(UndirectedEdge(faceVertexIndices[getPreviousHalfEdge(halfEdge)],faceVertexIndices[halfEdge]));
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::runPass(
+	void (PolygonMesh<MeshVertexParam>::*pass)(size_t,size_t),
+	size_t numElements)
+	{
+	if(taskScheduler!=0)
+		{
+		/* Split the elements into ranges starting at multiples of the bit array word size so that passes can set flags concurrently: */
+		size_t grainSize=taskScheduler->calcGrainSize(numElements,BitArray::wordSize*64);
+		grainSize=((grainSize+BitArray::wordSize-1)/BitArray::wordSize)*BitArray::wordSize;
+		MeshPass meshPass(*this,pass);
+		taskScheduler->parallelFor(0,numElements,grainSize,meshPass);
+		}
+	else
+		{
+		/* Run the pass in the calling thread: */
+		(this->*pass)(0,numElements);
+		}
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::linkHalfEdges(
+	size_t rangeBegin,
+	size_t rangeEnd)
+	{
+	for(size_t faceIndex=rangeBegin;faceIndex<rangeEnd;++faceIndex)
+		{
+		const Face& face=faces[faceIndex];
+		for(Card i=0;i<face.numVertices;++i)
+			halfEdgeFaces[face.firstVertexIndex+i]=Card(faceIndex);
+		}
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::linkOppositeHalfEdges(
+	size_t rangeBegin,
+	size_t rangeEnd)
+	{
+	for(size_t halfEdge=rangeBegin;halfEdge<rangeEnd;++halfEdge)
+		{
+		/* The opposite half-edge runs from this half-edge's end vertex to its start vertex: */
+		halfEdgeOpposites[halfEdge]=findHalfEdge(faceVertexIndices[halfEdge],faceVertexIndices[getPreviousHalfEdge(Card(halfEdge))]);
+		}
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::updateAdjacency(
+	void)
+	{
+	if(adjacencyValid)
+		return;
+	
+	/* Assign all half-edges to their faces: */
+	Card numHalfEdges=faces.empty()?0:faces.back().firstVertexIndex+faces.back().numVertices;
+	halfEdgeFaces.resize(numHalfEdges);
+	runPass(&PolygonMesh::linkHalfEdges,faces.size());
+	
+	/* Group all half-edges by their start vertices: */
+	Card numVertices=vertices.size();
+	vertexHalfEdgeOffsets.assign(numVertices+1,0);
+	for(Card halfEdge=0;halfEdge<numHalfEdges;++halfEdge)
+		++vertexHalfEdgeOffsets[faceVertexIndices[getPreviousHalfEdge(halfEdge)]+1];
+	for(Card vertexIndex=0;vertexIndex<numVertices;++vertexIndex)
+		vertexHalfEdgeOffsets[vertexIndex+1]+=vertexHalfEdgeOffsets[vertexIndex];
+	vertexHalfEdges.resize(numHalfEdges);
+	{
+	std::vector<Card> vertexHalfEdgeEnds(vertexHalfEdgeOffsets.begin(),vertexHalfEdgeOffsets.end()-1);
+	for(Card halfEdge=0;halfEdge<numHalfEdges;++halfEdge)
+		vertexHalfEdges[vertexHalfEdgeEnds[faceVertexIndices[getPreviousHalfEdge(halfEdge)]]++]=halfEdge;
+	}
+	
+	/* Link all half-edges to their opposites: */
+	halfEdgeOpposites.resize(numHalfEdges);
+	runPass(&PolygonMesh::linkOppositeHalfEdges,numHalfEdges);
+	
+	/* Keep crease flags of existing half-edges, as faces are only ever appended: */
+	halfEdgeCreaseFlags.resize(numHalfEdges);
+	
+	adjacencyValid=true;
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::markCreaseHalfEdges(
+	size_t rangeBegin,
+	size_t rangeEnd)
+	{
+	for(size_t halfEdge=rangeBegin;halfEdge<rangeEnd;++halfEdge)
+		{
+		/* Check if the half-edge has an opposite: */
+		Card opposite=halfEdgeOpposites[halfEdge];
+		if(opposite==invalidIndex)
+			continue;
+		const Face& face=faces[halfEdgeFaces[halfEdge]];
+		const Face& oppositeFace=faces[halfEdgeFaces[opposite]];
+		
+		/* Check the two faces sharing the edge against the crease rule: */
+		bool crease=false;
+		switch(creaseRule)
+			{
+			case SMOOTHING_GROUPS:
+				crease=(face.smoothingGroupMask&oppositeFace.smoothingGroupMask)==0x0;
+				break;
+			
+			case CREASE_ANGLE:
+				crease=oppositeFace.normal*face.normal<cosCreaseAngle;
+				break;
+			
+			case SURFACE_CREASE_ANGLE:
+				crease=face.surfaceIndex==creaseSurfaceIndex&&oppositeFace.surfaceIndex==creaseSurfaceIndex&&oppositeFace.normal*face.normal<cosCreaseAngle;
+				break;
+			
+			case SURFACE_CREASE_ANGLES:
+				{
+				Scalar cosAngle=oppositeFace.normal*face.normal;
+				crease=cosAngle<cosCreaseAngles[oppositeFace.surfaceIndex]&&cosAngle<cosCreaseAngles[face.surfaceIndex];
+				break;
+				}
+			
+			case SURFACES:
+				crease=oppositeFace.surfaceIndex!=face.surfaceIndex;
+				break;
+			}
+		
+		if(crease)
+			{
+			/* Mark the half-edge: */
+			creaseCalls.set(halfEdge);
+			halfEdgeCreaseFlags.set(halfEdge);
+			}
+		}
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::moveCreaseVertexEdges(
+	size_t rangeBegin,
+	size_t rangeEnd)
+	{
+	for(size_t vertexIndex=rangeBegin;vertexIndex<rangeEnd;++vertexIndex)
+		{
+		/* Only move the outgoing edge if it is an interior edge: */
+		if(findHalfEdge(vertexEdges[vertexIndex],Card(vertexIndex))==invalidIndex)
+			continue;
+		
+		/*******************************************************************
+		Edges were marked in order of half-edge index, and marking an edge
+		moved the outgoing edges of both its vertices to the edge. Find the
+		crease edge marked last among the vertex' outgoing half-edges and
+		their opposites.
+		*******************************************************************/
+		
+		Card lastMark=invalidIndex;
+		Card lastEdge=invalidIndex;
+		for(Card i=vertexHalfEdgeOffsets[vertexIndex];i<vertexHalfEdgeOffsets[vertexIndex+1];++i)
+			{
+			Card halfEdge=vertexHalfEdges[i];
+			if(creaseCalls[halfEdge]&&(lastMark==invalidIndex||lastMark<halfEdge))
+				{
+				lastMark=halfEdge;
+				lastEdge=faceVertexIndices[halfEdge];
+				}
+			Card opposite=halfEdgeOpposites[halfEdge];
+			if(opposite!=invalidIndex&&creaseCalls[opposite]&&(lastMark==invalidIndex||lastMark<opposite))
+				{
+				lastMark=opposite;
+				lastEdge=faceVertexIndices[halfEdge];
+				}
+			}
+		if(lastMark!=invalidIndex)
+			vertexEdges[vertexIndex]=lastEdge;
+		}
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::markCreaseEdges(
+	typename PolygonMesh<MeshVertexParam>::CreaseRule newCreaseRule)
+	{
+	creaseRule=newCreaseRule;
+	updateAdjacency();
+	
+	/* Mark all half-edges matching the crease rule: */
+	Card numHalfEdges=halfEdgeFaces.size();
+	creaseCalls.resize(numHalfEdges);
+	runPass(&PolygonMesh::markCreaseHalfEdges,numHalfEdges);
+	
+	/* Move the outgoing edges of all affected vertices to crease edges to simplify normal vector calculation later: */
+	runPass(&PolygonMesh::moveCreaseVertexEdges,vertices.size());
+	
+	creaseCalls.clear();
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::calcRangeVertexNormals(
+	size_t rangeBegin,
+	size_t rangeEnd)
+	{
+	for(size_t vertexIndex=rangeBegin;vertexIndex<rangeEnd;++vertexIndex)
+		{
+		/* Initialize the vertex normal: */
+		Vector normal=Vector::zero;
+		
+		/* Find the first outgoing half-edge for this vertex (might not exist): */
+		Card firstEdge=findHalfEdge(Card(vertexIndex),vertexEdges[vertexIndex]);
+		
+		/* Loop around the vertex in counter-clockwise order: */
+		Card edge=firstEdge;
+		bool isCreaseVertex=false;
+		Card wedgeStartEdge=firstEdge;
+		do
+			{
+			/* Bail out if boundary edge is reached: */
+			if(edge==invalidIndex)
+				break;
+			const Face& face=faces[halfEdgeFaces[edge]];
+			Card corner=getPreviousHalfEdge(edge);
+			
+			/* Calculate the corner angle: */
+			Vector d0=vertices[faceVertexIndices[getPreviousHalfEdge(corner)]].position-vertices[vertexIndex].position;
+			Vector d1=vertices[faceVertexIndices[edge]].position-vertices[vertexIndex].position;
+			Scalar angleCos=(d0*d1)/(Geometry::mag(d0)*Geometry::mag(d1));
+			Scalar angle;
+			if(angleCos>Scalar(1))
+				angle=Scalar(0);
+			else if(angleCos<Scalar(-1))
+				angle=Math::Constants<Scalar>::pi;
+			else
+				angle=Math::acos(angleCos);
+			
+			/* Accumulate this face's normal vector weighted by corner angle: */
+			normal+=face.normal*angle;
+			
+			/* Find the next edge around the vertex: */
+			edge=halfEdgeOpposites[corner];
+			
+			/* Check if the new edge is a crease edge: */
+			if(edge!=firstEdge&&isCreaseHalfEdge(corner))
+				{
+				/* Store the current accumulated normal in all faces belonging to the current wedge: */
+				normal.normalize();
+				for(Card wedgeEdge=wedgeStartEdge;wedgeEdge!=edge;)
+					{
+					/* Store the per-face vertex normal: */
+					Card wedgeCorner=getPreviousHalfEdge(wedgeEdge);
+					cornerNormals[wedgeCorner]=normal;
+					cornerNormalFlags[wedgeCorner]=1;
+					
+					/* Go to the next edge: */
+					wedgeEdge=halfEdgeOpposites[wedgeCorner];
+					}
+				
+				/* Start accumulating a new wedge: */
+				normal=Vector::zero;
+				wedgeStartEdge=edge;
+				
+				/* Mark the vertex as a crease vertex: */
+				isCreaseVertex=true;
+				}
+			}
+		while(edge!=firstEdge);
+		
+		if(isCreaseVertex)
+			{
+			/* Store the current accumulated normal in all faces belonging to the current wedge: */
+			normal.normalize();
+			for(Card wedgeEdge=wedgeStartEdge;wedgeEdge!=edge;)
+				{
+				/* Store the per-face vertex normal: */
+				Card wedgeCorner=getPreviousHalfEdge(wedgeEdge);
+				cornerNormals[wedgeCorner]=normal;
+				cornerNormalFlags[wedgeCorner]=1;
+				
+				/* Go to the next edge: */
+				wedgeEdge=halfEdgeOpposites[wedgeCorner];
+				}
+			
+			/* Mark the vertex permanently: */
+			vertexCreaseFlags.set(vertexIndex);
+			}
+		else
+			{
+			/* Store the final normal vector: */
+			vertices[vertexIndex].normal=normal.normalize();
+			}
+		}
+	}
+
 template <class MeshVertexParam>
 inline
 PolygonMesh<MeshVertexParam>::PolygonMesh(void)
@@ -548,7 +907,8 @@ PolygonMesh<MeshVertexParam>::PolygonMesh(void)
 	 faceEdges(101),
 	 vertexTexCoords(101),
 	 creaseEdges(101),
-	 vertexNormals(101),
+	 taskScheduler(0),
+	 adjacencyValid(false),
 	 addingFace(false)
 	{
 	}
@@ -559,6 +919,34 @@ PolygonMesh<MeshVertexParam>::~PolygonMesh(void)
 	{
 	}
 
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::setTaskScheduler(
+	Threads::TaskScheduler* newTaskScheduler)
+	{
+	taskScheduler=newTaskScheduler;
+	}
+
+template <class MeshVertexParam>
+inline
+void
+PolygonMesh<MeshVertexParam>::reserve(
+	typename PolygonMesh<MeshVertexParam>::Card numVertices,
+	typename PolygonMesh<MeshVertexParam>::Card numFaces,
+	typename PolygonMesh<MeshVertexParam>::Card numFaceVertices)
+	{
+	/* Reserve room in the vertex and face lists: */
+	vertices.reserve(numVertices);
+	vertexEdges.reserve(numVertices);
+	vertexMultiSurfaceFlags.reserve(numVertices);
+	faceVertexIndices.reserve(numFaceVertices);
+	faces.reserve(numFaces);
+	
+	/* Size the face edge hash table to hold one directed edge per face vertex: */
+	faceEdges.setTableSize((size_t(numFaceVertices)*3)/2+101);
+	}
+
 template <class MeshVertexParam>
 inline
 typename PolygonMesh<MeshVertexParam>::Card
@@ -571,6 +959,7 @@ PolygonMesh<MeshVertexParam>::addVertex(
 	vertexEdges.push_back(invalidIndex); // Vertex doesn't have any edges yet
 	vertexMultiSurfaceFlags.push_back(false); // Not a multi-surface vertex, either
 	vertexCreaseFlags.push_back(false); // Not a crease vertex, either
+	adjacencyValid=false;
 	
 	return result;
 	}
@@ -726,10 +1115,20 @@ PolygonMesh<MeshVertexParam>::setFaceVertexNormal(
 	const typename PolygonMesh<MeshVertexParam>::Vector& newNormal)
 	{
 	/* Mark the vertex as a crease vertex: */
-	vertexCreaseFlags[vertexIndex]=true;
+	vertexCreaseFlags.set(vertexIndex);
 	
 	/* Store the per-face vertex normal: */
-	vertexNormals.setEntry(typename FaceVertexNormalHasher::Entry(FaceVertex(faceIndex,vertexIndex),newNormal));
+	Card corner=findFaceVertex(faceIndex,vertexIndex);
+	if(corner!=invalidIndex)
+		{
+		if(cornerNormals.size()<=corner)
+			{
+			cornerNormals.resize(faceVertexIndices.size());
+			cornerNormalFlags.resize(faceVertexIndices.size(),0);
+			}
+		cornerNormals[corner]=newNormal;
+		cornerNormalFlags[corner]=1;
+		}
 	}
 
 template <class MeshVertexParam>
@@ -882,31 +1281,8 @@ void
 PolygonMesh<MeshVertexParam>::findSmoothingGroupCreaseEdges(
 	void)
 	{
-	/* Iterate through all faces: */
-	for(typename std::vector<Face>::iterator fIt=faces.begin();fIt!=faces.end();++fIt)
-		{
-		/* Iterate through all edges of this face: */
-		Card e0=faceVertexIndices[fIt->firstVertexIndex+fIt->numVertices-1];
-		for(Card i=0;i<fIt->numVertices;++i)
-			{
-			Card e1=faceVertexIndices[fIt->firstVertexIndex+i];
-			
-			/* Check if the edge has an opposite: */
-			typename FaceEdgeHasher::Iterator feIt=faceEdges.findEntry(DirectedEdge(e1,e0));
-			if(!feIt.isFinished())
-				{
-				/* Check if the two faces sharing this edge have a smoothing group in common: */
-				if((fIt->smoothingGroupMask&faces[feIt->getDest().faceIndex].smoothingGroupMask)==0x0)
-					{
-					/* Mark the edge as a crease: */
-					addCreaseEdge(e0,e1);
-					}
-				}
-			
-			/* Go to the next edge: */
-			e0=e1;
-			}
-		}
+	/* Mark all edges whose faces do not have a smoothing group in common: */
+	markCreaseEdges(SMOOTHING_GROUPS);
 	}
 
 template <class MeshVertexParam>
@@ -916,34 +1292,10 @@ PolygonMesh<MeshVertexParam>::findCreaseEdges(
 	typename PolygonMesh<MeshVertexParam>::Scalar creaseAngle)
 	{
 	/* Calculate the cosine of the crease angle: */
-	Scalar cosCreaseAngle=Math::cos(creaseAngle);
+	cosCreaseAngle=Math::cos(creaseAngle);
 	
-	/* Iterate through all faces: */
-	for(typename std::vector<Face>::iterator fIt=faces.begin();fIt!=faces.end();++fIt)
-		{
-		/* Iterate through all edges of this face: */
-		Card e0=faceVertexIndices[fIt->firstVertexIndex+fIt->numVertices-1];
-		for(Card i=0;i<fIt->numVertices;++i)
-			{
-			Card e1=faceVertexIndices[fIt->firstVertexIndex+i];
-			
-			/* Check if the edge has an opposite: */
-			typename FaceEdgeHasher::Iterator feIt=faceEdges.findEntry(DirectedEdge(e1,e0));
-			if(!feIt.isFinished())
-				{
-				/* Calculate the angle between this face and the neighboring face: */
-				Scalar cosAngle=faces[feIt->getDest().faceIndex].normal*fIt->normal;
-				if(cosAngle<cosCreaseAngle)
-					{
-					/* Mark the edge as a crease: */
-					addCreaseEdge(e0,e1);
-					}
-				}
-			
-			/* Go to the next edge: */
-			e0=e1;
-			}
-		}
+	/* Mark all edges whose faces form an angle of more than the crease angle: */
+	markCreaseEdges(CREASE_ANGLE);
 	}
 
 template <class MeshVertexParam>
@@ -954,39 +1306,11 @@ PolygonMesh<MeshVertexParam>::findCreaseEdges(
 	typename PolygonMesh<MeshVertexParam>::Scalar creaseAngle)
 	{
 	/* Calculate the cosine of the crease angle: */
-	Scalar cosCreaseAngle=Math::cos(creaseAngle);
+	creaseSurfaceIndex=surfaceIndex;
+	cosCreaseAngle=Math::cos(creaseAngle);
 	
-	/* Iterate through all faces: */
-	for(typename std::vector<Face>::iterator fIt=faces.begin();fIt!=faces.end();++fIt)
-		if(fIt->surfaceIndex==surfaceIndex)
-			{
-			/* Iterate through all edges of this face: */
-			Card e0=faceVertexIndices[fIt->firstVertexIndex+fIt->numVertices-1];
-			for(Card i=0;i<fIt->numVertices;++i)
-				{
-				Card e1=faceVertexIndices[fIt->firstVertexIndex+i];
-				
-				/* Check if the edge has an opposite whose face belongs to the same surface: */
-				typename FaceEdgeHasher::Iterator feIt=faceEdges.findEntry(DirectedEdge(e1,e0));
-				if(!feIt.isFinished())
-					{
-					Face& face=faces[feIt->getDest().faceIndex];
-					if(face.surfaceIndex==surfaceIndex)
-						{
-						/* Calculate the angle between this face and the neighboring face: */
-						Scalar cosAngle=face.normal*fIt->normal;
-						if(cosAngle<cosCreaseAngle)
-							{
-							/* Mark the edge as a crease: */
-							addCreaseEdge(e0,e1);
-							}
-						}
-					}
-				
-				/* Go to the next edge: */
-				e0=e1;
-				}
-			}
+	/* Mark all edges whose faces both belong to the surface and form an angle of more than the crease angle: */
+	markCreaseEdges(SURFACE_CREASE_ANGLE);
 	}
 
 template <class MeshVertexParam>
@@ -999,41 +1323,13 @@ PolygonMesh<MeshVertexParam>::findCreaseEdges(
 		Misc::throwStdErr("PolygonMesh::findCreaseEdges: Not enough crease angles supplied");
 	
 	/* Calculate the cosines of all crease angles: */
-	std::vector<Scalar> cosCreaseAngles;
+	cosCreaseAngles.clear();
 	cosCreaseAngles.reserve(creaseAngles.size());
 	for(typename std::vector<Scalar>::const_iterator caIt=creaseAngles.begin();caIt!=creaseAngles.end();++caIt)
 		cosCreaseAngles.push_back(Math::cos(*caIt));
 	
-	/* Iterate through all faces: */
-	for(typename std::vector<Face>::iterator fIt=faces.begin();fIt!=faces.end();++fIt)
-		{
-		/* Iterate through all edges of this face: */
-		Card e0=faceVertexIndices[fIt->firstVertexIndex+fIt->numVertices-1];
-		for(Card i=0;i<fIt->numVertices;++i)
-			{
-			Card e1=faceVertexIndices[fIt->firstVertexIndex+i];
-			
-			/* Check if the edge has an opposite whose face belongs to the same surface: */
-			typename FaceEdgeHasher::Iterator feIt=faceEdges.findEntry(DirectedEdge(e1,e0));
-			if(!feIt.isFinished())
-				{
-				Face& face=faces[feIt->getDest().faceIndex];
-				
-				/* Calculate the angle between this face and the neighboring face: */
-				Scalar cosAngle=face.normal*fIt->normal;
-				
-				/* Compare the angle against the crease angles on both sides of the edge: */
-				if(cosAngle<cosCreaseAngles[face.surfaceIndex]&&cosAngle<cosCreaseAngles[fIt->surfaceIndex])
-					{
-					/* Mark the edge as a crease: */
-					addCreaseEdge(e0,e1);
-					}
-				}
-
-			/* Go to the next edge: */
-			e0=e1;
-			}
-		}
+	/* Mark all edges whose faces form an angle of more than the crease angles on both sides: */
+	markCreaseEdges(SURFACE_CREASE_ANGLES);
 	}
 
 template <class MeshVertexParam>
@@ -1042,27 +1338,8 @@ void
 PolygonMesh<MeshVertexParam>::findSurfaceCreaseEdges(
 	void)
 	{
-	/* Iterate through all faces: */
-	for(typename std::vector<Face>::iterator fIt=faces.begin();fIt!=faces.end();++fIt)
-		{
-		/* Iterate through all edges of this face: */
-		Card e0=faceVertexIndices[fIt->firstVertexIndex+fIt->numVertices-1];
-		for(Card i=0;i<fIt->numVertices;++i)
-			{
-			Card e1=faceVertexIndices[fIt->firstVertexIndex+i];
-			
-			/* Check if the edge has an opposite whose face belongs to a different surface: */
-			typename FaceEdgeHasher::Iterator feIt=faceEdges.findEntry(DirectedEdge(e1,e0));
-			if(!feIt.isFinished()&&faces[feIt->getDest().faceIndex].surfaceIndex!=fIt->surfaceIndex)
-				{
-				/* Mark the edge as a crease: */
-				addCreaseEdge(e0,e1);
-				}
-			
-			/* Go to the next edge: */
-			e0=e1;
-			}
-		}
+	/* Mark all edges whose faces belong to different surfaces: */
+	markCreaseEdges(SURFACES);
 	}
 
 template <class MeshVertexParam>
@@ -1071,101 +1348,17 @@ void
 PolygonMesh<MeshVertexParam>::calcVertexNormals(
 	void)
 	{
-	/* Iterate through all vertices (have to do it by index): */
-	Card numVertices=vertices.size();
-	for(Card vertexIndex=0;vertexIndex<numVertices;++vertexIndex)
+	updateAdjacency();
+	
+	/* Make room for per-face normal vectors of all face vertices: */
+	if(cornerNormals.size()<halfEdgeFaces.size())
 		{
-		/* Initialize the vertex normal: */
-		Vector normal=Vector::zero;
-		
-		/* Find the first outgoing edge for this vertex (might not exist): */
-		DirectedEdge firstEdge(vertexIndex,vertexEdges[vertexIndex]);
-		
-		/* Loop around the vertex in counter-clockwise order: */
-		DirectedEdge edge=firstEdge;
-		bool isCreaseVertex=false;
-		DirectedEdge wedgeStartEdge=firstEdge;
-		do
-			{
-			/* Find the face defined by this edge: */
-			typename FaceEdgeHasher::Iterator feIt=faceEdges.findEntry(edge);
-			if(feIt.isFinished()) // Bail out if boundary edge is reached
-				break;
-			Face& face=faces[feIt->getDest().faceIndex];
-			
-			#if 1
-			/* Calculate the corner angle: */
-			Vector d0=vertices[feIt->getDest().previousVertexIndex].position-vertices[edge[0]].position;
-			Vector d1=vertices[edge[1]].position-vertices[edge[0]].position;
-			Scalar angleCos=(d0*d1)/(Geometry::mag(d0)*Geometry::mag(d1));
-			Scalar angle;
-			if(angleCos>Scalar(1))
-				angle=Scalar(0);
-			else if(angleCos<Scalar(-1))
-				angle=Math::Constants<Scalar>::pi;
-			else
-				angle=Math::acos(angleCos);
-			
-			/* Accumulate this face's normal vector weighted by corner angle: */
-			normal+=face.normal*angle;
-			#else
-			/* Accumulate this face's normal vector: */
-			normal+=face.normal;
-			#endif
-			
-			/* Find the next edge around the vertex: */
-			edge.set(1,feIt->getDest().previousVertexIndex);
-			
-			/* Check if the new edge is a crease edge: */
-			if(edge!=firstEdge&&creaseEdges.isEntry(UndirectedEdge(edge[0],edge[1])))
-				{
-				/* Store the current accumulated normal in all faces belonging to the current wedge: */
-				normal.normalize();
-				DirectedEdge wedgeEdge=wedgeStartEdge;
-				while(wedgeEdge!=edge)
-					{
-					/* Store the per-face vertex normal: */
-					const FaceEdge& fe=faceEdges.getEntry(wedgeEdge).getDest();
-					vertexNormals.setEntry(typename FaceVertexNormalHasher::Entry(FaceVertex(fe.faceIndex,vertexIndex),normal));
-					
-					/* Go to the next edge: */
-					wedgeEdge.set(1,fe.previousVertexIndex);
-					}
-				
-				/* Start accumulating a new wedge: */
-				normal=Vector::zero;
-				wedgeStartEdge=edge;
-				
-				/* Mark the vertex as a crease vertex: */
-				isCreaseVertex=true;
-				}
-			}
-		while(edge!=firstEdge);
-		
-		if(isCreaseVertex)
-			{
-			/* Store the current accumulated normal in all faces belonging to the current wedge: */
-			normal.normalize();
-			DirectedEdge wedgeEdge=wedgeStartEdge;
-			while(wedgeEdge!=edge)
-				{
-				/* Store the per-face vertex normal: */
-				const FaceEdge& fe=faceEdges.getEntry(wedgeEdge).getDest();
-				vertexNormals.setEntry(typename FaceVertexNormalHasher::Entry(FaceVertex(fe.faceIndex,vertexIndex),normal));
-				
-				/* Go to the next edge: */
-				wedgeEdge.set(1,fe.previousVertexIndex);
-				}
-			
-			/* Mark the vertex permanently: */
-			vertexCreaseFlags[vertexIndex]=true;
-			}
-		else
-			{
-			/* Store the final normal vector: */
-			vertices[vertexIndex].normal=normal.normalize();
-			}
+		cornerNormals.resize(halfEdgeFaces.size());
+		cornerNormalFlags.resize(halfEdgeFaces.size(),0);
 		}
+	
+	/* Calculate the normal vectors of all vertices: */
+	runPass(&PolygonMesh::calcRangeVertexNormals,vertices.size());
 	}
 
 template <class MeshVertexParam>
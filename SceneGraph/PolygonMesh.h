@@ -31,6 +31,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/HashTable.h>
 
 /* Forward declarations: */
+namespace Threads {
+class TaskScheduler;
+}
 namespace SceneGraph {
 template <class MeshVertexParam>
 class TexCoordCalculator;
@@ -77,21 +80,116 @@ class PolygonMesh
 	typedef Misc::HashTable<DirectedEdge,FaceEdge,DirectedEdge> FaceEdgeHasher; // Hash table type to map directed edges to face edges
 	typedef Misc::HashTable<FaceVertex,TPoint,FaceVertex> FaceVertexTexCoordHasher; // Hash table type to map face vertices to per-face vertex texture coordinates
 	typedef Misc::HashTable<UndirectedEdge,void,UndirectedEdge> CreaseEdgeHasher; // Hash table type to represent sets of crease edges
-	typedef Misc::HashTable<FaceVertex,Vector,FaceVertex> FaceVertexNormalHasher; // Hash table type to map face vertices to per-face vertex normals
+	
+	class BitArray // Class for compact arrays of flags; flags in different 32-flag words can be written concurrently
+		{
+		/* Elements: */
+		public:
+		static const size_t wordSize=32; // Number of flags per storage word
+		private:
+		std::vector<unsigned int> words; // Storage words
+		size_t numFlags; // Number of flags in the array
+		
+		/* Constructors and destructors: */
+		public:
+		BitArray(void)
+			:numFlags(0)
+			{
+			}
+		
+		/* Methods: */
+		size_t size(void) const // Returns the number of flags
+			{
+			return numFlags;
+			}
+		void resize(size_t newNumFlags) // Changes the number of flags; new flags are cleared
+			{
+			if(newNumFlags<numFlags&&newNumFlags%wordSize!=0)
+				words[newNumFlags/wordSize]&=(1U<<(newNumFlags%wordSize))-1U;
+			words.resize((newNumFlags+wordSize-1)/wordSize,0U);
+			numFlags=newNumFlags;
+			}
+		void clear(void) // Removes all flags
+			{
+			words.clear();
+			numFlags=0;
+			}
+		void push_back(bool value) // Appends a flag
+			{
+			resize(numFlags+1);
+			if(value)
+				set(numFlags-1);
+			}
+		bool operator[](size_t index) const // Returns a flag
+			{
+			return (words[index/wordSize]&(1U<<(index%wordSize)))!=0U;
+			}
+		void set(size_t index) // Sets a flag
+			{
+			words[index/wordSize]|=1U<<(index%wordSize);
+			}
+		};
+	
+	enum CreaseRule // Enumerated type for rules to find crease edges
+		{
+		SMOOTHING_GROUPS,CREASE_ANGLE,SURFACE_CREASE_ANGLE,SURFACE_CREASE_ANGLES,SURFACES
+		};
+	
+	class MeshPass; // Functor class to run a pass over a range of vertices, faces, or half-edges
+	
+	friend class MeshPass;
+	
+	class MeshPass
+		{
+		/* Elements: */
+		private:
+		PolygonMesh& mesh; // The processed mesh
+		void (PolygonMesh::*pass)(size_t,size_t); // Method running the pass over a range of elements
+		
+		/* Constructors and destructors: */
+		public:
+		MeshPass(PolygonMesh& sMesh,void (PolygonMesh::*sPass)(size_t,size_t))
+			:mesh(sMesh),pass(sPass)
+			{
+			}
+		
+		/* Methods: */
+		void operator()(size_t rangeBegin,size_t rangeEnd)
+			{
+			(mesh.*pass)(rangeBegin,rangeEnd);
+			}
+		};
 	
 	/* Elements: */
 	private:
 	std::vector<MeshVertex> vertices; // List of mesh vertices
 	std::vector<Card> vertexEdges; // List of one outgoing directed edge for each mesh vertex
 	std::vector<bool> vertexMultiSurfaceFlags; // List of flags indicating per-face texture coordinates for each mesh vertex
-	std::vector<bool> vertexCreaseFlags; // List of crease flags indicating per-face normal vectors for each mesh vertex
+	BitArray vertexCreaseFlags; // List of crease flags indicating per-face normal vectors for each mesh vertex
 	std::vector<Card> faceVertexIndices; // List of vertex indices for each mesh face
 	std::vector<Face> faces; // List of mesh faces
 	Card numSurfaces; // Number of different surfaces present in the mesh
 	FaceEdgeHasher faceEdges; // Hash table of face edges
 	FaceVertexTexCoordHasher vertexTexCoords; // Hash table storing per-face vertex texture coordinates for multi-surface vertices
-	CreaseEdgeHasher creaseEdges; // Hash table of crease edges
-	FaceVertexNormalHasher vertexNormals; // Hash table storing per-face normal vectors for crease vertices
+	CreaseEdgeHasher creaseEdges; // Hash table of crease edges marked explicitly via addCreaseEdge
+	std::vector<Vector> cornerNormals; // Per-face normal vectors of crease vertices, parallel to the face vertex index list
+	std::vector<unsigned char> cornerNormalFlags; // Flags whether a face vertex has a per-face normal vector, parallel to the face vertex index list
+	Threads::TaskScheduler* taskScheduler; // Task scheduler to run crease and normal passes in parallel, or null
+	
+	/* Half-edge adjacency; half-edge h ends at face vertex faceVertexIndices[h] and starts at the preceding face vertex: */
+	bool adjacencyValid; // Flag if the adjacency arrays are up-to-date with the mesh's vertices and faces
+	std::vector<Card> halfEdgeFaces; // Index of the face containing each half-edge
+	std::vector<Card> halfEdgeOpposites; // Index of each half-edge's opposite half-edge, or invalidIndex on boundaries
+	std::vector<Card> vertexHalfEdgeOffsets; // Offsets of each vertex' outgoing half-edges in the outgoing half-edge list
+	std::vector<Card> vertexHalfEdges; // List of outgoing half-edges of all vertices, grouped by start vertex
+	BitArray halfEdgeCreaseFlags; // Flags for half-edges marked as crease edges by the crease edge finders
+	
+	/* Temporary state while finding crease edges: */
+	CreaseRule creaseRule; // Rule by which crease edges are found
+	Card creaseSurfaceIndex; // Surface index for SURFACE_CREASE_ANGLE
+	Scalar cosCreaseAngle; // Cosine of the crease angle for CREASE_ANGLE and SURFACE_CREASE_ANGLE
+	std::vector<Scalar> cosCreaseAngles; // Cosines of the per-surface crease angles for SURFACE_CREASE_ANGLES
+	BitArray creaseCalls; // Flags for half-edges marked as crease edges by the current pass
 	
 	/* Temporary state while adding a face: */
 	bool addingFace; // Flag that we're currently adding a face
@@ -102,8 +200,23 @@ class PolygonMesh
 	void connectFace(Card faceIndex); // Inserts a face into the mesh's connectivity
 	void triangulateFace(Card faceIndex,std::vector<Card>& triangleVertexIndices) const; // Triangulates the given convex or non-convex face; puts triangle vertex index triples into vector
 	const TPoint& getVertexTexCoord(Card faceIndex,Card vertexIndex) const; // Returns texture coordinates of a vertex for a given face
-	const Vector& getVertexNormal(Card faceIndex,Card vertexIndex) const; // Returns normal vector of a vertex for a given face
 	Card getTriangleVertexIndex(Card faceIndex,Card vertexIndex) const;
+	Card getPreviousHalfEdge(Card halfEdge) const // Returns the half-edge preceding the given half-edge in its face
+		{
+		const Face& face=faces[halfEdgeFaces[halfEdge]];
+		return halfEdge!=face.firstVertexIndex?halfEdge-1:halfEdge+face.numVertices-1;
+		}
+	Card findHalfEdge(Card vertexIndex0,Card vertexIndex1) const; // Returns the half-edge from the first to the second vertex, or invalidIndex
+	Card findFaceVertex(Card faceIndex,Card vertexIndex) const; // Returns the position of a vertex in the face vertex index list, or invalidIndex
+	bool isCreaseHalfEdge(Card halfEdge) const; // Returns true if the given half-edge is part of a crease edge
+	void runPass(void (PolygonMesh::*pass)(size_t,size_t),size_t numElements); // Runs a pass over a range of elements, in parallel if a task scheduler is set
+	void linkHalfEdges(size_t rangeBegin,size_t rangeEnd); // Assigns the half-edges of a range of faces to their faces
+	void linkOppositeHalfEdges(size_t rangeBegin,size_t rangeEnd); // Finds the opposites of a range of half-edges
+	void updateAdjacency(void); // Rebuilds the half-edge adjacency if vertices or faces were added
+	void markCreaseHalfEdges(size_t rangeBegin,size_t rangeEnd); // Marks a range of half-edges matching the current crease rule
+	void moveCreaseVertexEdges(size_t rangeBegin,size_t rangeEnd); // Moves the outgoing edges of a range of vertices to crease edges marked by the current pass
+	void markCreaseEdges(CreaseRule newCreaseRule); // Marks all edges matching the given crease rule as crease edges
+	void calcRangeVertexNormals(size_t rangeBegin,size_t rangeEnd); // Calculates normal vectors for a range of vertices
 	
 	/* Constructors and destructors: */
 	public:
@@ -111,6 +224,12 @@ class PolygonMesh
 	~PolygonMesh(void); // Destroys polygon mesh
 	
 	/* New Methods: */
+	Threads::TaskScheduler* getTaskScheduler(void) const // Returns the task scheduler running crease and normal passes
+		{
+		return taskScheduler;
+		}
+	void setTaskScheduler(Threads::TaskScheduler* newTaskScheduler); // Sets a task scheduler to run crease and normal passes in parallel; null runs them in the calling thread
+	void reserve(Card numVertices,Card numFaces,Card numFaceVertices); // Prepares an empty mesh to receive the given total numbers of vertices, faces, and face vertex indices without re-allocating or re-hashing
 	Card getNumVertices(void) const // Returns the current number of vertices in the mesh
 		{
 		return vertices.size();
@@ -124,6 +243,7 @@ class PolygonMesh
 		return vertices[vertexIndex];
 		}
 	Card addVertex(const MeshVertex& newVertex); // Adds a new vertex to the mesh and returns its index
+	const Vector& getVertexNormal(Card faceIndex,Card vertexIndex) const; // Returns normal vector of a vertex for a given face
 	Card getNumFaces(void) const // Returns the current number of faces in the mesh
 		{
 		return faces.size();
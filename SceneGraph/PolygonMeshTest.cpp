@@ -0,0 +1,356 @@
+/***********************************************************************
+PolygonMeshTest - Program to measure the time to find crease edges and
+calculate vertex normals of large triangle meshes with and without a
+task scheduler, and to check the results against a naive reference
+implementation.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <Misc/Timer.h>
+#include <Math/Math.h>
+#include <Math/Constants.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
+#include <Threads/TaskScheduler.h>
+#include <SceneGraph/PolygonMesh.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct MeshVertex // Structure for polygon mesh vertices
+	{
+	/* Embedded classes: */
+	public:
+	typedef float Scalar;
+	typedef Geometry::Point<float,3> Point;
+	typedef Geometry::Vector<float,3> Vector;
+	typedef Geometry::Point<float,2> TPoint;
+	
+	/* Elements: */
+	Point position;
+	Vector normal;
+	TPoint texCoord;
+	};
+
+typedef SceneGraph::PolygonMesh<MeshVertex> Mesh;
+typedef Mesh::Card Card;
+typedef MeshVertex::Vector Vector;
+
+struct Grid // Structure for a height field triangulated into a regular grid
+	{
+	/* Elements: */
+	public:
+	Card size; // Number of vertices along each grid axis
+	std::vector<MeshVertex::Point> points; // Grid vertex positions
+	std::vector<Card> triangles; // Vertex index triples of all triangles
+	};
+
+struct MeshResult // Structure for the timings and normal vector checksum of one run
+	{
+	/* Elements: */
+	public:
+	double buildTime; // Time to add all vertices and faces
+	double creaseTime; // Time to find crease edges
+	double normalTime; // Time to calculate vertex normals
+	unsigned long long checksum; // Checksum over the normal vectors of all face vertices in face order
+	unsigned int numMismatches; // Number of face vertex normals that differ from the reference implementation
+	};
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+void createGrid(Card size,Grid& grid) // Creates a smooth height field crossed by sharp ridges
+	{
+	grid.size=size;
+	grid.points.reserve(size_t(size)*size_t(size));
+	for(Card y=0;y<size;++y)
+		for(Card x=0;x<size;++x)
+			{
+			float z=0.3f*Math::sin(float(x)*0.05f)*Math::cos(float(y)*0.07f);
+			if(x%50==0||y%70==0)
+				z+=2.0f;
+			grid.points.push_back(MeshVertex::Point(float(x),float(y),z));
+			}
+	grid.triangles.reserve(size_t(size-1)*size_t(size-1)*6);
+	for(Card y=0;y<size-1;++y)
+		for(Card x=0;x<size-1;++x)
+			{
+			Card v00=y*size+x;
+			Card v10=v00+1;
+			Card v01=v00+size;
+			Card v11=v01+1;
+			Card t[6]={v00,v10,v11,v00,v11,v01};
+			grid.triangles.insert(grid.triangles.end(),t,t+6);
+			}
+	}
+
+float cornerAngle(const Grid& grid,const Card* triangle,int corner) // Returns a triangle's interior angle at the given corner
+	{
+	const MeshVertex::Point& p=grid.points[triangle[corner]];
+	Vector d0=grid.points[triangle[(corner+2)%3]]-p;
+	Vector d1=grid.points[triangle[(corner+1)%3]]-p;
+	float angleCos=(d0*d1)/(Geometry::mag(d0)*Geometry::mag(d1));
+	if(angleCos>1.0f)
+		return 0.0f;
+	else if(angleCos<-1.0f)
+		return Math::Constants<float>::pi;
+	else
+		return Math::acos(angleCos);
+	}
+
+class ReferenceNormals // Naive crease-aware vertex normal calculation directly from the triangle list
+	{
+	/* Elements: */
+	private:
+	const Grid& grid;
+	float cosCreaseAngle;
+	std::vector<Vector> faceNormals; // Normal vector of each triangle
+	std::vector<Card> vertexFaceOffsets; // Offsets of each vertex' triangles in the vertex triangle list
+	std::vector<Card> vertexFaces; // List of triangles around each vertex
+	
+	/* Constructors and destructors: */
+	public:
+	ReferenceNormals(const Grid& sGrid,float creaseAngle)
+		:grid(sGrid),cosCreaseAngle(Math::cos(creaseAngle))
+		{
+		Card numTriangles=Card(grid.triangles.size()/3);
+		faceNormals.reserve(numTriangles);
+		for(Card f=0;f<numTriangles;++f)
+			{
+			const Card* t=&grid.triangles[f*3];
+			Vector normal=Geometry::cross(grid.points[t[2]]-grid.points[t[1]],grid.points[t[0]]-grid.points[t[2]]);
+			faceNormals.push_back(normal.normalize());
+			}
+		
+		/* Collect the triangles around each vertex: */
+		vertexFaceOffsets.assign(grid.points.size()+1,0);
+		for(std::vector<Card>::const_iterator tIt=grid.triangles.begin();tIt!=grid.triangles.end();++tIt)
+			++vertexFaceOffsets[*tIt+1];
+		for(size_t v=0;v<grid.points.size();++v)
+			vertexFaceOffsets[v+1]+=vertexFaceOffsets[v];
+		vertexFaces.resize(grid.triangles.size());
+		std::vector<Card> ends(vertexFaceOffsets.begin(),vertexFaceOffsets.end()-1);
+		for(size_t i=0;i<grid.triangles.size();++i)
+			vertexFaces[ends[grid.triangles[i]]++]=Card(i/3);
+		}
+	
+	/* Methods: */
+	Card getNumFaces(Card vertexIndex) const
+		{
+		return vertexFaceOffsets[vertexIndex+1]-vertexFaceOffsets[vertexIndex];
+		}
+	Card getFace(Card vertexIndex,Card i) const
+		{
+		return vertexFaces[vertexFaceOffsets[vertexIndex]+i];
+		}
+	void calcNormals(Card vertexIndex,std::vector<Vector>& normals) const // Calculates the vertex' normal vector for each of its triangles
+		{
+		/* Group the vertex' triangles into wedges connected by non-crease edges: */
+		Card numFaces=getNumFaces(vertexIndex);
+		std::vector<Card> wedges(numFaces);
+		for(Card i=0;i<numFaces;++i)
+			wedges[i]=i;
+		bool changed=true;
+		while(changed)
+			{
+			changed=false;
+			for(Card i=0;i<numFaces;++i)
+				for(Card j=i+1;j<numFaces;++j)
+					if(wedges[i]!=wedges[j]&&shareEdge(getFace(vertexIndex,i),getFace(vertexIndex,j),vertexIndex)&&faceNormals[getFace(vertexIndex,i)]*faceNormals[getFace(vertexIndex,j)]>=cosCreaseAngle)
+						{
+						Card w=wedges[i]<wedges[j]?wedges[i]:wedges[j];
+						wedges[i]=wedges[j]=w;
+						changed=true;
+						}
+			}
+		
+		/* Average the triangle normals in each wedge, weighted by corner angle: */
+		normals.assign(numFaces,Vector::zero);
+		for(Card i=0;i<numFaces;++i)
+			{
+			Card f=getFace(vertexIndex,i);
+			const Card* t=&grid.triangles[f*3];
+			int corner=t[0]==vertexIndex?0:(t[1]==vertexIndex?1:2);
+			normals[wedges[i]]+=faceNormals[f]*cornerAngle(grid,t,corner);
+			}
+		for(Card i=0;i<numFaces;++i)
+			normals[i]=normals[wedges[i]];
+		for(Card i=0;i<numFaces;++i)
+			normals[i].normalize();
+		}
+	bool shareEdge(Card f0,Card f1,Card vertexIndex) const // Returns true if the two triangles share an edge at the given vertex
+		{
+		for(int i=0;i<3;++i)
+			{
+			Card v=grid.triangles[f0*3+i];
+			if(v!=vertexIndex)
+				for(int j=0;j<3;++j)
+					if(grid.triangles[f1*3+j]==v)
+						return true;
+			}
+		return false;
+		}
+	};
+
+void hashBytes(unsigned long long& hash,const void* data,size_t size) // Updates an FNV-1a hash
+	{
+	const unsigned char* bytes=static_cast<const unsigned char*>(data);
+	for(size_t i=0;i<size;++i)
+		{
+		hash^=bytes[i];
+		hash*=1099511628211ULL;
+		}
+	}
+
+MeshResult runMesh(const Grid& grid,float creaseAngle,Threads::TaskScheduler* taskScheduler,const ReferenceNormals* reference)
+	{
+	MeshResult result;
+	
+	/* Build the mesh: */
+	Mesh mesh;
+	mesh.setTaskScheduler(taskScheduler);
+	Misc::Timer buildTimer;
+	mesh.reserve(Card(grid.points.size()),Card(grid.triangles.size()/3),Card(grid.triangles.size()));
+	for(std::vector<MeshVertex::Point>::const_iterator pIt=grid.points.begin();pIt!=grid.points.end();++pIt)
+		{
+		MeshVertex mv;
+		mv.position=*pIt;
+		mv.normal=Vector::zero;
+		mv.texCoord=MeshVertex::TPoint::origin;
+		mesh.addVertex(mv);
+		}
+	for(size_t i=0;i<grid.triangles.size();i+=3)
+		mesh.addFace(3,&grid.triangles[i]);
+	buildTimer.elapse();
+	result.buildTime=buildTimer.getTime();
+	
+	/* Find crease edges and calculate vertex normals: */
+	Misc::Timer creaseTimer;
+	mesh.findCreaseEdges(creaseAngle);
+	creaseTimer.elapse();
+	result.creaseTime=creaseTimer.getTime();
+	Misc::Timer normalTimer;
+	mesh.calcVertexNormals();
+	normalTimer.elapse();
+	result.normalTime=normalTimer.getTime();
+	
+	/* Hash the normal vectors of all face vertices: */
+	result.checksum=14695981039346656037ULL;
+	for(size_t i=0;i<grid.triangles.size();++i)
+		hashBytes(result.checksum,mesh.getVertexNormal(Card(i/3),grid.triangles[i]).getComponents(),sizeof(Vector));
+	
+	/* Compare against the reference implementation: */
+	result.numMismatches=0;
+	if(reference!=0)
+		{
+		std::vector<Vector> normals;
+		for(Card v=0;v<Card(grid.points.size());++v)
+			{
+			reference->calcNormals(v,normals);
+			for(Card i=0;i<reference->getNumFaces(v);++i)
+				if(mesh.getVertexNormal(reference->getFace(v,i),v)*normals[i]<0.99999f)
+					++result.numMismatches;
+			}
+		}
+	
+	return result;
+	}
+
+void printResult(const char* name,const MeshResult& result)
+	{
+	printf("%s: building %.3f s, crease edges %.3f s, vertex normals %.3f s, checksum %016llx\n",name,result.buildTime,result.creaseTime,result.normalTime,result.checksum);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numTriangles=10000000;
+	int numWorkers=Threads::TaskScheduler::getNumProcessors()-1;
+	bool checkReference=true;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-triangles")==0&&i+1<argc)
+			numTriangles=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-threads")==0&&i+1<argc)
+			numWorkers=atoi(argv[++i])-1;
+		else if(strcasecmp(argv[i],"-noReference")==0)
+			checkReference=false;
+		}
+	if(numWorkers<1)
+		numWorkers=1;
+	float creaseAngle=float(Math::rad(30.0));
+	
+	/* Create a grid with about the requested number of triangles: */
+	Grid grid;
+	createGrid(Card(Math::sqrt(double(numTriangles)*0.5))+1,grid);
+	printf("%ux%u grid, %u triangles\n",grid.size,grid.size,(unsigned int)(grid.triangles.size()/3));
+	
+	/* Set up the reference implementation: */
+	ReferenceNormals* reference=0;
+	if(checkReference)
+		{
+		Misc::Timer referenceTimer;
+		reference=new ReferenceNormals(grid,creaseAngle);
+		referenceTimer.elapse();
+		printf("Reference adjacency: %.3f s\n",referenceTimer.getTime());
+		}
+	
+	/* Run the mesh in the calling thread, and compare it against the reference implementation: */
+	MeshResult serial=runMesh(grid,creaseAngle,0,reference);
+	printResult("Calling thread",serial);
+	if(checkReference)
+		{
+		printf("%u face vertex normals differ from the reference implementation\n",serial.numMismatches);
+		check(serial.numMismatches==0,"vertex normals match the reference implementation");
+		}
+	delete reference;
+	
+	/* Run the mesh on a task scheduler: */
+	Threads::TaskScheduler taskScheduler(numWorkers);
+	MeshResult parallel=runMesh(grid,creaseAngle,&taskScheduler,0);
+	char name[64];
+	snprintf(name,sizeof(name),"%d worker threads",numWorkers);
+	printResult(name,parallel);
+	check(parallel.checksum==serial.checksum,"task scheduler results are identical to calling thread results");
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -25,6 +25,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <Misc/ThrowStdErr.h>
 #include <Misc/ValueSource.h>
 #include <Threads/GzippedFileCharacterSource.h>
+#include <Geometry/Point.h>
+#include <Geometry/Vector.h>
 #include <Geometry/Box.h>
 #include <GL/gl.h>
 #include <GL/GLColorTemplates.h>
@@ -35,9 +37,33 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <GL/GLGeometryWrappers.h>
 #include <SceneGraph/VRMLFile.h>
 #include <SceneGraph/GLRenderState.h>
+#include <SceneGraph/PolygonMesh.h>
 
 namespace SceneGraph {
 
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct TSurfMeshVertex // Structure for polygon mesh vertices used to calculate smooth vertex normals
+	{
+	/* Embedded classes: */
+	public:
+	typedef float Scalar;
+	typedef Geometry::Point<float,3> Point;
+	typedef Geometry::Vector<float,3> Vector;
+	typedef Geometry::Point<float,2> TPoint;
+	
+	/* Elements: */
+	Point position;
+	Vector normal;
+	TPoint texCoord;
+	};
+
+}
+
 /****************************************
 Methods of class TSurfFileNode::DataItem:
 ****************************************/
@@ -71,7 +97,9 @@ Methods of class TSurfFileNode:
 ******************************/
 
 TSurfFileNode::TSurfFileNode(void)
-	:version(0)
+	:computeNormals(false),
+	 version(0),
+	 taskScheduler(0)
 	{
 	}
 
@@ -91,6 +119,10 @@ void TSurfFileNode::parseField(const char* fieldName,VRMLFile& vrmlFile)
 		{
 		vrmlFile.parseField(url);
 		}
+	else if(strcmp(fieldName,"computeNormals")==0)
+		{
+		vrmlFile.parseField(computeNormals);
+		}
 	else
 		GeometryNode::parseField(fieldName,vrmlFile);
 	}
@@ -154,6 +186,38 @@ void TSurfFileNode::update(void)
 			break;
 		}
 	
+	if(computeNormals.getValue())
+		{
+		/* Calculate smooth vertex normals by angle-weighted averaging over all triangles around each vertex: */
+		PolygonMesh<TSurfMeshVertex> mesh;
+		mesh.setTaskScheduler(taskScheduler);
+		Card numVertices=Card(vertices.size());
+		mesh.reserve(numVertices,Card(indices.size()/3),Card(indices.size()));
+		for(std::vector<Vertex>::const_iterator vIt=vertices.begin();vIt!=vertices.end();++vIt)
+			{
+			TSurfMeshVertex mv;
+			mv.position=vIt->position;
+			mv.normal=TSurfMeshVertex::Vector::zero;
+			mv.texCoord=TSurfMeshVertex::TPoint::origin;
+			mesh.addVertex(mv);
+			}
+		for(std::vector<Card>::const_iterator iIt=indices.begin();iIt+3<=indices.end();iIt+=3)
+			{
+			/* Skip triangles with invalid or repeated vertex indices: */
+			if(iIt[0]<numVertices&&iIt[1]<numVertices&&iIt[2]<numVertices&&iIt[0]!=iIt[1]&&iIt[1]!=iIt[2]&&iIt[2]!=iIt[0])
+				mesh.addFace(3,&*iIt);
+			}
+		mesh.calcVertexNormals();
+		
+		/* Copy the normal vectors of all vertices that belong to at least one triangle: */
+		for(Card i=0;i<numVertices;++i)
+			{
+			const TSurfMeshVertex::Vector& normal=mesh.getVertex(i).normal;
+			if(Geometry::sqr(normal)>0.0f)
+				vertices[i].normal=normal;
+			}
+		}
+	
 	/* Bump up the mesh version number: */
 	++version;
 	}
@@ -179,8 +243,8 @@ void TSurfFileNode::glRenderAction(GLRenderState& renderState) const
 	if(dataItem->vertexBufferObjectId!=0&&dataItem->indexBufferObjectId!=0)
 		{
 		/* Bind the vertex and index buffer objects: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,dataItem->vertexBufferObjectId);
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,dataItem->indexBufferObjectId);
+		renderState.bindVertexBuffer(dataItem->vertexBufferObjectId);
+		renderState.bindIndexBuffer(dataItem->indexBufferObjectId);
 		
 		/* Check if the buffers need to be updated: */
 		if(dataItem->version!=version)
@@ -196,27 +260,21 @@ void TSurfFileNode::glRenderAction(GLRenderState& renderState) const
 		}
 	else
 		{
+		/* Unbind any buffer objects left by other nodes: */
+		renderState.bindVertexBuffer(0);
+		renderState.bindIndexBuffer(0);
+		
 		/* Get the addresses of the vertex and index arrays: */
 		vertexPtr=&vertices[0];
 		indexPtr=&indices[0];
 		}
 	
 	/* Set up the vertex arrays: */
-	GLVertexArrayParts::enable(Vertex::getPartsMask());
+	renderState.enableVertexArrays(Vertex::getPartsMask());
 	glVertexPointer(vertexPtr);
 	
 	/* Draw all triangles: */
 	glDrawElements(GL_TRIANGLES,indices.size(),GL_UNSIGNED_INT,indexPtr);
-	
-	/* Reset the vertex arrays: */
-	GLVertexArrayParts::disable(Vertex::getPartsMask());
-	
-	if(dataItem->vertexBufferObjectId!=0&&dataItem->indexBufferObjectId!=0)
-		{
-		/* Protect the buffer objects: */
-		glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
-		glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
-		}
 	}
 
 void TSurfFileNode::initContext(GLContextData& contextData) const
@@ -226,4 +284,9 @@ void TSurfFileNode::initContext(GLContextData& contextData) const
 	contextData.addDataItem(this,dataItem);
 	}
 
+void TSurfFileNode::setTaskScheduler(Threads::TaskScheduler* newTaskScheduler)
+	{
+	taskScheduler=newTaskScheduler;
+	}
+
 }
@@ -29,6 +29,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/FieldTypes.h>
 #include <SceneGraph/GeometryNode.h>
 
+/* Forward declarations: */
+namespace Threads {
+class TaskScheduler;
+}
+
 namespace SceneGraph {
 
 class TSurfFileNode:public GeometryNode,public GLObject
@@ -54,12 +59,14 @@ class TSurfFileNode:public GeometryNode,public GLObject
 	/* Fields: */
 	public:
 	MFString url; //  Name of the TSurf input file
+	SFBool computeNormals; // Non-standard field to calculate smooth vertex normals instead of using a constant normal vector
 	
 	/* Derived elements: */
 	protected:
 	std::vector<Vertex> vertices; // List of mesh vertices
 	std::vector<Card> indices; // List of mesh vertex indices
 	unsigned int version; // Version number of triangle mesh
+	Threads::TaskScheduler* taskScheduler; // Task scheduler to calculate smooth vertex normals in parallel, or null
 	
 	/* Constructors and destructors: */
 	public:
@@ -77,6 +84,9 @@ class TSurfFileNode:public GeometryNode,public GLObject
 	
 	/* Methods from GLObject: */
 	virtual void initContext(GLContextData& contextData) const;
+	
+	/* New methods: */
+	void setTaskScheduler(Threads::TaskScheduler* newTaskScheduler); // Sets a task scheduler to calculate smooth vertex normals in parallel; null calculates them in the calling thread
 	};
 
 }
@@ -227,7 +227,7 @@ void TextNode::glRenderAction(GLRenderState& renderState) const
 		/* Draw the strings as texture-mapped quads: */
 		for(size_t i=0;i<string.getNumValues();++i)
 			{
-			glBindTexture(GL_TEXTURE_2D,dataItem->textureObjectIds[i]);
+			renderState.bindTexture2D(dataItem->textureObjectIds[i]);
 			glBegin(GL_QUADS);
 			glNormal3f(0.0f,0.0f,1.0f);
 			glTexCoord(stringTexBox[i].getCorner(0));
@@ -241,9 +241,6 @@ void TextNode::glRenderAction(GLRenderState& renderState) const
 			glEnd();
 			}
 		
-		/* Protect the texture objects: */
-		glBindTexture(GL_TEXTURE_2D,0);
-		
 		/* Reset OpenGL state: */
 		glPopAttrib();
 		}
@@ -0,0 +1,332 @@
+/***********************************************************************
+TextureImageCache - Class to share decoded texture images between all
+image texture nodes in a process, and to decode them in background
+threads.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/TextureImageCache.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <new>
+#include <stdexcept>
+#include <Images/ReadImageFile.h>
+#include <Images/ResampleImage.h>
+
+namespace SceneGraph {
+
+/******************************************
+Static elements of class TextureImageCache:
+******************************************/
+
+TextureImageCache TextureImageCache::theCache(2);
+
+/**********************************
+Methods of class TextureImageCache:
+**********************************/
+
+time_t TextureImageCache::getModTime(const std::string& url)
+	{
+	struct stat fileStat;
+	if(stat(url.c_str(),&fileStat)<0)
+		return 0;
+	return fileStat.st_mtime;
+	}
+
+void TextureImageCache::queueImage(TextureImageCache::Image* image,Threads::MutexCond::Lock& cacheLock)
+	{
+	/* Start the decoder threads on the first request: */
+	if(decoderThreads==0)
+		{
+		decoderThreads=new Threads::Thread[numDecoderThreads];
+		for(int i=0;i<numDecoderThreads;++i)
+			decoderThreads[i].start(this,&TextureImageCache::decoderThreadMethod);
+		}
+	
+	/* Queue the image and wake up a decoder thread: */
+	image->state=PENDING;
+	image->queued=true;
+	decodeQueue.push_back(image);
+	mutexCond.signal(cacheLock);
+	}
+
+void TextureImageCache::releaseLevels(TextureImageCache::Image* image)
+	{
+	numBytes-=image->numBytes;
+	image->numBytes=0;
+	std::vector<Images::RGBImage>().swap(image->levels);
+	if(image->state==LOADED)
+		image->state=RELEASED;
+	}
+
+void TextureImageCache::retireImage(TextureImageCache::Image* image)
+	{
+	if(image->queued)
+		{
+		/* Remove the image from the decode queue and delete it: */
+		for(std::deque<Image*>::iterator dqIt=decodeQueue.begin();dqIt!=decodeQueue.end();++dqIt)
+			if(*dqIt==image)
+				{
+				decodeQueue.erase(dqIt);
+				break;
+				}
+		image->queued=false;
+		deleteImage(image);
+		}
+	else if(image->decoding)
+		{
+		/* Let the decoder thread retire the image once it is done: */
+		}
+	else if(image->state==LOADED&&image->cached)
+		{
+		/* Keep the decoded image for reuse until it has to be evicted: */
+		image->lruIt=unusedImages.insert(unusedImages.end(),image);
+		image->unused=true;
+		evictImages();
+		}
+	else
+		{
+		/* The image holds no decoded data worth keeping: */
+		deleteImage(image);
+		}
+	}
+
+void TextureImageCache::deleteImage(TextureImageCache::Image* image)
+	{
+	if(image->cached)
+		images.removeEntry(image->url);
+	if(image->unused)
+		unusedImages.erase(image->lruIt);
+	releaseLevels(image);
+	delete image;
+	}
+
+void TextureImageCache::evictImages(void)
+	{
+	/* Evict the least-recently used unused images until the cache fits its budget: */
+	while(numBytes>memoryBudget&&!unusedImages.empty())
+		deleteImage(unusedImages.front());
+	}
+
+void* TextureImageCache::decoderThreadMethod(void)
+	{
+	while(true)
+		{
+		/* Wait for the next image to decode: */
+		Image* image;
+		{
+		Threads::MutexCond::Lock cacheLock(mutexCond);
+		while(!shutdown&&decodeQueue.empty())
+			mutexCond.wait(cacheLock);
+		if(shutdown)
+			break;
+		image=decodeQueue.front();
+		decodeQueue.pop_front();
+		image->queued=false;
+		image->decoding=true;
+		}
+		
+		/* Decode the image and create its mipmap pyramid outside the lock: */
+		time_t modTime=getModTime(image->url);
+		std::vector<Images::RGBImage> levels;
+		ImageState newState=LOADED;
+		try
+			{
+			Images::RGBImage decodedImage=Images::readImageFile(image->url.c_str());
+			Images::createMipmapPyramid(decodedImage,levels);
+			}
+		catch(const std::runtime_error& err)
+			{
+			/* Mark the image as failed; the texture will not be shown: */
+			newState=FAILED;
+			}
+		catch(const std::bad_alloc& err)
+			{
+			/* The image is too large to decode; mark it as failed: */
+			newState=FAILED;
+			}
+		catch(...)
+			{
+			/* Don't let any other error escape the decoder thread, and mark the image as failed: */
+			newState=FAILED;
+			}
+		if(newState==FAILED)
+			std::vector<Images::RGBImage>().swap(levels);
+		
+		/* Calculate the size of the decoded image: */
+		size_t levelsSize=0;
+		for(std::vector<Images::RGBImage>::const_iterator lIt=levels.begin();lIt!=levels.end();++lIt)
+			levelsSize+=size_t(lIt->getWidth())*size_t(lIt->getHeight())*3;
+		
+		/* Publish the decoded image: */
+		Threads::MutexCond::Lock cacheLock(mutexCond);
+		image->levels.swap(levels);
+		image->state=newState;
+		image->modTime=modTime;
+		image->numBytes=levelsSize;
+		numBytes+=levelsSize;
+		image->decoding=false;
+		
+		/* Retire the image if it was released while being decoded, or evict unused images to make room: */
+		if(image->refCount==0&&image->numUploads==0)
+			retireImage(image);
+		else
+			evictImages();
+		}
+	
+	return 0;
+	}
+
+TextureImageCache::TextureImageCache(int sNumDecoderThreads)
+	:images(17),
+	 memoryBudget(size_t(256)*1024*1024),numBytes(0),
+	 numDecoderThreads(sNumDecoderThreads),decoderThreads(0),
+	 shutdown(false)
+	{
+	}
+
+TextureImageCache::~TextureImageCache(void)
+	{
+	if(decoderThreads!=0)
+		{
+		/* Tell the decoder threads to terminate, and wait for them: */
+		{
+		Threads::MutexCond::Lock cacheLock(mutexCond);
+		shutdown=true;
+		mutexCond.broadcast(cacheLock);
+		}
+		delete[] decoderThreads;
+		}
+	
+	/* Delete all cached images: */
+	for(ImageMap::Iterator iIt=images.begin();!iIt.isFinished();++iIt)
+		delete iIt->getDest();
+	}
+
+void TextureImageCache::setMemoryBudget(size_t newMemoryBudget)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	memoryBudget=newMemoryBudget;
+	evictImages();
+	}
+
+size_t TextureImageCache::getNumBytes(void)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	return numBytes;
+	}
+
+const TextureImageCache::Image* TextureImageCache::requestImage(const std::string& url)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	
+	/* Check if the image has been requested before: */
+	ImageMap::Iterator iIt=images.findEntry(url);
+	if(!iIt.isFinished())
+		{
+		Image* image=iIt->getDest();
+		
+		/* Check if the image file changed since it was decoded: */
+		if(image->state==PENDING||getModTime(url)==image->modTime)
+			{
+			/* Share the cached image: */
+			if(image->unused)
+				{
+				unusedImages.erase(image->lruIt);
+				image->unused=false;
+				}
+			++image->refCount;
+			return image;
+			}
+		
+		/* Drop the stale image from the cache; texture nodes still using it keep it until they release it: */
+		if(image->refCount==0&&image->numUploads==0)
+			deleteImage(image);
+		else
+			{
+			images.removeEntry(iIt);
+			image->cached=false;
+			}
+		}
+	
+	/* Create a new image and queue it for decoding: */
+	Image* result=new Image(url);
+	images.setEntry(ImageMap::Entry(url,result));
+	queueImage(result,cacheLock);
+	
+	return result;
+	}
+
+void TextureImageCache::releaseImage(const TextureImageCache::Image* image)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	
+	/* Retire the image if it was the last reference: */
+	Image* img=const_cast<Image*>(image);
+	--img->refCount;
+	if(img->refCount==0&&img->numUploads==0)
+		retireImage(img);
+	}
+
+TextureImageCache::ImageState TextureImageCache::getImageState(const TextureImageCache::Image* image)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	return image->state;
+	}
+
+bool TextureImageCache::startUpload(const TextureImageCache::Image* image)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	
+	Image* img=const_cast<Image*>(image);
+	if(img->state==LOADED)
+		{
+		/* Lock the decoded levels until the upload is finished: */
+		++img->numUploads;
+		return true;
+		}
+	else
+		{
+		/* Decode the image again if its levels were already released after previous uploads: */
+		if(img->state==RELEASED)
+			queueImage(img,cacheLock);
+		return false;
+		}
+	}
+
+void TextureImageCache::finishUpload(const TextureImageCache::Image* image)
+	{
+	Threads::MutexCond::Lock cacheLock(mutexCond);
+	
+	Image* img=const_cast<Image*>(image);
+	--img->numUploads;
+	if(img->numUploads==0)
+		{
+		if(img->refCount>0)
+			{
+			/* All texture objects are up-to-date; release the decoded levels: */
+			releaseLevels(img);
+			}
+		else
+			retireImage(img);
+		}
+	}
+
+}
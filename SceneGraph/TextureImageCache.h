@@ -0,0 +1,145 @@
+/***********************************************************************
+TextureImageCache - Class to share decoded texture images between all
+image texture nodes in a process, and to decode them in background
+threads.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_TEXTUREIMAGECACHE_INCLUDED
+#define SCENEGRAPH_TEXTUREIMAGECACHE_INCLUDED
+
+#include <stddef.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <Misc/StringHashFunctions.h>
+#include <Misc/HashTable.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+#include <Images/RGBImage.h>
+
+namespace SceneGraph {
+
+class TextureImageCache
+	{
+	/* Embedded classes: */
+	public:
+	enum ImageState // Enumerated type for states of cached images
+		{
+		PENDING,LOADED,FAILED,RELEASED
+		};
+	
+	class Image // Class for cached images
+		{
+		friend class TextureImageCache;
+		
+		/* Elements: */
+		private:
+		std::string url; // URL of the image file
+		ImageState state; // Current state of the image; protected by the cache's mutex
+		std::vector<Images::RGBImage> levels; // The decoded image and its mipmap levels; must not be accessed until the image is loaded
+		time_t modTime; // Modification time of the image file when it was last decoded
+		size_t numBytes; // Total size of the decoded image and its mipmap levels
+		unsigned int refCount; // Number of texture nodes using the image
+		unsigned int numUploads; // Number of texture objects currently uploading the decoded image
+		bool queued; // Flag whether the image is waiting in the decode queue
+		bool decoding; // Flag whether a decoder thread is currently decoding the image
+		bool cached; // Flag whether the image is still in the cache's URL map
+		std::list<Image*>::iterator lruIt; // Position of the image in the list of unused images, if it is unused and holds decoded levels
+		bool unused; // Flag whether the image is in the list of unused images
+		
+		/* Constructors and destructors: */
+		Image(const std::string& sUrl)
+			:url(sUrl),state(PENDING),
+			 modTime(0),numBytes(0),
+			 refCount(1),numUploads(0),
+			 queued(false),decoding(false),cached(true),unused(false)
+			{
+			}
+		
+		/* Methods: */
+		public:
+		const std::string& getUrl(void) const // Returns the image's URL
+			{
+			return url;
+			}
+		const Images::RGBImage& getImage(void) const // Returns the decoded image; only valid between successful startUpload and finishUpload calls
+			{
+			return levels[0];
+			}
+		unsigned int getNumLevels(void) const // Returns the number of mipmap levels of the decoded image; only valid between successful startUpload and finishUpload calls
+			{
+			return (unsigned int)(levels.size());
+			}
+		const Images::RGBImage& getLevel(unsigned int level) const // Returns the given mipmap level of the decoded image; only valid between successful startUpload and finishUpload calls
+			{
+			return levels[level];
+			}
+		};
+	
+	private:
+	typedef Misc::HashTable<std::string,Image*> ImageMap; // Hash table type to map URLs to cached images
+	
+	/* Elements: */
+	static TextureImageCache theCache; // The process-wide texture image cache
+	Threads::MutexCond mutexCond; // Mutex protecting the cache's state, and condition variable to wake up decoder threads
+	ImageMap images; // Map of all cached images
+	std::deque<Image*> decodeQueue; // Queue of images waiting to be decoded
+	std::list<Image*> unusedImages; // List of decoded images no longer used by any texture node, in least-recently used order
+	size_t memoryBudget; // Maximum total size of decoded images before unused images are evicted
+	size_t numBytes; // Total size of all decoded images currently held by the cache
+	int numDecoderThreads; // Number of background decoder threads
+	Threads::Thread* decoderThreads; // Array of background decoder threads; started on the first request
+	bool shutdown; // Flag to tell the decoder threads to terminate
+	
+	/* Private methods: */
+	static time_t getModTime(const std::string& url); // Returns the modification time of the given image file, or 0 if the file does not exist
+	void queueImage(Image* image,Threads::MutexCond::Lock& cacheLock); // Queues the given image for decoding; must be called with the cache locked
+	void releaseLevels(Image* image); // Discards the given image's decoded levels; must be called with the cache locked
+	void retireImage(Image* image); // Handles an image that is no longer used by any texture node or texture object; must be called with the cache locked
+	void deleteImage(Image* image); // Removes the given image from the cache and deletes it; must be called with the cache locked
+	void evictImages(void); // Evicts unused images until the cache is within its memory budget; must be called with the cache locked
+	void* decoderThreadMethod(void); // Decodes queued images
+	
+	/* Constructors and destructors: */
+	TextureImageCache(int sNumDecoderThreads); // Creates an empty cache with the given number of decoder threads
+	TextureImageCache(const TextureImageCache& source); // Prohibit copy constructor
+	TextureImageCache& operator=(const TextureImageCache& source); // Prohibit assignment operator
+	~TextureImageCache(void);
+	
+	/* Methods: */
+	public:
+	static TextureImageCache& getTheCache(void) // Returns the process-wide texture image cache
+		{
+		return theCache;
+		}
+	void setMemoryBudget(size_t newMemoryBudget); // Sets the maximum total size of decoded images before images no longer used by any texture node are evicted
+	size_t getNumBytes(void); // Returns the total size of all decoded images currently held by the cache
+	const Image* requestImage(const std::string& url); // Returns the cached image for the given URL and adds a reference to it; queues the image for decoding if it was not decoded yet, or if its file changed since it was decoded
+	void releaseImage(const Image* image); // Removes a reference to the given image; image is kept for reuse until it is evicted to stay within the memory budget
+	ImageState getImageState(const Image* image); // Returns the current state of the given cached image
+	bool startUpload(const Image* image); // Locks the decoded levels of the given image while they are uploaded into a texture object and returns true; returns false if the image is not decoded, and queues it for decoding again if its levels were released
+	void finishUpload(const Image* image); // Unlocks the decoded levels of the given image; releases them once all texture objects using the image have finished uploading
+	};
+
+}
+
+#endif
@@ -23,6 +23,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/VRMLFile.h>
 
 #include <stdlib.h>
+#include <stdexcept>
 #include <Misc/StringPrintf.h>
 #include <Misc/ThrowStdErr.h>
 #include <Misc/CharacterSource.h>
@@ -33,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 #include <SceneGraph/EventTypes.h>
 #include <SceneGraph/NodeCreator.h>
 #include <SceneGraph/GraphNode.h>
+#include <SceneGraph/InlineFileCache.h>
 
 namespace SceneGraph {
 
@@ -66,7 +68,7 @@ void parseRoute(VRMLFile& vrmlFile)
 		std::string sourceNode(source,periodPtr);
 		eventOut=vrmlFile.useNode(sourceNode.c_str())->getEventOut(periodPtr+1);
 		}
-	catch(Node::FieldError err)
+	catch(const Node::FieldError&)
 		{
 		throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("unknown field \"%s\" in event source",periodPtr+1));
 		}
@@ -98,7 +100,7 @@ void parseRoute(VRMLFile& vrmlFile)
 		std::string sinkNode(sink,periodPtr);
 		eventIn=vrmlFile.useNode(sinkNode.c_str())->getEventIn(periodPtr+1);
 		}
-	catch(Node::FieldError err)
+	catch(const Node::FieldError&)
 		{
 		throw VRMLFile::ParseError(vrmlFile,Misc::stringPrintf("unknown field \"%s\" in event sink",periodPtr+1));
 		}
@@ -109,7 +111,7 @@ void parseRoute(VRMLFile& vrmlFile)
 		{
 		route=eventOut->connectTo(eventIn);
 		}
-	catch(Route::TypeMismatchError err)
+	catch(const Route::TypeMismatchError&)
 		{
 		throw VRMLFile::ParseError(vrmlFile,"mismatching field types in route definition");
 		}
@@ -529,6 +531,29 @@ VRMLFile::VRMLFile(std::string sSourceUrl,Misc::CharacterSource& sSource,NodeCre
 	}
 
 void VRMLFile::parse(GroupNodePointer root)
+	{
+	try
+		{
+		parseNodes(root);
+		}
+	catch(...)
+		{
+		/* Let pending inlined files finish loading before the node creator might go away: */
+		try
+			{
+			InlineFileCache::getTheCache().waitForLoads(nodeCreator.getTaskScheduler());
+			}
+		catch(const std::runtime_error&)
+			{
+			}
+		throw;
+		}
+	
+	/* Wait for all inlined files, which are loaded in parallel: */
+	InlineFileCache::getTheCache().waitForLoads(nodeCreator.getTaskScheduler());
+	}
+
+void VRMLFile::parseNodes(GroupNodePointer root)
 	{
 	/* Read nodes until end of file: */
 	while(!eof())
@@ -117,7 +117,8 @@ class VRMLFile:public Misc::TokenSource
 		}
 	
 	/* Main method: */
-	void parse(GroupNodePointer root); // Adds top-level nodes from the VRML file to the given group node
+	void parse(GroupNodePointer root); // Adds top-level nodes from the VRML file to the given group node, and waits until all inlined VRML files are loaded
+	void parseNodes(GroupNodePointer root); // Adds top-level nodes from the VRML file to the given group node without waiting for inlined VRML files
 	
 	/* Methods called during parsing: */
 	template <class ValueParam>
@@ -0,0 +1,175 @@
+/***********************************************************************
+VertexCacheOptimizer - Functions to reorder indexed triangle sets for
+post-transform vertex cache and vertex fetch locality.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <SceneGraph/VertexCacheOptimizer.h>
+
+#include <stddef.h>
+
+namespace SceneGraph {
+
+void optimizeTriangleOrder(std::vector<GLuint>& triangleIndices,GLuint numVertices,unsigned int cacheSize)
+	{
+	size_t numTriangles=triangleIndices.size()/3;
+	if(numTriangles==0)
+		return;
+	
+	/* Count the number of triangles using each vertex: */
+	std::vector<GLuint> liveCounts(numVertices,0);
+	for(std::vector<GLuint>::const_iterator tiIt=triangleIndices.begin();tiIt!=triangleIndices.end();++tiIt)
+		++liveCounts[*tiIt];
+	
+	/* Create the vertex-triangle adjacency lists: */
+	std::vector<size_t> adjacencyOffsets(numVertices+1);
+	adjacencyOffsets[0]=0;
+	for(GLuint v=0;v<numVertices;++v)
+		adjacencyOffsets[v+1]=adjacencyOffsets[v]+liveCounts[v];
+	std::vector<GLuint> adjacentTriangles(adjacencyOffsets[numVertices]);
+	{
+	std::vector<size_t> fillOffsets(adjacencyOffsets.begin(),adjacencyOffsets.end()-1);
+	for(size_t i=0;i<numTriangles*3;++i)
+		adjacentTriangles[fillOffsets[triangleIndices[i]]++]=GLuint(i/3);
+	}
+	
+	/* Emit triangles by fanning around vertices that are still in the simulated cache: */
+	std::vector<GLuint> result;
+	result.reserve(numTriangles*3);
+	std::vector<bool> emitted(numTriangles,false);
+	std::vector<size_t> cacheTimeStamps(numVertices,0);
+	size_t timeStamp=cacheSize+1;
+	std::vector<GLuint> deadEndStack; // Recently used vertices to restart from when a fan runs dry
+	std::vector<GLuint> candidates; // Vertices of the triangles emitted around the current fanning vertex
+	GLuint cursor=0; // Next vertex to check when the dead-end stack is empty
+	GLuint fanningVertex=triangleIndices[0];
+	while(true)
+		{
+		/* Emit all remaining triangles around the fanning vertex: */
+		candidates.clear();
+		for(size_t a=adjacencyOffsets[fanningVertex];a<adjacencyOffsets[fanningVertex+1];++a)
+			{
+			GLuint triangle=adjacentTriangles[a];
+			if(!emitted[triangle])
+				{
+				for(int i=0;i<3;++i)
+					{
+					GLuint v=triangleIndices[triangle*3+i];
+					result.push_back(v);
+					deadEndStack.push_back(v);
+					candidates.push_back(v);
+					--liveCounts[v];
+					
+					/* Check if the vertex causes a cache miss: */
+					if(timeStamp-cacheTimeStamps[v]>cacheSize)
+						cacheTimeStamps[v]=timeStamp++;
+					}
+				emitted[triangle]=true;
+				}
+			}
+		
+		/* Select the candidate that is oldest in the cache while still remaining in it after emitting its fan: */
+		bool haveNext=false;
+		size_t bestPriority=0;
+		for(std::vector<GLuint>::const_iterator cIt=candidates.begin();cIt!=candidates.end();++cIt)
+			if(liveCounts[*cIt]>0)
+				{
+				size_t priority=0;
+				size_t age=timeStamp-cacheTimeStamps[*cIt];
+				if(age+2*liveCounts[*cIt]<=cacheSize)
+					priority=age;
+				if(!haveNext||bestPriority<priority)
+					{
+					fanningVertex=*cIt;
+					bestPriority=priority;
+					haveNext=true;
+					}
+				}
+		
+		if(!haveNext)
+			{
+			/* Restart from the most recently used vertex that still has triangles: */
+			while(!deadEndStack.empty()&&!haveNext)
+				{
+				GLuint v=deadEndStack.back();
+				deadEndStack.pop_back();
+				if(liveCounts[v]>0)
+					{
+					fanningVertex=v;
+					haveNext=true;
+					}
+				}
+			
+			/* Otherwise restart from the next vertex in input order that still has triangles: */
+			while(cursor<numVertices&&!haveNext)
+				{
+				if(liveCounts[cursor]>0)
+					{
+					fanningVertex=cursor;
+					haveNext=true;
+					}
+				++cursor;
+				}
+			
+			if(!haveNext)
+				break;
+			}
+		}
+	
+	triangleIndices.swap(result);
+	}
+
+void optimizeVertexOrder(std::vector<GLuint>& triangleIndices,GLuint numVertices,std::vector<GLuint>& vertexOrder)
+	{
+	/* Assign new vertex indices in order of first use: */
+	const GLuint unused=~GLuint(0);
+	std::vector<GLuint> newIndices(numVertices,unused);
+	vertexOrder.clear();
+	for(std::vector<GLuint>::iterator tiIt=triangleIndices.begin();tiIt!=triangleIndices.end();++tiIt)
+		{
+		if(newIndices[*tiIt]==unused)
+			{
+			newIndices[*tiIt]=GLuint(vertexOrder.size());
+			vertexOrder.push_back(*tiIt);
+			}
+		*tiIt=newIndices[*tiIt];
+		}
+	}
+
+double calcACMR(const std::vector<GLuint>& triangleIndices,GLuint numVertices,unsigned int cacheSize)
+	{
+	size_t numTriangles=triangleIndices.size()/3;
+	if(numTriangles==0)
+		return 0.0;
+	
+	/* Simulate a FIFO cache using the time stamps at which vertices entered it: */
+	std::vector<size_t> cacheTimeStamps(numVertices,0);
+	size_t timeStamp=cacheSize+1;
+	size_t numMisses=0;
+	for(std::vector<GLuint>::const_iterator tiIt=triangleIndices.begin();tiIt!=triangleIndices.end();++tiIt)
+		if(timeStamp-cacheTimeStamps[*tiIt]>cacheSize)
+			{
+			cacheTimeStamps[*tiIt]=timeStamp++;
+			++numMisses;
+			}
+	
+	return double(numMisses)/double(numTriangles);
+	}
+
+}
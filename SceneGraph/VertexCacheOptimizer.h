@@ -0,0 +1,37 @@
+/***********************************************************************
+VertexCacheOptimizer - Functions to reorder indexed triangle sets for
+post-transform vertex cache and vertex fetch locality.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef SCENEGRAPH_VERTEXCACHEOPTIMIZER_INCLUDED
+#define SCENEGRAPH_VERTEXCACHEOPTIMIZER_INCLUDED
+
+#include <vector>
+#include <GL/gl.h>
+
+namespace SceneGraph {
+
+void optimizeTriangleOrder(std::vector<GLuint>& triangleIndices,GLuint numVertices,unsigned int cacheSize =16); // Reorders the triangles of an indexed triangle set for a FIFO vertex cache of the given size using Sander et al.'s Tipsify algorithm
+void optimizeVertexOrder(std::vector<GLuint>& triangleIndices,GLuint numVertices,std::vector<GLuint>& vertexOrder); // Renumbers vertices in order of first use; returns old index of each new vertex in vertexOrder; drops unused vertices
+double calcACMR(const std::vector<GLuint>& triangleIndices,GLuint numVertices,unsigned int cacheSize =16); // Returns the average number of vertex cache misses per triangle for a FIFO cache of the given size
+
+}
+
+#endif
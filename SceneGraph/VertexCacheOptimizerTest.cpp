@@ -0,0 +1,229 @@
+/***********************************************************************
+VertexCacheOptimizerTest - Program to measure the average cache miss
+ratio of indexed triangle sets before and after vertex cache
+optimization, and to check that optimization preserves all triangles
+and their orientations.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Simple Scene Graph Renderer (SceneGraph).
+
+The Simple Scene Graph Renderer is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Simple Scene Graph Renderer is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Simple Scene Graph Renderer; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include <Misc/Timer.h>
+#include <SceneGraph/VertexCacheOptimizer.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct Triangle // Structure for triangles with their smallest vertex index first, which keeps their orientation
+	{
+	/* Elements: */
+	public:
+	GLuint v[3];
+	
+	/* Constructors and destructors: */
+	Triangle(GLuint v0,GLuint v1,GLuint v2)
+		{
+		if(v0<=v1&&v0<=v2)
+			{
+			v[0]=v0;
+			v[1]=v1;
+			v[2]=v2;
+			}
+		else if(v1<=v2)
+			{
+			v[0]=v1;
+			v[1]=v2;
+			v[2]=v0;
+			}
+		else
+			{
+			v[0]=v2;
+			v[1]=v0;
+			v[2]=v1;
+			}
+		}
+	
+	/* Methods: */
+	bool operator<(const Triangle& other) const
+		{
+		for(int i=0;i<3;++i)
+			if(v[i]!=other.v[i])
+				return v[i]<other.v[i];
+		return false;
+		}
+	bool operator==(const Triangle& other) const
+		{
+		return v[0]==other.v[0]&&v[1]==other.v[1]&&v[2]==other.v[2];
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+void createGrid(unsigned int size,std::vector<GLuint>& triangleIndices,GLuint& numVertices) // Creates a regular grid of two triangles per cell, in row order
+	{
+	for(unsigned int y=0;y<size;++y)
+		for(unsigned int x=0;x<size;++x)
+			{
+			GLuint v00=y*(size+1)+x;
+			GLuint v10=v00+1;
+			GLuint v01=v00+size+1;
+			GLuint v11=v01+1;
+			triangleIndices.push_back(v00);
+			triangleIndices.push_back(v10);
+			triangleIndices.push_back(v11);
+			triangleIndices.push_back(v00);
+			triangleIndices.push_back(v11);
+			triangleIndices.push_back(v01);
+			}
+	numVertices=(size+1)*(size+1);
+	}
+
+void shuffleTriangles(std::vector<GLuint>& triangleIndices) // Randomly permutes the triangles
+	{
+	size_t numTriangles=triangleIndices.size()/3;
+	for(size_t i=numTriangles-1;i>0;--i)
+		{
+		size_t j=size_t(rand())%(i+1);
+		for(int k=0;k<3;++k)
+			std::swap(triangleIndices[i*3+k],triangleIndices[j*3+k]);
+		}
+	}
+
+std::vector<Triangle> getTriangles(const std::vector<GLuint>& triangleIndices,const std::vector<GLuint>* vertexOrder) // Returns the sorted list of triangles, with vertices mapped back to their original indices if a vertex order is given
+	{
+	std::vector<Triangle> result;
+	result.reserve(triangleIndices.size()/3);
+	for(size_t i=0;i+2<triangleIndices.size();i+=3)
+		{
+		GLuint v[3];
+		for(int k=0;k<3;++k)
+			v[k]=vertexOrder!=0?(*vertexOrder)[triangleIndices[i+k]]:triangleIndices[i+k];
+		result.push_back(Triangle(v[0],v[1],v[2]));
+		}
+	std::sort(result.begin(),result.end());
+	return result;
+	}
+
+void testMesh(const char* name,const std::vector<GLuint>& triangleIndices,GLuint numVertices,double maxOptimizedACMR)
+	{
+	double acmrBefore=SceneGraph::calcACMR(triangleIndices,numVertices,16);
+	
+	/* Optimize the triangle and vertex orders: */
+	std::vector<GLuint> optimized=triangleIndices;
+	Misc::Timer triangleTimer;
+	SceneGraph::optimizeTriangleOrder(optimized,numVertices);
+	triangleTimer.elapse();
+	std::vector<GLuint> vertexOrder;
+	Misc::Timer vertexTimer;
+	SceneGraph::optimizeVertexOrder(optimized,numVertices,vertexOrder);
+	vertexTimer.elapse();
+	
+	double acmr16=SceneGraph::calcACMR(optimized,GLuint(vertexOrder.size()),16);
+	double acmr32=SceneGraph::calcACMR(optimized,GLuint(vertexOrder.size()),32);
+	printf("%s: %u triangles, ACMR %.3f -> %.3f (cache size 16), %.3f (cache size 32); triangle order %.1f ms, vertex order %.1f ms\n",name,(unsigned int)(triangleIndices.size()/3),acmrBefore,acmr16,acmr32,triangleTimer.getTime()*1000.0,vertexTimer.getTime()*1000.0);
+	
+	check(getTriangles(optimized,&vertexOrder)==getTriangles(triangleIndices,0),"optimization keeps all triangles and their orientations");
+	std::vector<bool> used(numVertices,false);
+	for(std::vector<GLuint>::const_iterator iIt=triangleIndices.begin();iIt!=triangleIndices.end();++iIt)
+		used[*iIt]=true;
+	check(vertexOrder.size()==size_t(std::count(used.begin(),used.end(),true)),"vertex order contains exactly the used vertices");
+	check(acmr16<=acmrBefore,"optimization does not increase the ACMR");
+	check(acmr16<=maxOptimizedACMR,"optimized ACMR is within the expected bound");
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int gridSize=1000;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-size")==0&&i+1<argc)
+			gridSize=(unsigned int)(atoi(argv[++i]));
+		}
+	srand(1);
+	
+	/* A regular grid in row order, as written by most exporters: */
+	std::vector<GLuint> grid;
+	GLuint numGridVertices;
+	createGrid(gridSize,grid,numGridVertices);
+	testMesh("Grid in row order",grid,numGridVertices,0.7);
+	
+	/* The same grid in random triangle order: */
+	shuffleTriangles(grid);
+	testMesh("Grid in random order",grid,numGridVertices,0.7);
+	
+	/* Many small patches whose triangles are interleaved, as in some CAD exports: */
+	std::vector<std::vector<GLuint> > patches(400);
+	GLuint numPatchVertices=0;
+	for(std::vector<std::vector<GLuint> >::iterator pIt=patches.begin();pIt!=patches.end();++pIt)
+		{
+		GLuint numVertices;
+		createGrid(12,*pIt,numVertices);
+		for(std::vector<GLuint>::iterator iIt=pIt->begin();iIt!=pIt->end();++iIt)
+			*iIt+=numPatchVertices;
+		numPatchVertices+=numVertices;
+		}
+	std::vector<GLuint> interleaved;
+	for(size_t t=0;t<patches[0].size();t+=3)
+		for(std::vector<std::vector<GLuint> >::iterator pIt=patches.begin();pIt!=patches.end();++pIt)
+			interleaved.insert(interleaved.end(),pIt->begin()+t,pIt->begin()+t+3);
+	testMesh("Interleaved patches",interleaved,numPatchVertices,0.8);
+	
+	/* Random triangles over a small vertex set, with unused vertices: */
+	std::vector<GLuint> random;
+	GLuint numRandomVertices=5000;
+	while(random.size()<30000*3)
+		{
+		GLuint v0=GLuint(rand())%(numRandomVertices-100);
+		GLuint v1=GLuint(rand())%(numRandomVertices-100);
+		GLuint v2=GLuint(rand())%(numRandomVertices-100);
+		if(v0!=v1&&v1!=v2&&v2!=v0)
+			{
+			random.push_back(v0);
+			random.push_back(v1);
+			random.push_back(v2);
+			}
+		}
+	testMesh("Random triangles",random,numRandomVertices,3.0);
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -0,0 +1,155 @@
+/***********************************************************************
+SpinBarrier - Class implementing a barrier for tightly coupled threads,
+which spins for a limited time before blocking the calling thread.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_SPINBARRIER_INCLUDED
+#define THREADS_SPINBARRIER_INCLUDED
+
+#include <sys/time.h>
+#include <sched.h>
+#include <pthread.h>
+
+namespace Threads {
+
+class SpinBarrier
+	{
+	/* Elements: */
+	private:
+	unsigned int numSynchronizingThreads; // Number of threads that have to synchronize before they can proceed
+	long spinTime; // Time in microseconds a waiting thread spins before it blocks
+	volatile unsigned int numArrivedThreads; // Number of threads that have arrived at the current synchronization point
+	volatile unsigned int frame; // Synchronization counter; threads waiting at the barrier watch it change
+	volatile unsigned int numBlockedThreads; // Number of threads that have given up spinning and might be blocked on the condition variable
+	pthread_mutex_t mutex; // Mutex protecting the condition variable
+	pthread_cond_t cond; // A condition variable to wake up blocked threads if the synchronization point is complete
+	
+	/* Private methods: */
+	static void pause(void) // Tells the processor that the calling thread is spinning
+		{
+		#if defined(__i386__)||defined(__x86_64__)
+		__asm__ __volatile__("pause");
+		#endif
+		}
+	static long getTime(void) // Returns the current time in microseconds
+		{
+		struct timeval tv;
+		gettimeofday(&tv,0);
+		return long(tv.tv_sec)*1000000L+long(tv.tv_usec);
+		}
+	
+	/* Constructors and destructors: */
+	public:
+	SpinBarrier(unsigned int sNumSynchronizingThreads =1,double sSpinTime =0.0001) // Creates a barrier to synchronize the given number of threads, which spin for the given time in seconds before blocking
+		:numSynchronizingThreads(sNumSynchronizingThreads),
+		 spinTime(long(sSpinTime*1.0e6+0.5)),
+		 numArrivedThreads(0),frame(0),numBlockedThreads(0)
+		{
+		/* Initialize the mutex and the condition variable: */
+		pthread_mutex_init(&mutex,0);
+		pthread_cond_init(&cond,0);
+		}
+	private:
+	SpinBarrier(const SpinBarrier& source); // Prohibit copy constructor
+	SpinBarrier& operator=(const SpinBarrier& source); // Prohibit assignment operator
+	public:
+	~SpinBarrier(void)
+		{
+		/* Destroy the mutex and the condition variable: */
+		pthread_mutex_destroy(&mutex);
+		pthread_cond_destroy(&cond);
+		}
+	
+	/* Methods: */
+	unsigned int getNumSynchronizingThreads(void) const // Returns the number of threads that have to synchronize
+		{
+		return numSynchronizingThreads;
+		}
+	void setNumSynchronizingThreads(unsigned int newNumSynchronizingThreads) // Sets the number of threads that have to synchronize; must not be called while any thread is waiting at the barrier
+		{
+		numSynchronizingThreads=newNumSynchronizingThreads;
+		}
+	double getSpinTime(void) const // Returns the time in seconds a waiting thread spins before it blocks
+		{
+		return double(spinTime)*1.0e-6;
+		}
+	void setSpinTime(double newSpinTime) // Sets the time in seconds a waiting thread spins before it blocks; must not be called while any thread is waiting at the barrier
+		{
+		spinTime=long(newSpinTime*1.0e6+0.5);
+		}
+	void synchronize(void) // Enters the synchronization point; blocks the calling thread until synchronization is complete
+		{
+		/* Enter the synchronization point: */
+		unsigned int currentFrame=frame;
+		if(__sync_add_and_fetch(&numArrivedThreads,1U)==numSynchronizingThreads)
+			{
+			/* Reset the barrier for the next synchronization before releasing the waiting threads: */
+			numArrivedThreads=0;
+			__sync_synchronize();
+			++frame;
+			__sync_synchronize();
+			
+			/* Wake up threads that stopped spinning: */
+			if(numBlockedThreads!=0)
+				{
+				pthread_mutex_lock(&mutex);
+				pthread_cond_broadcast(&cond);
+				pthread_mutex_unlock(&mutex);
+				}
+			
+			return;
+			}
+		
+		/* Spin with exponential backoff and then yield until the synchronization is complete or the spin time is up: */
+		if(spinTime>0)
+			{
+			long spinEnd=getTime()+spinTime;
+			unsigned int backoff=1;
+			while(true)
+				{
+				for(unsigned int i=0;i<backoff;++i)
+					pause();
+				if(frame!=currentFrame)
+					return;
+				if(backoff<64U)
+					backoff<<=1;
+				else
+					{
+					/* Give up the processor in case the threads being waited for don't have one: */
+					sched_yield();
+					if(getTime()>=spinEnd)
+						break;
+					}
+				}
+			}
+		
+		/* Announce that this thread might block before checking the frame counter one last time: */
+		__sync_add_and_fetch(&numBlockedThreads,1U);
+		pthread_mutex_lock(&mutex);
+		while(frame==currentFrame)
+			pthread_cond_wait(&cond,&mutex);
+		pthread_mutex_unlock(&mutex);
+		__sync_sub_and_fetch(&numBlockedThreads,1U);
+		}
+	};
+
+}
+
+#endif
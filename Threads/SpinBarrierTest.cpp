@@ -0,0 +1,139 @@
+/***********************************************************************
+SpinBarrierTest - Program to measure the synchronization latency of
+SpinBarrier against the blocking Barrier for different numbers of
+threads, and to check that neither barrier releases a thread early.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <Misc/Timer.h>
+#include <Threads/Thread.h>
+#include <Threads/Barrier.h>
+#include <Threads/SpinBarrier.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+template <class BarrierParam>
+class BarrierTest // Class to run a number of synchronization rounds through a barrier
+	{
+	/* Elements: */
+	public:
+	BarrierParam& barrier; // The tested barrier
+	unsigned int numThreads; // Number of threads synchronizing at the barrier
+	unsigned int numRounds; // Number of synchronization rounds
+	volatile unsigned int numArrivals; // Total number of times any thread arrived at the barrier
+	volatile unsigned int numEarlyReleases; // Number of times a thread left the barrier before all threads arrived
+	
+	/* Constructors and destructors: */
+	BarrierTest(BarrierParam& sBarrier,unsigned int sNumThreads,unsigned int sNumRounds)
+		:barrier(sBarrier),numThreads(sNumThreads),numRounds(sNumRounds),
+		 numArrivals(0),numEarlyReleases(0)
+		{
+		}
+	
+	/* Methods: */
+	void* run(void) // Runs all synchronization rounds
+		{
+		for(unsigned int round=0;round<numRounds;++round)
+			{
+			__sync_add_and_fetch(&numArrivals,1U);
+			barrier.synchronize();
+			
+			/* Check that all threads arrived for this round: */
+			if(numArrivals<numThreads*(round+1))
+				__sync_add_and_fetch(&numEarlyReleases,1U);
+			}
+		
+		return 0;
+		}
+	};
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+template <class BarrierParam>
+double measureLatency(BarrierParam& barrier,unsigned int numThreads,unsigned int numRounds) // Returns the average time per synchronization round in seconds
+	{
+	BarrierTest<BarrierParam> test(barrier,numThreads,numRounds);
+	
+	/* Start the other threads; the calling thread synchronizes as well: */
+	Misc::Timer timer;
+	Threads::Thread* threads=new Threads::Thread[numThreads-1];
+	for(unsigned int i=0;i<numThreads-1;++i)
+		threads[i].start(&test,&BarrierTest<BarrierParam>::run);
+	test.run();
+	for(unsigned int i=0;i<numThreads-1;++i)
+		threads[i].join();
+	delete[] threads;
+	timer.elapse();
+	
+	check(test.numEarlyReleases==0,"no thread leaves the barrier before all threads arrived");
+	return timer.getTime()/double(numRounds);
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	/* Parse the command line: */
+	unsigned int numRounds=10000;
+	double spinTime=0.0001;
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-rounds")==0&&i+1<argc)
+			numRounds=(unsigned int)(atoi(argv[++i]));
+		else if(strcasecmp(argv[i],"-spinTime")==0&&i+1<argc)
+			spinTime=atof(argv[++i]);
+		}
+	
+	printf("Average synchronization latency over %u rounds, spin time %g s:\n",numRounds,spinTime);
+	printf("Threads      Barrier  SpinBarrier  SpinBarrier (no spinning)\n");
+	for(unsigned int numThreads=2;numThreads<=16;numThreads*=2)
+		{
+		Threads::Barrier barrier(numThreads);
+		double barrierLatency=measureLatency(barrier,numThreads,numRounds);
+		Threads::SpinBarrier spinBarrier(numThreads,spinTime);
+		double spinBarrierLatency=measureLatency(spinBarrier,numThreads,numRounds);
+		Threads::SpinBarrier blockingSpinBarrier(numThreads,0.0);
+		double blockingSpinBarrierLatency=measureLatency(blockingSpinBarrier,numThreads,numRounds);
+		printf("%7u  %8.2f us  %8.2f us  %8.2f us\n",numThreads,barrierLatency*1.0e6,spinBarrierLatency*1.0e6,blockingSpinBarrierLatency*1.0e6);
+		}
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
@@ -0,0 +1,248 @@
+/***********************************************************************
+TaskScheduler - Class to execute tasks on a fixed pool of worker threads
+with per-worker task queues and work stealing.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#include <Threads/TaskScheduler.h>
+
+#include <unistd.h>
+#include <stdexcept>
+
+namespace Threads {
+
+/******************************
+Methods of class TaskScheduler:
+******************************/
+
+TaskScheduler::Task* TaskScheduler::popTask(TaskScheduler::Worker* worker)
+	{
+	Task* result=0;
+	
+	/* Take the most recently queued task from the worker's own queue to keep its working set warm: */
+	int firstVictim=0;
+	if(worker!=0)
+		{
+		Mutex::Lock tasksLock(worker->tasksMutex);
+		if(!worker->tasks.empty())
+			{
+			result=worker->tasks.back();
+			worker->tasks.pop_back();
+			}
+		firstVictim=int(worker-workers)+1;
+		}
+	
+	/* Otherwise steal the oldest queued task from another worker: */
+	for(int i=0;result==0&&i<numWorkers;++i)
+		{
+		Worker* victim=&workers[(firstVictim+i)%numWorkers];
+		if(victim==worker)
+			continue;
+		Mutex::Lock tasksLock(victim->tasksMutex);
+		if(!victim->tasks.empty())
+			{
+			result=victim->tasks.front();
+			victim->tasks.pop_front();
+			}
+		}
+	
+	if(result!=0)
+		{
+		MutexCond::Lock idleLock(idleCond);
+		--numQueuedTasks;
+		}
+	
+	return result;
+	}
+
+void TaskScheduler::executeTask(TaskScheduler::Task* task)
+	{
+	/* Execute and delete the task, catching any exception so that the task still completes: */
+	TaskGroup* group=task->group;
+	bool failed=false;
+	std::string errorMessage;
+	try
+		{
+		task->execute();
+		}
+	catch(const std::exception& err)
+		{
+		failed=true;
+		errorMessage=err.what();
+		}
+	catch(...)
+		{
+		failed=true;
+		errorMessage="Unknown exception";
+		}
+	delete task;
+	
+	if(failed)
+		{
+		MutexCond::Lock idleLock(idleCond);
+		++numFailedTasks;
+		}
+	
+	/* Notify the task's group: */
+	if(group!=0)
+		{
+		MutexCond::Lock groupLock(group->mutexCond);
+		if(failed&&group->numFailedTasks++==0)
+			group->errorMessage=errorMessage;
+		--group->numPendingTasks;
+		if(group->numPendingTasks==0)
+			group->mutexCond.broadcast(groupLock);
+		}
+	}
+
+void* TaskScheduler::workerThreadMethod(int workerIndex)
+	{
+	Worker* worker=&workers[workerIndex];
+	pthread_setspecific(workerKey,worker);
+	
+	while(true)
+		{
+		/* Execute the next task from any queue: */
+		Task* task=popTask(worker);
+		if(task!=0)
+			{
+			executeTask(task);
+			continue;
+			}
+		
+		/* Sleep until more tasks are queued: */
+		MutexCond::Lock idleLock(idleCond);
+		while(numQueuedTasks<=0&&!shutdown)
+			idleCond.wait(idleLock);
+		if(numQueuedTasks<=0&&shutdown)
+			break;
+		}
+	
+	return 0;
+	}
+
+TaskScheduler::TaskScheduler(int sNumWorkers)
+	:numWorkers(sNumWorkers>0?sNumWorkers:1),workers(new Worker[numWorkers]),
+	 numQueuedTasks(0),nextWorker(0),shutdown(false),numFailedTasks(0)
+	{
+	pthread_key_create(&workerKey,0);
+	
+	/* Start the worker threads: */
+	for(int i=0;i<numWorkers;++i)
+		workers[i].thread.start(this,&TaskScheduler::workerThreadMethod,i);
+	}
+
+TaskScheduler::~TaskScheduler(void)
+	{
+	/* Tell the worker threads to terminate once all queued tasks are done: */
+	{
+	MutexCond::Lock idleLock(idleCond);
+	shutdown=true;
+	idleCond.broadcast(idleLock);
+	}
+
+	/* Wait for all worker threads to terminate before destroying any task queue, as idle workers might still try to steal from them: */
+	for(int i=0;i<numWorkers;++i)
+		workers[i].thread.join();
+	delete[] workers;
+	pthread_key_delete(workerKey);
+	}
+
+int TaskScheduler::getNumProcessors(void)
+	{
+	long numProcessors=sysconf(_SC_NPROCESSORS_ONLN);
+	return numProcessors>0?int(numProcessors):1;
+	}
+
+size_t TaskScheduler::getNumFailedTasks(void)
+	{
+	MutexCond::Lock idleLock(idleCond);
+	return numFailedTasks;
+	}
+
+void TaskScheduler::submit(TaskScheduler::Task* task,TaskScheduler::TaskGroup* group)
+	{
+	/* Add the task to its group: */
+	task->group=group;
+	if(group!=0)
+		{
+		MutexCond::Lock groupLock(group->mutexCond);
+		++group->numPendingTasks;
+		}
+	
+	/* Queue the task with the calling worker, or distribute it round-robin if the caller is not a worker: */
+	Worker* worker=static_cast<Worker*>(pthread_getspecific(workerKey));
+	if(worker==0)
+		{
+		MutexCond::Lock idleLock(idleCond);
+		worker=&workers[nextWorker];
+		nextWorker=(nextWorker+1)%numWorkers;
+		}
+	{
+	Mutex::Lock tasksLock(worker->tasksMutex);
+	worker->tasks.push_back(task);
+	}
+	
+	/* Wake up an idle worker: */
+	MutexCond::Lock idleLock(idleCond);
+	++numQueuedTasks;
+	idleCond.signal(idleLock);
+	}
+
+void TaskScheduler::wait(TaskScheduler::TaskGroup& group)
+	{
+	Worker* worker=static_cast<Worker*>(pthread_getspecific(workerKey));
+	while(true)
+		{
+		/* Bail out if all tasks in the group are done: */
+		{
+		MutexCond::Lock groupLock(group.mutexCond);
+		if(group.numPendingTasks==0)
+			break;
+		}
+		
+		/* Help out by executing a queued task, which is likely one of the group's: */
+		Task* task=popTask(worker);
+		if(task!=0)
+			{
+			executeTask(task);
+			continue;
+			}
+		
+		/* All remaining tasks of the group are already running; wait for them to finish: */
+		MutexCond::Lock groupLock(group.mutexCond);
+		while(group.numPendingTasks>0)
+			group.mutexCond.wait(groupLock);
+		}
+	
+	/* Report any exceptions thrown by the group's tasks, and reset the group for reuse: */
+	MutexCond::Lock groupLock(group.mutexCond);
+	if(group.numFailedTasks>0)
+		{
+		std::string errorMessage=group.errorMessage;
+		size_t numFailedTasks=group.numFailedTasks;
+		group.numFailedTasks=0;
+		group.errorMessage.clear();
+		if(numFailedTasks>1)
+			throw std::runtime_error(errorMessage+" (and further errors in other tasks)");
+		throw std::runtime_error(errorMessage);
+		}
+	}
+
+}
@@ -0,0 +1,238 @@
+/***********************************************************************
+TaskScheduler - Class to execute tasks on a fixed pool of worker threads
+with per-worker task queues and work stealing.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Portable Threading Library (Threads).
+
+The Portable Threading Library is free software; you can redistribute
+it and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the
+License, or (at your option) any later version.
+
+The Portable Threading Library is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Portable Threading Library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+***********************************************************************/
+
+#ifndef THREADS_TASKSCHEDULER_INCLUDED
+#define THREADS_TASKSCHEDULER_INCLUDED
+
+#include <stddef.h>
+#include <pthread.h>
+#include <deque>
+#include <vector>
+#include <string>
+#include <Threads/Mutex.h>
+#include <Threads/MutexCond.h>
+#include <Threads/Thread.h>
+
+namespace Threads {
+
+class TaskScheduler
+	{
+	/* Embedded classes: */
+	public:
+	class TaskGroup;
+
+	class Task // Abstract base class for tasks; exceptions thrown out of a task's execute method are caught and recorded by the scheduler
+		{
+		friend class TaskScheduler;
+		
+		/* Elements: */
+		private:
+		TaskGroup* group; // Task group to which the task belongs, or null
+		
+		/* Constructors and destructors: */
+		public:
+		Task(void)
+			:group(0)
+			{
+			}
+		virtual ~Task(void)
+			{
+			}
+		
+		/* Methods: */
+		virtual void execute(void) =0; // Executes the task
+		};
+	
+	class TaskGroup // Class to wait for the completion of a set of tasks
+		{
+		friend class TaskScheduler;
+		
+		/* Elements: */
+		private:
+		MutexCond mutexCond; // Mutex protecting the number of pending tasks, and condition variable signalled when it drops to zero
+		size_t numPendingTasks; // Number of submitted tasks in the group that have not finished yet
+		size_t numFailedTasks; // Number of tasks in the group that threw an exception since the group was last waited on
+		std::string errorMessage; // Message of the first exception thrown by a task in the group
+		
+		/* Constructors and destructors: */
+		public:
+		TaskGroup(void) // Creates an empty task group
+			:numPendingTasks(0),numFailedTasks(0)
+			{
+			}
+		private:
+		TaskGroup(const TaskGroup& source); // Prohibit copy constructor
+		TaskGroup& operator=(const TaskGroup& source); // Prohibit assignment operator
+		};
+	
+	private:
+	struct Worker // Structure holding the state of a worker thread
+		{
+		/* Elements: */
+		public:
+		Mutex tasksMutex; // Mutex protecting the worker's task queue
+		std::deque<Task*> tasks; // Worker's task queue; the worker takes tasks from the back, other threads steal from the front
+		Thread thread; // The worker thread
+		};
+	
+	template <class FunctorParam>
+	class ParallelForTask:public Task // Class for tasks processing a sub-range of a parallel for loop
+		{
+		/* Elements: */
+		private:
+		FunctorParam& functor; // Functor processing index ranges
+		size_t rangeBegin,rangeEnd; // Index range processed by this task
+		
+		/* Constructors and destructors: */
+		public:
+		ParallelForTask(FunctorParam& sFunctor,size_t sRangeBegin,size_t sRangeEnd)
+			:functor(sFunctor),rangeBegin(sRangeBegin),rangeEnd(sRangeEnd)
+			{
+			}
+		
+		/* Methods from Task: */
+		virtual void execute(void)
+			{
+			functor(rangeBegin,rangeEnd);
+			}
+		};
+	
+	template <class ValueParam,class FunctorParam>
+	class ParallelReduceTask:public Task // Class for tasks reducing a sub-range of a parallel reduction
+		{
+		/* Elements: */
+		private:
+		FunctorParam& functor; // Functor reducing index ranges
+		size_t rangeBegin,rangeEnd; // Index range reduced by this task
+		ValueParam& result; // Location for the reduction result of this task's sub-range
+		
+		/* Constructors and destructors: */
+		public:
+		ParallelReduceTask(FunctorParam& sFunctor,size_t sRangeBegin,size_t sRangeEnd,ValueParam& sResult)
+			:functor(sFunctor),rangeBegin(sRangeBegin),rangeEnd(sRangeEnd),result(sResult)
+			{
+			}
+		
+		/* Methods from Task: */
+		virtual void execute(void)
+			{
+			result=functor(rangeBegin,rangeEnd);
+			}
+		};
+	
+	/* Elements: */
+	int numWorkers; // Number of worker threads
+	Worker* workers; // Array of worker threads
+	pthread_key_t workerKey; // Key to find the worker structure of the calling thread
+	MutexCond idleCond; // Mutex protecting the queued task counter, and condition variable to wake up idle worker threads
+	ptrdiff_t numQueuedTasks; // Number of tasks waiting in all workers' queues; may be transiently negative
+	int nextWorker; // Index of the worker receiving the next task submitted by a thread outside the pool
+	bool shutdown; // Flag to tell the worker threads to terminate once all queued tasks are done
+	size_t numFailedTasks; // Total number of tasks that threw an exception; protected by the idle mutex
+
+	/* Private methods: */
+	Task* popTask(Worker* worker); // Takes a task from the given worker's queue, or steals one from another worker's queue; returns null if all queues are empty
+	void executeTask(Task* task); // Executes and deletes the given task, records any exception it throws, and notifies its task group
+	void* workerThreadMethod(int workerIndex); // Executes queued tasks
+	
+	/* Constructors and destructors: */
+	public:
+	TaskScheduler(int sNumWorkers); // Creates a scheduler with the given number of worker threads
+	private:
+	TaskScheduler(const TaskScheduler& source); // Prohibit copy constructor
+	TaskScheduler& operator=(const TaskScheduler& source); // Prohibit assignment operator
+	public:
+	~TaskScheduler(void); // Executes all queued tasks and terminates the worker threads
+	
+	/* Methods: */
+	static int getNumProcessors(void); // Returns the number of processors available to the process
+	int getNumWorkers(void) const // Returns the number of worker threads
+		{
+		return numWorkers;
+		}
+	size_t calcGrainSize(size_t numItems,size_t minGrainSize =1) const // Returns a grain size splitting the given number of items into a few ranges per thread to balance load, but not below the given minimum
+		{
+		size_t grainSize=numItems/(size_t(numWorkers+1)*4);
+		return grainSize>=minGrainSize?grainSize:minGrainSize;
+		}
+	size_t getNumFailedTasks(void); // Returns the total number of tasks that threw an exception
+	void submit(Task* task,TaskGroup* group =0); // Queues the given task for execution and adds it to the given task group; scheduler deletes the task after execution
+	void wait(TaskGroup& group); // Blocks until all tasks in the given group are finished; executes queued tasks while waiting; throws std::runtime_error if any task in the group threw an exception
+	template <class FunctorParam>
+	void parallelFor(size_t begin,size_t end,size_t grainSize,FunctorParam& functor) // Calls functor(rangeBegin,rangeEnd) on sub-ranges of at most grainSize indices covering [begin,end) in parallel, and waits until all are done
+		{
+		if(end<=begin)
+			return;
+		if(grainSize==0)
+			grainSize=1;
+		if(end-begin<=grainSize)
+			{
+			/* Don't bother queuing a single range: */
+			functor(begin,end);
+			return;
+			}
+		
+		/* Queue one task per sub-range and wait for all of them: */
+		TaskGroup group;
+		for(size_t rangeBegin=begin;rangeBegin<end;rangeBegin+=grainSize)
+			{
+			size_t rangeEnd=end-rangeBegin>grainSize?rangeBegin+grainSize:end;
+			submit(new ParallelForTask<FunctorParam>(functor,rangeBegin,rangeEnd),&group);
+			}
+		wait(group);
+		}
+	template <class ValueParam,class FunctorParam,class CombinerParam>
+	ValueParam parallelReduce(size_t begin,size_t end,size_t grainSize,const ValueParam& identity,FunctorParam& functor,CombinerParam& combiner) // Reduces sub-ranges of [begin,end) with functor(rangeBegin,rangeEnd) in parallel, and returns their results combined in index order with combiner(value1,value2)
+		{
+		if(end<=begin)
+			return identity;
+		if(grainSize==0)
+			grainSize=1;
+		
+		/* Queue one task per sub-range and wait for all of them: */
+		size_t numRanges=(end-begin+grainSize-1)/grainSize;
+		std::vector<ValueParam> rangeResults(numRanges,identity);
+		if(numRanges==1)
+			rangeResults[0]=functor(begin,end);
+		else
+			{
+			TaskGroup group;
+			for(size_t i=0;i<numRanges;++i)
+				{
+				size_t rangeBegin=begin+i*grainSize;
+				size_t rangeEnd=end-rangeBegin>grainSize?rangeBegin+grainSize:end;
+				submit(new ParallelReduceTask<ValueParam,FunctorParam>(functor,rangeBegin,rangeEnd,rangeResults[i]),&group);
+				}
+			wait(group);
+			}
+		
+		/* Combine the sub-range results in order so that the result does not depend on scheduling: */
+		ValueParam result=identity;
+		for(size_t i=0;i<numRanges;++i)
+			result=combiner(result,rangeResults[i]);
+		return result;
+		}
+	};
+
+}
+
+#endif
@@ -23,6 +23,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/ThrowStdErr.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Geometry/ProjectiveTransformation.h>
 #include <GL/GLValueCoders.h>
 #include <GL/GLTransformationWrappers.h>
 #include <GL/GLModels.h>
@@ -30,9 +31,23 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Vrui/GlyphRenderer.h>
 
 using GLTransformationWrappers::glMultMatrix; // PO'Leary
+using GLTransformationWrappers::glLoadMatrix;
 
 namespace Vrui {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+inline bool equal(const GLMaterial& m1,const GLMaterial& m2)
+	{
+	return m1.ambient==m2.ambient&&m1.diffuse==m2.diffuse&&m1.specular==m2.specular&&m1.shininess==m2.shininess&&m1.emission==m2.emission;
+	}
+
+}
+
 /**********************
 Methods of class Glyph:
 **********************/
@@ -175,7 +190,8 @@ Methods of class GlyphRenderer::DataItem:
 ****************************************/
 
 GlyphRenderer::DataItem::DataItem(void)
-	:glyphDisplayLists(glGenLists(Glyph::GLYPHS_END))
+	:glyphDisplayLists(glGenLists(Glyph::GLYPHS_END)),
+	 numBatchedGlyphs(0),numMaterialChanges(0)
 	{
 	}
 
@@ -222,4 +238,47 @@ void GlyphRenderer::renderGlyph(const Glyph& glyph,const OGTransform& transforma
 		}
 	}
 
+void GlyphRenderer::renderBatch(const GlyphRenderer::DataItem* contextDataItem) const
+	{
+	/* Bail out if there is nothing to render: */
+	contextDataItem->numMaterialChanges=0;
+	if(contextDataItem->numBatchedGlyphs==0)
+		return;
+	
+	/* Retrieve the current modelview matrix once for the entire batch: */
+	PTransform modelview=glGetModelviewMatrix<Scalar>();
+	glPushMatrix();
+	
+	/* Render the batch one glyph type at a time to keep display list and material changes to a minimum: */
+	const GLMaterial* currentMaterial=0;
+	for(int glyphType=Glyph::CONE;glyphType<Glyph::GLYPHS_END;++glyphType)
+		{
+		std::vector<DataItem::BatchedGlyph>& batch=contextDataItem->batches[glyphType];
+		GLuint displayList=contextDataItem->glyphDisplayLists+glyphType;
+		for(std::vector<DataItem::BatchedGlyph>::const_iterator bgIt=batch.begin();bgIt!=batch.end();++bgIt)
+			{
+			/* Only change the material if it differs from the last one that was set: */
+			if(currentMaterial==0||(bgIt->material!=currentMaterial&&!equal(*bgIt->material,*currentMaterial)))
+				{
+				glMaterial(GLMaterialEnums::FRONT,*bgIt->material);
+				currentMaterial=bgIt->material;
+				++contextDataItem->numMaterialChanges;
+				}
+			
+			/* Replace the modelview matrix instead of pushing and popping it for every glyph: */
+			PTransform glyphModelview=modelview;
+			glyphModelview*=PTransform(bgIt->transformation);
+			glLoadMatrix(glyphModelview);
+			glCallList(displayList);
+			}
+		
+		/* Clear the batch, but keep its allocated memory for the next frame: */
+		batch.clear();
+		}
+	
+	/* Restore the modelview matrix: */
+	glPopMatrix();
+	contextDataItem->numBatchedGlyphs=0;
+	}
+
 }
@@ -23,6 +23,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_GLYPHRENDERER_INCLUDED
 #define VRUI_GLYPHRENDERER_INCLUDED
 
+#include <vector>
+#include <Geometry/OrthogonalTransformation.h>
 #include <GL/gl.h>
 #include <GL/GLMaterial.h>
 #include <GL/GLObject.h>
@@ -93,14 +95,42 @@ class GlyphRenderer:public GLObject
 		{
 		friend class GlyphRenderer;
 		
-		/* Elements: */
+		/* Embedded classes: */
 		private:
+		struct BatchedGlyph // Structure for a glyph instance collected in a batch
+			{
+			/* Elements: */
+			public:
+			const GLMaterial* material; // Pointer to the glyph's material; must remain valid until the batch is rendered
+			OGTransform transformation; // Glyph's transformation relative to the modelview matrix current at the time the batch is rendered
+			
+			/* Constructors and destructors: */
+			BatchedGlyph(const GLMaterial* sMaterial,const OGTransform& sTransformation)
+				:material(sMaterial),transformation(sTransformation)
+				{
+				}
+			};
+		
+		/* Elements: */
 		GLuint glyphDisplayLists; // Base ID for consecutive display lists to render glyphs
+		mutable std::vector<BatchedGlyph> batches[Glyph::GLYPHS_END]; // Glyph instances collected for batched rendering, one list per glyph type
+		mutable size_t numBatchedGlyphs; // Total number of glyph instances in the current batch
+		mutable size_t numMaterialChanges; // Number of material changes caused by the most recently rendered batch
 		
 		/* Constructors and destructors: */
 		DataItem(void);
 		public:
 		virtual ~DataItem(void);
+		
+		/* Methods: */
+		size_t getNumBatchedGlyphs(void) const // Returns the number of glyphs collected in the current batch
+			{
+			return numBatchedGlyphs;
+			}
+		size_t getNumMaterialChanges(void) const // Returns the number of material changes issued while rendering the last batch
+			{
+			return numMaterialChanges;
+			}
 		};
 	
 	/* Elements: */
@@ -123,6 +153,17 @@ class GlyphRenderer:public GLObject
 		return contextData.retrieveDataItem<DataItem>(this);
 		}
 	void renderGlyph(const Glyph& glyph,const OGTransform& transformation,const DataItem* contextDataItem) const; // Renders glyph into current OpenGL context
+	void batchGlyph(const Glyph& glyph,const OGTransform& transformation,const DataItem* contextDataItem) const // Adds glyph to the context's current batch without rendering it
+		{
+		/* Check if the glyph is enabled: */
+		if(glyph.enabled)
+			{
+			/* Append the glyph to its type's batch: */
+			contextDataItem->batches[glyph.glyphType].push_back(DataItem::BatchedGlyph(&glyph.glyphMaterial,transformation));
+			++contextDataItem->numBatchedGlyphs;
+			}
+		}
+	void renderBatch(const DataItem* contextDataItem) const; // Renders all glyphs collected in the context's current batch, grouped by glyph type, using the current modelview matrix; clears the batch afterwards
 	};
 
 }
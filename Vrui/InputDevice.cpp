@@ -22,6 +22,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 ***********************************************************************/
 
 #include <string.h>
+#include <algorithm>
 #include <Misc/ThrowStdErr.h>
 
 #include <Vrui/InputDevice.h>
@@ -37,8 +38,11 @@ InputDevice::InputDevice(void)
 	 numButtons(0),numValuators(0),
 	 buttonCallbacks(0),valuatorCallbacks(0),
 	 buttonStates(0),valuatorValues(0),
-	 callbacksEnabled(true),
-	 savedButtonStates(0),savedValuatorValues(0)
+	 stateVersion(0),
+	 callbacksEnabled(true),savedStateVersion(0),
+	 savedButtonStates(0),savedValuatorValues(0),
+	 queueButtonEvents(false),
+	 numPendingEvents(0),numDeliveredEvents(0),numSuppressedEvents(0)
 	{
 	deviceName[0]='\0';
 	}
@@ -50,9 +54,12 @@ InputDevice::InputDevice(const char* sDeviceName,int sTrackType,int sNumButtons,
 	 valuatorCallbacks(numValuators>0?new Misc::CallbackList[numValuators]:0),
 	 buttonStates(numButtons>0?new bool[numButtons]:0),
 	 valuatorValues(numValuators>0?new double[numValuators]:0),
-	 callbacksEnabled(true),
+	 stateVersion(0),
+	 callbacksEnabled(true),savedStateVersion(0),
 	 savedButtonStates(numButtons>0?new bool[numButtons]:0),
-	 savedValuatorValues(numValuators>0?new double[numValuators]:0)
+	 savedValuatorValues(numValuators>0?new double[numValuators]:0),
+	 queueButtonEvents(false),
+	 numPendingEvents(0),numDeliveredEvents(0),numSuppressedEvents(0)
 	{
 	/* Copy device name: */
 	strcpy(deviceName,sDeviceName);
@@ -75,8 +82,11 @@ InputDevice::InputDevice(const InputDevice& source)
 	 numButtons(0),numValuators(0),
 	 buttonCallbacks(0),valuatorCallbacks(0),
 	 buttonStates(0),valuatorValues(0),
-	 callbacksEnabled(true),
-	 savedButtonStates(0),savedValuatorValues(0)
+	 stateVersion(0),
+	 callbacksEnabled(true),savedStateVersion(0),
+	 savedButtonStates(0),savedValuatorValues(0),
+	 queueButtonEvents(false),
+	 numPendingEvents(0),numDeliveredEvents(0),numSuppressedEvents(0)
 	{
 	deviceName[0]='\0';
 	
@@ -141,6 +151,9 @@ InputDevice& InputDevice::set(const char* sDeviceName,int sTrackType,int sNumBut
 		valuatorValues[i]=0.0;
 		savedValuatorValues[i]=0.0;
 		}
+	buttonEventQueue.clear();
+	numPendingEvents=0;
+	++stateVersion;
 	
 	return *this;
 	}
@@ -149,12 +162,16 @@ void InputDevice::setDeviceRayDirection(const Vector& newDeviceRayDirection)
 	{
 	/* Set ray direction: */
 	deviceRayDirection=newDeviceRayDirection;
+	rayDirection=transformation.transform(deviceRayDirection);
+	++stateVersion;
 	}
 
 void InputDevice::setTransformation(const TrackerState& newTransformation)
 	{
 	/* Set transformation: */
 	transformation=newTransformation;
+	rayDirection=transformation.transform(deviceRayDirection);
+	++stateVersion;
 	
 	/* Call callbacks: */
 	if(callbacksEnabled)
@@ -165,6 +182,40 @@ void InputDevice::setTransformation(const TrackerState& newTransformation)
 		}
 	}
 
+void InputDevice::reportButtonChange(int buttonIndex,bool newButtonState)
+	{
+	if(callbacksEnabled)
+		{
+		/* Call the button's callbacks: */
+		ButtonCallbackData cbData(this,buttonIndex,newButtonState);
+		buttonCallbacks[buttonIndex].call(&cbData);
+		++numDeliveredEvents;
+		}
+	else
+		{
+		/* Record the change to call the button's callbacks when callbacks are enabled again: */
+		if(queueButtonEvents)
+			buttonEventQueue.push_back(ButtonEvent(buttonIndex,newButtonState));
+		++numPendingEvents;
+		}
+	}
+
+void InputDevice::reportValuatorChange(int valuatorIndex,double oldValuatorValue,double newValuatorValue)
+	{
+	if(callbacksEnabled)
+		{
+		/* Call the valuator's callbacks: */
+		ValuatorCallbackData cbData(this,valuatorIndex,oldValuatorValue,newValuatorValue);
+		valuatorCallbacks[valuatorIndex].call(&cbData);
+		++numDeliveredEvents;
+		}
+	else
+		{
+		/* Only count the change; the valuator's callbacks will be called with its latest value: */
+		++numPendingEvents;
+		}
+	}
+
 void InputDevice::clearButtonStates(void)
 	{
 	for(int i=0;i<numButtons;++i)
@@ -172,23 +223,19 @@ void InputDevice::clearButtonStates(void)
 		if(buttonStates[i])
 			{
 			buttonStates[i]=false;
-			if(callbacksEnabled)
-				{
-				ButtonCallbackData cbData(this,i,false);
-				buttonCallbacks[i].call(&cbData);
-				}
+			++stateVersion;
+			reportButtonChange(i,false);
 			}
 		}
 	}
 
 void InputDevice::setButtonState(int index,bool newButtonState)
 	{
-	ButtonCallbackData cbData(this,index,newButtonState);
 	if(buttonStates[index]!=newButtonState)
 		{
 		buttonStates[index]=newButtonState;
-		if(callbacksEnabled)
-			buttonCallbacks[index].call(&cbData);
+		++stateVersion;
+		reportButtonChange(index,newButtonState);
 		}
 	}
 
@@ -201,37 +248,52 @@ void InputDevice::setSingleButtonPressed(int index)
 			if(buttonStates[i])
 				{
 				buttonStates[i]=false;
-				if(callbacksEnabled)
-					{
-					ButtonCallbackData cbData(this,i,false);
-					buttonCallbacks[i].call(&cbData);
-					}
+				++stateVersion;
+				reportButtonChange(i,false);
 				}
 			}
 		}
-	ButtonCallbackData cbData(this,index,true);
 	if(!buttonStates[index])
 		{
 		buttonStates[index]=true;
-		if(callbacksEnabled)
-			buttonCallbacks[index].call(&cbData);
+		++stateVersion;
+		reportButtonChange(index,true);
 		}
 	}
 
 void InputDevice::setValuator(int index,double value)
 	{
-	ValuatorCallbackData cbData(this,index,valuatorValues[index],value);
 	if(valuatorValues[index]!=value)
 		{
+		double oldValue=valuatorValues[index];
 		valuatorValues[index]=value;
-		if(callbacksEnabled)
-			valuatorCallbacks[index].call(&cbData);
+		++stateVersion;
+		reportValuatorChange(index,oldValue,value);
 		}
 	}
 
+void InputDevice::setQueueButtonEvents(bool newQueueButtonEvents)
+	{
+	if(newQueueButtonEvents&&!queueButtonEvents&&!callbacksEnabled)
+		{
+		/* Queue the net changes of all buttons that changed since callbacks were disabled, so they are not lost when the queue is replayed: */
+		for(int i=0;i<numButtons;++i)
+			if(savedButtonStates[i]!=buttonStates[i])
+				buttonEventQueue.push_back(ButtonEvent(i,buttonStates[i]));
+		}
+	queueButtonEvents=newQueueButtonEvents;
+	
+	/* Report button changes queued so far as net changes: */
+	if(!queueButtonEvents)
+		buttonEventQueue.clear();
+	}
+
 void InputDevice::disableCallbacks(void)
 	{
 	callbacksEnabled=false;
+	savedStateVersion=stateVersion;
+	buttonEventQueue.clear();
+	numPendingEvents=0;
 	
 	/* Save all button states and valuator values to call the appropriate callbacks whence callbacks are enabled again: */
 	for(int i=0;i<numButtons;++i)
@@ -244,21 +306,59 @@ void InputDevice::enableCallbacks(void)
 	{
 	callbacksEnabled=true;
 	
+	/* Bail out if nothing changed since callbacks were disabled: */
+	if(stateVersion==savedStateVersion)
+		return;
+	
 	/* Call callbacks for everything that has changed, to update the user program's state: */
+	unsigned int numEvents=0;
 	CallbackData trackingCbData(this);
 	trackingCallbacks.call(&trackingCbData);
-	for(int i=0;i<numButtons;++i)
-		if(savedButtonStates[i]!=buttonStates[i])
+	if(queueButtonEvents&&!buttonEventQueue.empty())
+		{
+		/* Rewind the button states to their saved values, and keep the current values in the saved button state array: */
+		for(int i=0;i<numButtons;++i)
+			std::swap(buttonStates[i],savedButtonStates[i]);
+		
+		/* Call button callbacks for all queued button changes in order, with the button states as of each change: */
+		std::vector<ButtonEvent> events;
+		events.swap(buttonEventQueue);
+		for(std::vector<ButtonEvent>::iterator eIt=events.begin();eIt!=events.end();++eIt)
 			{
-			ButtonCallbackData cbData(this,i,buttonStates[i]);
-			buttonCallbacks[i].call(&cbData);
+			buttonStates[eIt->buttonIndex]=eIt->newButtonState;
+			ButtonCallbackData cbData(this,eIt->buttonIndex,eIt->newButtonState);
+			buttonCallbacks[eIt->buttonIndex].call(&cbData);
+			++numEvents;
 			}
+		
+		/* Reinstate the current button states: */
+		for(int i=0;i<numButtons;++i)
+			buttonStates[i]=savedButtonStates[i];
+		}
+	else
+		{
+		/* Call button callbacks for all net button changes: */
+		for(int i=0;i<numButtons;++i)
+			if(savedButtonStates[i]!=buttonStates[i])
+				{
+				ButtonCallbackData cbData(this,i,buttonStates[i]);
+				buttonCallbacks[i].call(&cbData);
+				++numEvents;
+				}
+		}
 	for(int i=0;i<numValuators;++i)
 		if(savedValuatorValues[i]!=valuatorValues[i])
 			{
 			ValuatorCallbackData cbData(this,i,savedValuatorValues[i],valuatorValues[i]);
 			valuatorCallbacks[i].call(&cbData);
+			++numEvents;
 			}
+	
+	/* Update the event counters: */
+	numDeliveredEvents+=numEvents;
+	if(numPendingEvents>numEvents)
+		numSuppressedEvents+=numPendingEvents-numEvents;
+	numPendingEvents=0;
 	}
 
 }
@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_INPUTDEVICE_INCLUDED
 #define VRUI_INPUTDEVICE_INCLUDED
 
+#include <vector>
 #include <Misc/CallbackList.h>
 #include <Geometry/Point.h>
 #include <Geometry/Vector.h>
@@ -87,6 +88,20 @@ class InputDevice // Class for input devices
 			}
 		};
 	
+	struct ButtonEvent // Structure for button changes queued while callbacks are disabled
+		{
+		/* Elements: */
+		public:
+		int buttonIndex; // Index of button that changed state
+		bool newButtonState; // New state of that button
+		
+		/* Constructors and destructors: */
+		ButtonEvent(int sButtonIndex,bool sNewButtonState)
+			:buttonIndex(sButtonIndex),newButtonState(sNewButtonState)
+			{
+			}
+		};
+	
 	/* Elements: */
 	private:
 	char* deviceName; // Arbitrary label to identify input devices
@@ -102,14 +117,26 @@ class InputDevice // Class for input devices
 	
 	/* Current device state: */
 	TrackerState transformation; // Full (orthonormal) transformation of locator device
+	Vector rayDirection; // Cached ray direction in physical coordinates
 	Vector linearVelocity,angularVelocity; // Velocities of locator device in units/second
 	bool* buttonStates; // Array of button press state(s)
 	double* valuatorValues; // Array of valuator values, normalized from -1 to 1
+	unsigned int stateVersion; // Version number of device state; incremented on every change of transformation, ray direction, button states, or valuator values
 	
 	/* State for disabling callbacks: */
 	bool callbacksEnabled; // Flag if callbacks are enabled
+	unsigned int savedStateVersion; // State version is saved at the time callbacks are disabled
 	bool* savedButtonStates; // Button states are saved at the time callbacks are disabled
 	double* savedValuatorValues; // Valuator values are saved at the time callbacks are disabled
+	bool queueButtonEvents; // Flag whether button changes are queued in order while callbacks are disabled; otherwise, only net button changes are reported when callbacks are enabled again
+	std::vector<ButtonEvent> buttonEventQueue; // Queue of button changes while callbacks are disabled
+	unsigned int numPendingEvents; // Number of button and valuator changes since callbacks were disabled
+	unsigned int numDeliveredEvents; // Total number of button and valuator callbacks called
+	unsigned int numSuppressedEvents; // Total number of button and valuator changes that were coalesced while callbacks were disabled
+	
+	/* Private methods: */
+	void reportButtonChange(int buttonIndex,bool newButtonState); // Calls the button's callbacks, or records the change while callbacks are disabled
+	void reportValuatorChange(int valuatorIndex,double oldValuatorValue,double newValuatorValue); // Calls the valuator's callbacks, or counts the change while callbacks are disabled
 	
 	/* Constructors and destructors: */
 	public:
@@ -213,9 +240,9 @@ class InputDevice // Class for input devices
 		{
 		return transformation;
 		}
-	Vector getRayDirection(void) const
+	const Vector& getRayDirection(void) const
 		{
-		return transformation.transform(deviceRayDirection);
+		return rayDirection;
 		}
 	const Vector& getLinearVelocity(void) const
 		{
@@ -233,10 +260,31 @@ class InputDevice // Class for input devices
 		{
 		return valuatorValues[index];
 		}
+	unsigned int getStateVersion(void) const // Returns the version number of the device's state; differs from a previously returned version number if the state changed since
+		{
+		return stateVersion;
+		}
 	
 	/* Callback enable/disable methods: */
+	bool getQueueButtonEvents(void) const // Returns whether button changes are queued while callbacks are disabled
+		{
+		return queueButtonEvents;
+		}
+	void setQueueButtonEvents(bool newQueueButtonEvents); // Sets whether button changes are queued while callbacks are disabled; turning queueing on while callbacks are disabled queues the net changes made so far
+	const std::vector<ButtonEvent>& getButtonEventQueue(void) const // Returns the button changes queued since callbacks were disabled
+		{
+		return buttonEventQueue;
+		}
+	unsigned int getNumDeliveredEvents(void) const // Returns the total number of button and valuator callbacks called
+		{
+		return numDeliveredEvents;
+		}
+	unsigned int getNumSuppressedEvents(void) const // Returns the total number of button and valuator changes coalesced while callbacks were disabled
+		{
+		return numSuppressedEvents;
+		}
 	void disableCallbacks(void);
-	void enableCallbacks(void);
+	void enableCallbacks(void); // Calls callbacks for all state changes since callbacks were disabled, in order of queued button changes and then latest valuator values; calls no callbacks if the device's state did not change
 	};
 
 }
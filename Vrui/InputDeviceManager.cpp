@@ -79,7 +79,8 @@ Methods of class InputDeviceManager:
 
 InputDeviceManager::InputDeviceManager(InputGraphManager* sInputGraphManager)
 	:inputGraphManager(sInputGraphManager),
-	 numInputDeviceAdapters(0),inputDeviceAdapters(0)
+	 numInputDeviceAdapters(0),inputDeviceAdapters(0),
+	 queueButtonEvents(false)
 	{
 	}
 
@@ -93,6 +94,9 @@ InputDeviceManager::~InputDeviceManager(void)
 
 void InputDeviceManager::initialize(const Misc::ConfigurationFileSection& configFileSection)
 	{
+	/* Check whether input devices report every button change, or only net changes per frame: */
+	queueButtonEvents=configFileSection.retrieveValue<bool>("./queueButtonEvents",queueButtonEvents);
+	
 	/* Retrieve the list of input device adapters: */
 	typedef std::vector<std::string> StringList;
 	StringList inputDeviceAdapterNames=configFileSection.retrieveValue<StringList>("./inputDeviceAdapterNames");
@@ -227,6 +231,7 @@ InputDevice* InputDeviceManager::createInputDevice(const char* deviceName,int tr
 		}
 	else
 		newDevicePtr->set(deviceName,trackType,numButtons,numValuators);
+	newDevicePtr->setQueueButtonEvents(queueButtonEvents);
 	
 	/* Add the new input device to the input graph: */
 	inputGraphManager->addInputDevice(newDevicePtr);
@@ -293,4 +298,20 @@ void InputDeviceManager::updateInputDevices(void)
 		inputDeviceAdapters[i]->updateInputDevices();
 	}
 
+unsigned int InputDeviceManager::getNumDeliveredEvents(void) const
+	{
+	unsigned int result=0;
+	for(InputDevices::const_iterator idIt=inputDevices.begin();idIt!=inputDevices.end();++idIt)
+		result+=idIt->getNumDeliveredEvents();
+	return result;
+	}
+
+unsigned int InputDeviceManager::getNumSuppressedEvents(void) const
+	{
+	unsigned int result=0;
+	for(InputDevices::const_iterator idIt=inputDevices.begin();idIt!=inputDevices.end();++idIt)
+		result+=idIt->getNumSuppressedEvents();
+	return result;
+	}
+
 }
@@ -80,6 +80,7 @@ class InputDeviceManager
 	int numInputDeviceAdapters; // Number of input device adapters managed by the input device manager
 	InputDeviceAdapter** inputDeviceAdapters; // Array of pointers to managed input device adapters
 	InputDevices inputDevices; // List of all created input devices
+	bool queueButtonEvents; // Flag whether created input devices queue button changes in order while their callbacks are disabled
 	Misc::CallbackList inputDeviceCreationCallbacks; // List of callbacks to be called after a new input device has been created
 	Misc::CallbackList inputDeviceDestructionCallbacks; // List of callbacks to be called before an input device will be destroyed
 	
@@ -116,6 +117,8 @@ class InputDeviceManager
 	InputDevice* findInputDevice(const char* deviceName);
 	void destroyInputDevice(InputDevice* device);
 	void updateInputDevices(void);
+	unsigned int getNumDeliveredEvents(void) const; // Returns the total number of button and valuator callbacks called on all input devices
+	unsigned int getNumSuppressedEvents(void) const; // Returns the total number of button and valuator changes coalesced on all input devices
 	Misc::CallbackList& getInputDeviceCreationCallbacks(void) // Returns list of input device creation callbacks
 		{
 		return inputDeviceCreationCallbacks;
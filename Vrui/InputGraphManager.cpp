@@ -49,7 +49,7 @@ void InputGraphManager::linkInputDevice(InputGraphManager::GraphInputDevice* gid
 	gid->levelSucc=deviceLevels[gid->level];
 	if(deviceLevels[gid->level]!=0)
 		deviceLevels[gid->level]->levelPred=gid;
-	deviceLevels[gid->level]=gid;	
+	deviceLevels[gid->level]=gid;
 	}
 
 void InputGraphManager::unlinkInputDevice(InputGraphManager::GraphInputDevice* gid)
@@ -70,7 +70,7 @@ void InputGraphManager::linkTool(InputGraphManager::GraphTool* gt)
 	gt->levelSucc=toolLevels[gt->level];
 	if(toolLevels[gt->level]!=0)
 		toolLevels[gt->level]->levelPred=gt;
-	toolLevels[gt->level]=gt;	
+	toolLevels[gt->level]=gt;
 	}
 
 void InputGraphManager::unlinkTool(InputGraphManager::GraphTool* gt)
@@ -176,14 +176,29 @@ void InputGraphManager::updateInputGraph(void)
 	shrinkInputGraph();
 	}
 
+bool InputGraphManager::hasInputChanged(const InputGraphManager::GraphTool* gt) const
+	{
+	/* Check all input devices assigned to the tool: */
+	const ToolInputAssignment& tia=gt->tool->getInputAssignment();
+	for(int i=0;i<gt->tool->getLayout().getNumDevices();++i)
+		if(deviceMap.getEntry(tia.getDevice(i)).getDest()->changed)
+			return true;
+	
+	return false;
+	}
+
 InputGraphManager::InputGraphManager(GlyphRenderer* sGlyphRenderer,VirtualInputDevice* sVirtualInputDevice)
 	:glyphRenderer(sGlyphRenderer),virtualInputDevice(sVirtualInputDevice),
 	 deviceMap(101),toolMap(101),
-	 maxGraphLevel(-1)
+	 maxGraphLevel(-1),
+	 navigationTransformationValid(false),
+	 numSkippedToolFrames(0)
 	{
 	/* Initialize the input device manager fake graph tool: */
 	inputDeviceManager.tool=0;
 	inputDeviceManager.level=-1;
+	inputDeviceManager.inputDriven=false;
+	inputDeviceManager.frameDue=false;
 	inputDeviceManager.levelPred=0;
 	inputDeviceManager.levelSucc=0;
 	}
@@ -223,6 +238,9 @@ void InputGraphManager::addInputDevice(InputDevice* newDevice)
 	newGid->device=newDevice;
 	newGid->level=0;
 	newGid->navigational=false;
+	newGid->navStateVersion=newDevice->getStateVersion();
+	newGid->updateStateVersion=newDevice->getStateVersion()-1U; // Treat the new device as changed during the next update
+	newGid->changed=true;
 	growInputGraph(0);
 	linkInputDevice(newGid);
 	newGid->grabber=0; // Mark the device as ungrabbed
@@ -488,6 +506,8 @@ void InputGraphManager::addTool(Tool* newTool)
 	GraphTool* newGt=new GraphTool;
 	newGt->tool=newTool;
 	newGt->level=maxDeviceLevel;
+	newGt->inputDriven=newTool->isFrameInputDriven();
+	newGt->frameDue=true; // Call the new tool's frame method at least once
 	linkTool(newGt);
 	
 	/* Add the new graph tool to the tool map: */
@@ -514,30 +534,55 @@ void InputGraphManager::removeTool(Tool* tool)
 
 void InputGraphManager::update(void)
 	{
-	/* Set the transformations of ungrabbed navigational devices in the first graph level: */
+	/* Check if the navigation transformation changed since the last update: */
+	const NavTransform& nav=getNavigationTransformation();
+	bool navigationChanged=!navigationTransformationValid||nav.getTranslation()!=navigationTransformation.getTranslation()||nav.getRotation()!=navigationTransformation.getRotation()||nav.getScaling()!=navigationTransformation.getScaling();
+	if(navigationChanged)
+		{
+		navigationTransformation=nav;
+		navigationTransformationValid=true;
+		}
+	
+	/* Set the transformations of ungrabbed navigational devices in the first graph level that are out of date: */
 	for(GraphInputDevice* gid=deviceLevels[0];gid!=0;gid=gid->levelSucc)
-		if(gid->navigational&&gid->grabber==0)
+		if(gid->navigational&&gid->grabber==0&&(navigationChanged||gid->device->getStateVersion()!=gid->navStateVersion))
 			{
 			/* Set the device's transformation: */
-			NavTrackerState transform=getNavigationTransformation();
+			NavTrackerState transform=nav;
 			transform*=gid->fromNavTransform;
 			transform.renormalize();
 			gid->device->setTransformation(TrackerState(transform.getTranslation(),transform.getRotation()));
+			gid->navStateVersion=gid->device->getStateVersion();
 			}
 	
 	/* Go through all graph levels: */
+	numSkippedToolFrames=0;
 	for(int i=0;i<=maxGraphLevel;++i)
 		{
-		/* Trigger callbacks on all input devices in the level: */
+		/* Trigger callbacks on all input devices in the level that changed since the last update: */
 		for(GraphInputDevice* gid=deviceLevels[i];gid!=0;gid=gid->levelSucc)
 			{
-			gid->device->enableCallbacks();
-			gid->device->disableCallbacks();
+			unsigned int stateVersion=gid->device->getStateVersion();
+			gid->changed=stateVersion!=gid->updateStateVersion;
+			gid->updateStateVersion=stateVersion;
+			if(gid->changed)
+				{
+				gid->device->enableCallbacks();
+				gid->device->disableCallbacks();
+				}
 			}
 		
-		/* Call frame method on all tools in the level: */
+		/* Call frame method on all tools in the level, skipping input-driven tools whose input devices did not change: */
 		for(GraphTool* gt=toolLevels[i];gt!=0;gt=gt->levelSucc)
-			gt->tool->frame();
+			{
+			if(gt->frameDue||!gt->inputDriven||hasInputChanged(gt))
+				{
+				gt->frameDue=false;
+				gt->tool->frame();
+				}
+			else
+				++numSkippedToolFrames;
+			}
 		}
 	}
 
@@ -546,31 +591,28 @@ void InputGraphManager::glRenderAction(GLContextData& contextData) const
 	/* Get the glyph renderer's context data item: */
 	const GlyphRenderer::DataItem* glyphRendererContextDataItem=glyphRenderer->getContextDataItem(contextData);
 	
-	/* Render all input devices in the first input graph level: */
+	/* Collect glyphs for all input devices in the first input graph level: */
 	for(const GraphInputDevice* gid=deviceLevels[0];gid!=0;gid=gid->levelSucc)
 		{
 		/* Check if the device is an ungrabbed virtual input device: */
 		if(gid->grabber==0)
 			virtualInputDevice->renderDevice(gid->device,gid->navigational,glyphRendererContextDataItem,contextData);
 		else
-			glyphRenderer->renderGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
+			glyphRenderer->batchGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
 		}
-
-	/* Render all tools in the first input graph level: */
-	for(const GraphTool* gt=toolLevels[0];gt!=0;gt=gt->levelSucc)
-		gt->tool->display(contextData);
 	
-	/* Iterate through all higher input graph levels: */
+	/* Collect glyphs for all input devices in all higher input graph levels: */
 	for(int level=1;level<=maxGraphLevel;++level)
-		{
-		/* Render all input devices in this level: */
 		for(const GraphInputDevice* gid=deviceLevels[level];gid!=0;gid=gid->levelSucc)
-			glyphRenderer->renderGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
-		
-		/* Render all tools in this level: */
+			glyphRenderer->batchGlyph(gid->deviceGlyph,OGTransform(gid->device->getTransformation()),glyphRendererContextDataItem);
+
+	/* Render all tools in all input graph levels: */
+	for(int level=0;level<=maxGraphLevel;++level)
 		for(const GraphTool* gt=toolLevels[level];gt!=0;gt=gt->levelSucc)
 			gt->tool->display(contextData);
-		}
+	
+	/* Render all collected device glyphs, and all glyphs batched by tools, in one batch: */
+	glyphRenderer->renderBatch(glyphRendererContextDataItem);
 	}
 
 }
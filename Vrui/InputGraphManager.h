@@ -55,6 +55,9 @@ class InputGraphManager
 		int level; // Index of the graph level containing the input device
 		bool navigational; // Flag whether this device, if ungrabbed, follows the navigation transformation
 		NavTrackerState fromNavTransform; // Transformation from navigation coordinates to device's coordinates while device is in navigational mode
+		unsigned int navStateVersion; // Device's state version after its transformation was last set from the navigation transformation
+		unsigned int updateStateVersion; // Device's state version at the last input graph update
+		bool changed; // Flag whether the device's state changed since the previous input graph update
 		GraphInputDevice* levelPred; // Pointer to the previous input device in the same graph level
 		GraphInputDevice* levelSucc; // Pointer to the next input device in the same graph level
 		GraphTool* grabber; // Pointer to the tool currently holding a grab on the input device
@@ -66,6 +69,8 @@ class InputGraphManager
 		public:
 		Tool* tool; // Pointer to the tool
 		int level; // Index of the graph level containing the tool
+		bool inputDriven; // Flag whether the tool's frame method only needs to be called when one of its input devices changed
+		bool frameDue; // Flag whether the tool's frame method must be called during the next update regardless of input changes
 		GraphTool* levelPred; // Pointer to the previous tool in the same graph level
 		GraphTool* levelSucc; // Pointer to the next tool in the same graph level
 		};
@@ -82,6 +87,9 @@ class InputGraphManager
 	int maxGraphLevel; // Maximum level in the input graph that has input devices or tools
 	std::vector<GraphInputDevice*> deviceLevels; // Vector of pointers to the first input device in each graph level
 	std::vector<GraphTool*> toolLevels; // Vector of pointers to the first tool in each graph level
+	bool navigationTransformationValid; // Flag whether navigationTransformation holds the navigation transformation applied during the last update
+	NavTransform navigationTransformation; // Navigation transformation applied to navigational devices during the last update
+	unsigned int numSkippedToolFrames; // Number of tool frame method calls skipped during the last update
 	
 	/* Private methods: */
 	void linkInputDevice(GraphInputDevice* gid); // Links a graph input device to its current graph level
@@ -91,6 +99,7 @@ class InputGraphManager
 	void growInputGraph(int level); // Grows the input graph to represent the given level
 	void shrinkInputGraph(void); // Removes all empty levels from the end of the input graph
 	void updateInputGraph(void); // Reorders graph levels after input device grab/release
+	bool hasInputChanged(const GraphTool* gt) const; // Returns true if any input device assigned to the given tool changed during the current update
 	
 	/* Constructors and destructors: */
 	public:
@@ -115,7 +124,11 @@ class InputGraphManager
 	void removeInputDevice(InputDevice* device); // Removes an input device from the graph
 	void addTool(Tool* newTool); // Adds a tool to the input graph, based on its current input assignment
 	void removeTool(Tool* tool); // Removes a tool from the input graph
-	void update(void); // Updates state of all tools and non-physical input devices in the graph
+	void update(void); // Updates state of all tools and non-physical input devices in the graph; skips input devices and tools whose inputs did not change
+	unsigned int getNumSkippedToolFrames(void) const // Returns the number of tool frame method calls skipped during the last update
+		{
+		return numSkippedToolFrames;
+		}
 	void glRenderAction(GLContextData& contextData) const; // Renders current state of all input devices and tools
 	};
 
@@ -79,6 +79,9 @@ MultipipeDispatcher::MultipipeDispatcher(Comm::MulticastPipe* sPipe,InputDeviceM
 			pipe->write<int>(id->getNumValuators());
 			totalNumValuators+=id->getNumValuators();
 			
+			/* Send button event queueing flag: */
+			pipe->write<int>(id->getQueueButtonEvents()?1:0);
+			
 			/* Send device glyph: */
 			pipe->write<Glyph>(inputDeviceManager->getInputGraphManager()->getInputDeviceGlyph(id));
 			}
@@ -114,6 +117,9 @@ MultipipeDispatcher::MultipipeDispatcher(Comm::MulticastPipe* sPipe,InputDeviceM
 			int numValuators=pipe->read<int>();
 			totalNumValuators+=numValuators;
 			
+			/* Read button event queueing flag: */
+			bool queueButtonEvents=pipe->read<int>()!=0;
+			
 			/* Read device glyph: */
 			Glyph deviceGlyph=pipe->read<Glyph>();
 			
@@ -123,6 +129,7 @@ MultipipeDispatcher::MultipipeDispatcher(Comm::MulticastPipe* sPipe,InputDeviceM
 			
 			/* Initialize the input device: */
 			id->setDeviceRayDirection(deviceRayDirection);
+			id->setQueueButtonEvents(queueButtonEvents);
 			inputDeviceManager->getInputGraphManager()->getInputDeviceGlyph(id)=deviceGlyph;
 			}
 		}
@@ -163,6 +170,22 @@ void MultipipeDispatcher::dispatchState(void)
 		pipe->write<InputDeviceTrackingState>(trackingStates,numInputDevices);
 		pipe->write<bool>(buttonStates,totalNumButtons);
 		pipe->write<double>(valuatorStates,totalNumValuators);
+		
+		/* Send the queued button changes of all input devices that queue button changes: */
+		for(int i=0;i<numInputDevices;++i)
+			{
+			InputDevice* id=inputDeviceManager->getInputDevice(i);
+			if(id->getQueueButtonEvents())
+				{
+				const std::vector<InputDevice::ButtonEvent>& events=id->getButtonEventQueue();
+				pipe->write<int>(int(events.size()));
+				for(std::vector<InputDevice::ButtonEvent>::const_iterator eIt=events.begin();eIt!=events.end();++eIt)
+					{
+					pipe->write<int>(eIt->buttonIndex);
+					pipe->write<int>(eIt->newButtonState?1:0);
+					}
+				}
+			}
 		}
 	else
 		{
@@ -180,6 +203,20 @@ void MultipipeDispatcher::dispatchState(void)
 			id->setTransformation(trackingStates[i].transformation);
 			id->setLinearVelocity(trackingStates[i].linearVelocity);
 			id->setAngularVelocity(trackingStates[i].angularVelocity);
+			
+			if(id->getQueueButtonEvents())
+				{
+				/* Replay the master's queued button changes in order: */
+				int numEvents=pipe->read<int>();
+				for(int j=0;j<numEvents;++j)
+					{
+					int buttonIndex=pipe->read<int>();
+					bool newButtonState=pipe->read<int>()!=0;
+					id->setButtonState(buttonIndex,newButtonState);
+					}
+				}
+			
+			/* Set the final button states and valuator values: */
 			for(int j=0;j<id->getNumButtons();++j,++bsPtr)
 				id->setButtonState(j,*bsPtr);
 			for(int j=0;j<id->getNumValuators();++j,++vsPtr)
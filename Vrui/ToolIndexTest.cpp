@@ -0,0 +1,171 @@
+/***********************************************************************
+ToolIndexTest - Program to compare the tool class setup time of a tool
+manager that uses an up-to-date tool class index against one that opens
+the DSOs of all default tool classes, and to check that the index is
+consistent with the installed tool DSOs.
+Copyright (c) 2010 Oliver Kreylos
+
+This file is part of the Virtual Reality User Interface Library (Vrui).
+
+The Virtual Reality User Interface Library is free software; you can
+redistribute it and/or modify it under the terms of the GNU General
+Public License as published by the Free Software Foundation; either
+version 2 of the License, or (at your option) any later version.
+
+The Virtual Reality User Interface Library is distributed in the hope
+that it will be useful, but WITHOUT ANY WARRANTY; without even the
+implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with the Virtual Reality User Interface Library; if not, write to the
+Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+02111-1307 USA
+***********************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <Misc/Timer.h>
+#include <Misc/ConfigurationFile.h>
+#include <Misc/StandardValueCoders.h>
+#include <Misc/CompoundValueCoders.h>
+
+namespace {
+
+/**************
+Helper classes:
+**************/
+
+struct IndexedClass // Structure for a tool class as described by the tool class index
+	{
+	/* Elements: */
+	public:
+	std::string className; // Name of the tool class
+	std::vector<std::string> parentClassNames; // Names of the class's parent classes
+	std::string dsoName; // Full name of the DSO containing the class
+	double dsoTime; // Modification time of the DSO when the class was indexed
+	unsigned int dsoSize; // Size of the DSO when the class was indexed
+	};
+
+/****************
+Helper functions:
+****************/
+
+int numFailures=0;
+
+void check(bool condition,const char* what)
+	{
+	if(!condition)
+		{
+		fprintf(stderr,"FAILED: %s\n",what);
+		++numFailures;
+		}
+	}
+
+bool getDsoStatus(const std::string& dsoName,double& dsoTime,unsigned int& dsoSize) // Same test as in ToolManager
+	{
+	struct stat dsoStat;
+	if(stat(dsoName.c_str(),&dsoStat)!=0)
+		return false;
+	dsoTime=double(dsoStat.st_mtime);
+	dsoSize=(unsigned int)dsoStat.st_size;
+	return true;
+	}
+
+}
+
+int main(int argc,char* argv[])
+	{
+	typedef std::vector<std::string> StringList;
+	
+	/* Parse the command line; use the system-wide index if there is one, like ToolManager: */
+	std::string indexFileName=SYSTOOLINDEXFILENAME;
+	struct stat indexStat;
+	if(stat(indexFileName.c_str(),&indexStat)!=0&&getenv("HOME")!=0)
+		{
+		indexFileName=getenv("HOME");
+		indexFileName.append("/.VruiToolIndex.cfg");
+		}
+	for(int i=1;i<argc;++i)
+		{
+		if(strcasecmp(argv[i],"-index")==0&&i+1<argc)
+			indexFileName=argv[++i];
+		}
+	printf("Reading tool class index %s\n",indexFileName.c_str());
+	printf("(run any Vrui application once to create or update the index)\n");
+	
+	/* Read and validate the index as ToolManager does when it finds an index: */
+	std::vector<IndexedClass> indexedClasses;
+	bool indexValid=true;
+	Misc::Timer indexTimer;
+	try
+		{
+		Misc::ConfigurationFile indexFile(indexFileName.c_str());
+		StringList indexedClassNames=indexFile.retrieveValue<StringList>("/toolClassNames");
+		for(StringList::const_iterator icnIt=indexedClassNames.begin();icnIt!=indexedClassNames.end();++icnIt)
+			{
+			Misc::ConfigurationFileSection classSection=indexFile.getSection(("/"+*icnIt).c_str());
+			IndexedClass ic;
+			ic.className=*icnIt;
+			classSection.retrieveValue<std::string>("./name");
+			ic.parentClassNames=classSection.retrieveValue<StringList>("./parentClassNames");
+			ic.dsoName=classSection.retrieveValue<std::string>("./dsoName");
+			ic.dsoTime=classSection.retrieveValue<double>("./dsoTime");
+			ic.dsoSize=classSection.retrieveValue<unsigned int>("./dsoSize");
+			
+			double dsoTime;
+			unsigned int dsoSize;
+			if(!getDsoStatus(ic.dsoName,dsoTime,dsoSize)||dsoTime!=ic.dsoTime||dsoSize!=ic.dsoSize)
+				indexValid=false;
+			
+			indexedClasses.push_back(ic);
+			}
+		}
+	catch(const std::runtime_error& err)
+		{
+		fprintf(stderr,"Cannot read tool class index %s due to exception %s\n",indexFileName.c_str(),err.what());
+		return 1;
+		}
+	indexTimer.elapse();
+	
+	check(!indexedClasses.empty(),"index contains tool classes");
+	check(indexValid,"all indexed DSOs exist and are unchanged");
+	
+	/* Check that all indexed parents are listed before their children, so the menu layout does not depend on load order: */
+	bool parentsFirst=true;
+	for(size_t i=0;i<indexedClasses.size();++i)
+		for(StringList::const_iterator pcnIt=indexedClasses[i].parentClassNames.begin();pcnIt!=indexedClasses[i].parentClassNames.end();++pcnIt)
+			for(size_t j=i+1;j<indexedClasses.size();++j)
+				if(indexedClasses[j].className==*pcnIt)
+					parentsFirst=false;
+	check(parentsFirst,"indexed parent classes precede their children");
+	
+	/* Open all indexed DSOs in index order, as ToolManager does when it has no index: */
+	unsigned int numOpened=0;
+	Misc::Timer loadTimer;
+	for(std::vector<IndexedClass>::const_iterator icIt=indexedClasses.begin();icIt!=indexedClasses.end();++icIt)
+		{
+		void* dsoHandle=dlopen(icIt->dsoName.c_str(),RTLD_LAZY|RTLD_GLOBAL);
+		if(dsoHandle!=0)
+			++numOpened;
+		else
+			fprintf(stderr,"Cannot open DSO %s due to %s\n",icIt->dsoName.c_str(),dlerror());
+		}
+	loadTimer.elapse();
+	check(numOpened==indexedClasses.size(),"all indexed DSOs can be opened");
+	
+	/* Report the results: */
+	printf("%u indexed tool classes\n",(unsigned int)(indexedClasses.size()));
+	printf("Tool class setup from index: %.3f ms\n",indexTimer.getTime()*1000.0);
+	printf("Opening all tool DSOs: %.3f ms (not including factory creation)\n",loadTimer.getTime()*1000.0);
+	
+	if(numFailures==0)
+		printf("All checks passed\n");
+	return numFailures!=0?1:0;
+	}
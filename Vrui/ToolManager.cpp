@@ -21,10 +21,15 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 02111-1307 USA
 ***********************************************************************/
 
+#include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <iostream>
 #include <vector>
 #include <Misc/ThrowStdErr.h>
+#include <Misc/Timer.h>
+#include <Misc/File.h>
 #include <Misc/StandardValueCoders.h>
 #include <Misc/CompoundValueCoders.h>
 #include <GLMotif/Button.h>
@@ -56,6 +61,24 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 namespace Vrui {
 
+namespace {
+
+/****************
+Helper functions:
+****************/
+
+bool getDsoStatus(const std::string& dsoName,double& dsoTime,unsigned int& dsoSize) // Returns the modification time and size of the given DSO; returns false if the DSO does not exist
+	{
+	struct stat dsoStat;
+	if(stat(dsoName.c_str(),&dsoStat)!=0)
+		return false;
+	dsoTime=double(dsoStat.st_mtime);
+	dsoSize=(unsigned int)dsoStat.st_size;
+	return true;
+	}
+
+}
+
 /************************************************
 Methods of class ToolManager::ToolAssignmentSlot:
 ************************************************/
@@ -214,36 +237,204 @@ void ToolManager::destroyToolFactoryFunction(ToolFactory* toolFactory)
 Methods of class ToolManager:
 ****************************/
 
-GLMotif::Popup* ToolManager::createToolSubmenu(const Plugins::Factory& factory)
+const ToolManager::ToolClassInfo* ToolManager::findIndexedClass(const std::string& className) const
 	{
-	char popupName[256];
-	snprintf(popupName,sizeof(popupName),"%sSubmenuPopup",factory.getClassName());
-	GLMotif::Popup* toolSubmenuPopup=new GLMotif::Popup(popupName,getWidgetManager());
+	for(ToolClassList::const_iterator tcIt=toolIndex.begin();tcIt!=toolIndex.end();++tcIt)
+		if(tcIt->className==className)
+			return &(*tcIt);
+	return 0;
+	}
+
+bool ToolManager::addIndexedClass(const ToolManager::ToolClassList& indexedClasses,const std::string& className)
+	{
+	/* Bail out if the class has already been added: */
+	if(findIndexedClass(className)!=0)
+		return true;
 	
-	GLMotif::SubMenu* toolSubmenu=new GLMotif::SubMenu("ToolSubmenu",toolSubmenuPopup,false);
+	/* Find the class among the indexed classes; classes that are not indexed must have been loaded explicitly: */
+	ToolClassList::const_iterator icIt;
+	for(icIt=indexedClasses.begin();icIt!=indexedClasses.end()&&icIt->className!=className;++icIt)
+		;
+	if(icIt==indexedClasses.end())
+		return findClass(className.c_str())!=0;
 	
-	/* Create entries for all tool subclasses: */
-	for(Plugins::Factory::ClassList::const_iterator chIt=factory.childrenBegin();chIt!=factory.childrenEnd();++chIt)
+	/* Add the class's parents before the class itself, in the same order in which loading the class would load them: */
+	for(std::vector<std::string>::const_iterator pcnIt=icIt->parentClassNames.begin();pcnIt!=icIt->parentClassNames.end();++pcnIt)
+		if(!addIndexedClass(indexedClasses,*pcnIt))
+			return false;
+	toolIndex.push_back(*icIt);
+	
+	return true;
+	}
+
+bool ToolManager::indexToolClasses(const ToolManager::ToolClassList& indexedClasses,const std::vector<std::string>& toolClassNames)
+	{
+	/* Add all requested classes and the classes they depend on: */
+	toolIndex.clear();
+	for(std::vector<std::string>::const_iterator tcnIt=toolClassNames.begin();tcnIt!=toolClassNames.end();++tcnIt)
+		if(!addIndexedClass(indexedClasses,*tcnIt))
+			{
+			toolIndex.clear();
+			return false;
+			}
+	
+	return true;
+	}
+
+bool ToolManager::readToolIndex(const char* indexFileName,const std::vector<std::string>& toolClassNames)
+	{
+	typedef std::vector<std::string> StringList;
+	
+	ToolClassList indexedClasses;
+	try
 		{
-		/* Get a pointer to the tool factory: */
-		const ToolFactory* factory=dynamic_cast<const ToolFactory*>(*chIt);
-		if(factory==0)
-			Misc::throwStdErr("ToolManager::createToolSubmenu: factory class %s is not a Vrui tool factory class",(*chIt)->getClassName());
+		/* Read the tool class index file: */
+		Misc::ConfigurationFile indexFile(indexFileName);
 		
-		/* Check if current class is leaf class: */
-		if((*chIt)->getChildren().empty())
+		/* Read the descriptions of all indexed tool classes: */
+		StringList indexedClassNames=indexFile.retrieveValue<StringList>("/toolClassNames");
+		for(StringList::const_iterator icnIt=indexedClassNames.begin();icnIt!=indexedClassNames.end();++icnIt)
 			{
-			/* Create button for tool class: */
-			GLMotif::Button* toolButton=new GLMotif::Button((*chIt)->getClassName(),toolSubmenu,factory->getName());
-			toolButton->getSelectCallbacks().add(this,&ToolManager::toolMenuSelectionCallback);
+			Misc::ConfigurationFileSection classSection=indexFile.getSection(("/"+*icnIt).c_str());
+			ToolClassInfo tci;
+			tci.className=*icnIt;
+			tci.name=classSection.retrieveValue<std::string>("./name");
+			tci.parentClassNames=classSection.retrieveValue<StringList>("./parentClassNames");
+			tci.dsoName=classSection.retrieveValue<std::string>("./dsoName");
+			tci.dsoTime=classSection.retrieveValue<double>("./dsoTime");
+			tci.dsoSize=classSection.retrieveValue<unsigned int>("./dsoSize");
+			
+			/* Check that the class still resolves to the same, unchanged DSO: */
+			double dsoTime;
+			unsigned int dsoSize;
+			if(getDsoName(icnIt->c_str())!=tci.dsoName||!getDsoStatus(tci.dsoName,dsoTime,dsoSize)||dsoTime!=tci.dsoTime||dsoSize!=tci.dsoSize)
+				return false;
+			
+			indexedClasses.push_back(tci);
+			}
+		}
+	catch(const std::runtime_error&)
+		{
+		/* The index file does not exist, is malformed, or refers to missing DSOs: */
+		return false;
+		}
+	
+	/* Check that the index covers all requested classes and the classes they depend on: */
+	return indexToolClasses(indexedClasses,toolClassNames);
+	}
+
+void ToolManager::createToolIndex(const std::vector<std::string>& toolClassNames)
+	{
+	typedef std::vector<std::string> StringList;
+	
+	/* Count the classes that were added explicitly: */
+	unsigned int numBuiltinClasses=0;
+	for(FactoryIterator fIt=begin();fIt!=end();++fIt)
+		++numBuiltinClasses;
+	
+	/* Load all requested tool classes, which also loads the classes they depend on: */
+	for(StringList::const_iterator tcnIt=toolClassNames.begin();tcnIt!=toolClassNames.end();++tcnIt)
+		loadClass(tcnIt->c_str());
+	
+	/* Describe all classes that were loaded from DSOs: */
+	ToolClassList loadedClasses;
+	unsigned int classIndex=0;
+	for(FactoryIterator fIt=begin();fIt!=end();++fIt,++classIndex)
+		if(classIndex>=numBuiltinClasses)
+			{
+			ToolClassInfo tci;
+			tci.className=fIt->getClassName();
+			tci.name=fIt->getName();
+			for(Plugins::Factory::ClassList::const_iterator pIt=fIt->parentsBegin();pIt!=fIt->parentsEnd();++pIt)
+				tci.parentClassNames.push_back((*pIt)->getClassName());
+			tci.dsoName=getDsoName(fIt->getClassName());
+			if(!getDsoStatus(tci.dsoName,tci.dsoTime,tci.dsoSize))
+				{
+				tci.dsoTime=0.0;
+				tci.dsoSize=0;
+				}
+			loadedClasses.push_back(tci);
 			}
-		else
+	
+	/* Order the loaded classes exactly as if they had been read from the index file: */
+	indexToolClasses(loadedClasses,toolClassNames);
+	}
+
+void ToolManager::writeToolIndex(void) const
+	{
+	typedef std::vector<std::string> StringList;
+	
+	/* Write the index to a temporary file first, in case several nodes or processes create the index at the same time: */
+	char hostName[256];
+	if(gethostname(hostName,sizeof(hostName))!=0)
+		hostName[0]='\0';
+	hostName[sizeof(hostName)-1]='\0';
+	char tempFileName[1024];
+	snprintf(tempFileName,sizeof(tempFileName),"%s.%s.%d",toolIndexFileName.c_str(),hostName,int(getpid()));
+	try
+		{
+		Misc::File indexFile(tempFileName,"wt");
+		FILE* indexFilePtr=indexFile.getFilePtr();
+		
+		/* Write the list of indexed classes: */
+		StringList indexedClassNames;
+		for(ToolClassList::const_iterator tcIt=toolIndex.begin();tcIt!=toolIndex.end();++tcIt)
+			indexedClassNames.push_back(tcIt->className);
+		fprintf(indexFilePtr,"toolClassNames %s\n",Misc::ValueCoder<StringList>::encode(indexedClassNames).c_str());
+		
+		/* Write one section per indexed class: */
+		for(ToolClassList::const_iterator tcIt=toolIndex.begin();tcIt!=toolIndex.end();++tcIt)
 			{
-			/* Create cascade button and submenu for tool class: */
-			GLMotif::CascadeButton* toolCascade=new GLMotif::CascadeButton((*chIt)->getClassName(),toolSubmenu,factory->getName());
-			toolCascade->setPopup(createToolSubmenu(**chIt));
+			fprintf(indexFilePtr,"\nsection %s\n",tcIt->className.c_str());
+			fprintf(indexFilePtr,"\tname %s\n",Misc::ValueCoder<std::string>::encode(tcIt->name).c_str());
+			fprintf(indexFilePtr,"\tparentClassNames %s\n",Misc::ValueCoder<StringList>::encode(tcIt->parentClassNames).c_str());
+			fprintf(indexFilePtr,"\tdsoName %s\n",Misc::ValueCoder<std::string>::encode(tcIt->dsoName).c_str());
+			fprintf(indexFilePtr,"\tdsoTime %s\n",Misc::ValueCoder<double>::encode(tcIt->dsoTime).c_str());
+			fprintf(indexFilePtr,"\tdsoSize %s\n",Misc::ValueCoder<unsigned int>::encode(tcIt->dsoSize).c_str());
+			fprintf(indexFilePtr,"endsection\n");
 			}
 		}
+	catch(const std::runtime_error&)
+		{
+		/* Don't keep an index if the index file cannot be written: */
+		unlink(tempFileName);
+		return;
+		}
+	
+	/* Replace the index file: */
+	if(rename(tempFileName,toolIndexFileName.c_str())!=0)
+		unlink(tempFileName);
+	}
+
+GLMotif::Popup* ToolManager::createToolSubmenu(const ToolManager::ToolClassList& toolClasses,const ToolManager::ToolClassInfo& toolClass)
+	{
+	char popupName[256];
+	snprintf(popupName,sizeof(popupName),"%sSubmenuPopup",toolClass.className.c_str());
+	GLMotif::Popup* toolSubmenuPopup=new GLMotif::Popup(popupName,getWidgetManager());
+	
+	GLMotif::SubMenu* toolSubmenu=new GLMotif::SubMenu("ToolSubmenu",toolSubmenuPopup,false);
+	
+	/* Create entries for all tool subclasses: */
+	for(ToolClassList::const_iterator chIt=toolClasses.begin();chIt!=toolClasses.end();++chIt)
+		if(chIt->isDerivedFrom(toolClass.className))
+			{
+			/* Check if current class is leaf class: */
+			ToolClassList::const_iterator gchIt;
+			for(gchIt=toolClasses.begin();gchIt!=toolClasses.end()&&!gchIt->isDerivedFrom(chIt->className);++gchIt)
+				;
+			if(gchIt==toolClasses.end())
+				{
+				/* Create button for tool class: */
+				GLMotif::Button* toolButton=new GLMotif::Button(chIt->className.c_str(),toolSubmenu,chIt->name.c_str());
+				toolButton->getSelectCallbacks().add(this,&ToolManager::toolMenuSelectionCallback);
+				}
+			else
+				{
+				/* Create cascade button and submenu for tool class: */
+				GLMotif::CascadeButton* toolCascade=new GLMotif::CascadeButton(chIt->className.c_str(),toolSubmenu,chIt->name.c_str());
+				toolCascade->setPopup(createToolSubmenu(toolClasses,*chIt));
+				}
+			}
 	
 	toolSubmenu->manageChild();
 	
@@ -252,6 +443,31 @@ GLMotif::Popup* ToolManager::createToolSubmenu(const Plugins::Factory& factory)
 
 GLMotif::PopupMenu* ToolManager::createToolMenu(void)
 	{
+	/*********************************************************************
+	Collect all loaded classes that are not in the tool class index, and
+	then all indexed classes in index order, so that the menu is laid out
+	identically no matter which indexed classes have already been loaded.
+	Indexed classes are only loaded when a tool is created from the menu.
+	*********************************************************************/
+	
+	ToolClassList toolClasses;
+	for(FactoryIterator fIt=begin();fIt!=end();++fIt)
+		if(findIndexedClass(fIt->getClassName())==0)
+			{
+			/* Get a pointer to the tool factory: */
+			const ToolFactory* factory=dynamic_cast<const ToolFactory*>(&(*fIt));
+			if(factory==0)
+				Misc::throwStdErr("ToolManager::createToolMenu: factory class %s is not a Vrui tool factory class",fIt->getClassName());
+			
+			ToolClassInfo tci;
+			tci.className=factory->getClassName();
+			tci.name=factory->getName();
+			for(Plugins::Factory::ClassList::const_iterator pIt=factory->parentsBegin();pIt!=factory->parentsEnd();++pIt)
+				tci.parentClassNames.push_back((*pIt)->getClassName());
+			toolClasses.push_back(tci);
+			}
+	toolClasses.insert(toolClasses.end(),toolIndex.begin(),toolIndex.end());
+	
 	/* Create menu shell: */
 	GLMotif::PopupMenu* toolSelectionMenuPopup=new GLMotif::PopupMenu("ToolSelectionMenuPopup",getWidgetManager());
 	toolSelectionMenuPopup->setTitle("Tool Selection Menu");
@@ -259,23 +475,26 @@ GLMotif::PopupMenu* ToolManager::createToolMenu(void)
 	GLMotif::Menu* toolSelectionMenu=new GLMotif::Menu("ToolSelectionMenu",toolSelectionMenuPopup,false);
 	
 	/* Create entries for all root tool classes: */
-	for(FactoryIterator fIt=begin();fIt!=end();++fIt)
+	for(ToolClassList::const_iterator tcIt=toolClasses.begin();tcIt!=toolClasses.end();++tcIt)
 		{
 		/* Check if current class is root class: */
-		if(fIt->getParents().empty())
+		if(tcIt->parentClassNames.empty())
 			{
 			/* Check if current class is leaf class: */
-			if(fIt->getChildren().empty())
+			ToolClassList::const_iterator chIt;
+			for(chIt=toolClasses.begin();chIt!=toolClasses.end()&&!chIt->isDerivedFrom(tcIt->className);++chIt)
+				;
+			if(chIt==toolClasses.end())
 				{
 				/* Create button for tool class: */
-				GLMotif::Button* toolButton=new GLMotif::Button(fIt->getClassName(),toolSelectionMenu,fIt->getName());
+				GLMotif::Button* toolButton=new GLMotif::Button(tcIt->className.c_str(),toolSelectionMenu,tcIt->name.c_str());
 				toolButton->getSelectCallbacks().add(this,&ToolManager::toolMenuSelectionCallback);
 				}
 			else
 				{
 				/* Create cascade button and submenu for tool class: */
-				GLMotif::CascadeButton* toolCascade=new GLMotif::CascadeButton(fIt->getClassName(),toolSelectionMenu,fIt->getName());
-				toolCascade->setPopup(createToolSubmenu(*fIt));
+				GLMotif::CascadeButton* toolCascade=new GLMotif::CascadeButton(tcIt->className.c_str(),toolSelectionMenu,tcIt->name.c_str());
+				toolCascade->setPopup(createToolSubmenu(toolClasses,*tcIt));
 				}
 			}
 		}
@@ -592,13 +811,30 @@ ToolManager::ToolManager(InputDeviceManager* sInputDeviceManager,const Misc::Con
 	addClass(new PointingToolFactory(*this),destroyToolFactoryFunction);
 	addClass(new UtilityToolFactory(*this),destroyToolFactoryFunction);
 	
-	/* Load default tool classes: */
+	/* Get the default tool classes from the tool class index, or load them if there is no up-to-date index: */
+	Misc::Timer loadTimer;
 	StringList toolClassNames=configFileSection.retrieveValue<StringList>("./toolClassNames");
-	for(StringList::const_iterator tcnIt=toolClassNames.begin();tcnIt!=toolClassNames.end();++tcnIt)
+	std::string userToolIndexFileName;
+	if(getenv("HOME")!=0)
 		{
-		/* Load tool class: */
-		loadClass(tcnIt->c_str());
+		/* Keep the index in the user's home directory, as the tool DSO directory is usually not writable: */
+		userToolIndexFileName=getenv("HOME");
+		userToolIndexFileName.append("/.VruiToolIndex.cfg");
+		}
+	toolIndexFileName=configFileSection.retrieveString("./toolIndexFileName",userToolIndexFileName);
+	
+	/* Prefer a system-wide index created by the administrator over the per-user index: */
+	bool haveIndex=!toolIndexFileName.empty()&&(readToolIndex(SYSTOOLINDEXFILENAME,toolClassNames)||readToolIndex(toolIndexFileName.c_str(),toolClassNames));
+	if(!haveIndex)
+		{
+		/* Load all default tool classes and index them: */
+		createToolIndex(toolClassNames);
+		if(!toolIndexFileName.empty())
+			writeToolIndex();
 		}
+	loadTimer.elapse();
+	if(configFileSection.retrieveValue<bool>("./reportToolLoadingTime",false))
+		std::cout<<"ToolManager: "<<(haveIndex?"Indexed ":"Loaded ")<<toolIndex.size()<<" tool classes in "<<loadTimer.getTime()*1000.0<<" ms"<<std::endl;
 	
 	/* Call the input device creation callback for all already existing devices: */
 	int numInputDevices=inputDeviceManager->getNumInputDevices();
@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_TOOLMANAGER_INCLUDED
 #define VRUI_TOOLMANAGER_INCLUDED
 
+#include <string>
 #include <vector>
 #include <Misc/CallbackData.h>
 #include <Misc/CallbackList.h>
@@ -117,6 +118,29 @@ class ToolManager:public Plugins::FactoryManager<ToolFactory>
 	
 	typedef std::vector<ToolManagementQueueItem> ToolManagementQueue;
 	
+	struct ToolClassInfo // Structure describing a tool class that can be created from a DSO without loading it
+		{
+		/* Elements: */
+		public:
+		std::string className; // Name of the tool class
+		std::string name; // Descriptive name of tools created by the class
+		std::vector<std::string> parentClassNames; // Names of the class's parent classes
+		std::string dsoName; // Full name of the DSO containing the class
+		double dsoTime; // Modification time of the DSO when the class was indexed
+		unsigned int dsoSize; // Size of the DSO when the class was indexed
+		
+		/* Methods: */
+		bool isDerivedFrom(const std::string& parentClassName) const // Returns true if the class is a direct child of the given class
+			{
+			for(std::vector<std::string>::const_iterator pcnIt=parentClassNames.begin();pcnIt!=parentClassNames.end();++pcnIt)
+				if(*pcnIt==parentClassName)
+					return true;
+			return false;
+			}
+		};
+	
+	typedef std::vector<ToolClassInfo> ToolClassList;
+	
 	public:
 	class ToolCreationCallbackData:public Misc::CallbackData // Callback data sent when a tool is created
 		{
@@ -151,6 +175,8 @@ class ToolManager:public Plugins::FactoryManager<ToolFactory>
 	Misc::ConfigurationFileSection configFileSection; // The tool manager's configuration file section - valid throughout the manager's entire lifetime
 	ToolList tools; // List of currently instantiated tools
 	ToolAssignmentSlotList toolAssignmentSlots; // Assignments of tools to input device buttons
+	std::string toolIndexFileName; // Name of the per-user persistent tool class index file; empty if no index is kept
+	ToolClassList toolIndex; // Descriptions of all default tool classes and the classes they depend on that are loaded from DSOs, parents first
 	ToolFactory* toolSelectionMenuFactory; // Factory for tool selection menu tools
 	GLMotif::PopupMenu* toolMenuPopup; // Hierarchical popup menu for tool selection
 	MutexMenu* toolMenu; // Shell for tool selection menu
@@ -165,7 +191,13 @@ class ToolManager:public Plugins::FactoryManager<ToolFactory>
 	static void destroyToolFactoryFunction(ToolFactory* toolFactory); // Destruction function for tool classes added explicitly
 	
 	/* Private methods: */
-	GLMotif::Popup* createToolSubmenu(const Plugins::Factory& factory); // Returns submenu containing all subclasses of the given class
+	const ToolClassInfo* findIndexedClass(const std::string& className) const; // Returns the index entry of the given tool class, or null
+	bool addIndexedClass(const ToolClassList& indexedClasses,const std::string& className); // Adds the given class and the indexed classes it depends on to the tool class index; returns false if a class is neither indexed nor loaded
+	bool indexToolClasses(const ToolClassList& indexedClasses,const std::vector<std::string>& toolClassNames); // Creates the tool class index from the given tool classes and the classes they depend on; returns false if the given list is incomplete
+	bool readToolIndex(const char* indexFileName,const std::vector<std::string>& toolClassNames); // Reads the given tool class index file; returns false if the index does not cover the given tool classes, or is out of date
+	void createToolIndex(const std::vector<std::string>& toolClassNames); // Loads the given tool classes and indexes all classes loaded from DSOs
+	void writeToolIndex(void) const; // Writes the tool class index to the per-user tool class index file
+	GLMotif::Popup* createToolSubmenu(const ToolClassList& toolClasses,const ToolClassInfo& toolClass); // Returns submenu containing all subclasses of the given class
 	GLMotif::PopupMenu* createToolMenu(void); // Returns top level of tool selection menu
 	Tool* assignToolSelectionTool(ToolAssignmentSlot& tas);
 	void assignToolSelectionTools(void); // Assigns tool selection tools to all empty tool assignment slots
@@ -163,6 +163,12 @@ void ClutchTool::buttonCallback(int,int deviceButtonIndex,InputDevice::ButtonCal
 		}
 	}
 
+bool ClutchTool::isFrameInputDriven(void) const
+	{
+	/* The transformed device only depends on the source device: */
+	return true;
+	}
+
 void ClutchTool::frame(void)
 	{
 	if(!clutchButtonState)
@@ -69,6 +69,7 @@ class ClutchTool:public TransformTool
 	/* Methods from Tool: */
 	virtual const ToolFactory* getFactory(void) const;
 	virtual void buttonCallback(int deviceIndex,int deviceButtonIndex,InputDevice::ButtonCallbackData* cbData);
+	virtual bool isFrameInputDriven(void) const;
 	virtual void frame(void);
 	};
 
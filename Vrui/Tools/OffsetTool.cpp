@@ -126,6 +126,12 @@ const ToolFactory* OffsetTool::getFactory(void) const
 	return factory;
 	}
 
+bool OffsetTool::isFrameInputDriven(void) const
+	{
+	/* The transformed device only depends on the source device: */
+	return true;
+	}
+
 void OffsetTool::frame(void)
 	{
 	/* Calculate the transformed device's transformation: */
@@ -65,6 +65,7 @@ class OffsetTool:public TransformTool
 	
 	/* Methods from Tool: */
 	virtual const ToolFactory* getFactory(void) const;
+	virtual bool isFrameInputDriven(void) const;
 	virtual void frame(void);
 	};
 
@@ -211,6 +211,11 @@ void Tool::valuatorCallback(int,int,InputDevice::ValuatorCallbackData*)
 	{
 	}
 
+bool Tool::isFrameInputDriven(void) const
+	{
+	return false;
+	}
+
 void Tool::frame(void)
 	{
 	}
@@ -133,7 +133,8 @@ class Tool
 	void assignValuator(int deviceIndex,int deviceValuatorIndex,int newAssignedValuatorIndex); // Re-assigns a valuator of the given input device
 	virtual void buttonCallback(int deviceIndex,int deviceButtonIndex,InputDevice::ButtonCallbackData* cbData); // Method called when state of a button changes
 	virtual void valuatorCallback(int deviceIndex,int deviceValuatorIndex,InputDevice::ValuatorCallbackData* cbData); // Method called when state of a valuator changes
-	virtual void frame(void); // Method called exactly once every frame
+	virtual bool isFrameInputDriven(void) const; // Returns true if the frame method only depends on the state of the tool's input devices, and can be skipped in frames in which none of them changed
+	virtual void frame(void); // Method called once every frame, or only in frames in which an input device changed if isFrameInputDriven returns true
 	virtual void display(GLContextData& contextData) const; // Method for rendering the tool's current state into the current OpenGL context
 	};
 
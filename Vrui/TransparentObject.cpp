@@ -23,14 +23,30 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/TransparentObject.h>
 
+#include <algorithm>
+#include <Math/Constants.h>
+#include <GL/gl.h>
+#include <Vrui/DisplayState.h>
+#include <Vrui/Vrui.h>
+
 namespace Vrui {
 
+/************************************************
+Methods of class TransparentObject::DrawItemList:
+************************************************/
+
+void TransparentObject::DrawItemList::addBackgroundItem(const TransparentObject* object,unsigned int itemIndex)
+	{
+	items.push_back(DrawItem(Math::Constants<Scalar>::max,object,itemIndex));
+	}
+
 /******************************************
 Static elements of class TransparentObject:
 ******************************************/
 
 TransparentObject* TransparentObject::head=0;
 TransparentObject* TransparentObject::tail=0;
+TransparentObject::TransparencyMode TransparentObject::transparencyMode=TransparentObject::SORTED;
 
 /**********************************
 Methods of class TransparentObject:
@@ -61,11 +77,59 @@ TransparentObject::~TransparentObject(void)
 		tail=pred;
 	}
 
+void TransparentObject::submitTransparentItems(TransparentObject::DrawItemList& drawItems,GLContextData&) const
+	{
+	/* Render the entire object behind all sorted draw items: */
+	drawItems.addBackgroundItem(this,0);
+	}
+
+void TransparentObject::glRenderActionTransparentItem(unsigned int,GLContextData& contextData) const
+	{
+	/* Render the entire object: */
+	glRenderActionTransparent(contextData);
+	}
+
+void TransparentObject::setTransparencyMode(TransparentObject::TransparencyMode newTransparencyMode)
+	{
+	transparencyMode=newTransparencyMode;
+	}
+
+void TransparentObject::setBlendFunction(void)
+	{
+	if(transparencyMode==ADDITIVE)
+		{
+		/* Use additive blending, which does not depend on rendering order: */
+		glBlendFunc(GL_SRC_ALPHA,GL_ONE);
+		}
+	else
+		{
+		/* Use the over operator, which requires back-to-front order: */
+		glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+		}
+	}
+
 void TransparentObject::transparencyPass(GLContextData& contextData)
 	{
-	/* Call rendering method of all registered transparent objects: */
-	for(const TransparentObject* toPtr=head;toPtr!=0;toPtr=toPtr->succ)
-		toPtr->glRenderActionTransparent(contextData);
+	if(transparencyMode==ADDITIVE)
+		{
+		/* Call rendering method of all registered transparent objects: */
+		for(const TransparentObject* toPtr=head;toPtr!=0;toPtr=toPtr->succ)
+			toPtr->glRenderActionTransparent(contextData);
+		}
+	else
+		{
+		/* Collect the draw items of all registered transparent objects for the current eye: */
+		DrawItemList drawItems(getDisplayState(contextData).eyePosition);
+		for(const TransparentObject* toPtr=head;toPtr!=0;toPtr=toPtr->succ)
+			toPtr->submitTransparentItems(drawItems,contextData);
+		
+		/* Sort the draw items back to front; items with equal depth retain their submission order: */
+		std::stable_sort(drawItems.items.begin(),drawItems.items.end());
+		
+		/* Render all draw items: */
+		for(std::vector<DrawItemList::DrawItem>::const_iterator diIt=drawItems.items.begin();diIt!=drawItems.items.end();++diIt)
+			diIt->object->glRenderActionTransparentItem(diIt->itemIndex,contextData);
+		}
 	}
 
 }
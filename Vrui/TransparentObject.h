@@ -24,6 +24,10 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_TRANSPARENTOBJECT_INCLUDED
 #define VRUI_TRANSPARENTOBJECT_INCLUDED
 
+#include <vector>
+#include <Geometry/Point.h>
+#include <Vrui/Geometry.h>
+
 /* Forward declarations: */
 class GLContextData;
 
@@ -31,10 +35,69 @@ namespace Vrui {
 
 class TransparentObject
 	{
+	/* Embedded classes: */
+	public:
+	enum TransparencyMode // Enumerated type for the ways the transparency pass combines transparent objects
+		{
+		SORTED, // Draw items of all objects are sorted back to front for each eye and blended with the over operator
+		ADDITIVE // Objects are rendered in registration order using a commutative additive blending function
+		};
+	
+	class DrawItemList // Class to collect depth-keyed draw items of transparent objects for a single rendering pass
+		{
+		friend class TransparentObject;
+		
+		/* Embedded classes: */
+		private:
+		struct DrawItem // Structure for a single depth-keyed draw item
+			{
+			/* Elements: */
+			public:
+			Scalar depth; // Sort key of the draw item; squared distance from the eye in physical coordinates
+			const TransparentObject* object; // Object that submitted the draw item
+			unsigned int itemIndex; // Object-defined index of the draw item
+			
+			/* Constructors and destructors: */
+			DrawItem(Scalar sDepth,const TransparentObject* sObject,unsigned int sItemIndex)
+				:depth(sDepth),object(sObject),itemIndex(sItemIndex)
+				{
+				}
+			
+			/* Methods: */
+			bool operator<(const DrawItem& other) const // Back-to-front ordering: items further from the eye come first
+				{
+				return depth>other.depth;
+				}
+			};
+		
+		/* Elements: */
+		Point eyePosition; // Eye position of the current rendering pass in physical coordinates
+		std::vector<DrawItem> items; // List of draw items submitted for the current rendering pass
+		
+		/* Constructors and destructors: */
+		DrawItemList(const Point& sEyePosition)
+			:eyePosition(sEyePosition)
+			{
+			}
+		
+		/* Methods: */
+		public:
+		const Point& getEyePosition(void) const // Returns the eye position of the current rendering pass in physical coordinates
+			{
+			return eyePosition;
+			}
+		void addItem(const TransparentObject* object,const Point& position,unsigned int itemIndex) // Adds a draw item for the given object, centered at the given position in physical coordinates
+			{
+			items.push_back(DrawItem(Geometry::sqrDist(eyePosition,position),object,itemIndex));
+			}
+		void addBackgroundItem(const TransparentObject* object,unsigned int itemIndex); // Adds a draw item that is rendered behind all other items, in submission order
+		};
+	
 	/* Elements: */
 	private:
 	static TransparentObject* head; // Head of the list of transparent objects
 	static TransparentObject* tail; // Tail of the list of transparent objects
+	static TransparencyMode transparencyMode; // Current mode of the transparency pass
 	TransparentObject* pred; // Pointer to predecessor in the list
 	TransparentObject* succ; // Pointer to successor in the list
 	
@@ -45,10 +108,18 @@ class TransparentObject
 	
 	/* Methods: */
 	virtual void glRenderActionTransparent(GLContextData& contextData) const =0; // Rendering method
+	virtual void submitTransparentItems(DrawItemList& drawItems,GLContextData& contextData) const; // Submits the object's draw items for the current eye; default submits the entire object as a single background item
+	virtual void glRenderActionTransparentItem(unsigned int itemIndex,GLContextData& contextData) const; // Renders a single previously submitted draw item; default calls glRenderActionTransparent
 	static bool needRenderPass(void) // Returns true if there are any registered transparent objects
 		{
 		return head!=0;
 		}
+	static TransparencyMode getTransparencyMode(void) // Returns the current mode of the transparency pass
+		{
+		return transparencyMode;
+		}
+	static void setTransparencyMode(TransparencyMode newTransparencyMode); // Sets the mode of the transparency pass
+	static void setBlendFunction(void); // Sets the OpenGL blending function appropriate for the current transparency mode
 	static void transparencyPass(GLContextData& contextData); // Calls the transparent rendering methods of all transparent objects; does not change OpenGL state
 	};
 
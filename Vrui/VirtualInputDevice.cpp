@@ -232,24 +232,24 @@ void VirtualInputDevice::renderDevice(const InputDevice* device,bool navigationa
 	/* Get the device's current transformation: */
 	OGTransform transform(device->getTransformation());
 	
-	/* Render glyphs for the device's buttons: */
+	/* Batch glyphs for the device's buttons: */
 	int numButtons=device->getNumButtons();
 	OGTransform buttonTransform=OGTransform::translate(transform.getTranslation()+buttonOffset-buttonPanelDirection*(Scalar(0.5)*buttonSpacing*Scalar(numButtons-1)));
 	buttonTransform*=OGTransform::scale(buttonSize);
 	Vector step=buttonPanelDirection*(buttonSpacing/buttonSize);
 	for(int i=0;i<numButtons;++i)
 		{
-		glyphRenderer->renderGlyph(device->getButtonState(i)?onButtonGlyph:offButtonGlyph,buttonTransform,glyphRendererContextDataItem);
+		glyphRenderer->batchGlyph(device->getButtonState(i)?onButtonGlyph:offButtonGlyph,buttonTransform,glyphRendererContextDataItem);
 		buttonTransform*=OGTransform::translate(step);
 		}
 	
-	/* Render a glyph for the device's navigational coordinate mode button: */
+	/* Batch a glyph for the device's navigational coordinate mode button: */
 	buttonTransform=OGTransform::translate(transform.getTranslation()-buttonOffset);
 	buttonTransform*=OGTransform::scale(buttonSize);
-	glyphRenderer->renderGlyph(navigational?onButtonGlyph:offButtonGlyph,buttonTransform,glyphRendererContextDataItem);
+	glyphRenderer->batchGlyph(navigational?onButtonGlyph:offButtonGlyph,buttonTransform,glyphRendererContextDataItem);
 	
-	/* Render a glyph for the device itself: */
-	glyphRenderer->renderGlyph(deviceGlyph,transform,glyphRendererContextDataItem);
+	/* Batch a glyph for the device itself: */
+	glyphRenderer->batchGlyph(deviceGlyph,transform,glyphRendererContextDataItem);
 	}
 
 }
@@ -23,6 +23,8 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 
 #include <Vrui/Vislets/SceneGraphViewer.h>
 
+#include <string.h>
+#include <iostream>
 #include <Misc/FileCharacterSource.h>
 #include <GL/gl.h>
 #include <GL/GLTransformationWrappers.h>
@@ -109,24 +111,44 @@ Methods of class SceneGraphViewer:
 *********************************/
 
 SceneGraphViewer::SceneGraphViewer(int numArguments,const char* const arguments[])
+	:sortShapes(false),reportStateChanges(false),
+	 numRenderPasses(0),numStateChanges(0.0),numRedundantStateChanges(0.0)
 	{
-	/* Create a node creator: */
+	/* Create a node creator processing node geometry on Vrui's task scheduler: */
 	SceneGraph::NodeCreator nodeCreator;
+	nodeCreator.setTaskScheduler(getTaskScheduler());
 	
 	/* Create the scene graph's root node: */
 	root=new SceneGraph::GroupNode;
 	
-	/* Load all VRML files from the command line: */
+	/* Parse the command line and load all VRML files: */
 	for(int i=0;i<numArguments;++i)
 		{
-		Misc::FileCharacterSource inputFile(arguments[i]);
-		SceneGraph::VRMLFile vrmlFile(arguments[i],inputFile,nodeCreator);
-		vrmlFile.parse(root);
+		if(arguments[i][0]=='-')
+			{
+			if(strcasecmp(arguments[i]+1,"SORTSHAPES")==0)
+				sortShapes=true;
+			else if(strcasecmp(arguments[i]+1,"REPORTSTATECHANGES")==0)
+				reportStateChanges=true;
+			}
+		else
+			{
+			Misc::FileCharacterSource inputFile(arguments[i]);
+			SceneGraph::VRMLFile vrmlFile(arguments[i],inputFile,nodeCreator);
+			vrmlFile.parse(root);
+			}
 		}
 	}
 
 SceneGraphViewer::~SceneGraphViewer(void)
 	{
+	if(reportStateChanges&&numRenderPasses>0)
+		{
+		/* Report the average numbers of state changes per rendering pass: */
+		std::cout<<"SceneGraphViewer: "<<numStateChanges/double(numRenderPasses)<<" OpenGL state changes and ";
+		std::cout<<numRedundantStateChanges/double(numRenderPasses)<<" skipped redundant state changes per rendering pass over ";
+		std::cout<<numRenderPasses<<" passes"<<std::endl;
+		}
 	}
 
 VisletFactory* SceneGraphViewer::getFactory(void) const
@@ -156,12 +178,24 @@ void SceneGraphViewer::display(GLContextData& contextData) const
 	glLoadIdentity();
 	glMultMatrix(getDisplayState(contextData).modelviewNavigational);
 	
+	{
 	/* Create a render state to traverse the scene graph: */
 	SceneGraph::GLRenderState renderState(contextData,getHeadPosition(),getNavigationTransformation().inverseTransform(getUpDirection()));
+	renderState.sortShapes=sortShapes;
 	
 	/* Traverse the scene graph: */
 	root->glRenderAction(renderState);
 	
+	if(reportStateChanges)
+		{
+		/* Accumulate the rendering pass' state change counts: */
+		Threads::Mutex::Lock stateChangeCountLock(stateChangeCountMutex);
+		++numRenderPasses;
+		numStateChanges+=double(renderState.getNumStateChanges());
+		numRedundantStateChanges+=double(renderState.getNumRedundantStateChanges());
+		}
+	}
+	
 	/* Restore OpenGL state: */
 	glPopMatrix();
 	glPopAttrib();
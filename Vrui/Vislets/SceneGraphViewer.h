@@ -24,6 +24,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #ifndef VRUI_VISLETS_SCENEGRAPHVIEWER_INCLUDED
 #define VRUI_VISLETS_SCENEGRAPHVIEWER_INCLUDED
 
+#include <Threads/Mutex.h>
 #include <SceneGraph/GroupNode.h>
 #include <Vrui/Vislet.h>
 
@@ -60,6 +61,12 @@ class SceneGraphViewer:public Vrui::Vislet
 	static SceneGraphViewerFactory* factory; // Pointer to the factory object for this class
 	
 	SceneGraph::GroupNodePointer root; // The scene graph root node
+	bool sortShapes; // Flag whether group nodes render their shape children grouped by appearance
+	bool reportStateChanges; // Flag whether to report the average numbers of OpenGL state changes per rendering pass when the vislet is destroyed
+	mutable Threads::Mutex stateChangeCountMutex; // Mutex serializing access to the state change counts from concurrent rendering threads
+	mutable unsigned int numRenderPasses; // Number of rendering passes so far
+	mutable double numStateChanges; // Total number of OpenGL state changes issued during all rendering passes
+	mutable double numRedundantStateChanges; // Total number of redundant state changes skipped during all rendering passes
 	
 	/* Constructors and destructors: */
 	public:
@@ -43,6 +43,7 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/TimerEventScheduler.h>
 #include <Comm/MulticastPipeMultiplexer.h>
 #include <Comm/MulticastPipe.h>
+#include <Threads/TaskScheduler.h>
 #include <Math/Constants.h>
 #include <Geometry/GeometryValueCoders.h>
 #include <GL/gl.h>
@@ -297,6 +298,7 @@ VruiState::VruiState(Comm::MulticastPipeMultiplexer* sMultiplexer,Comm::Multicas
 	:multiplexer(sMultiplexer),
 	 master(multiplexer==0||multiplexer->isMaster()),
 	 pipe(sPipe),
+	 taskScheduler(0),
 	 inchScale(1.0),
 	 meterScale(1000.0/25.4),
 	 displayCenter(0.0,0.0,0.0),displaySize(1.0),
@@ -405,6 +407,9 @@ VruiState::~VruiState(void)
 	
 	/* Delete glyph management: */
 	delete glyphRenderer;
+	
+	/* Delete parallel computation management: */
+	delete taskScheduler;
 	}
 
 void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSection)
@@ -420,6 +425,10 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 		multiplexer->setBarrierWaitTimeout(configFileSection.retrieveValue<double>("./multipipeBarrierWaitTimeout",0.01));
 		}
 	
+	/* Create the task scheduler; threads waiting for parallel computations execute tasks themselves, so leave one processor for them by default: */
+	int numTaskSchedulerThreads=configFileSection.retrieveValue<int>("./numTaskSchedulerThreads",Threads::TaskScheduler::getNumProcessors()-1);
+	taskScheduler=new Threads::TaskScheduler(numTaskSchedulerThreads);
+	
 	/* Read the conversion factors from Vrui physical coordinate units to inches and meters: */
 	inchScale=configFileSection.retrieveValue<Scalar>("./inchScale",inchScale);
 	Scalar readMeterScale=configFileSection.retrieveValue<Scalar>("./meterScale",Scalar(0));
@@ -540,6 +549,8 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	backplaneDist=configFileSection.retrieveValue<Scalar>("./backplaneDist",backplaneDist);
 	backgroundColor=configFileSection.retrieveValue<Color>("./backgroundColor",backgroundColor);
 	ambientLightColor=configFileSection.retrieveValue<Color>("./ambientLightColor",ambientLightColor);
+	if(configFileSection.retrieveValue<bool>("./additiveTransparency",false))
+		TransparentObject::setTransparencyMode(TransparentObject::ADDITIVE);
 	
 	/* Initialize widget management: */
 	widgetMaterial=configFileSection.retrieveValue<GLMaterial>("./widgetMaterial",widgetMaterial);
@@ -564,6 +575,7 @@ void VruiState::initialize(const Misc::ConfigurationFileSection& configFileSecti
 	widgetManager->setStyleSheet(&uiStyleSheet);
 	widgetManager->setTimerEventScheduler(timerEventScheduler);
 	widgetManager->setDrawOverlayWidgets(configFileSection.retrieveValue<bool>("./drawOverlayWidgets",widgetManager->getDrawOverlayWidgets()));
+	widgetManager->setRetainedMode(configFileSection.retrieveValue<bool>("./retainedModeWidgets",widgetManager->getRetainedMode()));
 	popWidgetsOnScreen=configFileSection.retrieveValue<bool>("./popWidgetsOnScreen",popWidgetsOnScreen);
 	
 	/* Create the coordinate manager: */
@@ -916,7 +928,7 @@ void VruiState::display(DisplayState* displayState,GLContextData& contextData) c
 		{
 		/* Set up OpenGL state for transparency: */
 		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+		TransparentObject::setBlendFunction();
 		glDepthMask(GL_FALSE);
 		
 		/* Execute transparent rendering pass: */
@@ -1158,6 +1170,11 @@ Comm::MulticastPipe* openPipe(void)
 		return 0;
 	}
 
+Threads::TaskScheduler* getTaskScheduler(void)
+	{
+	return vruiState->taskScheduler;
+	}
+
 GlyphRenderer* getGlyphRenderer(void)
 	{
 	return vruiState->glyphRenderer;
@@ -1168,6 +1185,16 @@ void renderGlyph(const Glyph& glyph,const OGTransform& transformation,GLContextD
 	vruiState->glyphRenderer->renderGlyph(glyph,transformation,vruiState->glyphRenderer->getContextDataItem(contextData));
 	}
 
+void batchGlyph(const Glyph& glyph,const OGTransform& transformation,GLContextData& contextData)
+	{
+	vruiState->glyphRenderer->batchGlyph(glyph,transformation,vruiState->glyphRenderer->getContextDataItem(contextData));
+	}
+
+void renderGlyphBatch(GLContextData& contextData)
+	{
+	vruiState->glyphRenderer->renderBatch(vruiState->glyphRenderer->getContextDataItem(contextData));
+	}
+
 VirtualInputDevice* getVirtualInputDevice(void)
 	{
 	return vruiState->virtualInputDevice;
@@ -51,6 +51,9 @@ namespace Comm {
 class MulticastPipeMultiplexer;
 class MulticastPipe;
 }
+namespace Threads {
+class TaskScheduler;
+}
 namespace GLMotif {
 class Container;
 class Popup;
@@ -106,6 +109,9 @@ struct VruiState
 	bool master;
 	Comm::MulticastPipe* pipe;
 	
+	/* Parallel computation management: */
+	Threads::TaskScheduler* taskScheduler; // Process-wide scheduler for parallel computations
+	
 	/* Environment dimensions: */
 	Scalar inchScale; // Length of an inch expressed in the (arbitrary) Vrui physical coordinate units
 	Scalar meterScale; // Length of a meter expressed in the (arbitrary) Vrui physical coordinate units
@@ -37,10 +37,11 @@ Free Software Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
 #include <Misc/StandardValueCoders.h>
 #include <Misc/CompoundValueCoders.h>
 #include <Misc/ConfigurationFile.h>
+#include <Misc/ConfigurationFileSnapshot.h>
 #include <Misc/TimerEventScheduler.h>
 #include <Threads/Thread.h>
 #include <Threads/Mutex.h>
-#include <Threads/Barrier.h>
+#include <Threads/SpinBarrier.h>
 #include <Comm/FdSet.h>
 #include <Comm/MulticastPipeMultiplexer.h>
 #include <Comm/MulticastPipe.h>
@@ -86,7 +87,7 @@ int vruiNumWindows=0;
 VRWindow** vruiWindows=0;
 bool vruiWindowsMultithreaded=false;
 Threads::Thread* vruiRenderingThreads=0;
-Threads::Barrier vruiRenderingBarrier;
+Threads::SpinBarrier vruiRenderingBarrier;
 int vruiNumSoundContexts=0;
 SoundContext** vruiSoundContexts=0;
 Comm::MulticastPipeMultiplexer* vruiMultiplexer=0;
@@ -359,8 +360,11 @@ void init(int& argc,char**& argv,char**&)
 			/* Open a multicast pipe: */
 			vruiPipe=vruiMultiplexer->openPipe();
 			
-			/* Read the entire configuration file and the root section name: */
-			vruiConfigFile=new Misc::ConfigurationFile(*vruiPipe);
+			/* Read the entire configuration file as a single snapshot, and the root section name: */
+			{
+			Misc::ConfigurationFileSnapshot configFileSnapshot(*vruiPipe);
+			vruiConfigFile=new Misc::ConfigurationFile(configFileSnapshot);
+			}
 			char* rootSectionName=Misc::readCString(*vruiPipe);
 			
 			/* Go to the given root section: */
@@ -555,8 +559,8 @@ void init(int& argc,char**& argv,char**&)
 				/* Open a multicast pipe: */
 				vruiPipe=vruiMultiplexer->openPipe();
 				
-				/* Send the entire Vrui configuration file and the root section name across the pipe: */
-				vruiConfigFile->writeToPipe(*vruiPipe);
+				/* Send the entire Vrui configuration file as a single snapshot, and the root section name across the pipe: */
+				Misc::ConfigurationFileSnapshot(*vruiConfigFile).writeToPipe(*vruiPipe);
 				Misc::writeCString(rootSectionName,*vruiPipe);
 				
 				/* Write the application's command line: */
@@ -776,6 +780,7 @@ void startDisplay(PerDisplayInitFunctionType perDisplayInitFunction,void* userDa
 			{
 			/* Initialize the rendering barrier: */
 			vruiRenderingBarrier.setNumSynchronizingThreads(vruiNumWindows+1);
+			vruiRenderingBarrier.setSpinTime(vruiConfigFile->retrieveValue<double>("./renderingBarrierSpinTime",vruiRenderingBarrier.getSpinTime()));
 			
 			/* Create one rendering thread for each window (which will in turn create the windows themselves): */
 			vruiRenderingThreads=new Threads::Thread[vruiNumWindows];
@@ -35,6 +35,9 @@ class TimerEventScheduler;
 namespace Comm {
 class MulticastPipe;
 }
+namespace Threads {
+class TaskScheduler;
+}
 class GLContextData;
 class GLMaterial;
 class GLFont;
@@ -125,9 +128,14 @@ int getNumNodes(void); // Returns number of multipipe nodes, including master
 Comm::MulticastPipe* getMainPipe(void); // Returns Vrui's main frame pipe; safe to use inside frame function, user must call finishMessage() when done (returns 0 if called in a non-cluster environment)
 Comm::MulticastPipe* openPipe(void); // Opens a pipe for 1-to-n communication from master to all slaves (returns 0 if called in a non-cluster environment)
 
+/* Manage parallel computations: */
+Threads::TaskScheduler* getTaskScheduler(void); // Returns the process-wide task scheduler shared by all parallel computations on the multipipe node the caller is running on
+
 /* Manage glyph rendering: */
 GlyphRenderer* getGlyphRenderer(void); // Returns pointer to the glyph renderer
 void renderGlyph(const Glyph& glyph,const OGTransform& transformation,GLContextData& contextData); // Renders the given glyph with the given transformation
+void batchGlyph(const Glyph& glyph,const OGTransform& transformation,GLContextData& contextData); // Adds the given glyph to the context's glyph batch without rendering it; glyph must remain valid until the batch is rendered, and transformation is relative to the modelview matrix current at that time
+void renderGlyphBatch(GLContextData& contextData); // Renders all glyphs batched in the context since the last call; called automatically after all tools were displayed
 
 /* Manage the input graph: */
 VirtualInputDevice* getVirtualInputDevice(void); // Returns pointer to the root virtual input device